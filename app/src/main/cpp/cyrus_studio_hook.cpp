@@ -1,13 +1,25 @@
+#include <errno.h>
+#include <spawn.h>
 #include <unistd.h>
 #include <android/log.h>
 #include <jni.h>
 #include <string>
+#include <vector>
+#include <atomic>
+#include <cstring>
 #include <stddef.h>
 #include "shadowhook.h"
 
 #include "dex/dex_file.h"
 #include "dex/art_method.h"
 #include "dex/class_accessor.h"
+#include "dex/dex_reader.h"
+#include "hook/active_invoker.h"
+#include "hook/code_capture.h"
+#include "hook/dex2oat_scheduler.h"
+#include "hook/dex_file_cache.h"
+#include "hook/exec_rules.h"
+#include "hook/instrumented_hook.h"
 #include <sys/mman.h>
 
 using namespace cyurs;
@@ -25,43 +37,135 @@ __attribute__ ((constructor)) void init() {
     g_sdkLevel = android_get_device_api_level();
 }
 
+// 当前的 execve / posix_spawn 规则，替换后旧的规则集不释放（可能还有线程在匹配）
+static std::atomic<const hook::ExecRuleSet *> g_exec_rules{nullptr};
+
+// 没有加载规则时的默认行为：拒绝 dex2oat
+static const char kDefaultExecRules[] = "deny **dex2oat**\n";
+
 // 原始 execve 函数指针
 int (*orig_execve)(const char *__file, char *const *__argv, char *const *__envp);
 
+int (*orig_posix_spawn)(pid_t *__pid, const char *__path, const posix_spawn_file_actions_t *__actions,
+                        const posix_spawnattr_t *__attr, char *const __argv[], char *const __env[]);
+
+int (*orig_posix_spawnp)(pid_t *__pid, const char *__file, const posix_spawn_file_actions_t *__actions,
+                         const posix_spawnattr_t *__attr, char *const __argv[], char *const __env[]);
+
+/**
+ * 按规则处理一次进程创建，path / argv 可能被替换（argv 指向 buffer）
+ *
+ * 只在规则生效时打印日志；execve 可能在 vfork 的子进程中调用，放行的调用不做任何分配。
+ * ScopedExecRulesBypass 作用域内直接放行：posix_spawn 已经应用过规则，或者是模块自己启动的子进程。
+ */
+static hook::ExecAction apply_exec_rules(const char *api, const char *&path, char *const *&argv,
+                                         hook::ExecArgv &buffer) {
+    if (hook::ScopedExecRulesBypass::active()) return hook::kExecAllow;
+    const hook::ExecRuleSet *rules = g_exec_rules.load(std::memory_order_acquire);
+    if (rules == nullptr) return hook::kExecAllow;
+    const char *original = path;
+    const hook::ExecRule *rule = nullptr;
+    hook::ExecAction action = rules->Apply(path, argv, buffer, &rule);
+    if (rule != nullptr && action != hook::kExecAllow) {
+        LOGW("%s %s: %s (rule line %u) -> %s", api, original, hook::exec_action_name(action), rule->line,
+             path == nullptr ? "" : path);
+    }
+    return action;
+}
+
 // 替代 execve 实现
 int my_execve(const char *__file, char *const *__argv, char *const *__envp) {
+    hook::ExecArgv buffer;
+    if (apply_exec_rules("execve", __file, __argv, buffer) == hook::kExecDeny) {
+        errno = EACCES;
+        return -1;
+    }
+    return orig_execve(__file, __argv, __envp);
+}
 
-    LOGI("execve called: %s", __file);
+int my_posix_spawn(pid_t *__pid, const char *__path, const posix_spawn_file_actions_t *__actions,
+                   const posix_spawnattr_t *__attr, char *const __argv[], char *const __env[]) {
+    hook::ExecArgv buffer;
+    char *const *argv = __argv;
+    // posix_spawn 通过返回值报告错误
+    if (apply_exec_rules("posix_spawn", __path, argv, buffer) == hook::kExecDeny) return EACCES;
+    // bionic 在 vfork 的子进程中调用 execve，规则不再应用第二次（rewrite 会重复追加参数）
+    hook::ScopedExecRulesBypass bypass;
+    return orig_posix_spawn(__pid, __path, __actions, __attr, argv, __env);
+}
 
-    if (__file && strstr(__file, "dex2oat")) {
-        LOGW("Blocked dex2oat execution: %s", __file);
-        // 返回失败，模拟 dex2oat 调用失败
-        return -1;
+int my_posix_spawnp(pid_t *__pid, const char *__file, const posix_spawn_file_actions_t *__actions,
+                    const posix_spawnattr_t *__attr, char *const __argv[], char *const __env[]) {
+    hook::ExecArgv buffer;
+    char *const *argv = __argv;
+    if (apply_exec_rules("posix_spawnp", __file, argv, buffer) == hook::kExecDeny) return EACCES;
+    hook::ScopedExecRulesBypass bypass;
+    return orig_posix_spawnp(__pid, __file, __actions, __attr, argv, __env);
+}
+
+static void log_hook_result(const char *sym_name, void *handle) {
+    if (handle != nullptr) {
+        LOGI("Successfully hooked %s", sym_name);
+    } else {
+        LOGW("Failed to hook %s", sym_name);
     }
+}
 
-    // 调用原始 execve
-    return orig_execve(__file, __argv, __envp);
+template<auto Replacement>
+static void hook_libc(const char *sym_name, void **orig_addr) {
+    log_hook_result(sym_name, hook::InstrumentedHookSym<Replacement>("libc.so", sym_name, orig_addr));
 }
 
 extern "C"
 JNIEXPORT void JNICALL
 Java_com_cyrus_example_hook_CyrusStudioHook_hookExecve(JNIEnv *, jclass) {
-    void *handle = shadowhook_hook_sym_name(
-            "libc.so",  // 函数所在模块
-            "execve", // 要 hook 的符号名
-            reinterpret_cast<void *>(my_execve),
-            reinterpret_cast<void **>(&orig_execve)
-    );
+    if (g_exec_rules.load(std::memory_order_acquire) == nullptr) {
+        std::string error;
+        const hook::ExecRuleSet *expected = nullptr;
+        const hook::ExecRuleSet *rules = hook::ExecRuleSet::Parse(kDefaultExecRules, &error).release();
+        if (!g_exec_rules.compare_exchange_strong(expected, rules)) delete rules;
+    }
 
-    if (handle != nullptr) {
-        LOGI("Successfully hooked execve");
-    } else {
-        LOGW("Failed to hook execve");
+    // execve 会在 vfork 的子进程中调用（bionic 的 posix_spawn、dex2oat 调度的 vfork），不套计时跳板：
+    // 计时在返回时记录，子进程中的记录会写到父进程的内存（execve 成功也不会返回，统计没有意义）
+    log_hook_result("execve", shadowhook_hook_sym_name("libc.so", "execve", reinterpret_cast<void *>(my_execve),
+                                                       reinterpret_cast<void **>(&orig_execve)));
+    // posix_spawn 在 API 28 才加入 bionic，旧系统上 hook 失败不影响 execve
+    hook_libc<my_posix_spawn>("posix_spawn", reinterpret_cast<void **>(&orig_posix_spawn));
+    hook_libc<my_posix_spawnp>("posix_spawnp", reinterpret_cast<void **>(&orig_posix_spawnp));
+}
+
+extern "C"
+JNIEXPORT jint JNICALL
+Java_com_cyrus_example_hook_CyrusStudioHook_loadExecRules(JNIEnv *env, jclass, jstring path_) {
+    const char *path = env->GetStringUTFChars(path_, nullptr);
+    std::string error;
+    std::unique_ptr<hook::ExecRuleSet> rules = hook::ExecRuleSet::Load(path, &error);
+    if (rules == nullptr) {
+        LOGE("load exec rules %s failed: %s", path, error.c_str());
+        env->ReleaseStringUTFChars(path_, path);
+        return -1;
     }
+    auto count = static_cast<jint>(rules->size());
+    LOGI("loaded %d exec rules from %s", count, path);
+    env->ReleaseStringUTFChars(path_, path);
+    g_exec_rules.store(rules.release(), std::memory_order_release);
+    return count;
 }
 
 ///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
-extern char **environ;
+static std::vector<std::string> to_string_vector(JNIEnv *env, jobjectArray array) {
+    std::vector<std::string> strings;
+    jsize count = array == nullptr ? 0 : env->GetArrayLength(array);
+    for (jsize i = 0; i < count; ++i) {
+        auto str = static_cast<jstring>(env->GetObjectArrayElement(array, i));
+        const char *chars = str == nullptr ? nullptr : env->GetStringUTFChars(str, nullptr);
+        strings.emplace_back(chars == nullptr ? "" : chars);
+        if (chars != nullptr) env->ReleaseStringUTFChars(str, chars);
+        env->DeleteLocalRef(str);
+    }
+    return strings;
+}
 
 extern "C"
 JNIEXPORT jboolean JNICALL
@@ -70,35 +174,49 @@ Java_com_cyrus_example_hook_CyrusStudioHook_dex2oat(JNIEnv *env, jclass,
                                                     jstring oatPath_) {
     const char *dexPath = env->GetStringUTFChars(dexPath_, nullptr);
     const char *oatPath = env->GetStringUTFChars(oatPath_, nullptr);
-
-    const char *dex2oatPath = "/system/bin/dex2oat";
-
-    char dexArg[256];
-    char oatArg[256];
-    char isaArg[] = "--instruction-set=arm64";
-    snprintf(dexArg, sizeof(dexArg), "--dex-file=%s", dexPath);
-    snprintf(oatArg, sizeof(oatArg), "--oat-file=%s", oatPath);
-
-    const char *argv[] = {
-            dex2oatPath,
-            dexArg,
-            oatArg,
-            isaArg,
-            "--runtime-arg", "-Xbootclasspath:/apex/com.android.art/javalib/core-oj.jar:/apex/com.android.art/javalib/core-libart.jar",
-            "--boot-image=/apex/com.android.art/javalib/boot.art",
-            nullptr
-    };
-
-    LOGI("Calling dex2oat with: %s %s %s", dexArg, oatArg, isaArg);
-
-    int ret = execve(dex2oatPath, (char *const *) argv, environ);
-
-    LOGE("execve called with ret: %s", ret);
-
+    std::vector<hook::Dex2oatJob> jobs = {{dexPath, oatPath}};
     env->ReleaseStringUTFChars(dexPath_, dexPath);
     env->ReleaseStringUTFChars(oatPath_, oatPath);
 
-    return false; // execve 不返回，除非失败
+    // 在子进程中执行，等待 dex2oat 退出
+    std::vector<hook::Dex2oatResult> results = hook::RunDex2oatJobs(jobs, hook::Dex2oatOptions());
+    return results[0].status == 0;
+}
+
+extern "C"
+JNIEXPORT jintArray JNICALL
+Java_com_cyrus_example_hook_CyrusStudioHook_dex2oatBatch(JNIEnv *env, jclass, jobjectArray dexPaths,
+                                                         jobjectArray oatPaths, jstring compiler_,
+                                                         jobjectArray args, jstring cacheDir_, jint maxJobs) {
+    std::vector<std::string> dex_paths = to_string_vector(env, dexPaths);
+    std::vector<std::string> oat_paths = to_string_vector(env, oatPaths);
+    if (dex_paths.size() != oat_paths.size()) {
+        LOGE("dex2oatBatch: %zu dex paths but %zu oat paths", dex_paths.size(), oat_paths.size());
+        return nullptr;
+    }
+    std::vector<hook::Dex2oatJob> jobs;
+    for (size_t i = 0; i < dex_paths.size(); ++i) jobs.push_back({dex_paths[i], oat_paths[i]});
+
+    hook::Dex2oatOptions options;
+    if (compiler_ != nullptr) {
+        const char *compiler = env->GetStringUTFChars(compiler_, nullptr);
+        options.compiler = compiler;
+        env->ReleaseStringUTFChars(compiler_, compiler);
+    }
+    if (cacheDir_ != nullptr) {
+        const char *cache_dir = env->GetStringUTFChars(cacheDir_, nullptr);
+        options.cache_dir = cache_dir;
+        env->ReleaseStringUTFChars(cacheDir_, cache_dir);
+    }
+    options.args = to_string_vector(env, args);
+    options.max_jobs = maxJobs;
+
+    std::vector<hook::Dex2oatResult> results = hook::RunDex2oatJobs(jobs, options);
+    std::vector<jint> statuses;
+    for (const hook::Dex2oatResult &result: results) statuses.push_back(result.status);
+    jintArray array = env->NewIntArray(static_cast<jsize>(statuses.size()));
+    if (array != nullptr) env->SetIntArrayRegion(array, 0, static_cast<jsize>(statuses.size()), statuses.data());
+    return array;
 }
 
 
@@ -131,45 +249,30 @@ void hexdump(const void *addr, size_t size) {
 
 typedef unsigned char byte;
 
+// 当前的补丁表；替换后旧表不释放，可能还有线程在 hook 中使用
+std::atomic<const hook::PatchTable *> g_patch_table{nullptr};
+
 void *(*orig_LoadMethod)(void *, void *, void *, void *, void *);
 
 void *my_LoadMethod(void *linker, void *dex_file, void *method, void *klass_handle, void *dst) {
 
-    // DexFile
-    std::string location;
-    uint8_t *begin = nullptr;
-    uint64_t dexSize = 0;
-    if (g_sdkLevel >= 35) {
-        auto *dexFileV35 = (V35::DexFile *) dex_file;
-        location = dexFileV35->location_;
-        begin = (uint8_t *) dexFileV35->begin_;
-        dexSize = dexFileV35->header_->file_size_;
-    } else if (g_sdkLevel >= __ANDROID_API_P__) {
-        auto *dexFileV28 = (V28::DexFile *) dex_file;
-        location = dexFileV28->location_;
-        begin = (uint8_t *) dexFileV28->begin_;
-        dexSize = dexFileV28->size_ == 0 ? dexFileV28->header_->file_size_ : dexFileV28->size_;
-    } else {
-        auto *dexFileV21 = (V21::DexFile *) dex_file;
-        location = dexFileV21->location_;
-        begin = (uint8_t *) dexFileV21->begin_;
-        dexSize = dexFileV21->size_ == 0 ? dexFileV21->header_->file_size_ : dexFileV21->size_;
-    }
-
-    // 打印 DexFile 信息
-    LOGI("[pid=%d][API=%d] my_LoadMethod:\n  DexFile Base    = %p\n  DexFile Size    = %zu bytes\n  DexFile Location= %s",
-         getpid(), g_sdkLevel, begin, dexSize, location.c_str());
-
     // 调用原始函数，使 ArtMethod 数据填充完成
     void *result = orig_LoadMethod(linker, dex_file, method, klass_handle, dst);
 
+    // DexFile 元数据：begin / size / checksum，每个 DexFile 只解析一次
+    const hook::DexFileMeta *meta = hook::DexFileCache::instance().Get(dex_file, g_sdkLevel);
+    if (meta == nullptr) return result;
+    const uint8_t *begin = meta->info.begin;
+    size_t dexSize = meta->info.size;
+
     // ArtMethod
     uint32_t dex_code_item_offset_ = -1;
     uint32_t dex_method_index_;
     if (g_sdkLevel >= 31) {
         auto *dstV31 = (V31::ArtMethod *) dst;
-        auto classAccessor_method = reinterpret_cast<Method &>(method);
-        dex_code_item_offset_ = classAccessor_method.code_off_;
+        // method 是 const ClassAccessor::Method &，传进来的是指针
+        auto *classAccessor_method = static_cast<const Method *>(method);
+        dex_code_item_offset_ = classAccessor_method->code_off_;
         dex_method_index_ = dstV31->dex_method_index_;
     } else {
         auto *dstV28 = (V28::ArtMethod *) dst;
@@ -177,47 +280,44 @@ void *my_LoadMethod(void *linker, void *dex_file, void *method, void *klass_hand
         dex_method_index_ = dstV28->dex_method_index_;
     }
 
-    // 打印 Method 信息
-    LOGI("[pid=%d][API=%d] my_LoadMethod:\n"
-         "  ArtMethod.dex_code_item_offset_ = 0x%x\n"
-         "  ArtMethod.dex_method_index_     = %d",
-         getpid(), g_sdkLevel, dex_code_item_offset_, dex_method_index_);
+    // 以 ART 刚加载的 code_item_offset 为准（壳可能在运行时改写 class_data / code_off）
+    if (dex_code_item_offset_ == 0) return result;
 
-    if (dex_method_index_ == 73) { // method_id[73]	java.lang.String com.cyrus.example.plugin.PluginClass.getString()
+    // cdex 的 code_item 格式不同，不采集也不回填
+    if (!meta->standard_dex) return result;
+    if (dex_code_item_offset_ >= dexSize || dexSize - dex_code_item_offset_ < sizeof(dex::CodeItem)) return result;
+    const uint8_t *code_item = begin + dex_code_item_offset_;
 
-        // 设置 dex 内存可写
-        int result = mprotect(begin, dexSize, PROT_WRITE);
-        if (result == 0) {
-            LOGI("mprotect succeeded: begin=%p, size=%zu", begin, dexSize);
-        } else {
-            LOGI("mprotect failed: begin=%p, size=%zu, errno=%d", begin, dexSize, errno);
+    // 采集原始 code_item：只拷贝到当前线程的缓冲区，由后台线程批量写文件
+    hook::CodeCapture &capture = hook::CodeCapture::instance();
+    if (capture.running()) {
+        size_t code_len = dex::ComputeCodeItemSize(code_item, dexSize - dex_code_item_offset_);
+        if (code_len != 0) {
+            capture.Capture(meta->dex_checksum, dex_method_index_, code_item, static_cast<uint32_t>(code_len));
         }
+    }
 
-        // CodeItem 地址
-        byte *code_item_addr = (byte *) begin + dex_code_item_offset_;
-        // insns 地址， 跳过 CodeItem 前 16 字节
-        byte *code_item_start = static_cast<byte *>(code_item_addr) + 16;
-        LOGI("[pid=%d] my_LoadMethod: \n"
-             "  dex_begin      = %p\n"
-             "  dex_size       = %lu\n"
-             "  code_item_off  = 0x%x\n"
-             "  code_item_addr = %p\n"
-             "  code_item_start= %p (addr + 16)",
-             getpid(), begin, dexSize, dex_code_item_offset_, code_item_addr, code_item_start);
-
-        // 打印修改前的字节码
-        hexdump(code_item_start, 6);
-
-        // 回填 CodeItem 指令
-        byte inst[6] = {0x1A, 0x00, 0x87, 0x00, 0x11, 0x00};
-        for (int i = 0; i < sizeof(inst); i++) {
-            code_item_start[i] = inst[i];
+    // 补丁表中属于这个 dex 的部分，按 method_idx 直接下标；构建时已把 MethodTable 中 code_item 所在的页设为可写
+    const hook::PatchTable *patch_table = g_patch_table.load(std::memory_order_acquire);
+    const hook::PatchEntry *patch = nullptr;
+    const hook::PatchSlice *slice = nullptr;
+    if (patch_table != nullptr) {
+        slice = meta->GetPatchSlice(patch_table);
+        patch = slice->Find(dex_method_index_);
+    }
+    if (patch != nullptr) {
+        // 回填的指令不能超过当前 code_item 的 insns 长度
+        uint32_t insns_size = reinterpret_cast<const dex::CodeItem *>(code_item)->insns_size_in_code_units_;
+        if (patch->insns_size_ > insns_size) return result;
+
+        // insns 地址，跳过 CodeItem 前 16 字节
+        byte *code_item_start = const_cast<byte *>(code_item) + 16;
+        size_t patch_bytes = patch->insns_size_ * sizeof(uint16_t);
+
+        // 回填 CodeItem 指令（快照之外的页、restoreDexPages 之后的页在这里设为可写）
+        if (slice->pages->MakeWritable(code_item_start, patch_bytes)) {
+            memcpy(code_item_start, patch_table->insns(*patch), patch_bytes);
         }
-
-        LOGI("[pid=%d] CodeItem patched successfully at %p", getpid(), code_item_start);
-
-        // 打印修改后的字节码
-        hexdump(code_item_start, 6);
     }
     return result;
 }
@@ -226,11 +326,11 @@ void *my_LoadMethod(void *linker, void *dex_file, void *method, void *klass_hand
 extern "C"
 JNIEXPORT void JNICALL
 Java_com_cyrus_example_hook_CyrusStudioHook_hookLoadMethod(JNIEnv *, jclass) {
-    void *handle = shadowhook_hook_sym_name(
+    void *handle = hook::InstrumentedHookSym<my_LoadMethod>(
             "libart.so",
             "_ZN3art11ClassLinker10LoadMethodERKNS_7DexFileERKNS_13ClassAccessor6MethodENS_6HandleINS_6mirror5ClassEEEPNS_9ArtMethodE", // 要 hook 的符号名
-            reinterpret_cast<void *>(my_LoadMethod),
-            reinterpret_cast<void **>(&orig_LoadMethod)
+            reinterpret_cast<void **>(&orig_LoadMethod),
+            "ClassLinker::LoadMethod"
     );
 
     if (handle != nullptr) {
@@ -239,3 +339,101 @@ Java_com_cyrus_example_hook_CyrusStudioHook_hookLoadMethod(JNIEnv *, jclass) {
         LOGW("Failed to hook LoadMethod");
     }
 }
+
+
+extern "C"
+JNIEXPORT jboolean JNICALL
+Java_com_cyrus_example_hook_CyrusStudioHook_startCodeCapture(JNIEnv *env, jclass, jstring path_) {
+    const char *path = env->GetStringUTFChars(path_, nullptr);
+    bool ok = hook::CodeCapture::instance().Start(path);
+    env->ReleaseStringUTFChars(path_, path);
+    return ok;
+}
+
+extern "C"
+JNIEXPORT jstring JNICALL
+Java_com_cyrus_example_hook_CyrusStudioHook_stopCodeCapture(JNIEnv *env, jclass) {
+    hook::CodeCapture &capture = hook::CodeCapture::instance();
+    capture.Stop();
+    return env->NewStringUTF(hook::format_capture_stats(capture.stats()).c_str());
+}
+
+extern "C"
+JNIEXPORT jint JNICALL
+Java_com_cyrus_example_hook_CyrusStudioHook_loadPatchTable(JNIEnv *env, jclass, jstring path_) {
+    const char *path = env->GetStringUTFChars(path_, nullptr);
+    std::string error;
+    std::unique_ptr<hook::PatchTable> table = hook::PatchTable::Open(path, &error);
+    if (table == nullptr) {
+        LOGE("load patch table %s failed: %s", path, error.c_str());
+        env->ReleaseStringUTFChars(path_, path);
+        return -1;
+    }
+    auto count = static_cast<jint>(table->size());
+    LOGI("loaded %d patches from %s", count, path);
+    env->ReleaseStringUTFChars(path_, path);
+    g_patch_table.store(table.release(), std::memory_order_release);
+    return count;
+}
+
+extern "C"
+JNIEXPORT jint JNICALL
+Java_com_cyrus_example_hook_CyrusStudioHook_restoreDexPages(JNIEnv *, jclass) {
+    size_t pages = hook::DexPageTrackerCache::instance().RestoreAll();
+    LOGI("restored %zu dex pages, mprotect calls=%llu", pages,
+         static_cast<unsigned long long>(hook::DexPageTrackerCache::instance().mprotect_calls()));
+    return static_cast<jint>(pages);
+}
+
+extern "C"
+JNIEXPORT jboolean JNICALL
+Java_com_cyrus_example_hook_CyrusStudioHook_startActiveInvoke(JNIEnv *env, jclass, jobject class_loader,
+                                                               jstring scope_path_, jstring checkpoint_path_,
+                                                               jint threads, jint classes_per_second, jint mode) {
+    if (mode < hook::kInvokeLoad || mode > hook::kInvokeResolveMethods) return JNI_FALSE;
+    hook::ClassScope scope;
+    if (scope_path_ != nullptr) {
+        const char *scope_path = env->GetStringUTFChars(scope_path_, nullptr);
+        std::string error;
+        bool ok = hook::ClassScope::Load(scope_path, scope, &error);
+        if (!ok) LOGE("load class scope %s failed: %s", scope_path, error.c_str());
+        env->ReleaseStringUTFChars(scope_path_, scope_path);
+        if (!ok) return JNI_FALSE;
+    }
+
+    hook::InvokeOptions options;
+    options.threads = threads;
+    options.classes_per_second = classes_per_second > 0 ? static_cast<uint32_t>(classes_per_second) : 0;
+    options.mode = static_cast<hook::InvokeMode>(mode);
+    if (checkpoint_path_ != nullptr) {
+        const char *checkpoint_path = env->GetStringUTFChars(checkpoint_path_, nullptr);
+        options.checkpoint_path = checkpoint_path;
+        env->ReleaseStringUTFChars(checkpoint_path_, checkpoint_path);
+    }
+    return hook::ActiveInvoker::instance().Start(env, class_loader, g_sdkLevel, scope, options);
+}
+
+extern "C"
+JNIEXPORT jstring JNICALL
+Java_com_cyrus_example_hook_CyrusStudioHook_stopActiveInvoke(JNIEnv *env, jclass) {
+    hook::ActiveInvoker::instance().Stop();
+    return env->NewStringUTF(hook::format_invoke_progress(hook::ActiveInvoker::instance().progress()).c_str());
+}
+
+extern "C"
+JNIEXPORT jstring JNICALL
+Java_com_cyrus_example_hook_CyrusStudioHook_getActiveInvokeProgress(JNIEnv *env, jclass) {
+    return env->NewStringUTF(hook::format_invoke_progress(hook::ActiveInvoker::instance().progress()).c_str());
+}
+
+extern "C"
+JNIEXPORT jstring JNICALL
+Java_com_cyrus_example_hook_CyrusStudioHook_getHookStats(JNIEnv *env, jclass) {
+    return env->NewStringUTF(hook::format_hook_stats(hook::HookStats::instance().Snapshot()).c_str());
+}
+
+extern "C"
+JNIEXPORT void JNICALL
+Java_com_cyrus_example_hook_CyrusStudioHook_resetHookStats(JNIEnv *, jclass) {
+    hook::HookStats::instance().Reset();
+}
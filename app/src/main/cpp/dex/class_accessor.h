@@ -3,12 +3,21 @@
 
 #include <stdint.h>
 #include <string>
+#include <vector>
+
+#include "dex_reader.h"
 
 
 namespace cyurs {
 
     class BaseItem {
     public:
+        uint32_t GetIndex() const { return index_; }
+
+        uint32_t GetAccessFlags() const { return access_flags_; }
+
+        const uint8_t* GetDataPointer() const { return ptr_pos_; }
+
         // Internal data pointer for reading.
         const void* dex_file_;
         const uint8_t* ptr_pos_ = nullptr;
@@ -21,10 +30,284 @@ namespace cyurs {
     // A decoded version of the method of a class_data_item.
     class Method : public BaseItem {
     public:
+        bool IsStaticOrDirect() const { return is_static_or_direct_; }
+
+        uint32_t GetCodeItemOffset() const { return code_off_; }
+
+        // 读取下一个 encoded_method，index_ 累加差值得到绝对 method_idx
+        bool Read(const uint8_t* end) {
+            uint32_t index_diff;
+            if (!dex::DecodeUnsignedLeb128Checked(&ptr_pos_, end, &index_diff) ||
+                !dex::DecodeUnsignedLeb128Checked(&ptr_pos_, end, &access_flags_) ||
+                !dex::DecodeUnsignedLeb128Checked(&ptr_pos_, end, &code_off_)) {
+                return false;
+            }
+            index_ += index_diff;
+            return true;
+        }
+
+        // direct_methods 读完后切换到 virtual_methods，method_idx 重新从 0 累加
+        void NextSection() {
+            is_static_or_direct_ = false;
+            index_ = 0u;
+        }
+
         bool is_static_or_direct_ = true;
         uint32_t code_off_ = 0u;
     };
 
+    // A decoded version of the field of a class_data_item.
+    class Field : public BaseItem {
+    public:
+        bool IsStatic() const { return is_static_; }
+
+        // 读取下一个 encoded_field，index_ 累加差值得到绝对 field_idx
+        bool Read(const uint8_t* end) {
+            uint32_t index_diff;
+            if (!dex::DecodeUnsignedLeb128Checked(&ptr_pos_, end, &index_diff) ||
+                !dex::DecodeUnsignedLeb128Checked(&ptr_pos_, end, &access_flags_)) {
+                return false;
+            }
+            index_ += index_diff;
+            return true;
+        }
+
+        // static_fields 读完后切换到 instance_fields
+        void NextSection() {
+            is_static_ = false;
+            index_ = 0u;
+        }
+
+        bool is_static_ = true;
+    };
+
+    /**
+     * 遍历一个 class_data_item，对应 ART 的 ClassAccessor
+     *
+     * 直接从 dex 映射中按顺序解码 field / method，得到绝对 field_idx / method_idx、access_flags 和 code_off，
+     * 不需要加载类，也不依赖 hook LoadMethod。class_data 被截断时遍历提前结束。
+     *
+     *   ClassAccessor accessor(reader, class_def);
+     *   for (const Method &method : accessor.GetMethods()) { ... }
+     */
+    class ClassAccessor {
+    public:
+        // 按顺序遍历一段 encoded_field / encoded_method，partition_pos 处切换到下一部分
+        template<typename DataType>
+        class DataIterator {
+        public:
+            DataIterator(const void* dex_file, const uint8_t* ptr, const uint8_t* end,
+                         uint32_t partition_pos, uint32_t iterator_end)
+                    : position_(0u), partition_pos_(partition_pos), iterator_end_(iterator_end), end_(end) {
+                data_.dex_file_ = dex_file;
+                data_.ptr_pos_ = ptr;
+                if (ptr == nullptr) {
+                    position_ = iterator_end_;
+                    return;
+                }
+                ReadData();
+            }
+
+            // 结束位置
+            explicit DataIterator(uint32_t iterator_end)
+                    : position_(iterator_end), partition_pos_(iterator_end), iterator_end_(iterator_end) {
+                data_.dex_file_ = nullptr;
+            }
+
+            bool operator!=(const DataIterator& other) const { return position_ != other.position_; }
+
+            const DataType& operator*() const { return data_; }
+
+            const DataType* operator->() const { return &data_; }
+
+            DataIterator& operator++() {
+                ++position_;
+                ReadData();
+                return *this;
+            }
+
+            // 最后一项之后的位置（遍历结束时即整个区间的结尾）
+            const uint8_t* GetDataPointer() const { return data_.ptr_pos_; }
+
+        private:
+            void ReadData() {
+                if (position_ >= iterator_end_) return;
+                if (position_ == partition_pos_) {
+                    data_.NextSection();
+                }
+                if (!data_.Read(end_)) {
+                    // 数据被截断，直接结束
+                    position_ = iterator_end_;
+                }
+            }
+
+            DataType data_;
+            uint32_t position_;
+            const uint32_t partition_pos_;
+            const uint32_t iterator_end_;
+            const uint8_t* end_ = nullptr;
+        };
+
+        template<typename DataType>
+        class Range {
+        public:
+            Range(DataIterator<DataType> begin, DataIterator<DataType> end) : begin_(begin), end_(end) {}
+
+            DataIterator<DataType> begin() const { return begin_; }
+
+            DataIterator<DataType> end() const { return end_; }
+
+        private:
+            DataIterator<DataType> begin_;
+            DataIterator<DataType> end_;
+        };
+
+        ClassAccessor(const dex::DexReader& reader, const dex::ClassDef& class_def)
+                : ClassAccessor(reader, reader.GetClassData(class_def)) {}
+
+        ClassAccessor(const dex::DexReader& reader, const uint8_t* class_data)
+                : reader_(reader), ptr_pos_(class_data) {
+            if (class_data == nullptr) return;
+            end_ = reader.DataBegin() + reader.DataSize();
+            const uint8_t* ptr = class_data;
+            if (!dex::DecodeUnsignedLeb128Checked(&ptr, end_, &num_static_fields_) ||
+                !dex::DecodeUnsignedLeb128Checked(&ptr, end_, &num_instance_fields_) ||
+                !dex::DecodeUnsignedLeb128Checked(&ptr, end_, &num_direct_methods_) ||
+                !dex::DecodeUnsignedLeb128Checked(&ptr, end_, &num_virtual_methods_)) {
+                num_static_fields_ = num_instance_fields_ = num_direct_methods_ = num_virtual_methods_ = 0u;
+                ptr_pos_ = nullptr;
+                return;
+            }
+            ptr_pos_ = ptr;
+        }
+
+        bool HasClassData() const { return ptr_pos_ != nullptr; }
+
+        uint32_t NumStaticFields() const { return num_static_fields_; }
+
+        uint32_t NumInstanceFields() const { return num_instance_fields_; }
+
+        uint32_t NumFields() const { return num_static_fields_ + num_instance_fields_; }
+
+        uint32_t NumDirectMethods() const { return num_direct_methods_; }
+
+        uint32_t NumVirtualMethods() const { return num_virtual_methods_; }
+
+        uint32_t NumMethods() const { return num_direct_methods_ + num_virtual_methods_; }
+
+        Range<Field> GetFields() const {
+            return Range<Field>(DataIterator<Field>(&reader_, ptr_pos_, end_, num_static_fields_, NumFields()),
+                                DataIterator<Field>(NumFields()));
+        }
+
+        // method 紧跟在 field 之后，需要先跳过全部 field
+        Range<Method> GetMethods() const {
+            return Range<Method>(DataIterator<Method>(&reader_, MethodsBegin(), end_, num_direct_methods_, NumMethods()),
+                                 DataIterator<Method>(NumMethods()));
+        }
+
+        /**
+         * 一次线性遍历全部 field 和 method（不需要为 method 再跳过 field）
+         */
+        template<typename FieldVisitor, typename MethodVisitor>
+        void VisitFieldsAndMethods(FieldVisitor&& field_visitor, MethodVisitor&& method_visitor) const {
+            if (!HasClassData()) return;
+            DataIterator<Field> field(&reader_, ptr_pos_, end_, num_static_fields_, NumFields());
+            uint32_t i = 0;
+            for (; i < NumFields() && field != DataIterator<Field>(NumFields()); ++field, ++i) {
+                field_visitor(*field);
+            }
+            // field 被截断时 method 也无法定位
+            if (i < NumFields()) return;
+
+            DataIterator<Method> method(&reader_, field.GetDataPointer(), end_, num_direct_methods_, NumMethods());
+            for (; method != DataIterator<Method>(NumMethods()); ++method) {
+                method_visitor(*method);
+            }
+        }
+
+        template<typename MethodVisitor>
+        void VisitMethods(MethodVisitor&& method_visitor) const {
+            VisitFieldsAndMethods([](const Field&) {}, method_visitor);
+        }
+
+        const dex::DexReader& GetReader() const { return reader_; }
+
+    private:
+        const uint8_t* MethodsBegin() const {
+            if (!HasClassData()) return nullptr;
+            const uint8_t* ptr = ptr_pos_;
+            uint32_t value;
+            for (uint32_t i = 0; i < NumFields() * 2; ++i) {
+                if (!dex::DecodeUnsignedLeb128Checked(&ptr, end_, &value)) return nullptr;
+            }
+            return ptr;
+        }
+
+        const dex::DexReader& reader_;
+        // 第一个 encoded_field 的位置
+        const uint8_t* ptr_pos_ = nullptr;
+        const uint8_t* end_ = nullptr;
+        uint32_t num_static_fields_ = 0u;
+        uint32_t num_instance_fields_ = 0u;
+        uint32_t num_direct_methods_ = 0u;
+        uint32_t num_virtual_methods_ = 0u;
+    };
+
+    /**
+     * 按 class_defs 顺序遍历 dex 中每个类的每个方法
+     *
+     * @param visitor void(uint32_t class_def_idx, const Method &method)
+     */
+    template<typename Visitor>
+    void VisitAllMethods(const dex::DexReader& reader, Visitor&& visitor) {
+        for (uint32_t i = 0; i < reader.NumClassDefs(); ++i) {
+            ClassAccessor accessor(reader, *reader.GetClassDef(i));
+            accessor.VisitMethods([&](const Method& method) { visitor(i, method); });
+        }
+    }
+
+    /**
+     * 重新编码一个 class_data_item 追加到 out，field / method 不变，只替换 code_off
+     *
+     * @param map_code_off uint32_t(const Method &method)，返回该方法新的 code_off
+     * @return class_data 被截断时返回 false（out 中已追加的内容由调用方回滚）
+     */
+    template<typename CodeOffMapper>
+    bool EncodeClassData(const ClassAccessor& accessor, std::vector<uint8_t>& out, CodeOffMapper&& map_code_off) {
+        dex::EncodeUnsignedLeb128(&out, accessor.NumStaticFields());
+        dex::EncodeUnsignedLeb128(&out, accessor.NumInstanceFields());
+        dex::EncodeUnsignedLeb128(&out, accessor.NumDirectMethods());
+        dex::EncodeUnsignedLeb128(&out, accessor.NumVirtualMethods());
+
+        uint32_t fields = 0, methods = 0;
+        uint32_t last_idx = 0;
+        bool last_static = true;
+        accessor.VisitFieldsAndMethods(
+                [&](const Field& field) {
+                    if (field.IsStatic() != last_static) {
+                        last_static = field.IsStatic();
+                        last_idx = 0;
+                    }
+                    dex::EncodeUnsignedLeb128(&out, field.GetIndex() - last_idx);
+                    dex::EncodeUnsignedLeb128(&out, field.GetAccessFlags());
+                    last_idx = field.GetIndex();
+                    ++fields;
+                },
+                [&](const Method& method) {
+                    if (methods == 0 || method.IsStaticOrDirect() != last_static) {
+                        last_static = method.IsStaticOrDirect();
+                        last_idx = 0;
+                    }
+                    dex::EncodeUnsignedLeb128(&out, method.GetIndex() - last_idx);
+                    dex::EncodeUnsignedLeb128(&out, method.GetAccessFlags());
+                    dex::EncodeUnsignedLeb128(&out, map_code_off(method));
+                    last_idx = method.GetIndex();
+                    ++methods;
+                });
+        return fields == accessor.NumFields() && methods == accessor.NumMethods();
+    }
+
 };//namespace cyrus
 
 #endif //CYRUS_METHOD_H
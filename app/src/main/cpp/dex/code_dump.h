@@ -0,0 +1,180 @@
+#ifndef CYURS_CODE_DUMP_H
+#define CYURS_CODE_DUMP_H
+
+#include <stdint.h>
+#include <cstring>
+#include <string>
+#include <string_view>
+#include <vector>
+
+/**
+ * 方法体 dump 格式
+ *
+ * 1. FART 文本格式（每个方法一条）：
+ *      {name:void a.b.C.d(),method_idx:73,offset:4620,code_item_len:40,ins:BASE64};
+ *    ins 是整个 code_item（头部 + insns + tries + handlers）的 Base64。
+ *
+ * 2. 二进制格式（小端）：
+ *      CodeDumpFileHeader
+ *      CodeDumpRecordHeader + code_item 字节，重复
+ *    dex_checksum 为 dex 头中的 checksum_，用于在多 dex 的 dump 中区分来源，0 表示不区分。
+ */
+namespace cyurs {
+    namespace dex {
+
+        constexpr char kCodeDumpMagic[4] = {'C', 'D', 'M', 'P'};
+        constexpr uint16_t kCodeDumpVersion = 1;
+
+        struct CodeDumpFileHeader {
+            char magic_[4];
+            uint16_t version_;
+            uint16_t reserved_;
+        };
+
+        struct CodeDumpRecordHeader {
+            uint32_t dex_checksum_;
+            uint32_t method_idx_;
+            uint32_t code_len_;
+        };
+
+        // 一条方法体记录，code 指向 dump 文件映射或 code_storage 中的数据
+        struct CodeDumpEntry {
+            uint32_t dex_checksum = 0;
+            uint32_t method_idx = 0;
+            const uint8_t *code = nullptr;
+            uint32_t code_len = 0;
+        };
+
+        struct CodeDump {
+            std::vector<CodeDumpEntry> entries;
+            // 文本格式 Base64 解码后的数据，entries 中的指针指向这里
+            std::vector<std::vector<uint8_t>> code_storage;
+        };
+
+        inline void WriteCodeDumpHeader(std::string &out) {
+            CodeDumpFileHeader header{};
+            memcpy(header.magic_, kCodeDumpMagic, sizeof(kCodeDumpMagic));
+            header.version_ = kCodeDumpVersion;
+            out.append(reinterpret_cast<const char *>(&header), sizeof(header));
+        }
+
+        inline void AppendCodeDumpRecord(std::string &out, uint32_t dex_checksum, uint32_t method_idx,
+                                         const uint8_t *code, uint32_t code_len) {
+            CodeDumpRecordHeader record{dex_checksum, method_idx, code_len};
+            out.append(reinterpret_cast<const char *>(&record), sizeof(record));
+            out.append(reinterpret_cast<const char *>(code), code_len);
+        }
+
+        inline bool IsBinaryCodeDump(const uint8_t *data, size_t size) {
+            return size >= sizeof(CodeDumpFileHeader) && memcmp(data, kCodeDumpMagic, sizeof(kCodeDumpMagic)) == 0;
+        }
+
+        // 解析二进制格式，entries 直接指向 data（调用方保证 data 的生命周期）
+        inline bool ParseBinaryCodeDump(const uint8_t *data, size_t size, CodeDump &dump) {
+            if (!IsBinaryCodeDump(data, size)) return false;
+            CodeDumpFileHeader header;
+            memcpy(&header, data, sizeof(header));
+            if (header.version_ != kCodeDumpVersion) return false;
+
+            size_t pos = sizeof(CodeDumpFileHeader);
+            while (size - pos >= sizeof(CodeDumpRecordHeader)) {
+                CodeDumpRecordHeader record;
+                memcpy(&record, data + pos, sizeof(record));
+                pos += sizeof(record);
+                // 最后一条被截断（如进程被杀时还在写）
+                if (record.code_len_ > size - pos) break;
+                dump.entries.push_back({record.dex_checksum_, record.method_idx_, data + pos, record.code_len_});
+                pos += record.code_len_;
+            }
+            return true;
+        }
+
+        inline int Base64Value(char c) {
+            if (c >= 'A' && c <= 'Z') return c - 'A';
+            if (c >= 'a' && c <= 'z') return c - 'a' + 26;
+            if (c >= '0' && c <= '9') return c - '0' + 52;
+            if (c == '+' || c == '-') return 62;
+            if (c == '/' || c == '_') return 63;
+            return -1;
+        }
+
+        // 标准 / URL 安全 Base64 解码，遇到 '=' 或非法字符停止
+        inline void Base64Decode(std::string_view in, std::vector<uint8_t> &out) {
+            out.clear();
+            out.reserve(in.size() / 4 * 3);
+            uint32_t acc = 0;
+            int bits = 0;
+            for (char c: in) {
+                int v = Base64Value(c);
+                if (v < 0) break;
+                acc = (acc << 6) | static_cast<uint32_t>(v);
+                bits += 6;
+                if (bits >= 8) {
+                    bits -= 8;
+                    out.push_back(static_cast<uint8_t>(acc >> bits));
+                }
+            }
+        }
+
+        inline bool ParseDecimal(std::string_view s, uint32_t &out) {
+            uint64_t v = 0;
+            size_t i = 0;
+            for (; i < s.size() && s[i] >= '0' && s[i] <= '9'; ++i) {
+                v = v * 10 + (s[i] - '0');
+                if (v > 0xFFFFFFFFULL) return false;
+            }
+            if (i == 0) return false;
+            out = static_cast<uint32_t>(v);
+            return true;
+        }
+
+        /**
+         * 解析 FART 文本格式
+         *
+         * name 是方法签名，可能包含逗号和空格，所以按 ",method_idx:"、",code_item_len:"、",ins:" 关键字定位。
+         */
+        inline void ParseFartCodeDump(std::string_view text, CodeDump &dump) {
+            size_t pos = 0;
+            while ((pos = text.find("{name:", pos)) != std::string_view::npos) {
+                size_t end = text.find("};", pos);
+                if (end == std::string_view::npos) end = text.size();
+                std::string_view record = text.substr(pos, end - pos);
+                pos = end;
+
+                size_t idx_pos = record.find(",method_idx:");
+                size_t len_pos = record.find(",code_item_len:");
+                size_t ins_pos = record.find(",ins:");
+                if (idx_pos == std::string_view::npos || ins_pos == std::string_view::npos) continue;
+
+                uint32_t method_idx;
+                if (!ParseDecimal(record.substr(idx_pos + 12), method_idx)) continue;
+
+                std::vector<uint8_t> code;
+                Base64Decode(record.substr(ins_pos + 5), code);
+                if (code.empty()) continue;
+
+                uint32_t code_len;
+                if (len_pos != std::string_view::npos && ParseDecimal(record.substr(len_pos + 15), code_len) &&
+                    code_len < code.size()) {
+                    code.resize(code_len);
+                }
+
+                dump.code_storage.emplace_back(std::move(code));
+                const std::vector<uint8_t> &stored = dump.code_storage.back();
+                dump.entries.push_back({0, method_idx, stored.data(), static_cast<uint32_t>(stored.size())});
+            }
+        }
+
+        // 自动识别格式
+        inline void ParseCodeDump(const uint8_t *data, size_t size, CodeDump &dump) {
+            if (IsBinaryCodeDump(data, size)) {
+                ParseBinaryCodeDump(data, size, dump);
+            } else {
+                ParseFartCodeDump(std::string_view(reinterpret_cast<const char *>(data), size), dump);
+            }
+        }
+
+    } // namespace dex
+};//namespace cyurs
+
+#endif //CYURS_CODE_DUMP_H
@@ -0,0 +1,171 @@
+#ifndef CYURS_DEX_CONTAINER_H
+#define CYURS_DEX_CONTAINER_H
+
+#include <stdint.h>
+#include <cstring>
+#include <vector>
+
+#include "dex_reader.h"
+
+/**
+ * 拆分包含多个 dex 的容器
+ *
+ * - 单个 dex / cdex；
+ * - v41 多 dex 容器（API 35+）：dex 首尾相接，下一个 dex 头在 header_offset_ + file_size_；
+ * - vdex 027（Android 12+）：section 表中 kDexFileSection 内的 dex 按 4 字节对齐首尾相接；
+ * - vdex 019 / 021（Android 9 ~ 11）：每个 dex 之前有 4 字节的 quickening 表偏移，cdex 共享 dex 之后的数据区。
+ *
+ * 无法识别的 vdex 版本按 4 字节对齐扫描 dex 头。返回的 DexReader 指向原始数据，不拷贝。
+ */
+namespace cyurs {
+    namespace dex {
+
+        // vdex 027 的文件头，之后是 number_of_sections_ 个 VdexSectionHeader
+        struct VdexFileHeader {
+            uint8_t magic_[4];
+            uint8_t vdex_version_[4];
+            uint32_t number_of_sections_;
+        };
+
+        struct VdexSectionHeader {
+            uint32_t section_kind_;
+            uint32_t section_offset_;
+            uint32_t section_size_;
+        };
+
+        enum VdexSection : uint32_t {
+            kVdexChecksumSection = 0,
+            kVdexDexFileSection = 1,
+            kVdexVerifierDepsSection = 2,
+            kVdexTypeLookupTableSection = 3,
+        };
+
+        // vdex 019 / 021 的文件头（021 多了 bootclasspath_checksums_size_ 和 class_loader_context_size_）
+        struct VdexLegacyHeader {
+            uint8_t magic_[4];
+            uint8_t verifier_deps_version_[4];
+            uint8_t dex_section_version_[4];
+            uint32_t number_of_dex_files_;
+            uint32_t verifier_deps_size_;
+        };
+
+        // vdex 019 / 021 中紧跟 dex 校验和之后
+        struct VdexDexSectionHeader {
+            uint32_t dex_size_;
+            uint32_t dex_shared_data_size_;
+            uint32_t quickening_info_size_;
+        };
+
+        inline bool IsVdex(const uint8_t *begin, size_t size) {
+            return size >= sizeof(VdexFileHeader) && memcmp(begin, "vdex", 4) == 0;
+        }
+
+        /**
+         * 从 offset 开始依次打开首尾相接（4 字节对齐）的 dex
+         *
+         * @param prefix 每个 dex 之前的字节数（vdex 019 / 021 的 quickening 表偏移）
+         * @param count 最多打开的个数
+         */
+        inline void OpenDexSequence(const uint8_t *begin, size_t size, uint64_t offset, uint64_t end,
+                                    uint32_t prefix, uint32_t count, std::vector<DexReader> &readers) {
+            end = end < size ? end : size;
+            for (uint32_t i = 0; i < count; ++i) {
+                offset += prefix;
+                if (offset + sizeof(Header) > end) return;
+
+                DexReader reader;
+                const uint8_t *dex_begin = begin + offset;
+                // v41 容器：容器内的偏移相对于第一个 dex 头
+                if (reader.OpenInContainer(dex_begin, end - offset, 0) && reader.IsDexContainer()) {
+                    uint32_t container_size = reinterpret_cast<const HeaderV41 *>(dex_begin)->container_size_;
+                    uint64_t header_offset = 0;
+                    while (header_offset < container_size &&
+                           reader.OpenInContainer(dex_begin, container_size, header_offset)) {
+                        uint32_t file_size = reader.GetHeader().file_size_;
+                        readers.push_back(reader);
+                        header_offset = (header_offset + file_size + 3) & ~3ULL;
+                    }
+                    offset = (offset + container_size + 3) & ~3ULL;
+                    continue;
+                }
+
+                // cdex 的数据区可能在 dex 之后的共享区域，容器范围取到 size
+                if (!reader.OpenInContainer(begin, size, offset)) return;
+                readers.push_back(reader);
+                offset = (offset + reader.GetHeader().file_size_ + 3) & ~3ULL;
+            }
+        }
+
+        // 无法识别的格式：按 4 字节对齐扫描 dex / cdex 头
+        inline void ScanDexFiles(const uint8_t *begin, size_t size, std::vector<DexReader> &readers) {
+            uint64_t offset = 0;
+            while (offset + sizeof(Header) <= size) {
+                DexReader reader;
+                if ((memcmp(begin + offset, "dex\n", 4) == 0 || memcmp(begin + offset, "cdex", 4) == 0) &&
+                    reader.OpenInContainer(begin, size, offset) && !reader.IsDexContainer()) {
+                    readers.push_back(reader);
+                    offset = (offset + reader.GetHeader().file_size_ + 3) & ~3ULL;
+                } else {
+                    offset += 4;
+                }
+            }
+        }
+
+        inline void OpenVdex(const uint8_t *begin, size_t size, std::vector<DexReader> &readers) {
+            const auto *header = reinterpret_cast<const VdexFileHeader *>(begin);
+            const uint8_t *version = header->vdex_version_;
+
+            if (memcmp(version, "027", 4) == 0) {
+                uint64_t sections_end = sizeof(VdexFileHeader) +
+                                        static_cast<uint64_t>(header->number_of_sections_) * sizeof(VdexSectionHeader);
+                if (sections_end > size) return;
+                const auto *sections = reinterpret_cast<const VdexSectionHeader *>(begin + sizeof(VdexFileHeader));
+                for (uint32_t i = 0; i < header->number_of_sections_; ++i) {
+                    const VdexSectionHeader &section = sections[i];
+                    if (section.section_kind_ != kVdexDexFileSection || section.section_size_ == 0) continue;
+                    uint64_t section_end = static_cast<uint64_t>(section.section_offset_) + section.section_size_;
+                    OpenDexSequence(begin, size, section.section_offset_, section_end, 0, UINT32_MAX, readers);
+                }
+                return;
+            }
+
+            bool v019 = memcmp(version, "019", 4) == 0;
+            bool v021 = memcmp(version, "021", 4) == 0;
+            if (v019 || v021) {
+                const auto *legacy = reinterpret_cast<const VdexLegacyHeader *>(begin);
+                // 021 的头部多两个 uint32_t
+                uint64_t header_size = sizeof(VdexLegacyHeader) + (v021 ? 2 * sizeof(uint32_t) : 0);
+                uint64_t dex_section = header_size + static_cast<uint64_t>(legacy->number_of_dex_files_) * sizeof(uint32_t);
+                // dex_section_version_ 为 "000" 时 vdex 中没有 dex
+                if (memcmp(legacy->dex_section_version_, "000", 4) == 0 ||
+                    dex_section + sizeof(VdexDexSectionHeader) > size) {
+                    return;
+                }
+                const auto *dex_header = reinterpret_cast<const VdexDexSectionHeader *>(begin + dex_section);
+                uint64_t dex_begin = dex_section + sizeof(VdexDexSectionHeader);
+                OpenDexSequence(begin, size, dex_begin, dex_begin + dex_header->dex_size_, sizeof(uint32_t),
+                                legacy->number_of_dex_files_, readers);
+                return;
+            }
+
+            ScanDexFiles(begin, size, readers);
+        }
+
+        /**
+         * 打开 dex / cdex / v41 容器 / vdex 中的全部 dex，无法识别返回空
+         */
+        inline std::vector<DexReader> OpenDexContainer(const uint8_t *begin, size_t size) {
+            std::vector<DexReader> readers;
+            if (begin == nullptr) return readers;
+            if (IsVdex(begin, size)) {
+                OpenVdex(begin, size, readers);
+            } else {
+                OpenDexSequence(begin, size, 0, size, 0, 1, readers);
+            }
+            return readers;
+        }
+
+    } // namespace dex
+};//namespace cyurs
+
+#endif //CYURS_DEX_CONTAINER_H
@@ -0,0 +1,73 @@
+#include "dex_cookie.h"
+
+namespace cyurs {
+
+    void CollectDexFiles(JNIEnv *env, jobject class_loader, int sdk_level, std::vector<const void *> &dex_files) {
+        jclass base_loader_class = env->FindClass("dalvik/system/BaseDexClassLoader");
+        jclass path_list_class = env->FindClass("dalvik/system/DexPathList");
+        jclass element_class = env->FindClass("dalvik/system/DexPathList$Element");
+        jclass dex_file_class = env->FindClass("dalvik/system/DexFile");
+        jclass loader_class = env->FindClass("java/lang/ClassLoader");
+        if (env->ExceptionCheck() || base_loader_class == nullptr || path_list_class == nullptr ||
+            element_class == nullptr || dex_file_class == nullptr || loader_class == nullptr) {
+            env->ExceptionClear();
+            return;
+        }
+        jfieldID path_list_field = env->GetFieldID(base_loader_class, "pathList", "Ldalvik/system/DexPathList;");
+        jfieldID elements_field = env->GetFieldID(path_list_class, "dexElements", "[Ldalvik/system/DexPathList$Element;");
+        jfieldID dex_file_field = env->GetFieldID(element_class, "dexFile", "Ldalvik/system/DexFile;");
+        jfieldID cookie_field = sdk_level >= 23 ? env->GetFieldID(dex_file_class, "mCookie", "Ljava/lang/Object;")
+                                                : env->GetFieldID(dex_file_class, "mCookie", "J");
+        jmethodID get_parent = env->GetMethodID(loader_class, "getParent", "()Ljava/lang/ClassLoader;");
+        if (env->ExceptionCheck() || path_list_field == nullptr || elements_field == nullptr ||
+            dex_file_field == nullptr || cookie_field == nullptr || get_parent == nullptr) {
+            env->ExceptionClear();
+            return;
+        }
+
+        jobject loader = env->NewLocalRef(class_loader);
+        while (loader != nullptr && env->PushLocalFrame(64) == JNI_OK) {
+            if (env->IsInstanceOf(loader, base_loader_class)) {
+                jobject path_list = env->GetObjectField(loader, path_list_field);
+                auto elements = path_list == nullptr ? nullptr
+                                                     : static_cast<jobjectArray>(env->GetObjectField(path_list, elements_field));
+                jsize count = elements == nullptr ? 0 : env->GetArrayLength(elements);
+                for (jsize i = 0; i < count; ++i) {
+                    jobject element = env->GetObjectArrayElement(elements, i);
+                    jobject dex_file = element == nullptr ? nullptr : env->GetObjectField(element, dex_file_field);
+                    if (dex_file == nullptr) {
+                        env->DeleteLocalRef(element);
+                        continue;
+                    }
+                    if (sdk_level >= 23) {
+                        auto cookie = static_cast<jlongArray>(env->GetObjectField(dex_file, cookie_field));
+                        jsize length = cookie == nullptr ? 0 : env->GetArrayLength(cookie);
+                        if (length > 1) {
+                            std::vector<jlong> values(length);
+                            env->GetLongArrayRegion(cookie, 0, length, values.data());
+                            for (jsize j = 1; j < length; ++j) {
+                                if (values[j] != 0) dex_files.push_back(reinterpret_cast<const void *>(values[j]));
+                            }
+                        }
+                        env->DeleteLocalRef(cookie);
+                    } else {
+                        auto *vector = reinterpret_cast<const std::vector<const void *> *>(
+                                env->GetLongField(dex_file, cookie_field));
+                        if (vector != nullptr) dex_files.insert(dex_files.end(), vector->begin(), vector->end());
+                    }
+                    env->DeleteLocalRef(dex_file);
+                    env->DeleteLocalRef(element);
+                }
+            }
+            jobject parent = env->CallObjectMethod(loader, get_parent);
+            if (env->ExceptionCheck()) {
+                env->ExceptionClear();
+                parent = nullptr;
+            }
+            jobject next = env->PopLocalFrame(parent);
+            env->DeleteLocalRef(loader);
+            loader = next;
+        }
+    }
+
+};//namespace cyurs
@@ -0,0 +1,20 @@
+#ifndef CYURS_DEX_COOKIE_H
+#define CYURS_DEX_COOKIE_H
+
+#include <jni.h>
+#include <vector>
+
+namespace cyurs {
+
+    /**
+     * 从 ClassLoader 及其 parent 中收集 art::DexFile 指针（追加到 dex_files，不去重）
+     *
+     * BaseDexClassLoader.pathList.dexElements[i].dexFile.mCookie：
+     *   API 23+ 为 long[]，[0] 是 OatFile*，之后是 DexFile*；
+     *   API 21 / 22 为 long，指向 std::vector<const DexFile *>。
+     */
+    void CollectDexFiles(JNIEnv *env, jobject class_loader, int sdk_level, std::vector<const void *> &dex_files);
+
+};//namespace cyurs
+
+#endif //CYURS_DEX_COOKIE_H
@@ -0,0 +1,266 @@
+#include "dex_disassembler.h"
+
+#include <cstdarg>
+#include <cstdio>
+
+namespace cyurs {
+    namespace dex {
+
+        __attribute__((format(printf, 2, 3)))
+        static void AppendFormat(std::string &out, const char *format, ...) {
+            char buf[128];
+            va_list args;
+            va_start(args, format);
+            int len = vsnprintf(buf, sizeof(buf), format, args);
+            va_end(args);
+            if (len > 0) out.append(buf, len < static_cast<int>(sizeof(buf)) ? len : sizeof(buf) - 1);
+        }
+
+        // 字符串常量加引号输出，控制字符转义
+        static void AppendQuoted(std::string &out, std::string_view str) {
+            out.push_back('"');
+            for (char c: str) {
+                switch (c) {
+                    case '"': out.append("\\\""); break;
+                    case '\\': out.append("\\\\"); break;
+                    case '\n': out.append("\\n"); break;
+                    case '\r': out.append("\\r"); break;
+                    case '\t': out.append("\\t"); break;
+                    default:
+                        if (static_cast<uint8_t>(c) < 0x20) {
+                            AppendFormat(out, "\\x%02x", static_cast<uint8_t>(c));
+                        } else {
+                            out.push_back(c);
+                        }
+                }
+            }
+            out.push_back('"');
+        }
+
+        // (参数)返回类型
+        static bool AppendProto(std::string &out, const DexReader &reader, uint32_t proto_idx) {
+            const ProtoId *proto = reader.GetProtoId(proto_idx);
+            if (proto == nullptr) return false;
+            out.push_back('(');
+            const TypeList *params = reader.GetProtoParameters(*proto);
+            for (uint32_t i = 0; params != nullptr && i < params->size_; ++i) {
+                out.append(reader.GetTypeDescriptor(params->list_[i].type_idx_));
+            }
+            out.push_back(')');
+            out.append(reader.GetTypeDescriptor(proto->return_type_idx_));
+            return true;
+        }
+
+        static bool AppendMethod(std::string &out, const DexReader &reader, uint32_t method_idx) {
+            const MethodId *method = reader.GetMethodId(method_idx);
+            if (method == nullptr) return false;
+            out.append(reader.GetTypeDescriptor(method->class_idx_));
+            out.append("->");
+            out.append(reader.GetStringData(method->name_idx_));
+            return AppendProto(out, reader, method->proto_idx_);
+        }
+
+        // 索引解析为名称，后面附上 kind@index
+        static void AppendIndex(std::string &out, InstructionIndexType type, uint32_t index, const DexReader *reader) {
+            const char *kind = "";
+            bool resolved = false;
+            size_t old_size = out.size();
+            switch (type) {
+                case kIndexString:
+                    kind = "string";
+                    if (reader != nullptr && index < reader->NumStringIds()) {
+                        AppendQuoted(out, reader->GetStringData(index));
+                        resolved = true;
+                    }
+                    break;
+                case kIndexType:
+                    kind = "type";
+                    if (reader != nullptr && index < reader->NumTypeIds()) {
+                        out.append(reader->GetTypeDescriptor(index));
+                        resolved = true;
+                    }
+                    break;
+                case kIndexField: {
+                    kind = "field";
+                    const FieldId *field = reader == nullptr ? nullptr : reader->GetFieldId(index);
+                    if (field != nullptr) {
+                        out.append(reader->GetTypeDescriptor(field->class_idx_));
+                        out.append("->");
+                        out.append(reader->GetStringData(field->name_idx_));
+                        out.push_back(':');
+                        out.append(reader->GetTypeDescriptor(field->type_idx_));
+                        resolved = true;
+                    }
+                    break;
+                }
+                case kIndexMethod:
+                case kIndexMethodAndProto:
+                    kind = "method";
+                    resolved = reader != nullptr && AppendMethod(out, *reader, index);
+                    break;
+                case kIndexProto:
+                    kind = "proto";
+                    resolved = reader != nullptr && AppendProto(out, *reader, index);
+                    break;
+                case kIndexCallSite:
+                    kind = "call_site";
+                    break;
+                case kIndexMethodHandle:
+                    kind = "method_handle";
+                    break;
+                case kIndexNone:
+                    return;
+            }
+            if (resolved) {
+                AppendFormat(out, " // %s@%04x", kind, index);
+            } else {
+                out.resize(old_size);
+                AppendFormat(out, "%s@%04x", kind, index);
+            }
+        }
+
+        static void AppendTarget(std::string &out, uint32_t dex_pc, uint32_t offset) {
+            auto relative = static_cast<int32_t>(offset);
+            AppendFormat(out, "%04x // %c%04x", dex_pc + offset, relative < 0 ? '-' : '+',
+                         relative < 0 ? 0u - offset : offset);
+        }
+
+        static void AppendArgs(std::string &out, const DecodedInstruction &inst) {
+            out.push_back('{');
+            InstructionFormat format = inst.format();
+            if (format == k35c || format == k45cc) {
+                for (uint32_t i = 0; i < inst.vA && i < 5; ++i) {
+                    AppendFormat(out, i == 0 ? "v%u" : ", v%u", inst.arg[i]);
+                }
+            } else if (inst.vA != 0) {
+                AppendFormat(out, "v%u .. v%u", inst.vC, inst.vC + inst.vA - 1);
+            }
+            out.append("}, ");
+        }
+
+        std::string FormatInstruction(const DecodedInstruction &inst, uint32_t dex_pc, const DexReader *reader) {
+            std::string out;
+            if (inst.payload == kPackedSwitchSignature) {
+                AppendFormat(out, "packed-switch-data (%u units) first_key=%d targets=%u",
+                             inst.width, static_cast<int32_t>(inst.vB), inst.vA);
+                return out;
+            }
+            if (inst.payload == kSparseSwitchSignature) {
+                AppendFormat(out, "sparse-switch-data (%u units) targets=%u", inst.width, inst.vA);
+                return out;
+            }
+            if (inst.payload == kArrayDataSignature) {
+                AppendFormat(out, "array-data (%u units) element_width=%u size=%u", inst.width, inst.vB, inst.vA);
+                return out;
+            }
+
+            const InstructionDescriptor &descriptor = inst.descriptor();
+            out.append(descriptor.name);
+            // const-wide* 的字面量是 long
+            bool wide = inst.opcode == CONST_WIDE_16 || inst.opcode == CONST_WIDE_32 ||
+                        inst.opcode == CONST_WIDE || inst.opcode == CONST_WIDE_HIGH16;
+            switch (descriptor.format) {
+                case k10x:
+                    break;
+                case k12x:
+                case k22x:
+                case k32x:
+                    AppendFormat(out, " v%u, v%u", inst.vA, inst.vB);
+                    break;
+                case k11n:
+                case k21s:
+                case k31i:
+                    AppendFormat(out, " v%u, #%s %d", inst.vA, wide ? "long" : "int", static_cast<int32_t>(inst.vB));
+                    break;
+                case k11x:
+                    AppendFormat(out, " v%u", inst.vA);
+                    break;
+                case k10t:
+                case k20t:
+                case k30t:
+                    out.push_back(' ');
+                    AppendTarget(out, dex_pc, inst.vA);
+                    break;
+                case k21t:
+                case k31t:
+                    AppendFormat(out, " v%u, ", inst.vA);
+                    AppendTarget(out, dex_pc, inst.vB);
+                    break;
+                case k21h:
+                    if (wide) {
+                        AppendFormat(out, " v%u, #long %lld", inst.vA,
+                                     static_cast<long long>(static_cast<uint64_t>(inst.vB) << 48));
+                    } else {
+                        AppendFormat(out, " v%u, #int %d", inst.vA, static_cast<int32_t>(inst.vB << 16));
+                    }
+                    break;
+                case k21c:
+                case k31c:
+                    AppendFormat(out, " v%u, ", inst.vA);
+                    AppendIndex(out, descriptor.index_type, inst.vB, reader);
+                    break;
+                case k23x:
+                    AppendFormat(out, " v%u, v%u, v%u", inst.vA, inst.vB, inst.vC);
+                    break;
+                case k22b:
+                case k22s:
+                    AppendFormat(out, " v%u, v%u, #int %d", inst.vA, inst.vB, static_cast<int32_t>(inst.vC));
+                    break;
+                case k22t:
+                    AppendFormat(out, " v%u, v%u, ", inst.vA, inst.vB);
+                    AppendTarget(out, dex_pc, inst.vC);
+                    break;
+                case k22c:
+                    AppendFormat(out, " v%u, v%u, ", inst.vA, inst.vB);
+                    AppendIndex(out, descriptor.index_type, inst.vC, reader);
+                    break;
+                case k35c:
+                case k3rc:
+                    out.push_back(' ');
+                    AppendArgs(out, inst);
+                    AppendIndex(out, descriptor.index_type, inst.vB, reader);
+                    break;
+                case k45cc:
+                case k4rcc:
+                    out.push_back(' ');
+                    AppendArgs(out, inst);
+                    AppendIndex(out, kIndexMethod, inst.vB, reader);
+                    out.append(", ");
+                    AppendIndex(out, kIndexProto, inst.vH, reader);
+                    break;
+                case k51l:
+                    AppendFormat(out, " v%u, #long %lld", inst.vA, static_cast<long long>(inst.vB_wide));
+                    break;
+            }
+            return out;
+        }
+
+        std::string DisassembleInsns(const uint16_t *insns, uint32_t insns_size, const DexReader *reader) {
+            std::string out;
+            // 按每个 code unit 约 24 字节文本预留
+            out.reserve(static_cast<size_t>(insns_size) * 24);
+            uint32_t end_pc = 0;
+            bool complete = VisitInstructions(insns, insns_size, [&](uint32_t dex_pc, const DecodedInstruction &inst) {
+                AppendFormat(out, "%04x: ", dex_pc);
+                out.append(FormatInstruction(inst, dex_pc, reader));
+                out.push_back('\n');
+                end_pc = dex_pc + inst.width;
+                return true;
+            });
+            if (!complete) AppendFormat(out, "%04x: <truncated>\n", end_pc);
+            return out;
+        }
+
+        bool DisassembleMethod(const DexReader &reader, uint32_t method_idx, uint32_t code_off, std::string &out) {
+            CodeItemInfo info;
+            if (!reader.GetCodeItemInfo(code_off, method_idx, &info)) return false;
+
+            if (!AppendMethod(out, reader, method_idx)) AppendFormat(out, "method@%04x", method_idx);
+            AppendFormat(out, " registers=%u ins=%u outs=%u tries=%u insns=%u\n",
+                         info.registers_size, info.ins_size, info.outs_size, info.tries_size, info.insns_size);
+            out.append(DisassembleInsns(info.insns, info.insns_size, &reader));
+            return true;
+        }
+
+    } // namespace dex
+};//namespace cyurs
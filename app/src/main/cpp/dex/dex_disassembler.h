@@ -0,0 +1,39 @@
+#ifndef CYURS_DEX_DISASSEMBLER_H
+#define CYURS_DEX_DISASSEMBLER_H
+
+#include <stdint.h>
+#include <string>
+
+#include "dex_instruction.h"
+#include "dex_reader.h"
+
+/**
+ * Dalvik 指令的文本输出（格式接近 dexdump -d）
+ *
+ *   0000: const-string v0, "hello" // string@0087
+ *   0002: invoke-static {v0}, Lcom/foo/Bar;->log(Ljava/lang/String;)V // method@0012
+ *   0005: if-eqz v0, 0009 // +0004
+ *
+ * reader 为 nullptr 时（如 hook 中只有 insns）索引只输出 string@0087 这样的编号。
+ */
+namespace cyurs {
+    namespace dex {
+
+        // 一条指令的文本（不含 dex_pc 前缀）
+        std::string FormatInstruction(const DecodedInstruction &inst, uint32_t dex_pc, const DexReader *reader);
+
+        // 反汇编整个 insns，每行 "dex_pc: 指令"；指令被截断时最后一行为 "dex_pc: <truncated>"
+        std::string DisassembleInsns(const uint16_t *insns, uint32_t insns_size, const DexReader *reader);
+
+        /**
+         * 反汇编方法体，第一行为方法签名和 code_item 头部信息
+         *
+         * @param code_off class_data 中的 code_off（支持 cdex）
+         * @return 没有方法体或 code_item 无效返回 false
+         */
+        bool DisassembleMethod(const DexReader &reader, uint32_t method_idx, uint32_t code_off, std::string &out);
+
+    } // namespace dex
+};//namespace cyurs
+
+#endif //CYURS_DEX_DISASSEMBLER_H
@@ -2,6 +2,7 @@
 #define CYURS_DEX_FILE_H
 
 #include <stdint.h>
+#include <memory>
 #include <string>
 
 namespace cyurs {
@@ -33,6 +34,48 @@ namespace cyurs {
             uint32_t data_off_;  // unused
         };
 
+        // Standard dex header of version 41 and later (dex container).
+        struct HeaderV41 : public Header {
+            uint32_t container_size_;  // total size of the container (all dex files)
+            uint32_t header_offset_;  // offset of this header from the start of the container
+        };
+
+        // Compact dex (cdex) header. Section offsets are relative to the header,
+        // other offsets are relative to the data section at data_off_.
+        struct CompactDexHeader : public Header {
+            uint32_t feature_flags_;
+            uint32_t debug_info_offsets_pos_;  // position of the debug info offset table in the data section
+            uint32_t debug_info_offsets_table_offset_;  // offset of the lookup table inside the table data
+            uint32_t debug_info_base_;  // base offset of all debug info streams
+            uint32_t owned_data_begin_;
+            uint32_t owned_data_end_;
+        };
+
+        // Type codes of MapItem::type_.
+        enum MapItemType : uint16_t {
+            kDexTypeHeaderItem = 0x0000,
+            kDexTypeStringIdItem = 0x0001,
+            kDexTypeTypeIdItem = 0x0002,
+            kDexTypeProtoIdItem = 0x0003,
+            kDexTypeFieldIdItem = 0x0004,
+            kDexTypeMethodIdItem = 0x0005,
+            kDexTypeClassDefItem = 0x0006,
+            kDexTypeCallSiteIdItem = 0x0007,
+            kDexTypeMethodHandleItem = 0x0008,
+            kDexTypeMapList = 0x1000,
+            kDexTypeTypeList = 0x1001,
+            kDexTypeAnnotationSetRefList = 0x1002,
+            kDexTypeAnnotationSetItem = 0x1003,
+            kDexTypeClassDataItem = 0x2000,
+            kDexTypeCodeItem = 0x2001,
+            kDexTypeStringDataItem = 0x2002,
+            kDexTypeDebugInfoItem = 0x2003,
+            kDexTypeAnnotationItem = 0x2004,
+            kDexTypeEncodedArrayItem = 0x2005,
+            kDexTypeAnnotationsDirectoryItem = 0x2006,
+            kDexTypeHiddenapiClassData = 0xF000,
+        };
+
         struct MapItem {
             uint16_t type_;
             uint16_t unused_;
@@ -101,6 +144,39 @@ namespace cyurs {
             uint32_t insns_size_in_code_units_;  // size of the insns array, in 2 byte code units
             uint16_t insns_[1];                  // actual array of bytecode.
         };
+
+        // Compact dex code_item. Sizes that do not fit are stored in a preheader of
+        // uint16_t values located right before the item; debug info is looked up by method_idx.
+        struct CompactCodeItem {
+        public:
+            static constexpr uint32_t kRegistersSizeShift = 12;
+            static constexpr uint32_t kInsSizeShift = 8;
+            static constexpr uint32_t kOutsSizeShift = 4;
+            static constexpr uint32_t kTriesSizeSizeShift = 0;
+            static constexpr uint16_t kFlagPreHeaderRegistersSize = 0x1 << 0;
+            static constexpr uint16_t kFlagPreHeaderInsSize = 0x1 << 1;
+            static constexpr uint16_t kFlagPreHeaderOutsSize = 0x1 << 2;
+            static constexpr uint16_t kFlagPreHeaderTriesSize = 0x1 << 3;
+            static constexpr uint16_t kFlagPreHeaderInsnsSize = 0x1 << 4;
+            static constexpr uint16_t kFlagPreHeaderCombined = 0x1f;
+            static constexpr uint32_t kInsnsSizeShift = 5;
+
+            // Packed code item data, 4 bits each: [registers_size, ins_size, outs_size, tries_size].
+            // registers_size does not include ins_size.
+            uint16_t fields_;
+            // 5 bits of preheader flags, 11 bits for the number of instruction code units.
+            uint16_t insns_count_and_flags_;
+            uint16_t insns_[1];                  // actual array of bytecode.
+        };
+        // Raw type_item.
+        struct TypeItem {
+            uint16_t type_idx_;  // index into type_ids section
+        };
+        // Raw type_list.
+        struct TypeList {
+            uint32_t size_;  // size of the list, in entries
+            TypeItem list_[1];  // elements of the list
+        };
         // Raw try_item.
         struct TryItem {
             uint32_t start_addr_;
@@ -0,0 +1,69 @@
+#ifndef CYURS_DEX_FILE_INFO_H
+#define CYURS_DEX_FILE_INFO_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <string>
+
+#include "dex_file.h"
+
+/**
+ * 从 ART 的 art::DexFile 对象中读取 begin / size / location / location_checksum
+ *
+ * 按系统版本选择 dex_file.h 中的内存布局：
+ *   API 21 ~ 27  V21（begin_, size_, location_, location_checksum_）
+ *   API 28 ~ 34  V28（多了 data_begin_ / data_size_）
+ *   API 35+      V35（size_ 固定为 0，长度取 header_->file_size_）
+ */
+namespace cyurs {
+
+    struct DexFileInfo {
+        const uint8_t *begin = nullptr;
+        size_t size = 0;
+        std::string location;
+        uint32_t location_checksum = 0;
+    };
+
+    /**
+     * @param dex_file art::DexFile 指针（如 DexFile.mCookie 中的元素、LoadMethod 的参数）
+     * @return dex_file 为空或 begin_ / header_ 为空时返回 false
+     */
+    inline bool GetDexFileInfo(const void *dex_file, int sdk_level, DexFileInfo *info) {
+        if (dex_file == nullptr) return false;
+        const dex::Header *header;
+        if (sdk_level >= 35) {
+            const auto *dex_file_v35 = static_cast<const V35::DexFile *>(dex_file);
+            header = dex_file_v35->header_;
+            info->begin = dex_file_v35->begin_;
+            info->size = header == nullptr ? 0 : header->file_size_;
+            info->location = dex_file_v35->location_;
+            info->location_checksum = dex_file_v35->location_checksum_;
+        } else if (sdk_level >= 28) {
+            const auto *dex_file_v28 = static_cast<const V28::DexFile *>(dex_file);
+            header = dex_file_v28->header_;
+            info->begin = dex_file_v28->begin_;
+            info->size = dex_file_v28->size_ != 0 || header == nullptr ? dex_file_v28->size_ : header->file_size_;
+            info->location = dex_file_v28->location_;
+            info->location_checksum = dex_file_v28->location_checksum_;
+        } else {
+            const auto *dex_file_v21 = static_cast<const V21::DexFile *>(dex_file);
+            header = dex_file_v21->header_;
+            info->begin = dex_file_v21->begin_;
+            info->size = dex_file_v21->size_ != 0 || header == nullptr ? dex_file_v21->size_ : header->file_size_;
+            info->location = dex_file_v21->location_;
+            info->location_checksum = dex_file_v21->location_checksum_;
+        }
+        return info->begin != nullptr && header != nullptr;
+    }
+
+    // 只读取 begin_（如校验缓存的 DexFile 指针是否还指向同一个 dex）
+    inline const uint8_t *GetDexFileBegin(const void *dex_file, int sdk_level) {
+        if (dex_file == nullptr) return nullptr;
+        if (sdk_level >= 35) return static_cast<const V35::DexFile *>(dex_file)->begin_;
+        if (sdk_level >= 28) return static_cast<const V28::DexFile *>(dex_file)->begin_;
+        return static_cast<const V21::DexFile *>(dex_file)->begin_;
+    }
+
+};//namespace cyurs
+
+#endif //CYURS_DEX_FILE_INFO_H
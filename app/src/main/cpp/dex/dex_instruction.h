@@ -0,0 +1,605 @@
+#ifndef CYURS_DEX_INSTRUCTION_H
+#define CYURS_DEX_INSTRUCTION_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+/**
+ * Dalvik 指令解码
+ *
+ * 256 个操作码的格式、索引类型和控制流标志由 DEX_INSTRUCTION_LIST 展开为 constexpr 表，
+ * 解码时按操作码查表得到格式，再按格式取出操作数，没有逐个操作码的分支。
+ *
+ * 格式命名同 https://source.android.com/docs/core/runtime/instruction-formats：
+ * 第 1 位是长度（code unit），第 2 位是寄存器个数，第 3 位是额外数据的类型。
+ */
+namespace cyurs {
+    namespace dex {
+
+        enum InstructionFormat : uint8_t {
+            k10x,   // op
+            k12x,   // op vA, vB
+            k11n,   // op vA, #+B
+            k11x,   // op vAA
+            k10t,   // op +AA
+            k20t,   // op +AAAA
+            k22x,   // op vAA, vBBBB
+            k21t,   // op vAA, +BBBB
+            k21s,   // op vAA, #+BBBB
+            k21h,   // op vAA, #+BBBB0000[00000000]
+            k21c,   // op vAA, thing@BBBB
+            k23x,   // op vAA, vBB, vCC
+            k22b,   // op vAA, vBB, #+CC
+            k22t,   // op vA, vB, +CCCC
+            k22s,   // op vA, vB, #+CCCC
+            k22c,   // op vA, vB, thing@CCCC
+            k32x,   // op vAAAA, vBBBB
+            k30t,   // op +AAAAAAAA
+            k31t,   // op vAA, +BBBBBBBB
+            k31i,   // op vAA, #+BBBBBBBB
+            k31c,   // op vAA, string@BBBBBBBB
+            k35c,   // op {vC, vD, vE, vF, vG}, thing@BBBB
+            k3rc,   // op {vCCCC .. vNNNN}, thing@BBBB
+            k45cc,  // op {vC, vD, vE, vF, vG}, meth@BBBB, proto@HHHH
+            k4rcc,  // op {vCCCC .. vNNNN}, meth@BBBB, proto@HHHH
+            k51l,   // op vAA, #+BBBBBBBBBBBBBBBB
+        };
+
+        enum InstructionIndexType : uint8_t {
+            kIndexNone,
+            kIndexString,
+            kIndexType,
+            kIndexField,
+            kIndexMethod,
+            kIndexProto,
+            kIndexCallSite,
+            kIndexMethodHandle,
+            // invoke-polymorphic：vB 是 method_idx，vH 是 proto_idx
+            kIndexMethodAndProto,
+        };
+
+        enum InstructionFlags : uint8_t {
+            // 可以顺序执行到下一条
+            kContinue = 0x01,
+            // 有分支目标（goto / if-*）
+            kBranch = 0x02,
+            // packed-switch / sparse-switch
+            kSwitch = 0x04,
+            kReturn = 0x08,
+            kThrow = 0x10,
+            kInvoke = 0x20,
+            // 操作数指向 payload（switch 表、fill-array-data 数据）
+            kPayload = 0x40,
+            // 未使用的操作码（含 ART 早期的 -quick 指令）
+            kUnused = 0x80,
+        };
+
+        // V(操作码, 枚举名, 助记符, 格式, 索引类型, 标志)
+#define DEX_INSTRUCTION_LIST(V) \
+    V(0x00, NOP, "nop", k10x, kIndexNone, kContinue) \
+    V(0x01, MOVE, "move", k12x, kIndexNone, kContinue) \
+    V(0x02, MOVE_FROM16, "move/from16", k22x, kIndexNone, kContinue) \
+    V(0x03, MOVE_16, "move/16", k32x, kIndexNone, kContinue) \
+    V(0x04, MOVE_WIDE, "move-wide", k12x, kIndexNone, kContinue) \
+    V(0x05, MOVE_WIDE_FROM16, "move-wide/from16", k22x, kIndexNone, kContinue) \
+    V(0x06, MOVE_WIDE_16, "move-wide/16", k32x, kIndexNone, kContinue) \
+    V(0x07, MOVE_OBJECT, "move-object", k12x, kIndexNone, kContinue) \
+    V(0x08, MOVE_OBJECT_FROM16, "move-object/from16", k22x, kIndexNone, kContinue) \
+    V(0x09, MOVE_OBJECT_16, "move-object/16", k32x, kIndexNone, kContinue) \
+    V(0x0A, MOVE_RESULT, "move-result", k11x, kIndexNone, kContinue) \
+    V(0x0B, MOVE_RESULT_WIDE, "move-result-wide", k11x, kIndexNone, kContinue) \
+    V(0x0C, MOVE_RESULT_OBJECT, "move-result-object", k11x, kIndexNone, kContinue) \
+    V(0x0D, MOVE_EXCEPTION, "move-exception", k11x, kIndexNone, kContinue) \
+    V(0x0E, RETURN_VOID, "return-void", k10x, kIndexNone, kReturn) \
+    V(0x0F, RETURN, "return", k11x, kIndexNone, kReturn) \
+    V(0x10, RETURN_WIDE, "return-wide", k11x, kIndexNone, kReturn) \
+    V(0x11, RETURN_OBJECT, "return-object", k11x, kIndexNone, kReturn) \
+    V(0x12, CONST_4, "const/4", k11n, kIndexNone, kContinue) \
+    V(0x13, CONST_16, "const/16", k21s, kIndexNone, kContinue) \
+    V(0x14, CONST, "const", k31i, kIndexNone, kContinue) \
+    V(0x15, CONST_HIGH16, "const/high16", k21h, kIndexNone, kContinue) \
+    V(0x16, CONST_WIDE_16, "const-wide/16", k21s, kIndexNone, kContinue) \
+    V(0x17, CONST_WIDE_32, "const-wide/32", k31i, kIndexNone, kContinue) \
+    V(0x18, CONST_WIDE, "const-wide", k51l, kIndexNone, kContinue) \
+    V(0x19, CONST_WIDE_HIGH16, "const-wide/high16", k21h, kIndexNone, kContinue) \
+    V(0x1A, CONST_STRING, "const-string", k21c, kIndexString, kContinue) \
+    V(0x1B, CONST_STRING_JUMBO, "const-string/jumbo", k31c, kIndexString, kContinue) \
+    V(0x1C, CONST_CLASS, "const-class", k21c, kIndexType, kContinue) \
+    V(0x1D, MONITOR_ENTER, "monitor-enter", k11x, kIndexNone, kContinue) \
+    V(0x1E, MONITOR_EXIT, "monitor-exit", k11x, kIndexNone, kContinue) \
+    V(0x1F, CHECK_CAST, "check-cast", k21c, kIndexType, kContinue) \
+    V(0x20, INSTANCE_OF, "instance-of", k22c, kIndexType, kContinue) \
+    V(0x21, ARRAY_LENGTH, "array-length", k12x, kIndexNone, kContinue) \
+    V(0x22, NEW_INSTANCE, "new-instance", k21c, kIndexType, kContinue) \
+    V(0x23, NEW_ARRAY, "new-array", k22c, kIndexType, kContinue) \
+    V(0x24, FILLED_NEW_ARRAY, "filled-new-array", k35c, kIndexType, kContinue) \
+    V(0x25, FILLED_NEW_ARRAY_RANGE, "filled-new-array/range", k3rc, kIndexType, kContinue) \
+    V(0x26, FILL_ARRAY_DATA, "fill-array-data", k31t, kIndexNone, kContinue | kPayload) \
+    V(0x27, THROW, "throw", k11x, kIndexNone, kThrow) \
+    V(0x28, GOTO, "goto", k10t, kIndexNone, kBranch) \
+    V(0x29, GOTO_16, "goto/16", k20t, kIndexNone, kBranch) \
+    V(0x2A, GOTO_32, "goto/32", k30t, kIndexNone, kBranch) \
+    V(0x2B, PACKED_SWITCH, "packed-switch", k31t, kIndexNone, kContinue | kSwitch | kPayload) \
+    V(0x2C, SPARSE_SWITCH, "sparse-switch", k31t, kIndexNone, kContinue | kSwitch | kPayload) \
+    V(0x2D, CMPL_FLOAT, "cmpl-float", k23x, kIndexNone, kContinue) \
+    V(0x2E, CMPG_FLOAT, "cmpg-float", k23x, kIndexNone, kContinue) \
+    V(0x2F, CMPL_DOUBLE, "cmpl-double", k23x, kIndexNone, kContinue) \
+    V(0x30, CMPG_DOUBLE, "cmpg-double", k23x, kIndexNone, kContinue) \
+    V(0x31, CMP_LONG, "cmp-long", k23x, kIndexNone, kContinue) \
+    V(0x32, IF_EQ, "if-eq", k22t, kIndexNone, kContinue | kBranch) \
+    V(0x33, IF_NE, "if-ne", k22t, kIndexNone, kContinue | kBranch) \
+    V(0x34, IF_LT, "if-lt", k22t, kIndexNone, kContinue | kBranch) \
+    V(0x35, IF_GE, "if-ge", k22t, kIndexNone, kContinue | kBranch) \
+    V(0x36, IF_GT, "if-gt", k22t, kIndexNone, kContinue | kBranch) \
+    V(0x37, IF_LE, "if-le", k22t, kIndexNone, kContinue | kBranch) \
+    V(0x38, IF_EQZ, "if-eqz", k21t, kIndexNone, kContinue | kBranch) \
+    V(0x39, IF_NEZ, "if-nez", k21t, kIndexNone, kContinue | kBranch) \
+    V(0x3A, IF_LTZ, "if-ltz", k21t, kIndexNone, kContinue | kBranch) \
+    V(0x3B, IF_GEZ, "if-gez", k21t, kIndexNone, kContinue | kBranch) \
+    V(0x3C, IF_GTZ, "if-gtz", k21t, kIndexNone, kContinue | kBranch) \
+    V(0x3D, IF_LEZ, "if-lez", k21t, kIndexNone, kContinue | kBranch) \
+    V(0x3E, UNUSED_3E, "unused-3e", k10x, kIndexNone, kUnused) \
+    V(0x3F, UNUSED_3F, "unused-3f", k10x, kIndexNone, kUnused) \
+    V(0x40, UNUSED_40, "unused-40", k10x, kIndexNone, kUnused) \
+    V(0x41, UNUSED_41, "unused-41", k10x, kIndexNone, kUnused) \
+    V(0x42, UNUSED_42, "unused-42", k10x, kIndexNone, kUnused) \
+    V(0x43, UNUSED_43, "unused-43", k10x, kIndexNone, kUnused) \
+    V(0x44, AGET, "aget", k23x, kIndexNone, kContinue) \
+    V(0x45, AGET_WIDE, "aget-wide", k23x, kIndexNone, kContinue) \
+    V(0x46, AGET_OBJECT, "aget-object", k23x, kIndexNone, kContinue) \
+    V(0x47, AGET_BOOLEAN, "aget-boolean", k23x, kIndexNone, kContinue) \
+    V(0x48, AGET_BYTE, "aget-byte", k23x, kIndexNone, kContinue) \
+    V(0x49, AGET_CHAR, "aget-char", k23x, kIndexNone, kContinue) \
+    V(0x4A, AGET_SHORT, "aget-short", k23x, kIndexNone, kContinue) \
+    V(0x4B, APUT, "aput", k23x, kIndexNone, kContinue) \
+    V(0x4C, APUT_WIDE, "aput-wide", k23x, kIndexNone, kContinue) \
+    V(0x4D, APUT_OBJECT, "aput-object", k23x, kIndexNone, kContinue) \
+    V(0x4E, APUT_BOOLEAN, "aput-boolean", k23x, kIndexNone, kContinue) \
+    V(0x4F, APUT_BYTE, "aput-byte", k23x, kIndexNone, kContinue) \
+    V(0x50, APUT_CHAR, "aput-char", k23x, kIndexNone, kContinue) \
+    V(0x51, APUT_SHORT, "aput-short", k23x, kIndexNone, kContinue) \
+    V(0x52, IGET, "iget", k22c, kIndexField, kContinue) \
+    V(0x53, IGET_WIDE, "iget-wide", k22c, kIndexField, kContinue) \
+    V(0x54, IGET_OBJECT, "iget-object", k22c, kIndexField, kContinue) \
+    V(0x55, IGET_BOOLEAN, "iget-boolean", k22c, kIndexField, kContinue) \
+    V(0x56, IGET_BYTE, "iget-byte", k22c, kIndexField, kContinue) \
+    V(0x57, IGET_CHAR, "iget-char", k22c, kIndexField, kContinue) \
+    V(0x58, IGET_SHORT, "iget-short", k22c, kIndexField, kContinue) \
+    V(0x59, IPUT, "iput", k22c, kIndexField, kContinue) \
+    V(0x5A, IPUT_WIDE, "iput-wide", k22c, kIndexField, kContinue) \
+    V(0x5B, IPUT_OBJECT, "iput-object", k22c, kIndexField, kContinue) \
+    V(0x5C, IPUT_BOOLEAN, "iput-boolean", k22c, kIndexField, kContinue) \
+    V(0x5D, IPUT_BYTE, "iput-byte", k22c, kIndexField, kContinue) \
+    V(0x5E, IPUT_CHAR, "iput-char", k22c, kIndexField, kContinue) \
+    V(0x5F, IPUT_SHORT, "iput-short", k22c, kIndexField, kContinue) \
+    V(0x60, SGET, "sget", k21c, kIndexField, kContinue) \
+    V(0x61, SGET_WIDE, "sget-wide", k21c, kIndexField, kContinue) \
+    V(0x62, SGET_OBJECT, "sget-object", k21c, kIndexField, kContinue) \
+    V(0x63, SGET_BOOLEAN, "sget-boolean", k21c, kIndexField, kContinue) \
+    V(0x64, SGET_BYTE, "sget-byte", k21c, kIndexField, kContinue) \
+    V(0x65, SGET_CHAR, "sget-char", k21c, kIndexField, kContinue) \
+    V(0x66, SGET_SHORT, "sget-short", k21c, kIndexField, kContinue) \
+    V(0x67, SPUT, "sput", k21c, kIndexField, kContinue) \
+    V(0x68, SPUT_WIDE, "sput-wide", k21c, kIndexField, kContinue) \
+    V(0x69, SPUT_OBJECT, "sput-object", k21c, kIndexField, kContinue) \
+    V(0x6A, SPUT_BOOLEAN, "sput-boolean", k21c, kIndexField, kContinue) \
+    V(0x6B, SPUT_BYTE, "sput-byte", k21c, kIndexField, kContinue) \
+    V(0x6C, SPUT_CHAR, "sput-char", k21c, kIndexField, kContinue) \
+    V(0x6D, SPUT_SHORT, "sput-short", k21c, kIndexField, kContinue) \
+    V(0x6E, INVOKE_VIRTUAL, "invoke-virtual", k35c, kIndexMethod, kContinue | kInvoke) \
+    V(0x6F, INVOKE_SUPER, "invoke-super", k35c, kIndexMethod, kContinue | kInvoke) \
+    V(0x70, INVOKE_DIRECT, "invoke-direct", k35c, kIndexMethod, kContinue | kInvoke) \
+    V(0x71, INVOKE_STATIC, "invoke-static", k35c, kIndexMethod, kContinue | kInvoke) \
+    V(0x72, INVOKE_INTERFACE, "invoke-interface", k35c, kIndexMethod, kContinue | kInvoke) \
+    V(0x73, UNUSED_73, "unused-73", k10x, kIndexNone, kUnused) \
+    V(0x74, INVOKE_VIRTUAL_RANGE, "invoke-virtual/range", k3rc, kIndexMethod, kContinue | kInvoke) \
+    V(0x75, INVOKE_SUPER_RANGE, "invoke-super/range", k3rc, kIndexMethod, kContinue | kInvoke) \
+    V(0x76, INVOKE_DIRECT_RANGE, "invoke-direct/range", k3rc, kIndexMethod, kContinue | kInvoke) \
+    V(0x77, INVOKE_STATIC_RANGE, "invoke-static/range", k3rc, kIndexMethod, kContinue | kInvoke) \
+    V(0x78, INVOKE_INTERFACE_RANGE, "invoke-interface/range", k3rc, kIndexMethod, kContinue | kInvoke) \
+    V(0x79, UNUSED_79, "unused-79", k10x, kIndexNone, kUnused) \
+    V(0x7A, UNUSED_7A, "unused-7a", k10x, kIndexNone, kUnused) \
+    V(0x7B, NEG_INT, "neg-int", k12x, kIndexNone, kContinue) \
+    V(0x7C, NOT_INT, "not-int", k12x, kIndexNone, kContinue) \
+    V(0x7D, NEG_LONG, "neg-long", k12x, kIndexNone, kContinue) \
+    V(0x7E, NOT_LONG, "not-long", k12x, kIndexNone, kContinue) \
+    V(0x7F, NEG_FLOAT, "neg-float", k12x, kIndexNone, kContinue) \
+    V(0x80, NEG_DOUBLE, "neg-double", k12x, kIndexNone, kContinue) \
+    V(0x81, INT_TO_LONG, "int-to-long", k12x, kIndexNone, kContinue) \
+    V(0x82, INT_TO_FLOAT, "int-to-float", k12x, kIndexNone, kContinue) \
+    V(0x83, INT_TO_DOUBLE, "int-to-double", k12x, kIndexNone, kContinue) \
+    V(0x84, LONG_TO_INT, "long-to-int", k12x, kIndexNone, kContinue) \
+    V(0x85, LONG_TO_FLOAT, "long-to-float", k12x, kIndexNone, kContinue) \
+    V(0x86, LONG_TO_DOUBLE, "long-to-double", k12x, kIndexNone, kContinue) \
+    V(0x87, FLOAT_TO_INT, "float-to-int", k12x, kIndexNone, kContinue) \
+    V(0x88, FLOAT_TO_LONG, "float-to-long", k12x, kIndexNone, kContinue) \
+    V(0x89, FLOAT_TO_DOUBLE, "float-to-double", k12x, kIndexNone, kContinue) \
+    V(0x8A, DOUBLE_TO_INT, "double-to-int", k12x, kIndexNone, kContinue) \
+    V(0x8B, DOUBLE_TO_LONG, "double-to-long", k12x, kIndexNone, kContinue) \
+    V(0x8C, DOUBLE_TO_FLOAT, "double-to-float", k12x, kIndexNone, kContinue) \
+    V(0x8D, INT_TO_BYTE, "int-to-byte", k12x, kIndexNone, kContinue) \
+    V(0x8E, INT_TO_CHAR, "int-to-char", k12x, kIndexNone, kContinue) \
+    V(0x8F, INT_TO_SHORT, "int-to-short", k12x, kIndexNone, kContinue) \
+    V(0x90, ADD_INT, "add-int", k23x, kIndexNone, kContinue) \
+    V(0x91, SUB_INT, "sub-int", k23x, kIndexNone, kContinue) \
+    V(0x92, MUL_INT, "mul-int", k23x, kIndexNone, kContinue) \
+    V(0x93, DIV_INT, "div-int", k23x, kIndexNone, kContinue) \
+    V(0x94, REM_INT, "rem-int", k23x, kIndexNone, kContinue) \
+    V(0x95, AND_INT, "and-int", k23x, kIndexNone, kContinue) \
+    V(0x96, OR_INT, "or-int", k23x, kIndexNone, kContinue) \
+    V(0x97, XOR_INT, "xor-int", k23x, kIndexNone, kContinue) \
+    V(0x98, SHL_INT, "shl-int", k23x, kIndexNone, kContinue) \
+    V(0x99, SHR_INT, "shr-int", k23x, kIndexNone, kContinue) \
+    V(0x9A, USHR_INT, "ushr-int", k23x, kIndexNone, kContinue) \
+    V(0x9B, ADD_LONG, "add-long", k23x, kIndexNone, kContinue) \
+    V(0x9C, SUB_LONG, "sub-long", k23x, kIndexNone, kContinue) \
+    V(0x9D, MUL_LONG, "mul-long", k23x, kIndexNone, kContinue) \
+    V(0x9E, DIV_LONG, "div-long", k23x, kIndexNone, kContinue) \
+    V(0x9F, REM_LONG, "rem-long", k23x, kIndexNone, kContinue) \
+    V(0xA0, AND_LONG, "and-long", k23x, kIndexNone, kContinue) \
+    V(0xA1, OR_LONG, "or-long", k23x, kIndexNone, kContinue) \
+    V(0xA2, XOR_LONG, "xor-long", k23x, kIndexNone, kContinue) \
+    V(0xA3, SHL_LONG, "shl-long", k23x, kIndexNone, kContinue) \
+    V(0xA4, SHR_LONG, "shr-long", k23x, kIndexNone, kContinue) \
+    V(0xA5, USHR_LONG, "ushr-long", k23x, kIndexNone, kContinue) \
+    V(0xA6, ADD_FLOAT, "add-float", k23x, kIndexNone, kContinue) \
+    V(0xA7, SUB_FLOAT, "sub-float", k23x, kIndexNone, kContinue) \
+    V(0xA8, MUL_FLOAT, "mul-float", k23x, kIndexNone, kContinue) \
+    V(0xA9, DIV_FLOAT, "div-float", k23x, kIndexNone, kContinue) \
+    V(0xAA, REM_FLOAT, "rem-float", k23x, kIndexNone, kContinue) \
+    V(0xAB, ADD_DOUBLE, "add-double", k23x, kIndexNone, kContinue) \
+    V(0xAC, SUB_DOUBLE, "sub-double", k23x, kIndexNone, kContinue) \
+    V(0xAD, MUL_DOUBLE, "mul-double", k23x, kIndexNone, kContinue) \
+    V(0xAE, DIV_DOUBLE, "div-double", k23x, kIndexNone, kContinue) \
+    V(0xAF, REM_DOUBLE, "rem-double", k23x, kIndexNone, kContinue) \
+    V(0xB0, ADD_INT_2ADDR, "add-int/2addr", k12x, kIndexNone, kContinue) \
+    V(0xB1, SUB_INT_2ADDR, "sub-int/2addr", k12x, kIndexNone, kContinue) \
+    V(0xB2, MUL_INT_2ADDR, "mul-int/2addr", k12x, kIndexNone, kContinue) \
+    V(0xB3, DIV_INT_2ADDR, "div-int/2addr", k12x, kIndexNone, kContinue) \
+    V(0xB4, REM_INT_2ADDR, "rem-int/2addr", k12x, kIndexNone, kContinue) \
+    V(0xB5, AND_INT_2ADDR, "and-int/2addr", k12x, kIndexNone, kContinue) \
+    V(0xB6, OR_INT_2ADDR, "or-int/2addr", k12x, kIndexNone, kContinue) \
+    V(0xB7, XOR_INT_2ADDR, "xor-int/2addr", k12x, kIndexNone, kContinue) \
+    V(0xB8, SHL_INT_2ADDR, "shl-int/2addr", k12x, kIndexNone, kContinue) \
+    V(0xB9, SHR_INT_2ADDR, "shr-int/2addr", k12x, kIndexNone, kContinue) \
+    V(0xBA, USHR_INT_2ADDR, "ushr-int/2addr", k12x, kIndexNone, kContinue) \
+    V(0xBB, ADD_LONG_2ADDR, "add-long/2addr", k12x, kIndexNone, kContinue) \
+    V(0xBC, SUB_LONG_2ADDR, "sub-long/2addr", k12x, kIndexNone, kContinue) \
+    V(0xBD, MUL_LONG_2ADDR, "mul-long/2addr", k12x, kIndexNone, kContinue) \
+    V(0xBE, DIV_LONG_2ADDR, "div-long/2addr", k12x, kIndexNone, kContinue) \
+    V(0xBF, REM_LONG_2ADDR, "rem-long/2addr", k12x, kIndexNone, kContinue) \
+    V(0xC0, AND_LONG_2ADDR, "and-long/2addr", k12x, kIndexNone, kContinue) \
+    V(0xC1, OR_LONG_2ADDR, "or-long/2addr", k12x, kIndexNone, kContinue) \
+    V(0xC2, XOR_LONG_2ADDR, "xor-long/2addr", k12x, kIndexNone, kContinue) \
+    V(0xC3, SHL_LONG_2ADDR, "shl-long/2addr", k12x, kIndexNone, kContinue) \
+    V(0xC4, SHR_LONG_2ADDR, "shr-long/2addr", k12x, kIndexNone, kContinue) \
+    V(0xC5, USHR_LONG_2ADDR, "ushr-long/2addr", k12x, kIndexNone, kContinue) \
+    V(0xC6, ADD_FLOAT_2ADDR, "add-float/2addr", k12x, kIndexNone, kContinue) \
+    V(0xC7, SUB_FLOAT_2ADDR, "sub-float/2addr", k12x, kIndexNone, kContinue) \
+    V(0xC8, MUL_FLOAT_2ADDR, "mul-float/2addr", k12x, kIndexNone, kContinue) \
+    V(0xC9, DIV_FLOAT_2ADDR, "div-float/2addr", k12x, kIndexNone, kContinue) \
+    V(0xCA, REM_FLOAT_2ADDR, "rem-float/2addr", k12x, kIndexNone, kContinue) \
+    V(0xCB, ADD_DOUBLE_2ADDR, "add-double/2addr", k12x, kIndexNone, kContinue) \
+    V(0xCC, SUB_DOUBLE_2ADDR, "sub-double/2addr", k12x, kIndexNone, kContinue) \
+    V(0xCD, MUL_DOUBLE_2ADDR, "mul-double/2addr", k12x, kIndexNone, kContinue) \
+    V(0xCE, DIV_DOUBLE_2ADDR, "div-double/2addr", k12x, kIndexNone, kContinue) \
+    V(0xCF, REM_DOUBLE_2ADDR, "rem-double/2addr", k12x, kIndexNone, kContinue) \
+    V(0xD0, ADD_INT_LIT16, "add-int/lit16", k22s, kIndexNone, kContinue) \
+    V(0xD1, RSUB_INT, "rsub-int", k22s, kIndexNone, kContinue) \
+    V(0xD2, MUL_INT_LIT16, "mul-int/lit16", k22s, kIndexNone, kContinue) \
+    V(0xD3, DIV_INT_LIT16, "div-int/lit16", k22s, kIndexNone, kContinue) \
+    V(0xD4, REM_INT_LIT16, "rem-int/lit16", k22s, kIndexNone, kContinue) \
+    V(0xD5, AND_INT_LIT16, "and-int/lit16", k22s, kIndexNone, kContinue) \
+    V(0xD6, OR_INT_LIT16, "or-int/lit16", k22s, kIndexNone, kContinue) \
+    V(0xD7, XOR_INT_LIT16, "xor-int/lit16", k22s, kIndexNone, kContinue) \
+    V(0xD8, ADD_INT_LIT8, "add-int/lit8", k22b, kIndexNone, kContinue) \
+    V(0xD9, RSUB_INT_LIT8, "rsub-int/lit8", k22b, kIndexNone, kContinue) \
+    V(0xDA, MUL_INT_LIT8, "mul-int/lit8", k22b, kIndexNone, kContinue) \
+    V(0xDB, DIV_INT_LIT8, "div-int/lit8", k22b, kIndexNone, kContinue) \
+    V(0xDC, REM_INT_LIT8, "rem-int/lit8", k22b, kIndexNone, kContinue) \
+    V(0xDD, AND_INT_LIT8, "and-int/lit8", k22b, kIndexNone, kContinue) \
+    V(0xDE, OR_INT_LIT8, "or-int/lit8", k22b, kIndexNone, kContinue) \
+    V(0xDF, XOR_INT_LIT8, "xor-int/lit8", k22b, kIndexNone, kContinue) \
+    V(0xE0, SHL_INT_LIT8, "shl-int/lit8", k22b, kIndexNone, kContinue) \
+    V(0xE1, SHR_INT_LIT8, "shr-int/lit8", k22b, kIndexNone, kContinue) \
+    V(0xE2, USHR_INT_LIT8, "ushr-int/lit8", k22b, kIndexNone, kContinue) \
+    V(0xE3, UNUSED_E3, "unused-e3", k10x, kIndexNone, kUnused) \
+    V(0xE4, UNUSED_E4, "unused-e4", k10x, kIndexNone, kUnused) \
+    V(0xE5, UNUSED_E5, "unused-e5", k10x, kIndexNone, kUnused) \
+    V(0xE6, UNUSED_E6, "unused-e6", k10x, kIndexNone, kUnused) \
+    V(0xE7, UNUSED_E7, "unused-e7", k10x, kIndexNone, kUnused) \
+    V(0xE8, UNUSED_E8, "unused-e8", k10x, kIndexNone, kUnused) \
+    V(0xE9, UNUSED_E9, "unused-e9", k10x, kIndexNone, kUnused) \
+    V(0xEA, UNUSED_EA, "unused-ea", k10x, kIndexNone, kUnused) \
+    V(0xEB, UNUSED_EB, "unused-eb", k10x, kIndexNone, kUnused) \
+    V(0xEC, UNUSED_EC, "unused-ec", k10x, kIndexNone, kUnused) \
+    V(0xED, UNUSED_ED, "unused-ed", k10x, kIndexNone, kUnused) \
+    V(0xEE, UNUSED_EE, "unused-ee", k10x, kIndexNone, kUnused) \
+    V(0xEF, UNUSED_EF, "unused-ef", k10x, kIndexNone, kUnused) \
+    V(0xF0, UNUSED_F0, "unused-f0", k10x, kIndexNone, kUnused) \
+    V(0xF1, UNUSED_F1, "unused-f1", k10x, kIndexNone, kUnused) \
+    V(0xF2, UNUSED_F2, "unused-f2", k10x, kIndexNone, kUnused) \
+    V(0xF3, UNUSED_F3, "unused-f3", k10x, kIndexNone, kUnused) \
+    V(0xF4, UNUSED_F4, "unused-f4", k10x, kIndexNone, kUnused) \
+    V(0xF5, UNUSED_F5, "unused-f5", k10x, kIndexNone, kUnused) \
+    V(0xF6, UNUSED_F6, "unused-f6", k10x, kIndexNone, kUnused) \
+    V(0xF7, UNUSED_F7, "unused-f7", k10x, kIndexNone, kUnused) \
+    V(0xF8, UNUSED_F8, "unused-f8", k10x, kIndexNone, kUnused) \
+    V(0xF9, UNUSED_F9, "unused-f9", k10x, kIndexNone, kUnused) \
+    V(0xFA, INVOKE_POLYMORPHIC, "invoke-polymorphic", k45cc, kIndexMethodAndProto, kContinue | kInvoke) \
+    V(0xFB, INVOKE_POLYMORPHIC_RANGE, "invoke-polymorphic/range", k4rcc, kIndexMethodAndProto, kContinue | kInvoke) \
+    V(0xFC, INVOKE_CUSTOM, "invoke-custom", k35c, kIndexCallSite, kContinue | kInvoke) \
+    V(0xFD, INVOKE_CUSTOM_RANGE, "invoke-custom/range", k3rc, kIndexCallSite, kContinue | kInvoke) \
+    V(0xFE, CONST_METHOD_HANDLE, "const-method-handle", k21c, kIndexMethodHandle, kContinue) \
+    V(0xFF, CONST_METHOD_TYPE, "const-method-type", k21c, kIndexProto, kContinue)
+
+        enum Opcode : uint8_t {
+#define DEX_INSTRUCTION_ENUM(opcode, cname, name, format, index, flags) cname = (opcode),
+            DEX_INSTRUCTION_LIST(DEX_INSTRUCTION_ENUM)
+#undef DEX_INSTRUCTION_ENUM
+        };
+
+        // 各格式的长度（code unit）
+        constexpr uint8_t FormatWidth(InstructionFormat format) {
+            switch (format) {
+                case k10x: case k12x: case k11n: case k11x: case k10t:
+                    return 1;
+                case k20t: case k22x: case k21t: case k21s: case k21h: case k21c:
+                case k23x: case k22b: case k22t: case k22s: case k22c:
+                    return 2;
+                case k32x: case k30t: case k31t: case k31i: case k31c: case k35c: case k3rc:
+                    return 3;
+                case k45cc: case k4rcc:
+                    return 4;
+                case k51l:
+                    return 5;
+            }
+            return 1;
+        }
+
+        struct InstructionDescriptor {
+            const char *name;
+            InstructionFormat format;
+            InstructionIndexType index_type;
+            uint8_t flags;
+            uint8_t width;
+        };
+
+        constexpr InstructionDescriptor kInstructionDescriptors[256] = {
+#define DEX_INSTRUCTION_DESCRIPTOR(opcode, cname, name, format, index, flags) \
+            {name, format, index, static_cast<uint8_t>(flags), FormatWidth(format)},
+            DEX_INSTRUCTION_LIST(DEX_INSTRUCTION_DESCRIPTOR)
+#undef DEX_INSTRUCTION_DESCRIPTOR
+        };
+
+        // 表中第 i 项必须是操作码 i
+        constexpr bool InstructionListInOrder() {
+            constexpr uint8_t opcodes[] = {
+#define DEX_INSTRUCTION_OPCODE(opcode, cname, name, format, index, flags) (opcode),
+                    DEX_INSTRUCTION_LIST(DEX_INSTRUCTION_OPCODE)
+#undef DEX_INSTRUCTION_OPCODE
+            };
+            if (sizeof(opcodes) != 256) return false;
+            for (size_t i = 0; i < sizeof(opcodes); ++i) {
+                if (opcodes[i] != i) return false;
+            }
+            return true;
+        }
+
+        static_assert(InstructionListInOrder(), "DEX_INSTRUCTION_LIST must list opcodes 0x00 ~ 0xFF in order");
+
+        inline const InstructionDescriptor &GetInstructionDescriptor(Opcode opcode) {
+            return kInstructionDescriptors[opcode];
+        }
+
+        // nop 的高字节为 payload 类型
+        constexpr uint16_t kPackedSwitchSignature = 0x0100;
+        constexpr uint16_t kSparseSwitchSignature = 0x0200;
+        constexpr uint16_t kArrayDataSignature = 0x0300;
+
+        /**
+         * 解码后的指令，字段含义同 ART 的 DecodedInstruction
+         *
+         * - 寄存器、索引、字面量按格式放入 vA / vB / vC，偏移和有符号字面量已做符号扩展（按 int32_t 读取）；
+         * - 35c / 45cc：vA 为参数个数，vB 为索引，arg[0 .. vA) 为参数寄存器；
+         * - 3rc / 4rcc：vA 为参数个数，vB 为索引，vC 为第一个寄存器；
+         * - 45cc / 4rcc 的 proto_idx 在 vH，51l 的字面量在 vB_wide；
+         * - payload（payload 不为 0）：opcode 为 NOP，vA 为元素个数，vB 为 packed-switch 的 first_key 或 fill-array-data 的元素宽度。
+         */
+        struct DecodedInstruction {
+            Opcode opcode = NOP;
+            // 0 或 k*Signature
+            uint16_t payload = 0;
+            // 长度（code unit），payload 为整个数据表的长度
+            uint32_t width = 0;
+            uint32_t vA = 0;
+            uint32_t vB = 0;
+            uint64_t vB_wide = 0;
+            uint32_t vC = 0;
+            uint32_t vH = 0;
+            uint32_t arg[5] = {};
+
+            const InstructionDescriptor &descriptor() const { return kInstructionDescriptors[opcode]; }
+
+            const char *name() const { return kInstructionDescriptors[opcode].name; }
+
+            InstructionFormat format() const { return kInstructionDescriptors[opcode].format; }
+        };
+
+        /**
+         * insns 处指令的长度（code unit），payload 按数据表计算
+         *
+         * @param available 剩余的 code unit 个数
+         * @return 超出 available 返回 0
+         */
+        inline uint32_t InstructionWidth(const uint16_t *insns, size_t available) {
+            if (available == 0) return 0;
+            uint16_t inst = insns[0];
+            uint64_t width = kInstructionDescriptors[inst & 0xFF].width;
+            if (inst == kPackedSwitchSignature || inst == kSparseSwitchSignature || inst == kArrayDataSignature) {
+                if (available < 2) return 0;
+                if (inst == kPackedSwitchSignature) {
+                    width = 4 + static_cast<uint64_t>(insns[1]) * 2;
+                } else if (inst == kSparseSwitchSignature) {
+                    width = 2 + static_cast<uint64_t>(insns[1]) * 4;
+                } else if (inst == kArrayDataSignature) {
+                    if (available < 4) return 0;
+                    uint64_t size = insns[2] | (static_cast<uint32_t>(insns[3]) << 16);
+                    width = 4 + (size * insns[1] + 1) / 2;
+                }
+            }
+            return width <= available ? static_cast<uint32_t>(width) : 0;
+        }
+
+        /**
+         * 解码 insns 处的一条指令
+         *
+         * @return 指令超出 available 返回 false
+         */
+        inline bool DecodeInstruction(const uint16_t *insns, size_t available, DecodedInstruction *out) {
+            uint32_t width = InstructionWidth(insns, available);
+            if (width == 0) return false;
+
+            uint16_t inst = insns[0];
+            DecodedInstruction &d = *out;
+            d = DecodedInstruction();
+            d.opcode = static_cast<Opcode>(inst & 0xFF);
+            d.width = width;
+
+            if (inst == kPackedSwitchSignature || inst == kSparseSwitchSignature || inst == kArrayDataSignature) {
+                d.payload = inst;
+                if (inst == kArrayDataSignature) {
+                    d.vA = insns[2] | (static_cast<uint32_t>(insns[3]) << 16);
+                    d.vB = insns[1];
+                } else {
+                    d.vA = insns[1];
+                    if (inst == kPackedSwitchSignature) d.vB = insns[2] | (static_cast<uint32_t>(insns[3]) << 16);
+                }
+                return true;
+            }
+
+            uint32_t a4 = (inst >> 8) & 0x0F;
+            uint32_t b4 = inst >> 12;
+            uint32_t aa = inst >> 8;
+            switch (kInstructionDescriptors[d.opcode].format) {
+                case k10x:
+                    break;
+                case k12x:
+                    d.vA = a4;
+                    d.vB = b4;
+                    break;
+                case k11n:
+                    d.vA = a4;
+                    d.vB = static_cast<uint32_t>(static_cast<int32_t>(static_cast<int16_t>(inst)) >> 12);
+                    break;
+                case k11x:
+                    d.vA = aa;
+                    break;
+                case k10t:
+                    d.vA = static_cast<uint32_t>(static_cast<int8_t>(aa));
+                    break;
+                case k20t:
+                    d.vA = static_cast<uint32_t>(static_cast<int16_t>(insns[1]));
+                    break;
+                case k22x:
+                    d.vA = aa;
+                    d.vB = insns[1];
+                    break;
+                case k21t:
+                case k21s:
+                    d.vA = aa;
+                    d.vB = static_cast<uint32_t>(static_cast<int16_t>(insns[1]));
+                    break;
+                case k21h:
+                case k21c:
+                    d.vA = aa;
+                    d.vB = insns[1];
+                    break;
+                case k23x:
+                    d.vA = aa;
+                    d.vB = insns[1] & 0xFF;
+                    d.vC = insns[1] >> 8;
+                    break;
+                case k22b:
+                    d.vA = aa;
+                    d.vB = insns[1] & 0xFF;
+                    d.vC = static_cast<uint32_t>(static_cast<int8_t>(insns[1] >> 8));
+                    break;
+                case k22t:
+                case k22s:
+                    d.vA = a4;
+                    d.vB = b4;
+                    d.vC = static_cast<uint32_t>(static_cast<int16_t>(insns[1]));
+                    break;
+                case k22c:
+                    d.vA = a4;
+                    d.vB = b4;
+                    d.vC = insns[1];
+                    break;
+                case k32x:
+                    d.vA = insns[1];
+                    d.vB = insns[2];
+                    break;
+                case k30t:
+                    d.vA = insns[1] | (static_cast<uint32_t>(insns[2]) << 16);
+                    break;
+                case k31t:
+                case k31i:
+                case k31c:
+                    d.vA = aa;
+                    d.vB = insns[1] | (static_cast<uint32_t>(insns[2]) << 16);
+                    break;
+                case k35c:
+                case k45cc: {
+                    // A|G|op BBBB F|E|D|C [HHHH]
+                    d.vA = b4;
+                    d.vB = insns[1];
+                    uint16_t regs = insns[2];
+                    d.arg[0] = regs & 0x0F;
+                    d.arg[1] = (regs >> 4) & 0x0F;
+                    d.arg[2] = (regs >> 8) & 0x0F;
+                    d.arg[3] = regs >> 12;
+                    d.arg[4] = a4;
+                    d.vC = d.arg[0];
+                    if (d.format() == k45cc) d.vH = insns[3];
+                    break;
+                }
+                case k3rc:
+                case k4rcc:
+                    d.vA = aa;
+                    d.vB = insns[1];
+                    d.vC = insns[2];
+                    if (d.format() == k4rcc) d.vH = insns[3];
+                    break;
+                case k51l:
+                    d.vA = aa;
+                    d.vB_wide = insns[1] | (static_cast<uint64_t>(insns[2]) << 16) |
+                                (static_cast<uint64_t>(insns[3]) << 32) | (static_cast<uint64_t>(insns[4]) << 48);
+                    break;
+            }
+            return true;
+        }
+
+        /**
+         * 依次解码 insns 中的全部指令（包括 payload）
+         *
+         * visitor: bool(uint32_t dex_pc, const DecodedInstruction &)，返回 false 停止
+         *
+         * @return 指令被截断返回 false
+         */
+        template<typename Visitor>
+        bool VisitInstructions(const uint16_t *insns, uint32_t insns_size, Visitor &&visitor) {
+            DecodedInstruction inst;
+            uint32_t dex_pc = 0;
+            while (dex_pc < insns_size) {
+                if (!DecodeInstruction(insns + dex_pc, insns_size - dex_pc, &inst)) return false;
+                if (!visitor(dex_pc, static_cast<const DecodedInstruction &>(inst))) return true;
+                dex_pc += inst.width;
+            }
+            return true;
+        }
+
+    } // namespace dex
+};//namespace cyurs
+
+#endif //CYURS_DEX_INSTRUCTION_H
@@ -0,0 +1,580 @@
+#ifndef CYURS_DEX_READER_H
+#define CYURS_DEX_READER_H
+
+#include <stdint.h>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <cstring>
+#include <string>
+#include <string_view>
+
+#include "dex_file.h"
+#include "leb128.h"
+
+/**
+ * 零拷贝 dex 读取
+ *
+ * 直接在 mmap 或内存中的 dex 上按偏移访问 dex_file.h 中的原始结构，不拷贝、不分配内存。
+ * 支持标准 dex、v41 多 dex 容器和 cdex（vdex 等容器的拆分见 dex_container.h）。
+ * 所有 id 访问都是 O(1) 且带边界检查，越界返回 nullptr / 空 string_view。
+ */
+namespace cyurs {
+    namespace dex {
+
+        constexpr uint32_t kDexEndianConstant = 0x12345678;
+        constexpr uint32_t kDexNoIndex = 0xFFFFFFFF;
+        constexpr uint16_t kDexNoIndex16 = 0xFFFF;
+        // CodeItem 中 insns_ 之前的字节数
+        constexpr uint32_t kCodeItemHeaderSize = 16;
+
+        /**
+         * try_item[] + encoded_catch_handler_list 的结尾
+         *
+         * @param tries_off item 中 try_item[] 的起始位置（已对齐）
+         * @return 整个 item 的长度，数据不完整或格式错误返回 0
+         */
+        inline size_t ComputeCodeItemTriesEnd(const uint8_t *item, size_t available, uint64_t tries_off, uint32_t tries_size) {
+            uint64_t size = tries_off + static_cast<uint64_t>(tries_size) * sizeof(TryItem);
+            if (size > available) return 0;
+
+            const uint8_t *ptr = item + size;
+            const uint8_t *end = item + available;
+            uint32_t handlers_size;
+            if (!DecodeUnsignedLeb128Checked(&ptr, end, &handlers_size)) return 0;
+            for (uint32_t i = 0; i < handlers_size; ++i) {
+                int32_t catches;
+                if (!DecodeSignedLeb128Checked(&ptr, end, &catches)) return 0;
+                uint32_t pairs = catches < 0 ? static_cast<uint32_t>(-static_cast<int64_t>(catches)) : catches;
+                uint32_t value;
+                for (uint64_t k = 0; k < static_cast<uint64_t>(pairs) * 2; ++k) {
+                    if (!DecodeUnsignedLeb128Checked(&ptr, end, &value)) return 0;
+                }
+                // catches <= 0 时带 catch_all_addr
+                if (catches <= 0 && !DecodeUnsignedLeb128Checked(&ptr, end, &value)) return 0;
+            }
+            return static_cast<size_t>(ptr - item);
+        }
+
+        /**
+         * code_item 的完整长度：头部 + insns + (对齐 + try_item[] + encoded_catch_handler_list)
+         *
+         * @param available item 之后可读的字节数
+         * @return 数据不完整或格式错误返回 0
+         */
+        inline size_t ComputeCodeItemSize(const uint8_t *item, size_t available) {
+            if (item == nullptr || available < kCodeItemHeaderSize) return 0;
+            // dump 记录中的 code_item 不一定对齐，拷出头部再读
+            CodeItem code_item_header;
+            memcpy(&code_item_header, item, kCodeItemHeaderSize);
+            const CodeItem *code_item = &code_item_header;
+            uint64_t size = kCodeItemHeaderSize + static_cast<uint64_t>(code_item->insns_size_in_code_units_) * sizeof(uint16_t);
+            if (code_item->tries_size_ == 0) {
+                return size <= available ? static_cast<size_t>(size) : 0;
+            }
+            // insns 为奇数个 code unit 时有 2 字节填充
+            return ComputeCodeItemTriesEnd(item, available, (size + 3) & ~3ULL, code_item->tries_size_);
+        }
+
+        // 解码后的 code_item，标准 dex 和 cdex 通用
+        struct CodeItemInfo {
+            // 包含 ins_size
+            uint16_t registers_size = 0;
+            uint16_t ins_size = 0;
+            uint16_t outs_size = 0;
+            uint16_t tries_size = 0;
+            // 相对于数据区，没有为 0
+            uint32_t debug_info_off = 0;
+            uint32_t insns_size = 0;
+            const uint16_t *insns = nullptr;
+            // try_item[] 相对于数据区的偏移，tries_size 为 0 时无意义
+            uint32_t tries_off = 0;
+        };
+
+        class DexReader {
+        public:
+            DexReader() = default;
+
+            DexReader(const uint8_t *begin, size_t size) {
+                Open(begin, size);
+            }
+
+            // 独立的 dex / cdex，或 v41 容器中的第一个 dex
+            bool Open(const uint8_t *begin, size_t size) {
+                return OpenInContainer(begin, size, 0);
+            }
+
+            /**
+             * 打开容器中 header_offset 处的 dex，校验 dex 头和各个 id section 的范围
+             *
+             * - 标准 dex（035 ~ 040）：所有偏移相对于 dex 头；
+             * - v41 容器：多个 dex 首尾相接，所有偏移（包括 id section）相对于容器起始，即第一个 dex 头；
+             * - cdex：id section 的偏移相对于 dex 头，其余偏移相对于 data_off_ 处的数据区（vdex 中多个 cdex 共享）。
+             */
+            bool OpenInContainer(const uint8_t *container, size_t container_size, size_t header_offset) {
+                *this = DexReader();
+                if (container == nullptr || header_offset > container_size ||
+                    container_size - header_offset < sizeof(Header)) {
+                    return false;
+                }
+                const uint8_t *begin = container + header_offset;
+                size_t available = container_size - header_offset;
+                begin_ = begin;
+                size_ = available;
+                data_begin_ = begin;
+                data_size_ = available;
+
+                const auto *header = reinterpret_cast<const Header *>(begin);
+                bool compact = memcmp(header->magic_, "cdex", 4) == 0;
+                if ((!compact && memcmp(header->magic_, "dex\n", 4) != 0) || header->magic_[7] != '\0') return false;
+                if (header->endian_tag_ != kDexEndianConstant) return false;
+                if (header->header_size_ < sizeof(Header) || header->header_size_ > available) return false;
+                if (header->file_size_ < header->header_size_ || header->file_size_ > available) return false;
+
+                // id section 所在的范围
+                const uint8_t *ids_begin = begin;
+                uint64_t ids_min = header->header_size_;
+                uint64_t ids_limit = header->file_size_;
+                if (compact) {
+                    if (header->header_size_ < sizeof(CompactDexHeader)) return false;
+                    if (header->data_off_ > available || header->data_size_ > available - header->data_off_) return false;
+                    data_begin_ = begin + header->data_off_;
+                    data_size_ = header->data_size_;
+                    compact_ = true;
+                } else if (ParseVersion(header->magic_) >= 41) {
+                    if (header->header_size_ < sizeof(HeaderV41)) return false;
+                    const auto *header_v41 = reinterpret_cast<const HeaderV41 *>(header);
+                    if (header_v41->header_offset_ != header_offset || header_v41->container_size_ > container_size ||
+                        header_offset + header->file_size_ > header_v41->container_size_) {
+                        return false;
+                    }
+                    data_begin_ = container;
+                    data_size_ = header_v41->container_size_;
+                    ids_begin = container;
+                    ids_min = header_offset + header->header_size_;
+                    ids_limit = header_offset + header->file_size_;
+                    container_ = true;
+                } else {
+                    // 标准 dex 只使用 file_size_ 范围内的数据
+                    data_size_ = header->file_size_;
+                }
+
+                if (!SectionInRange(header->string_ids_off_, header->string_ids_size_, sizeof(StringId), ids_min, ids_limit) ||
+                    !SectionInRange(header->type_ids_off_, header->type_ids_size_, sizeof(TypeId), ids_min, ids_limit) ||
+                    !SectionInRange(header->proto_ids_off_, header->proto_ids_size_, sizeof(ProtoId), ids_min, ids_limit) ||
+                    !SectionInRange(header->field_ids_off_, header->field_ids_size_, sizeof(FieldId), ids_min, ids_limit) ||
+                    !SectionInRange(header->method_ids_off_, header->method_ids_size_, sizeof(MethodId), ids_min, ids_limit) ||
+                    !SectionInRange(header->class_defs_off_, header->class_defs_size_, sizeof(ClassDef), ids_min, ids_limit)) {
+                    return false;
+                }
+
+                header_ = header;
+                string_ids_ = reinterpret_cast<const StringId *>(ids_begin + header->string_ids_off_);
+                type_ids_ = reinterpret_cast<const TypeId *>(ids_begin + header->type_ids_off_);
+                proto_ids_ = reinterpret_cast<const ProtoId *>(ids_begin + header->proto_ids_off_);
+                field_ids_ = reinterpret_cast<const FieldId *>(ids_begin + header->field_ids_off_);
+                method_ids_ = reinterpret_cast<const MethodId *>(ids_begin + header->method_ids_off_);
+                class_defs_ = reinterpret_cast<const ClassDef *>(ids_begin + header->class_defs_off_);
+                size_ = header->file_size_;
+                return true;
+            }
+
+            bool IsValid() const { return header_ != nullptr; }
+
+            const uint8_t *Begin() const { return begin_; }
+
+            size_t Size() const { return size_; }
+
+            const Header &GetHeader() const { return *header_; }
+
+            // dex 版本号，如 35、39；cdex 为 1
+            uint32_t GetVersion() const {
+                return ParseVersion(header_->magic_);
+            }
+
+            // cdex（dex2oat 生成的 compact dex）
+            bool IsCompactDex() const { return compact_; }
+
+            // v41 多 dex 容器中的 dex
+            bool IsDexContainer() const { return container_; }
+
+            // 标准 035 ~ 040 的独立 dex，偏移全部相对于 Begin()
+            bool IsStandaloneDex() const { return IsValid() && !compact_ && !container_; }
+
+            uint32_t NumStringIds() const { return header_->string_ids_size_; }
+
+            uint32_t NumTypeIds() const { return header_->type_ids_size_; }
+
+            uint32_t NumProtoIds() const { return header_->proto_ids_size_; }
+
+            uint32_t NumFieldIds() const { return header_->field_ids_size_; }
+
+            uint32_t NumMethodIds() const { return header_->method_ids_size_; }
+
+            uint32_t NumClassDefs() const { return header_->class_defs_size_; }
+
+            const StringId *GetStringId(uint32_t idx) const {
+                return idx < NumStringIds() ? &string_ids_[idx] : nullptr;
+            }
+
+            const TypeId *GetTypeId(uint32_t idx) const {
+                return idx < NumTypeIds() ? &type_ids_[idx] : nullptr;
+            }
+
+            const ProtoId *GetProtoId(uint32_t idx) const {
+                return idx < NumProtoIds() ? &proto_ids_[idx] : nullptr;
+            }
+
+            const FieldId *GetFieldId(uint32_t idx) const {
+                return idx < NumFieldIds() ? &field_ids_[idx] : nullptr;
+            }
+
+            const MethodId *GetMethodId(uint32_t idx) const {
+                return idx < NumMethodIds() ? &method_ids_[idx] : nullptr;
+            }
+
+            const ClassDef *GetClassDef(uint32_t idx) const {
+                return idx < NumClassDefs() ? &class_defs_[idx] : nullptr;
+            }
+
+            /**
+             * string_data_item：ULEB128 的 UTF-16 长度 + MUTF-8 字节 + '\0'
+             *
+             * @param utf16_length 不为空时返回 UTF-16 长度
+             * @return MUTF-8 字节（不含结尾的 '\0'）
+             */
+            std::string_view GetStringData(uint32_t string_idx, uint32_t *utf16_length = nullptr) const {
+                const StringId *id = GetStringId(string_idx);
+                if (id == nullptr) return {};
+                return GetStringDataAt(id->string_data_off_, utf16_length);
+            }
+
+            std::string_view GetStringDataAt(uint32_t string_data_off, uint32_t *utf16_length = nullptr) const {
+                const uint8_t *ptr = DataPointer(string_data_off, 1);
+                if (ptr == nullptr) return {};
+                const uint8_t *end = data_begin_ + data_size_;
+                uint32_t len;
+                if (!DecodeUnsignedLeb128Checked(&ptr, end, &len)) return {};
+                const void *nul = memchr(ptr, '\0', end - ptr);
+                if (nul == nullptr) return {};
+                if (utf16_length != nullptr) *utf16_length = len;
+                return std::string_view(reinterpret_cast<const char *>(ptr),
+                                        static_cast<const uint8_t *>(nul) - ptr);
+            }
+
+            // 类型描述符，如 Ljava/lang/String;
+            std::string_view GetTypeDescriptor(uint32_t type_idx) const {
+                const TypeId *id = GetTypeId(type_idx);
+                return id == nullptr ? std::string_view() : GetStringData(id->descriptor_idx_);
+            }
+
+            std::string_view GetShorty(uint32_t proto_idx) const {
+                const ProtoId *id = GetProtoId(proto_idx);
+                return id == nullptr ? std::string_view() : GetStringData(id->shorty_idx_);
+            }
+
+            std::string_view GetFieldName(uint32_t field_idx) const {
+                const FieldId *id = GetFieldId(field_idx);
+                return id == nullptr ? std::string_view() : GetStringData(id->name_idx_);
+            }
+
+            std::string_view GetMethodName(uint32_t method_idx) const {
+                const MethodId *id = GetMethodId(method_idx);
+                return id == nullptr ? std::string_view() : GetStringData(id->name_idx_);
+            }
+
+            std::string_view GetMethodDeclaringClassDescriptor(uint32_t method_idx) const {
+                const MethodId *id = GetMethodId(method_idx);
+                return id == nullptr ? std::string_view() : GetTypeDescriptor(id->class_idx_);
+            }
+
+            std::string_view GetClassDescriptor(const ClassDef &class_def) const {
+                return GetTypeDescriptor(class_def.class_idx_);
+            }
+
+            // 参数列表，没有参数返回 nullptr
+            const TypeList *GetProtoParameters(const ProtoId &proto) const {
+                return GetTypeList(proto.parameters_off_);
+            }
+
+            const TypeList *GetInterfacesList(const ClassDef &class_def) const {
+                return GetTypeList(class_def.interfaces_off_);
+            }
+
+            const TypeList *GetTypeList(uint32_t off) const {
+                if (off == 0) return nullptr;
+                const auto *list = reinterpret_cast<const TypeList *>(DataPointer(off, sizeof(uint32_t)));
+                if (list == nullptr) return nullptr;
+                if (DataPointer(off, sizeof(uint32_t) + static_cast<uint64_t>(list->size_) * sizeof(TypeItem)) == nullptr) {
+                    return nullptr;
+                }
+                return list;
+            }
+
+            // class_data_item 起始位置，没有 class data（如接口、注解）返回 nullptr
+            const uint8_t *GetClassData(const ClassDef &class_def) const {
+                return class_def.class_data_off_ == 0 ? nullptr : DataPointer(class_def.class_data_off_, 1);
+            }
+
+            // 标准 dex 的 code_item，insns_ 也在范围内才返回（code_item 按 4 字节对齐）；cdex 使用 GetCodeItemInfo
+            const CodeItem *GetCodeItem(uint32_t code_off) const {
+                if (compact_ || code_off == 0 || (code_off & 3) != 0) return nullptr;
+                const auto *item = reinterpret_cast<const CodeItem *>(DataPointer(code_off, kCodeItemHeaderSize));
+                if (item == nullptr) return nullptr;
+                uint64_t insns_bytes = static_cast<uint64_t>(item->insns_size_in_code_units_) * sizeof(uint16_t);
+                if (DataPointer(code_off, kCodeItemHeaderSize + insns_bytes) == nullptr) return nullptr;
+                return item;
+            }
+
+            // code_item 的完整长度（cdex 不含 preheader），格式错误返回 0
+            size_t GetCodeItemSize(uint32_t code_off) const {
+                if (code_off == 0 || code_off >= data_size_) return 0;
+                if (!compact_) {
+                    if ((code_off & 3) != 0) return 0;
+                    return ComputeCodeItemSize(data_begin_ + code_off, data_size_ - code_off);
+                }
+                CodeItemInfo info;
+                if (!GetCodeItemInfo(code_off, kDexNoIndex, &info)) return 0;
+                uint64_t insns_end = reinterpret_cast<const uint8_t *>(info.insns + info.insns_size) - (data_begin_ + code_off);
+                if (info.tries_size == 0) return static_cast<size_t>(insns_end);
+                return ComputeCodeItemTriesEnd(data_begin_ + code_off, data_size_ - code_off,
+                                               info.tries_off - code_off, info.tries_size);
+            }
+
+            /**
+             * 解码 code_item
+             *
+             * @param method_idx cdex 的 debug_info 不在 code_item 中，按 method_idx 查表；传 kDexNoIndex 时不查
+             */
+            bool GetCodeItemInfo(uint32_t code_off, uint32_t method_idx, CodeItemInfo *info) const {
+                if (!compact_) {
+                    const CodeItem *item = GetCodeItem(code_off);
+                    if (item == nullptr) return false;
+                    info->registers_size = item->registers_size_;
+                    info->ins_size = item->ins_size_;
+                    info->outs_size = item->outs_size_;
+                    info->tries_size = item->tries_size_;
+                    info->debug_info_off = item->debug_info_off_;
+                    info->insns_size = item->insns_size_in_code_units_;
+                    info->insns = item->insns_;
+                    info->tries_off = (code_off + kCodeItemHeaderSize + info->insns_size * 2 + 3) & ~3u;
+                    return true;
+                }
+
+                // cdex 的 code_item 按 2 字节对齐
+                if (code_off == 0 || (code_off & 1) != 0) return false;
+                const uint8_t *ptr = DataPointer(code_off, 2 * sizeof(uint16_t));
+                if (ptr == nullptr) return false;
+                uint16_t fields, insns_count_and_flags;
+                memcpy(&fields, ptr, sizeof(fields));
+                memcpy(&insns_count_and_flags, ptr + 2, sizeof(insns_count_and_flags));
+                uint32_t registers_size = (fields >> CompactCodeItem::kRegistersSizeShift) & 0xf;
+                uint32_t ins_size = (fields >> CompactCodeItem::kInsSizeShift) & 0xf;
+                uint32_t outs_size = (fields >> CompactCodeItem::kOutsSizeShift) & 0xf;
+                uint32_t tries_size = (fields >> CompactCodeItem::kTriesSizeSizeShift) & 0xf;
+                uint32_t insns_size = insns_count_and_flags >> CompactCodeItem::kInsnsSizeShift;
+
+                // 放不下的值按固定顺序存放在 code_item 之前的 preheader 中（向前增长）
+                uint16_t flags = insns_count_and_flags & CompactCodeItem::kFlagPreHeaderCombined;
+                if (flags != 0) {
+                    uint32_t preheader_pos = code_off;
+                    auto pop = [&](uint32_t *value) {
+                        if (preheader_pos < sizeof(uint16_t)) return false;
+                        preheader_pos -= sizeof(uint16_t);
+                        uint16_t unit;
+                        memcpy(&unit, data_begin_ + preheader_pos, sizeof(unit));
+                        *value = unit;
+                        return true;
+                    };
+                    uint32_t value;
+                    if (flags & CompactCodeItem::kFlagPreHeaderInsnsSize) {
+                        if (!pop(&value)) return false;
+                        insns_size += value;
+                        if (!pop(&value)) return false;
+                        insns_size += value << 16;
+                    }
+                    if (flags & CompactCodeItem::kFlagPreHeaderRegistersSize) {
+                        if (!pop(&value)) return false;
+                        registers_size += value;
+                    }
+                    if (flags & CompactCodeItem::kFlagPreHeaderInsSize) {
+                        if (!pop(&value)) return false;
+                        ins_size += value;
+                    }
+                    if (flags & CompactCodeItem::kFlagPreHeaderOutsSize) {
+                        if (!pop(&value)) return false;
+                        outs_size += value;
+                    }
+                    if (flags & CompactCodeItem::kFlagPreHeaderTriesSize) {
+                        if (!pop(&value)) return false;
+                        tries_size += value;
+                    }
+                }
+                if (DataPointer(code_off + 4ULL, static_cast<uint64_t>(insns_size) * sizeof(uint16_t)) == nullptr) {
+                    return false;
+                }
+
+                info->registers_size = static_cast<uint16_t>(registers_size + ins_size);
+                info->ins_size = static_cast<uint16_t>(ins_size);
+                info->outs_size = static_cast<uint16_t>(outs_size);
+                info->tries_size = static_cast<uint16_t>(tries_size);
+                info->debug_info_off = method_idx == kDexNoIndex ? 0 : GetCompactDebugInfoOffset(method_idx);
+                info->insns_size = insns_size;
+                info->insns = reinterpret_cast<const uint16_t *>(ptr + 4);
+                info->tries_off = static_cast<uint32_t>((code_off + 4ULL + insns_size * 2ULL + 3) & ~3ULL);
+                return true;
+            }
+
+            /**
+             * cdex 中方法的 debug_info 偏移（相对于数据区），没有返回 0
+             *
+             * 查找表每 16 个 method_idx 一块：块首是大端的 16 位掩码，之后是有 debug_info 的方法相对
+             * debug_info_base_ 依次累加的 ULEB128 差值。
+             */
+            uint32_t GetCompactDebugInfoOffset(uint32_t method_idx) const {
+                if (!compact_ || method_idx >= NumMethodIds()) return 0;
+                const auto *header = reinterpret_cast<const CompactDexHeader *>(header_);
+                uint64_t table_pos = header->debug_info_offsets_pos_;
+                const uint8_t *entry = DataPointer(table_pos + header->debug_info_offsets_table_offset_ +
+                                                   (method_idx / 16) * 4ULL, sizeof(uint32_t));
+                if (entry == nullptr) return 0;
+                uint32_t block_off;
+                memcpy(&block_off, entry, sizeof(block_off));
+                const uint8_t *block = DataPointer(table_pos + block_off, 2);
+                if (block == nullptr) return 0;
+
+                uint32_t bit_mask = (static_cast<uint32_t>(block[0]) << 8) | block[1];
+                uint32_t bit_index = method_idx % 16;
+                if ((bit_mask & (1u << bit_index)) == 0) return 0;
+                auto count = static_cast<uint32_t>(__builtin_popcount(bit_mask & ((2u << bit_index) - 1)));
+
+                const uint8_t *ptr = block + 2;
+                const uint8_t *end = data_begin_ + data_size_;
+                uint32_t offset = header->debug_info_base_;
+                uint32_t delta;
+                for (uint32_t i = 0; i < count; ++i) {
+                    if (!DecodeUnsignedLeb128Checked(&ptr, end, &delta)) return 0;
+                    offset += delta;
+                }
+                return offset;
+            }
+
+            const MapList *GetMapList() const {
+                uint32_t off = header_->map_off_;
+                const auto *map = reinterpret_cast<const MapList *>(DataPointer(off, sizeof(uint32_t)));
+                if (map == nullptr) return nullptr;
+                if (DataPointer(off, sizeof(uint32_t) + static_cast<uint64_t>(map->size_) * sizeof(MapItem)) == nullptr) {
+                    return nullptr;
+                }
+                return map;
+            }
+
+            // 数据区中 [off, off + size) 的地址，越界返回 nullptr
+            const uint8_t *DataPointer(uint64_t off, uint64_t size) const {
+                if (off > data_size_ || size > data_size_ - off) return nullptr;
+                return data_begin_ + off;
+            }
+
+            const uint8_t *DataBegin() const { return data_begin_; }
+
+            size_t DataSize() const { return data_size_; }
+
+            // 指针在数据区中的偏移
+            uint32_t OffsetOf(const void *ptr) const {
+                return static_cast<uint32_t>(static_cast<const uint8_t *>(ptr) - data_begin_);
+            }
+
+        private:
+            static bool SectionInRange(uint32_t off, uint32_t count, size_t elem_size, uint64_t min, uint64_t limit) {
+                if (count == 0) return true;
+                uint64_t end = static_cast<uint64_t>(off) + static_cast<uint64_t>(count) * elem_size;
+                return off >= min && end <= limit;
+            }
+
+            static uint32_t ParseVersion(const uint8_t *magic) {
+                const uint8_t *v = magic + 4;
+                return (v[0] - '0') * 100 + (v[1] - '0') * 10 + (v[2] - '0');
+            }
+
+            const uint8_t *begin_ = nullptr;
+            size_t size_ = 0;
+            const Header *header_ = nullptr;
+            // 大部分 dex 偏移（string data、code item、class data 等）相对于这里
+            const uint8_t *data_begin_ = nullptr;
+            size_t data_size_ = 0;
+            bool compact_ = false;
+            bool container_ = false;
+
+            const StringId *string_ids_ = nullptr;
+            const TypeId *type_ids_ = nullptr;
+            const ProtoId *proto_ids_ = nullptr;
+            const FieldId *field_ids_ = nullptr;
+            const MethodId *method_ids_ = nullptr;
+            const ClassDef *class_defs_ = nullptr;
+        };
+
+        /**
+         * mmap 一个 dex 文件并提供 DexReader
+         */
+        class MappedDexFile {
+        public:
+            MappedDexFile() = default;
+
+            ~MappedDexFile() { Close(); }
+
+            MappedDexFile(const MappedDexFile &) = delete;
+
+            MappedDexFile &operator=(const MappedDexFile &) = delete;
+
+            // writable 为 true 时使用 MAP_PRIVATE + PROT_WRITE（修改不会写回文件）
+            bool Open(const std::string &path, bool writable = false) {
+                Close();
+                int fd = open(path.c_str(), O_RDONLY | O_CLOEXEC);
+                if (fd < 0) return false;
+
+                struct stat st{};
+                if (fstat(fd, &st) != 0 || st.st_size <= 0) {
+                    close(fd);
+                    return false;
+                }
+
+                int prot = writable ? (PROT_READ | PROT_WRITE) : PROT_READ;
+                void *base = mmap(nullptr, static_cast<size_t>(st.st_size), prot, MAP_PRIVATE, fd, 0);
+                close(fd);
+                if (base == MAP_FAILED) return false;
+
+                base_ = static_cast<uint8_t *>(base);
+                size_ = static_cast<size_t>(st.st_size);
+                if (!reader_.Open(base_, size_)) {
+                    Close();
+                    return false;
+                }
+                return true;
+            }
+
+            void Close() {
+                if (base_ != nullptr) {
+                    munmap(base_, size_);
+                }
+                base_ = nullptr;
+                size_ = 0;
+                reader_ = DexReader();
+            }
+
+            const DexReader &reader() const { return reader_; }
+
+            uint8_t *data() const { return base_; }
+
+            size_t size() const { return size_; }
+
+        private:
+            uint8_t *base_ = nullptr;
+            size_t size_ = 0;
+            DexReader reader_;
+        };
+
+    } // namespace dex
+};//namespace cyurs
+
+#endif //CYURS_DEX_READER_H
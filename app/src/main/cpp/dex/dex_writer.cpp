@@ -0,0 +1,790 @@
+#include "dex_writer.h"
+
+#include <cstring>
+#include <string>
+#include <unordered_map>
+
+#include "class_accessor.h"
+
+namespace cyurs {
+    namespace dex {
+
+        // encoded_value 嵌套的最大深度，防止畸形数据递归过深
+        static constexpr int kMaxEncodedDepth = 64;
+
+        // encoded_value 的 value_type
+        enum EncodedValueType : uint8_t {
+            kEncodedByte = 0x00,
+            kEncodedShort = 0x02,
+            kEncodedChar = 0x03,
+            kEncodedInt = 0x04,
+            kEncodedLong = 0x06,
+            kEncodedFloat = 0x10,
+            kEncodedDouble = 0x11,
+            kEncodedMethodType = 0x15,
+            kEncodedMethodHandle = 0x16,
+            kEncodedString = 0x17,
+            kEncodedType = 0x18,
+            kEncodedField = 0x19,
+            kEncodedMethod = 0x1a,
+            kEncodedEnum = 0x1b,
+            kEncodedArray = 0x1c,
+            kEncodedAnnotation = 0x1d,
+            kEncodedNull = 0x1e,
+            kEncodedBoolean = 0x1f,
+        };
+
+        // debug_info_item 中的操作码
+        enum DebugInfoOpcode : uint8_t {
+            kDbgEndSequence = 0x00,
+            kDbgAdvancePc = 0x01,
+            kDbgAdvanceLine = 0x02,
+            kDbgStartLocal = 0x03,
+            kDbgStartLocalExtended = 0x04,
+            kDbgEndLocal = 0x05,
+            kDbgRestartLocal = 0x06,
+            kDbgSetPrologueEnd = 0x07,
+            kDbgSetEpilogueBegin = 0x08,
+            kDbgSetFile = 0x09,
+        };
+
+        static bool SkipUleb128(const uint8_t **data, const uint8_t *end, uint32_t count = 1) {
+            uint32_t value;
+            for (uint32_t i = 0; i < count; ++i) {
+                if (!DecodeUnsignedLeb128Checked(data, end, &value)) return false;
+            }
+            return true;
+        }
+
+        static bool SkipEncodedValue(const uint8_t **data, const uint8_t *end, int depth);
+
+        static bool SkipEncodedArray(const uint8_t **data, const uint8_t *end, int depth) {
+            uint32_t size;
+            if (depth > kMaxEncodedDepth || !DecodeUnsignedLeb128Checked(data, end, &size)) return false;
+            for (uint32_t i = 0; i < size; ++i) {
+                if (!SkipEncodedValue(data, end, depth + 1)) return false;
+            }
+            return true;
+        }
+
+        static bool SkipEncodedAnnotation(const uint8_t **data, const uint8_t *end, int depth) {
+            uint32_t type_idx, size;
+            if (depth > kMaxEncodedDepth ||
+                !DecodeUnsignedLeb128Checked(data, end, &type_idx) ||
+                !DecodeUnsignedLeb128Checked(data, end, &size)) {
+                return false;
+            }
+            for (uint32_t i = 0; i < size; ++i) {
+                // name_idx + value
+                if (!SkipUleb128(data, end) || !SkipEncodedValue(data, end, depth + 1)) return false;
+            }
+            return true;
+        }
+
+        static bool SkipEncodedValue(const uint8_t **data, const uint8_t *end, int depth) {
+            if (*data >= end) return false;
+            uint8_t header = *(*data)++;
+            uint32_t value_arg = header >> 5;
+            switch (static_cast<EncodedValueType>(header & 0x1f)) {
+                case kEncodedArray:
+                    return value_arg == 0 && SkipEncodedArray(data, end, depth);
+                case kEncodedAnnotation:
+                    return value_arg == 0 && SkipEncodedAnnotation(data, end, depth);
+                case kEncodedNull:
+                case kEncodedBoolean:
+                    return true;
+                case kEncodedByte:
+                case kEncodedShort:
+                case kEncodedChar:
+                case kEncodedInt:
+                case kEncodedLong:
+                case kEncodedFloat:
+                case kEncodedDouble:
+                case kEncodedMethodType:
+                case kEncodedMethodHandle:
+                case kEncodedString:
+                case kEncodedType:
+                case kEncodedField:
+                case kEncodedMethod:
+                case kEncodedEnum:
+                    // value_arg + 1 个字节的值
+                    if (static_cast<size_t>(end - *data) < value_arg + 1) return false;
+                    *data += value_arg + 1;
+                    return true;
+                default:
+                    return false;
+            }
+        }
+
+        static bool SkipDebugInfo(const uint8_t **data, const uint8_t *end) {
+            uint32_t parameters_size;
+            // line_start, parameters_size, parameter_names (uleb128p1)
+            if (!SkipUleb128(data, end) || !DecodeUnsignedLeb128Checked(data, end, &parameters_size) ||
+                !SkipUleb128(data, end, parameters_size)) {
+                return false;
+            }
+            int32_t line_diff;
+            while (*data < end) {
+                switch (*(*data)++) {
+                    case kDbgEndSequence:
+                        return true;
+                    case kDbgAdvanceLine:
+                        if (!DecodeSignedLeb128Checked(data, end, &line_diff)) return false;
+                        break;
+                    case kDbgStartLocal:
+                        // register_num, name_idx, type_idx
+                        if (!SkipUleb128(data, end, 3)) return false;
+                        break;
+                    case kDbgStartLocalExtended:
+                        // register_num, name_idx, type_idx, sig_idx
+                        if (!SkipUleb128(data, end, 4)) return false;
+                        break;
+                    case kDbgAdvancePc:
+                    case kDbgEndLocal:
+                    case kDbgRestartLocal:
+                    case kDbgSetFile:
+                        if (!SkipUleb128(data, end)) return false;
+                        break;
+                    default:
+                        // kDbgSetPrologueEnd、kDbgSetEpilogueBegin 和特殊操作码没有参数
+                        break;
+                }
+            }
+            return false;
+        }
+
+        static void AppendU4(std::vector<uint8_t> &out, uint32_t value) {
+            uint8_t bytes[sizeof(value)];
+            memcpy(bytes, &value, sizeof(value));
+            out.insert(out.end(), bytes, bytes + sizeof(value));
+        }
+
+        /**
+         * 一次重写过程
+         *
+         * 每个数据 section 在前一个写完之后整体追加，后面的 section 引用前面 section 的偏移时直接查表。
+         * 写出顺序：string_data -> type_list -> debug_info -> code_item -> annotation_item -> annotation_set_item
+         *          -> annotation_set_ref_list -> annotations_directory -> encoded_array -> class_data -> hiddenapi -> map_list
+         */
+        class DexRewriter {
+        public:
+            DexRewriter(const DexReader &reader, const DexWriterOptions &options,
+                        std::vector<uint8_t> &out, DexWriterStats &stats)
+                    : reader_(reader), options_(options), out_(out), stats_(stats) {}
+
+            bool Write() {
+                if (!reader_.IsValid()) return false;
+                out_.clear();
+                stats_ = DexWriterStats();
+                stats_.input_size = static_cast<uint32_t>(reader_.Size());
+
+                if (!FindExtraSections() || !LayoutIds()) return false;
+                if (!WriteStringData() || !WriteTypeLists() || !WriteCode() || !WriteAnnotations() ||
+                    !WriteEncodedArrays() || !WriteClassData() || !WriteHiddenapiClassData()) {
+                    return false;
+                }
+                if (!WriteIds()) return false;
+                WriteMapList();
+                WriteHeader();
+
+                stats_.output_size = static_cast<uint32_t>(out_.size());
+                for (const Section *section: data_sections_) {
+                    stats_.items += section->count;
+                }
+                stats_.dedup_strings = string_data_.deduped;
+                stats_.dedup_type_lists = type_lists_.deduped;
+                stats_.dedup_code_items = code_items_.deduped;
+                stats_.dedup_others = debug_info_.deduped + annotation_items_.deduped + annotation_sets_.deduped +
+                                      annotation_set_ref_lists_.deduped + annotations_directories_.deduped +
+                                      encoded_arrays_.deduped + class_data_.deduped;
+                return true;
+            }
+
+        private:
+            // 一个数据 section：源偏移 -> 新偏移，内容 -> 新偏移
+            struct Section {
+                Section(MapItemType type, uint32_t alignment) : type(type), alignment(alignment) {}
+
+                MapItemType type;
+                uint32_t alignment;
+                // 第一项的偏移
+                uint32_t offset = 0;
+                uint32_t count = 0;
+                uint32_t deduped = 0;
+                std::unordered_map<uint32_t, uint32_t> by_source;
+                std::unordered_map<std::string, uint32_t> by_content;
+            };
+
+            // 解析后的 annotations_directory_item
+            struct AnnotationsDirectory {
+                uint32_t source_off = 0;
+                uint32_t class_annotations_off = 0;
+                uint32_t fields_size = 0;
+                uint32_t methods_size = 0;
+                uint32_t parameters_size = 0;
+                // field、method、parameter 三段依次排列的 (idx, offset)
+                std::vector<std::pair<uint32_t, uint32_t>> entries;
+            };
+
+            bool ReadU4(uint32_t off, uint32_t *value) const {
+                const uint8_t *ptr = reader_.DataPointer(off, sizeof(uint32_t));
+                if (ptr == nullptr) return false;
+                memcpy(value, ptr, sizeof(uint32_t));
+                return true;
+            }
+
+            void WriteU4At(uint32_t pos, uint32_t value) {
+                memcpy(out_.data() + pos, &value, sizeof(value));
+            }
+
+            void Align(uint32_t alignment) {
+                while ((out_.size() & (alignment - 1)) != 0) out_.push_back(0);
+            }
+
+            /**
+             * 写入一项，返回新偏移
+             *
+             * 同一个源偏移只写一次；dedup 为 true 时内容相同的项也只写一次
+             */
+            uint32_t Emit(Section &section, uint32_t source_off, const uint8_t *bytes, size_t size, bool dedup = true) {
+                auto it = section.by_source.find(source_off);
+                if (it != section.by_source.end()) return it->second;
+
+                std::string key;
+                if (dedup) {
+                    key.assign(reinterpret_cast<const char *>(bytes), size);
+                    auto same = section.by_content.find(key);
+                    if (same != section.by_content.end()) {
+                        ++section.deduped;
+                        section.by_source.emplace(source_off, same->second);
+                        return same->second;
+                    }
+                }
+
+                Align(section.alignment);
+                auto off = static_cast<uint32_t>(out_.size());
+                if (section.count == 0) section.offset = off;
+                ++section.count;
+                out_.insert(out_.end(), bytes, bytes + size);
+                section.by_source.emplace(source_off, off);
+                if (dedup) section.by_content.emplace(std::move(key), off);
+                return off;
+            }
+
+            // 源偏移 -> 新偏移，0 表示没有，保持为 0；没有写出过返回 false
+            static bool Remap(const Section &section, uint32_t source_off, uint32_t *new_off) {
+                if (source_off == 0) {
+                    *new_off = 0;
+                    return true;
+                }
+                return Lookup(section, source_off, new_off);
+            }
+
+            // 不把 0 当作空偏移（cdex 数据区的第一项 string_data 偏移为 0）
+            static bool Lookup(const Section &section, uint32_t source_off, uint32_t *new_off) {
+                auto it = section.by_source.find(source_off);
+                if (it == section.by_source.end()) return false;
+                *new_off = it->second;
+                return true;
+            }
+
+            // 源 map_list 中才有的 id section（call_site_ids、method_handles）和 hiddenapi
+            bool FindExtraSections() {
+                const MapList *map = reader_.GetMapList();
+                if (map == nullptr) return false;
+                for (uint32_t i = 0; i < map->size_; ++i) {
+                    const MapItem &item = map->list_[i];
+                    switch (item.type_) {
+                        case kDexTypeCallSiteIdItem:
+                            call_site_ids_ = {item.offset_, item.size_};
+                            if (reader_.DataPointer(item.offset_, static_cast<uint64_t>(item.size_) * sizeof(uint32_t)) == nullptr) {
+                                return false;
+                            }
+                            break;
+                        case kDexTypeMethodHandleItem:
+                            method_handles_ = {item.offset_, item.size_};
+                            if (reader_.DataPointer(item.offset_, static_cast<uint64_t>(item.size_) * kMethodHandleItemSize) == nullptr) {
+                                return false;
+                            }
+                            break;
+                        case kDexTypeHiddenapiClassData:
+                            hiddenapi_off_ = item.offset_;
+                            break;
+                        default:
+                            break;
+                    }
+                }
+                return true;
+            }
+
+            // header 之后依次排列各个 id section
+            bool LayoutIds() {
+                const Header &header = reader_.GetHeader();
+                uint64_t pos = sizeof(Header);
+                auto place = [&](uint32_t count, size_t elem_size) {
+                    auto off = static_cast<uint32_t>(count == 0 ? 0 : pos);
+                    pos += static_cast<uint64_t>(count) * elem_size;
+                    return off;
+                };
+                string_ids_off_ = place(header.string_ids_size_, sizeof(StringId));
+                type_ids_off_ = place(header.type_ids_size_, sizeof(TypeId));
+                proto_ids_off_ = place(header.proto_ids_size_, sizeof(ProtoId));
+                field_ids_off_ = place(header.field_ids_size_, sizeof(FieldId));
+                method_ids_off_ = place(header.method_ids_size_, sizeof(MethodId));
+                class_defs_off_ = place(header.class_defs_size_, sizeof(ClassDef));
+                new_call_site_ids_off_ = place(call_site_ids_.second, sizeof(uint32_t));
+                new_method_handles_off_ = place(method_handles_.second, kMethodHandleItemSize);
+                if (pos > UINT32_MAX) return false;
+
+                data_off_ = static_cast<uint32_t>(pos);
+                out_.assign(data_off_, 0);
+                return true;
+            }
+
+            bool WriteStringData() {
+                const uint8_t *end = reader_.DataBegin() + reader_.DataSize();
+                for (uint32_t i = 0; i < reader_.NumStringIds(); ++i) {
+                    uint32_t off = reader_.GetStringId(i)->string_data_off_;
+                    std::string_view data = reader_.GetStringDataAt(off);
+                    if (data.data() == nullptr) return false;
+                    // utf16_size 的 ULEB128 + MUTF-8 + '\0'
+                    const uint8_t *begin = reader_.DataBegin() + off;
+                    auto size = static_cast<size_t>(reinterpret_cast<const uint8_t *>(data.data()) + data.size() + 1 - begin);
+                    if (begin + size > end) return false;
+                    Emit(string_data_, off, begin, size);
+                }
+                return true;
+            }
+
+            bool EmitTypeList(uint32_t off) {
+                if (off == 0) return true;
+                const TypeList *list = reader_.GetTypeList(off);
+                if (list == nullptr) return false;
+                Emit(type_lists_, off, reinterpret_cast<const uint8_t *>(list),
+                     sizeof(uint32_t) + static_cast<size_t>(list->size_) * sizeof(TypeItem));
+                return true;
+            }
+
+            bool WriteTypeLists() {
+                for (uint32_t i = 0; i < reader_.NumProtoIds(); ++i) {
+                    if (!EmitTypeList(reader_.GetProtoId(i)->parameters_off_)) return false;
+                }
+                for (uint32_t i = 0; i < reader_.NumClassDefs(); ++i) {
+                    if (!EmitTypeList(reader_.GetClassDef(i)->interfaces_off_)) return false;
+                }
+                return true;
+            }
+
+            // code_item 的源键：cdex 中同一个 code_item 可能被多个方法共用而 debug_info 属于方法，按 method_idx 区分
+            uint32_t CodeKey(const Method &method) const {
+                return reader_.IsCompactDex() ? method.GetIndex() + 1 : method.GetCodeItemOffset();
+            }
+
+            /**
+             * 先写全部 debug_info，再写 code_item（code_item 中引用 debug_info 的新偏移）
+             *
+             * code_item 统一按标准格式重新生成：cdex 的紧凑头部展开为 16 字节的头部，填充字节清零。
+             */
+            bool WriteCode() {
+                bool ok = true;
+                const uint8_t *end = reader_.DataBegin() + reader_.DataSize();
+                VisitAllMethods(reader_, [&](uint32_t, const Method &method) {
+                    if (!ok || method.GetCodeItemOffset() == 0) return;
+                    CodeItemInfo info;
+                    if (!reader_.GetCodeItemInfo(method.GetCodeItemOffset(), method.GetIndex(), &info)) {
+                        ok = false;
+                        return;
+                    }
+                    if (info.debug_info_off == 0) return;
+
+                    const uint8_t *begin = reader_.DataPointer(info.debug_info_off, 1);
+                    const uint8_t *ptr = begin;
+                    if (begin == nullptr || !SkipDebugInfo(&ptr, end)) {
+                        ok = false;
+                        return;
+                    }
+                    Emit(debug_info_, info.debug_info_off, begin, ptr - begin);
+                });
+                if (!ok) return false;
+
+                std::vector<uint8_t> item;
+                VisitAllMethods(reader_, [&](uint32_t, const Method &method) {
+                    uint32_t code_off = method.GetCodeItemOffset();
+                    if (!ok || code_off == 0) return;
+                    CodeItemInfo info;
+                    size_t size = reader_.GetCodeItemSize(code_off);
+                    if (size == 0 || !reader_.GetCodeItemInfo(code_off, method.GetIndex(), &info)) {
+                        ok = false;
+                        return;
+                    }
+
+                    CodeItem header{};
+                    header.registers_size_ = info.registers_size;
+                    header.ins_size_ = info.ins_size;
+                    header.outs_size_ = info.outs_size;
+                    header.tries_size_ = info.tries_size;
+                    header.insns_size_in_code_units_ = info.insns_size;
+                    if (!Remap(debug_info_, info.debug_info_off, &header.debug_info_off_)) {
+                        ok = false;
+                        return;
+                    }
+                    item.resize(kCodeItemHeaderSize);
+                    memcpy(item.data(), &header, kCodeItemHeaderSize);
+                    const auto *insns = reinterpret_cast<const uint8_t *>(info.insns);
+                    item.insert(item.end(), insns, insns + info.insns_size * sizeof(uint16_t));
+                    if (info.tries_size != 0) {
+                        // try_item[] + encoded_catch_handler_list 原样拷贝
+                        item.resize((item.size() + 3) & ~static_cast<size_t>(3), 0);
+                        item.insert(item.end(), reader_.DataBegin() + info.tries_off, reader_.DataBegin() + code_off + size);
+                    }
+                    Emit(code_items_, CodeKey(method), item.data(), item.size(), options_.dedup_code_items);
+                });
+                return ok;
+            }
+
+            bool ReadAnnotationsDirectory(uint32_t off, AnnotationsDirectory &dir) const {
+                dir.source_off = off;
+                if (!ReadU4(off, &dir.class_annotations_off) || !ReadU4(off + 4, &dir.fields_size) ||
+                    !ReadU4(off + 8, &dir.methods_size) || !ReadU4(off + 12, &dir.parameters_size)) {
+                    return false;
+                }
+                uint64_t count = static_cast<uint64_t>(dir.fields_size) + dir.methods_size + dir.parameters_size;
+                const uint8_t *ptr = reader_.DataPointer(off + 16ULL, count * 8);
+                if (ptr == nullptr) return false;
+                dir.entries.resize(static_cast<size_t>(count));
+                for (auto &entry: dir.entries) {
+                    memcpy(&entry.first, ptr, sizeof(uint32_t));
+                    memcpy(&entry.second, ptr + 4, sizeof(uint32_t));
+                    ptr += 8;
+                }
+                return true;
+            }
+
+            // annotation_set_item / annotation_set_ref_list：u4 size + u4 offset[size]
+            bool ReadOffsetList(uint32_t off, std::vector<uint32_t> &offsets) const {
+                uint32_t size;
+                if (!ReadU4(off, &size)) return false;
+                const uint8_t *ptr = reader_.DataPointer(off + 4ULL, static_cast<uint64_t>(size) * sizeof(uint32_t));
+                if (ptr == nullptr) return false;
+                offsets.resize(size);
+                if (size != 0) memcpy(offsets.data(), ptr, size * sizeof(uint32_t));
+                return true;
+            }
+
+            // 把 offsets 按 section 重新映射后写成一项
+            bool EmitOffsetList(Section &section, const Section &target, uint32_t source_off,
+                                const std::vector<uint32_t> &offsets, std::vector<uint8_t> &buffer) {
+                buffer.clear();
+                AppendU4(buffer, static_cast<uint32_t>(offsets.size()));
+                for (uint32_t off: offsets) {
+                    uint32_t new_off;
+                    if (!Remap(target, off, &new_off)) return false;
+                    AppendU4(buffer, new_off);
+                }
+                Emit(section, source_off, buffer.data(), buffer.size());
+                return true;
+            }
+
+            bool WriteAnnotations() {
+                // 按 class_defs 顺序收集注解目录，以及其中引用的 annotation_set / annotation_set_ref_list
+                std::vector<AnnotationsDirectory> directories;
+                std::unordered_map<uint32_t, bool> seen_directories;
+                std::vector<uint32_t> sets;
+                std::vector<uint32_t> ref_lists;
+                std::vector<uint32_t> offsets;
+                for (uint32_t i = 0; i < reader_.NumClassDefs(); ++i) {
+                    uint32_t off = reader_.GetClassDef(i)->annotations_off_;
+                    if (off == 0 || !seen_directories.emplace(off, true).second) continue;
+
+                    AnnotationsDirectory dir;
+                    if (!ReadAnnotationsDirectory(off, dir)) return false;
+                    if (dir.class_annotations_off != 0) sets.push_back(dir.class_annotations_off);
+                    size_t parameters_begin = dir.fields_size + dir.methods_size;
+                    for (size_t k = 0; k < dir.entries.size(); ++k) {
+                        uint32_t entry_off = dir.entries[k].second;
+                        if (entry_off == 0) continue;
+                        if (k < parameters_begin) {
+                            sets.push_back(entry_off);
+                            continue;
+                        }
+                        ref_lists.push_back(entry_off);
+                        if (!ReadOffsetList(entry_off, offsets)) return false;
+                        for (uint32_t set_off: offsets) {
+                            if (set_off != 0) sets.push_back(set_off);
+                        }
+                    }
+                    directories.push_back(std::move(dir));
+                }
+
+                // annotation_item：visibility + encoded_annotation
+                const uint8_t *end = reader_.DataBegin() + reader_.DataSize();
+                for (uint32_t set_off: sets) {
+                    if (!ReadOffsetList(set_off, offsets)) return false;
+                    for (uint32_t item_off: offsets) {
+                        const uint8_t *begin = reader_.DataPointer(item_off, 1);
+                        if (begin == nullptr) return false;
+                        const uint8_t *ptr = begin + 1;
+                        if (!SkipEncodedAnnotation(&ptr, end, 0)) return false;
+                        Emit(annotation_items_, item_off, begin, ptr - begin);
+                    }
+                }
+
+                std::vector<uint8_t> buffer;
+                for (uint32_t set_off: sets) {
+                    if (!ReadOffsetList(set_off, offsets) ||
+                        !EmitOffsetList(annotation_sets_, annotation_items_, set_off, offsets, buffer)) {
+                        return false;
+                    }
+                }
+                for (uint32_t ref_list_off: ref_lists) {
+                    if (!ReadOffsetList(ref_list_off, offsets) ||
+                        !EmitOffsetList(annotation_set_ref_lists_, annotation_sets_, ref_list_off, offsets, buffer)) {
+                        return false;
+                    }
+                }
+
+                for (const AnnotationsDirectory &dir: directories) {
+                    buffer.clear();
+                    uint32_t new_off;
+                    if (!Remap(annotation_sets_, dir.class_annotations_off, &new_off)) return false;
+                    AppendU4(buffer, new_off);
+                    AppendU4(buffer, dir.fields_size);
+                    AppendU4(buffer, dir.methods_size);
+                    AppendU4(buffer, dir.parameters_size);
+                    size_t parameters_begin = dir.fields_size + dir.methods_size;
+                    for (size_t k = 0; k < dir.entries.size(); ++k) {
+                        const Section &target = k < parameters_begin ? annotation_sets_ : annotation_set_ref_lists_;
+                        if (!Remap(target, dir.entries[k].second, &new_off)) return false;
+                        AppendU4(buffer, dir.entries[k].first);
+                        AppendU4(buffer, new_off);
+                    }
+                    Emit(annotations_directories_, dir.source_off, buffer.data(), buffer.size());
+                }
+                return true;
+            }
+
+            bool EmitEncodedArray(uint32_t off) {
+                if (off == 0) return true;
+                const uint8_t *begin = reader_.DataPointer(off, 1);
+                const uint8_t *ptr = begin;
+                if (begin == nullptr || !SkipEncodedArray(&ptr, reader_.DataBegin() + reader_.DataSize(), 0)) {
+                    return false;
+                }
+                Emit(encoded_arrays_, off, begin, ptr - begin);
+                return true;
+            }
+
+            // class_def 的 static_values 和 call_site_id 引用的 encoded_array_item
+            bool WriteEncodedArrays() {
+                for (uint32_t i = 0; i < reader_.NumClassDefs(); ++i) {
+                    if (!EmitEncodedArray(reader_.GetClassDef(i)->static_values_off_)) return false;
+                }
+                for (uint32_t i = 0; i < call_site_ids_.second; ++i) {
+                    uint32_t off;
+                    if (!ReadU4(call_site_ids_.first + i * sizeof(uint32_t), &off) || off == 0 ||
+                        !EmitEncodedArray(off)) {
+                        return false;
+                    }
+                }
+                return true;
+            }
+
+            // class_data 按新的 code_off 重新编码
+            bool WriteClassData() {
+                std::vector<uint8_t> buffer;
+                for (uint32_t i = 0; i < reader_.NumClassDefs(); ++i) {
+                    const ClassDef &class_def = *reader_.GetClassDef(i);
+                    if (class_def.class_data_off_ == 0) continue;
+                    ClassAccessor accessor(reader_, class_def);
+                    if (!accessor.HasClassData()) return false;
+
+                    bool remapped = true;
+                    buffer.clear();
+                    bool encoded = EncodeClassData(accessor, buffer, [&](const Method &method) {
+                        uint32_t new_off = 0;
+                        if (method.GetCodeItemOffset() != 0 && !Remap(code_items_, CodeKey(method), &new_off)) {
+                            remapped = false;
+                        }
+                        return new_off;
+                    });
+                    if (!encoded || !remapped) return false;
+                    Emit(class_data_, class_def.class_data_off_, buffer.data(), buffer.size());
+                }
+                return true;
+            }
+
+            // hiddenapi_class_data_item 中的偏移相对于自身，class_defs 顺序不变时可以原样拷贝
+            bool WriteHiddenapiClassData() {
+                if (hiddenapi_off_ == 0) return true;
+                uint32_t size;
+                if (!ReadU4(hiddenapi_off_, &size)) return false;
+                const uint8_t *begin = reader_.DataPointer(hiddenapi_off_, size);
+                if (begin == nullptr || size < sizeof(uint32_t)) return false;
+                Emit(hiddenapi_, hiddenapi_off_, begin, size, false);
+                return true;
+            }
+
+            bool WriteIds() {
+                const Header &header = reader_.GetHeader();
+                for (uint32_t i = 0; i < reader_.NumStringIds(); ++i) {
+                    uint32_t new_off;
+                    if (!Lookup(string_data_, reader_.GetStringId(i)->string_data_off_, &new_off)) return false;
+                    WriteU4At(string_ids_off_ + i * sizeof(StringId), new_off);
+                }
+
+                // type_ids、field_ids、method_ids 中没有偏移，原样拷贝
+                if (header.type_ids_size_ != 0) {
+                    memcpy(out_.data() + type_ids_off_, reader_.GetTypeId(0), header.type_ids_size_ * sizeof(TypeId));
+                }
+                if (header.field_ids_size_ != 0) {
+                    memcpy(out_.data() + field_ids_off_, reader_.GetFieldId(0), header.field_ids_size_ * sizeof(FieldId));
+                }
+                if (header.method_ids_size_ != 0) {
+                    memcpy(out_.data() + method_ids_off_, reader_.GetMethodId(0), header.method_ids_size_ * sizeof(MethodId));
+                }
+
+                for (uint32_t i = 0; i < reader_.NumProtoIds(); ++i) {
+                    ProtoId proto = *reader_.GetProtoId(i);
+                    if (!Remap(type_lists_, proto.parameters_off_, &proto.parameters_off_)) return false;
+                    memcpy(out_.data() + proto_ids_off_ + i * sizeof(ProtoId), &proto, sizeof(ProtoId));
+                }
+
+                for (uint32_t i = 0; i < reader_.NumClassDefs(); ++i) {
+                    ClassDef class_def = *reader_.GetClassDef(i);
+                    if (!Remap(type_lists_, class_def.interfaces_off_, &class_def.interfaces_off_) ||
+                        !Remap(annotations_directories_, class_def.annotations_off_, &class_def.annotations_off_) ||
+                        !Remap(class_data_, class_def.class_data_off_, &class_def.class_data_off_) ||
+                        !Remap(encoded_arrays_, class_def.static_values_off_, &class_def.static_values_off_)) {
+                        return false;
+                    }
+                    memcpy(out_.data() + class_defs_off_ + i * sizeof(ClassDef), &class_def, sizeof(ClassDef));
+                }
+
+                for (uint32_t i = 0; i < call_site_ids_.second; ++i) {
+                    uint32_t off, new_off;
+                    if (!ReadU4(call_site_ids_.first + i * sizeof(uint32_t), &off) ||
+                        !Remap(encoded_arrays_, off, &new_off)) {
+                        return false;
+                    }
+                    WriteU4At(new_call_site_ids_off_ + i * sizeof(uint32_t), new_off);
+                }
+                if (method_handles_.second != 0) {
+                    memcpy(out_.data() + new_method_handles_off_, reader_.DataBegin() + method_handles_.first,
+                           method_handles_.second * kMethodHandleItemSize);
+                }
+                return true;
+            }
+
+            // map_list 按偏移升序排列，放在文件末尾
+            void WriteMapList() {
+                const Header &header = reader_.GetHeader();
+                std::vector<MapItem> items;
+                auto add = [&](MapItemType type, uint32_t size, uint32_t offset) {
+                    if (size != 0) items.push_back(MapItem{type, 0, size, offset});
+                };
+                add(kDexTypeHeaderItem, 1, 0);
+                add(kDexTypeStringIdItem, header.string_ids_size_, string_ids_off_);
+                add(kDexTypeTypeIdItem, header.type_ids_size_, type_ids_off_);
+                add(kDexTypeProtoIdItem, header.proto_ids_size_, proto_ids_off_);
+                add(kDexTypeFieldIdItem, header.field_ids_size_, field_ids_off_);
+                add(kDexTypeMethodIdItem, header.method_ids_size_, method_ids_off_);
+                add(kDexTypeClassDefItem, header.class_defs_size_, class_defs_off_);
+                add(kDexTypeCallSiteIdItem, call_site_ids_.second, new_call_site_ids_off_);
+                add(kDexTypeMethodHandleItem, method_handles_.second, new_method_handles_off_);
+                for (const Section *section: data_sections_) {
+                    add(section->type, section->count, section->offset);
+                }
+
+                Align(sizeof(uint32_t));
+                map_off_ = static_cast<uint32_t>(out_.size());
+                items.push_back(MapItem{kDexTypeMapList, 0, 1, map_off_});
+                AppendU4(out_, static_cast<uint32_t>(items.size()));
+                const auto *bytes = reinterpret_cast<const uint8_t *>(items.data());
+                out_.insert(out_.end(), bytes, bytes + items.size() * sizeof(MapItem));
+            }
+
+            void WriteHeader() {
+                const Header &source = reader_.GetHeader();
+                Header header{};
+                // cdex 和 v41 容器中的 dex 写成独立的 039 标准 dex
+                if (reader_.IsStandaloneDex()) {
+                    memcpy(header.magic_, source.magic_, sizeof(header.magic_));
+                } else {
+                    memcpy(header.magic_, kStandardDexMagic, sizeof(header.magic_));
+                }
+                header.file_size_ = static_cast<uint32_t>(out_.size());
+                header.header_size_ = sizeof(Header);
+                header.endian_tag_ = kDexEndianConstant;
+                header.map_off_ = map_off_;
+                header.string_ids_size_ = source.string_ids_size_;
+                header.string_ids_off_ = string_ids_off_;
+                header.type_ids_size_ = source.type_ids_size_;
+                header.type_ids_off_ = type_ids_off_;
+                header.proto_ids_size_ = source.proto_ids_size_;
+                header.proto_ids_off_ = proto_ids_off_;
+                header.field_ids_size_ = source.field_ids_size_;
+                header.field_ids_off_ = field_ids_off_;
+                header.method_ids_size_ = source.method_ids_size_;
+                header.method_ids_off_ = method_ids_off_;
+                header.class_defs_size_ = source.class_defs_size_;
+                header.class_defs_off_ = class_defs_off_;
+                header.data_off_ = data_off_;
+                header.data_size_ = header.file_size_ - data_off_;
+                memcpy(out_.data(), &header, sizeof(Header));
+            }
+
+            static constexpr uint8_t kStandardDexMagic[8] = {'d', 'e', 'x', '\n', '0', '3', '9', '\0'};
+
+            // method_handle_item：u2 type + u2 unused + u2 field_or_method_id + u2 unused
+            static constexpr uint32_t kMethodHandleItemSize = 8;
+
+            const DexReader &reader_;
+            const DexWriterOptions &options_;
+            std::vector<uint8_t> &out_;
+            DexWriterStats &stats_;
+
+            // 源 dex 中的 (偏移, 个数)
+            std::pair<uint32_t, uint32_t> call_site_ids_{0, 0};
+            std::pair<uint32_t, uint32_t> method_handles_{0, 0};
+            uint32_t hiddenapi_off_ = 0;
+
+            // 新的 id section 偏移
+            uint32_t string_ids_off_ = 0;
+            uint32_t type_ids_off_ = 0;
+            uint32_t proto_ids_off_ = 0;
+            uint32_t field_ids_off_ = 0;
+            uint32_t method_ids_off_ = 0;
+            uint32_t class_defs_off_ = 0;
+            uint32_t new_call_site_ids_off_ = 0;
+            uint32_t new_method_handles_off_ = 0;
+            uint32_t data_off_ = 0;
+            uint32_t map_off_ = 0;
+
+            Section string_data_{kDexTypeStringDataItem, 1};
+            Section type_lists_{kDexTypeTypeList, 4};
+            Section debug_info_{kDexTypeDebugInfoItem, 1};
+            Section code_items_{kDexTypeCodeItem, 4};
+            Section annotation_items_{kDexTypeAnnotationItem, 1};
+            Section annotation_sets_{kDexTypeAnnotationSetItem, 4};
+            Section annotation_set_ref_lists_{kDexTypeAnnotationSetRefList, 4};
+            Section annotations_directories_{kDexTypeAnnotationsDirectoryItem, 4};
+            Section encoded_arrays_{kDexTypeEncodedArrayItem, 1};
+            Section class_data_{kDexTypeClassDataItem, 1};
+            Section hiddenapi_{kDexTypeHiddenapiClassData, 4};
+
+            // 写出顺序，也是 map_list 中的顺序
+            const Section *const data_sections_[11] = {
+                    &string_data_, &type_lists_, &debug_info_, &code_items_, &annotation_items_, &annotation_sets_,
+                    &annotation_set_ref_lists_, &annotations_directories_, &encoded_arrays_, &class_data_, &hiddenapi_,
+            };
+        };
+
+        bool RewriteDex(const DexReader &reader, const DexWriterOptions &options,
+                        std::vector<uint8_t> &out, DexWriterStats *stats) {
+            DexWriterStats local_stats;
+            DexRewriter rewriter(reader, options, out, stats != nullptr ? *stats : local_stats);
+            return rewriter.Write();
+        }
+
+    } // namespace dex
+};//namespace cyurs
@@ -0,0 +1,56 @@
+#ifndef CYURS_DEX_WRITER_H
+#define CYURS_DEX_WRITER_H
+
+#include <stdint.h>
+#include <vector>
+
+#include "dex_reader.h"
+
+/**
+ * dex 重写器：重新布局数据区，输出规范、去重且确定的 dex
+ *
+ * 1. header 之后连续写入 string_ids ~ class_defs、call_site_ids、method_handles，所有 id 的顺序和索引不变；
+ * 2. 数据区逐个 section 写入，section 内按 id 索引顺序中第一次被引用的先后排列，
+ *    没有被任何 id 引用的数据（修复后残留的旧 code_item、壳追加的垃圾数据等）不会写出；
+ * 3. 内容相同的 string_data / type_list / code_item / 注解等只保留一份，引用它们的偏移指向同一份；
+ * 4. 重新生成 map_list，header 中的 map_off_ / data_off_ / data_size_ / file_size_ 全部重新计算，link 清零。
+ *
+ * 输入可以是标准 dex、cdex 或 v41 容器中的 dex，后两者输出为独立的 039 标准 dex（code_item 展开为标准格式，
+ * cdex 按 method_idx 查表的 debug_info 写回 debug_info_off_），可以直接交给 jadx / baksmali。
+ *
+ * 输出只由输入 dex 的逻辑内容决定：同一个 dex 重写多次结果相同，重写的结果再重写也不变。
+ * checksum_ 和 signature_ 置 0，由调用方计算（dex_tools::fixup_dex_header）。
+ */
+namespace cyurs {
+    namespace dex {
+
+        struct DexWriterOptions {
+            // 内容相同的 code_item 只保留一份（多个方法共用同一个 code_off）
+            bool dedup_code_items = true;
+        };
+
+        struct DexWriterStats {
+            uint32_t input_size = 0;
+            uint32_t output_size = 0;
+            // 写出的数据项个数（不含 id）
+            uint32_t items = 0;
+            // 因内容相同被合并的个数
+            uint32_t dedup_strings = 0;
+            uint32_t dedup_type_lists = 0;
+            uint32_t dedup_code_items = 0;
+            // 注解、encoded_array、debug_info 等
+            uint32_t dedup_others = 0;
+        };
+
+        /**
+         * 重写 reader 中的 dex 到 out（out 原有内容被覆盖）
+         *
+         * @return dex 无效或数据区格式错误（偏移越界、code_item / class_data 被截断等）返回 false
+         */
+        bool RewriteDex(const DexReader &reader, const DexWriterOptions &options,
+                        std::vector<uint8_t> &out, DexWriterStats *stats = nullptr);
+
+    } // namespace dex
+};//namespace cyurs
+
+#endif //CYURS_DEX_WRITER_H
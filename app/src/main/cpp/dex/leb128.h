@@ -0,0 +1,261 @@
+#ifndef CYURS_LEB128_H
+#define CYURS_LEB128_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <cstring>
+#include <vector>
+
+#if defined(__aarch64__)
+#include <arm_neon.h>
+#elif defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+#if defined(__BMI2__)
+#include <immintrin.h>
+#endif
+
+namespace cyurs {
+    namespace dex {
+
+        // 逐字节读取 ULEB128（参考实现，用于基准对比），*data 指向下一个字节；最多读 5 个字节
+        inline uint32_t DecodeUnsignedLeb128Slow(const uint8_t **data) {
+            const uint8_t *ptr = *data;
+            uint32_t result = 0;
+            int shift = 0;
+            for (int i = 0; i < 5; ++i) {
+                uint8_t cur = *ptr++;
+                result |= static_cast<uint32_t>(cur & 0x7f) << shift;
+                if (cur <= 0x7f) break;
+                shift += 7;
+            }
+            *data = ptr;
+            return result;
+        }
+
+        /**
+         * 读取 ULEB128，*data 指向下一个字节
+         *
+         * 与 ART 相同的展开写法：1、2 字节的值（class_data 中绝大多数 idx 差值和 access_flags）
+         * 只走一两个可预测的分支，不进入循环。
+         */
+        inline uint32_t DecodeUnsignedLeb128(const uint8_t **data) {
+            const uint8_t *ptr = *data;
+            uint32_t result = *(ptr++);
+            if (result > 0x7f) {
+                uint32_t cur = *(ptr++);
+                result = (result & 0x7f) | ((cur & 0x7f) << 7);
+                if (cur > 0x7f) {
+                    cur = *(ptr++);
+                    result |= (cur & 0x7f) << 14;
+                    if (cur > 0x7f) {
+                        cur = *(ptr++);
+                        result |= (cur & 0x7f) << 21;
+                        if (cur > 0x7f) {
+                            // 第 5 个字节的高位不再检查
+                            cur = *(ptr++);
+                            result |= cur << 28;
+                        }
+                    }
+                }
+            }
+            *data = ptr;
+            return result;
+        }
+
+        // 带边界检查的 ULEB128，超出 end 返回 false
+        inline bool DecodeUnsignedLeb128Checked(const uint8_t **data, const uint8_t *end, uint32_t *out) {
+            const uint8_t *ptr = *data;
+            // 剩余字节足够一个最长的值时不需要逐字节检查
+            if (end - ptr >= 5) {
+                *out = DecodeUnsignedLeb128(data);
+                return true;
+            }
+
+            uint32_t result = 0;
+            int shift = 0;
+            while (ptr < end) {
+                uint8_t cur = *ptr++;
+                result |= static_cast<uint32_t>(cur & 0x7f) << shift;
+                if (cur <= 0x7f) {
+                    *data = ptr;
+                    *out = result;
+                    return true;
+                }
+                shift += 7;
+            }
+            return false;
+        }
+
+        /**
+         * 已知长度（1 ~ 5 字节）时，从小端读入的 8 字节中取出 ULEB128 的值，没有逐字节的分支
+         */
+        inline uint32_t ExtractUnsignedLeb128(uint64_t word, uint32_t len) {
+            uint64_t bytes = word & (~0ULL >> (64 - len * 8));
+#if defined(__BMI2__)
+            return static_cast<uint32_t>(_pext_u64(bytes, 0x0000007f7f7f7f7fULL));
+#else
+            return static_cast<uint32_t>((bytes & 0x7f) |
+                                         ((bytes >> 1) & (0x7fULL << 7)) |
+                                         ((bytes >> 2) & (0x7fULL << 14)) |
+                                         ((bytes >> 3) & (0x7fULL << 21)) |
+                                         ((bytes >> 4) & (0x0fULL << 28)));
+#endif
+        }
+
+        // 16 个字节的最高位组成的掩码，第 i 位对应 ptr[i]
+        inline uint32_t ContinuationMask16(const uint8_t *ptr) {
+#if defined(__aarch64__)
+            static const uint8_t kBitWeights[16] = {1, 2, 4, 8, 16, 32, 64, 128,
+                                                    1, 2, 4, 8, 16, 32, 64, 128};
+            uint8x16_t high = vtstq_u8(vld1q_u8(ptr), vdupq_n_u8(0x80));
+            uint8x16_t bits = vandq_u8(high, vld1q_u8(kBitWeights));
+            return vaddv_u8(vget_low_u8(bits)) | (static_cast<uint32_t>(vaddv_u8(vget_high_u8(bits))) << 8);
+#elif defined(__SSE2__)
+            return static_cast<uint32_t>(_mm_movemask_epi8(_mm_loadu_si128(reinterpret_cast<const __m128i *>(ptr))));
+#else
+            uint32_t mask = 0;
+            for (int i = 0; i < 16; ++i) {
+                mask |= static_cast<uint32_t>(ptr[i] >> 7) << i;
+            }
+            return mask;
+#endif
+        }
+
+        /**
+         * 批量读取 count 个连续的 ULEB128（如整个 class_data_item）
+         *
+         * 逐个解码时下一个值的位置依赖上一个值读出的字节，长度不规律时分支预测失败很多。
+         * 这里每次取 16 字节的最高位掩码，值的边界直接在掩码上用 ctz 算出，
+         * 每个值再用 ExtractUnsignedLeb128 无分支地取出；16 个字节都是单字节值时直接整体展开。
+         * 距离 end 不足一个块时退回 DecodeUnsignedLeb128Checked。
+         *
+         * @return 成功读取的个数，小于 count 表示数据被截断
+         */
+        inline size_t DecodeUnsignedLeb128Bulk(const uint8_t **data, const uint8_t *end, uint32_t *out, size_t count) {
+            const uint8_t *ptr = *data;
+            size_t i = 0;
+            // 块内最后一个值从第 15 字节开始时仍会读 8 字节
+            while (i < count && end - ptr >= 24) {
+                uint32_t terminators = ~ContinuationMask16(ptr) & 0xffff;
+
+                if (terminators == 0xffff && count - i >= 16) {
+                    for (int k = 0; k < 16; ++k) {
+                        out[i + k] = ptr[k];
+                    }
+                    ptr += 16;
+                    i += 16;
+                    continue;
+                }
+
+                uint32_t pos = 0;
+                while (i < count) {
+                    uint32_t rest = terminators >> pos;
+                    if (rest == 0) break;
+                    uint32_t len = static_cast<uint32_t>(__builtin_ctz(rest)) + 1;
+                    // 超过 5 字节的畸形值交给逐字节解码
+                    if (len > 5) break;
+                    uint64_t word;
+                    memcpy(&word, ptr + pos, sizeof(word));
+                    out[i++] = ExtractUnsignedLeb128(word, len);
+                    pos += len;
+                }
+
+                if (pos == 0) {
+                    // 块开头就是一个跨块或畸形的值
+                    DecodeUnsignedLeb128Checked(&ptr, end, &out[i++]);
+                }
+                ptr += pos;
+            }
+
+            while (i < count) {
+                if (!DecodeUnsignedLeb128Checked(&ptr, end, &out[i])) break;
+                ++i;
+            }
+            *data = ptr;
+            return i;
+        }
+
+        // 读取 SLEB128，1 字节的值走快速路径
+        inline int32_t DecodeSignedLeb128(const uint8_t **data) {
+            const uint8_t *ptr = *data;
+            uint8_t first = *ptr;
+            if (first <= 0x7f) {
+                *data = ptr + 1;
+                // 第 6 位是符号位
+                return static_cast<int32_t>(static_cast<uint32_t>(first) << 25) >> 25;
+            }
+
+            int32_t result = 0;
+            int shift = 0;
+            uint8_t cur;
+            do {
+                cur = *ptr++;
+                result |= static_cast<int32_t>(cur & 0x7f) << shift;
+                shift += 7;
+            } while (cur > 0x7f && shift < 35);
+            // 符号扩展
+            if (shift < 32 && (cur & 0x40) != 0) {
+                result |= -(1 << shift);
+            }
+            *data = ptr;
+            return result;
+        }
+
+        // 带边界检查的 SLEB128，超出 end 返回 false
+        inline bool DecodeSignedLeb128Checked(const uint8_t **data, const uint8_t *end, int32_t *out) {
+            const uint8_t *ptr = *data;
+            if (end - ptr >= 5) {
+                *out = DecodeSignedLeb128(data);
+                return true;
+            }
+
+            int32_t result = 0;
+            int shift = 0;
+            while (ptr < end) {
+                uint8_t cur = *ptr++;
+                result |= static_cast<int32_t>(cur & 0x7f) << shift;
+                shift += 7;
+                if (cur <= 0x7f) {
+                    if (shift < 32 && (cur & 0x40) != 0) {
+                        result |= -(1 << shift);
+                    }
+                    *data = ptr;
+                    *out = result;
+                    return true;
+                }
+            }
+            return false;
+        }
+
+        // ULEB128 编码后的字节数
+        inline uint32_t UnsignedLeb128Size(uint32_t value) {
+            uint32_t size = 1;
+            while (value >= 0x80) {
+                value >>= 7;
+                ++size;
+            }
+            return size;
+        }
+
+        // 写入 ULEB128，返回写入后的位置
+        inline uint8_t *EncodeUnsignedLeb128(uint8_t *dest, uint32_t value) {
+            while (value >= 0x80) {
+                *dest++ = static_cast<uint8_t>((value & 0x7f) | 0x80);
+                value >>= 7;
+            }
+            *dest++ = static_cast<uint8_t>(value);
+            return dest;
+        }
+
+        // 追加 ULEB128 到 dest 末尾
+        inline void EncodeUnsignedLeb128(std::vector<uint8_t> *dest, uint32_t value) {
+            uint8_t buf[5];
+            uint8_t *end = EncodeUnsignedLeb128(buf, value);
+            dest->insert(dest->end(), buf, end);
+        }
+
+    } // namespace dex
+};//namespace cyurs
+
+#endif //CYURS_LEB128_H
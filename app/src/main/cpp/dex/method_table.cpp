@@ -0,0 +1,72 @@
+#include "method_table.h"
+
+#include "class_accessor.h"
+
+namespace cyurs {
+    namespace dex {
+
+        std::shared_ptr<const MethodTable> MethodTable::Build(const DexReader &reader) {
+            if (!reader.IsValid()) return nullptr;
+
+            auto table = std::make_shared<MethodTable>();
+            table->checksum_ = reader.GetHeader().checksum_;
+            table->entries_.assign(reader.NumMethodIds(), MethodTableEntry{kNotDefined, 0, 0});
+
+            VisitAllMethods(reader, [&](uint32_t, const Method &method) {
+                uint32_t method_idx = method.GetIndex();
+                if (method_idx >= table->entries_.size()) return;
+                MethodTableEntry &entry = table->entries_[method_idx];
+                if (entry.code_off == kNotDefined) ++table->defined_count_;
+
+                entry.code_off = method.GetCodeItemOffset();
+                entry.access_flags = method.GetAccessFlags();
+                CodeItemInfo info;
+                entry.insns_size = reader.GetCodeItemInfo(entry.code_off, kDexNoIndex, &info) ? info.insns_size : 0;
+            });
+            return table;
+        }
+
+        MethodTableCache &MethodTableCache::instance() {
+            static MethodTableCache cache;
+            return cache;
+        }
+
+        const MethodTable *MethodTableCache::Get(const uint8_t *begin, size_t size) {
+            if (begin == nullptr || size < sizeof(Header)) return nullptr;
+            const auto *header = reinterpret_cast<const Header *>(begin);
+            uint64_t key = (static_cast<uint64_t>(header->checksum_) << 32) | header->file_size_;
+
+            // 同一线程连续加载同一个 dex 的方法
+            thread_local uint64_t last_key = 0;
+            thread_local const MethodTable *last_table = nullptr;
+            if (last_table != nullptr && last_key == key) return last_table;
+
+            {
+                std::lock_guard<std::mutex> lock(mutex_);
+                auto it = tables_.find(key);
+                if (it != tables_.end()) {
+                    last_key = key;
+                    last_table = it->second.get();
+                    return last_table;
+                }
+            }
+
+            // 在锁外构建，多个线程同时构建时只保留第一个
+            DexReader reader(begin, size);
+            std::shared_ptr<const MethodTable> table = MethodTable::Build(reader);
+            if (table == nullptr) return nullptr;
+
+            std::lock_guard<std::mutex> lock(mutex_);
+            auto result = tables_.emplace(key, std::move(table));
+            last_key = key;
+            last_table = result.first->second.get();
+            return last_table;
+        }
+
+        size_t MethodTableCache::size() {
+            std::lock_guard<std::mutex> lock(mutex_);
+            return tables_.size();
+        }
+
+    } // namespace dex
+};//namespace cyurs
@@ -0,0 +1,84 @@
+#ifndef CYURS_METHOD_TABLE_H
+#define CYURS_METHOD_TABLE_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+
+#include "dex_reader.h"
+
+/**
+ * method_idx -> code_item 查找表
+ *
+ * 对一个 dex 的 class_data 做一次线性遍历，生成以 method_idx 为下标的平坦数组，
+ * 之后 hook / dump 中按 method_idx 查 code_off、insns 长度和 access_flags 都是 O(1)。
+ * 同一个 dex（按 checksum + file_size 区分）只构建一次。
+ */
+namespace cyurs {
+    namespace dex {
+
+        struct MethodTableEntry {
+            // 不在本 dex 的 class_data 中定义（如只是引用的其他 dex 的方法）时为 kNotDefined
+            uint32_t code_off;
+            // code_item 的 insns 长度（code unit），没有 code_item 时为 0
+            uint32_t insns_size;
+            uint32_t access_flags;
+        };
+
+        class MethodTable {
+        public:
+            static constexpr uint32_t kNotDefined = 0xFFFFFFFF;
+
+            // 遍历全部 class_data 构建
+            static std::shared_ptr<const MethodTable> Build(const DexReader &reader);
+
+            // 未定义或越界返回 nullptr
+            const MethodTableEntry *Find(uint32_t method_idx) const {
+                if (method_idx >= entries_.size()) return nullptr;
+                const MethodTableEntry *entry = &entries_[method_idx];
+                return entry->code_off == kNotDefined ? nullptr : entry;
+            }
+
+            uint32_t checksum() const { return checksum_; }
+
+            // method_ids 个数
+            size_t size() const { return entries_.size(); }
+
+            // class_data 中定义的方法数
+            uint32_t defined_count() const { return defined_count_; }
+
+        private:
+            std::vector<MethodTableEntry> entries_;
+            uint32_t checksum_ = 0;
+            uint32_t defined_count_ = 0;
+        };
+
+        /**
+         * 进程内的 MethodTable 缓存
+         *
+         * 表构建后不会释放，返回的指针在进程生命周期内有效；
+         * 每个线程记住上一次命中的表，连续加载同一个 dex 的方法时不需要加锁。
+         */
+        class MethodTableCache {
+        public:
+            static MethodTableCache &instance();
+
+            // 按 dex 头的 checksum + file_size 查找，没有则构建；dex 无效返回 nullptr
+            const MethodTable *Get(const uint8_t *begin, size_t size);
+
+            size_t size();
+
+        private:
+            MethodTableCache() = default;
+
+            std::mutex mutex_;
+            std::unordered_map<uint64_t, std::shared_ptr<const MethodTable>> tables_;
+        };
+
+    } // namespace dex
+};//namespace cyurs
+
+#endif //CYURS_METHOD_TABLE_H
@@ -0,0 +1,163 @@
+#ifndef CYURS_MUTF8_H
+#define CYURS_MUTF8_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <string_view>
+#include <vector>
+
+#include "leb128.h"
+#include "dex_reader.h"
+
+/**
+ * MUTF-8 -> UTF-16 解码（dex 的 string_data_item）
+ *
+ * MUTF-8 与 UTF-8 的区别：'\0' 编码为 C0 80；补充平面字符编码为两个 3 字节的代理项（CESU-8），
+ * 逐个 3 字节序列解码就得到正确的代理对。dex 039 之后也可能出现 4 字节的标准 UTF-8 序列，解码为代理对。
+ *
+ * 每 16 字节用最高位掩码判断是否全是 ASCII，是则直接展开为 16 个 UTF-16；
+ * 否则 ASCII 前缀逐字节拷贝，多字节字符逐个解码后再回到 16 字节的快速路径。
+ * 与 ART 一样不校验编码：截断或非法的前导字节按单字节原样输出，输出的 UTF-16 个数不超过输入字节数。
+ */
+namespace cyurs {
+    namespace dex {
+
+        // 16 个 ASCII 字节展开为 16 个 UTF-16
+        inline void WidenAscii16(const uint8_t *in, uint16_t *out) {
+#if defined(__aarch64__)
+            uint8x16_t bytes = vld1q_u8(in);
+            vst1q_u16(out, vmovl_u8(vget_low_u8(bytes)));
+            vst1q_u16(out + 8, vmovl_u8(vget_high_u8(bytes)));
+#elif defined(__SSE2__)
+            __m128i bytes = _mm_loadu_si128(reinterpret_cast<const __m128i *>(in));
+            __m128i zero = _mm_setzero_si128();
+            _mm_storeu_si128(reinterpret_cast<__m128i *>(out), _mm_unpacklo_epi8(bytes, zero));
+            _mm_storeu_si128(reinterpret_cast<__m128i *>(out + 8), _mm_unpackhi_epi8(bytes, zero));
+#else
+            for (int i = 0; i < 16; ++i) out[i] = in[i];
+#endif
+        }
+
+        /**
+         * 解码 ptr 处的一个多字节字符（ptr[0] >= 0x80）
+         *
+         * @return 读取的字节数
+         */
+        inline size_t DecodeMutf8Char(const uint8_t *ptr, const uint8_t *end, uint16_t *&out) {
+            uint8_t c = ptr[0];
+            size_t available = end - ptr;
+            if ((c & 0xE0) == 0xC0 && available >= 2) {
+                // C0 80 解码为 '\0'
+                *out++ = static_cast<uint16_t>(((c & 0x1F) << 6) | (ptr[1] & 0x3F));
+                return 2;
+            }
+            if ((c & 0xF0) == 0xE0 && available >= 3) {
+                // 代理项按普通字符输出，两个相邻的 3 字节序列组成代理对
+                *out++ = static_cast<uint16_t>(((c & 0x0F) << 12) | ((ptr[1] & 0x3F) << 6) | (ptr[2] & 0x3F));
+                return 3;
+            }
+            if ((c & 0xF8) == 0xF0 && available >= 4) {
+                uint32_t code_point = ((c & 0x07) << 18) | ((ptr[1] & 0x3F) << 12) |
+                                      ((ptr[2] & 0x3F) << 6) | (ptr[3] & 0x3F);
+                code_point -= 0x10000;
+                *out++ = static_cast<uint16_t>(0xD800 | ((code_point >> 10) & 0x3FF));
+                *out++ = static_cast<uint16_t>(0xDC00 | (code_point & 0x3FF));
+                return 4;
+            }
+            *out++ = c;
+            return 1;
+        }
+
+        /**
+         * MUTF-8 解码为 UTF-16
+         *
+         * @param out 至少 size 个 uint16_t
+         * @return 写入的 UTF-16 个数
+         */
+        inline size_t DecodeMutf8(const char *data, size_t size, uint16_t *out) {
+            const auto *ptr = reinterpret_cast<const uint8_t *>(data);
+            const uint8_t *end = ptr + size;
+            uint16_t *out_begin = out;
+            while (ptr < end) {
+                if (end - ptr >= 16) {
+                    uint32_t mask = ContinuationMask16(ptr);
+                    if (mask == 0) {
+                        WidenAscii16(ptr, out);
+                        ptr += 16;
+                        out += 16;
+                        continue;
+                    }
+                    // ASCII 前缀
+                    for (int n = __builtin_ctz(mask); n > 0; --n) *out++ = *ptr++;
+                } else {
+                    while (ptr < end && *ptr < 0x80) *out++ = *ptr++;
+                    if (ptr == end) break;
+                }
+                ptr += DecodeMutf8Char(ptr, end, out);
+            }
+            return out - out_begin;
+        }
+
+        inline size_t DecodeMutf8(std::string_view mutf8, uint16_t *out) {
+            return DecodeMutf8(mutf8.data(), mutf8.size(), out);
+        }
+
+        inline std::vector<uint16_t> DecodeMutf8(std::string_view mutf8) {
+            std::vector<uint16_t> utf16(mutf8.size());
+            utf16.resize(DecodeMutf8(mutf8, utf16.data()));
+            return utf16;
+        }
+
+        /**
+         * 一段 string_ids 解码后的结果，全部字符在同一块缓冲区中
+         *
+         * 第 i 个字符串为 chars[offsets[i], offsets[i + 1])
+         */
+        struct DecodedStrings {
+            std::vector<uint16_t> chars;
+            std::vector<uint32_t> offsets;
+
+            size_t size() const { return offsets.empty() ? 0 : offsets.size() - 1; }
+
+            const uint16_t *data(size_t i) const { return chars.data() + offsets[i]; }
+
+            size_t length(size_t i) const { return offsets[i + 1] - offsets[i]; }
+        };
+
+        /**
+         * 批量解码 string_ids[begin, begin + count)，超出 string_ids 的部分忽略，格式错误的字符串为空串
+         *
+         * 先累计全部 MUTF-8 的字节数一次分配缓冲区，再逐个解码到缓冲区中。
+         *
+         * @return 解码的字符串个数
+         */
+        inline uint32_t DecodeStringIds(const DexReader &reader, uint32_t begin, uint32_t count, DecodedStrings &out) {
+            out.chars.clear();
+            out.offsets.clear();
+            uint32_t num_strings = reader.IsValid() ? reader.NumStringIds() : 0;
+            if (begin >= num_strings) return 0;
+            if (count > num_strings - begin) count = num_strings - begin;
+
+            std::vector<std::string_view> strings(count);
+            size_t total = 0;
+            for (uint32_t i = 0; i < count; ++i) {
+                strings[i] = reader.GetStringData(begin + i);
+                total += strings[i].size();
+            }
+
+            out.chars.resize(total);
+            out.offsets.resize(count + 1);
+            size_t pos = 0;
+            for (uint32_t i = 0; i < count; ++i) {
+                out.offsets[i] = static_cast<uint32_t>(pos);
+                pos += DecodeMutf8(strings[i], out.chars.data() + pos);
+            }
+            out.offsets[count] = static_cast<uint32_t>(pos);
+            out.chars.resize(pos);
+            return count;
+        }
+
+    } // namespace dex
+};//namespace cyurs
+
+#endif //CYURS_MUTF8_H
@@ -0,0 +1,215 @@
+#include "name_index.h"
+
+#include <cstdio>
+#include <cstring>
+
+namespace cyurs {
+    namespace dex {
+
+        static constexpr uint32_t kFnvOffset = 2166136261u;
+        static constexpr uint32_t kFnvPrime = 16777619u;
+
+        static uint32_t Fnv1a(uint32_t hash, std::string_view data) {
+            for (char c: data) {
+                hash ^= static_cast<uint8_t>(c);
+                hash *= kFnvPrime;
+            }
+            return hash;
+        }
+
+        // 同名重载的哈希相同，签名在探测时比较
+        static uint32_t HashKey(std::string_view class_descriptor, std::string_view name) {
+            uint32_t hash = Fnv1a(kFnvOffset, class_descriptor);
+            hash = (hash ^ 0xFFu) * kFnvPrime;
+            return Fnv1a(hash, name);
+        }
+
+        // 不小于 2 * count 的 2 的幂
+        static uint32_t CapacityFor(uint32_t count) {
+            uint32_t capacity = 16;
+            while (capacity < 2ULL * count) capacity <<= 1;
+            return capacity;
+        }
+
+        uint32_t MethodNameIndex::HashOf(uint32_t method_idx) const {
+            return HashKey(reader_.GetMethodDeclaringClassDescriptor(method_idx), reader_.GetMethodName(method_idx));
+        }
+
+        void MethodNameIndex::EnsureBuilt() const {
+            if (built_.load(std::memory_order_acquire)) return;
+            std::lock_guard<std::mutex> lock(mutex_);
+            if (built_.load(std::memory_order_relaxed)) return;
+            BuildLocked();
+            built_.store(true, std::memory_order_release);
+        }
+
+        void MethodNameIndex::BuildLocked() const {
+            slots_.clear();
+            mask_ = 0;
+            if (!reader_.IsValid()) return;
+
+            uint32_t count = reader_.NumMethodIds();
+            slots_.assign(CapacityFor(count), kEmptySlot);
+            mask_ = static_cast<uint32_t>(slots_.size() - 1);
+            for (uint32_t method_idx = 0; method_idx < count; ++method_idx) {
+                uint32_t slot = HashOf(method_idx) & mask_;
+                while (slots_[slot] != kEmptySlot) slot = (slot + 1) & mask_;
+                slots_[slot] = method_idx;
+            }
+        }
+
+        bool MethodNameIndex::Matches(uint32_t method_idx, std::string_view class_descriptor,
+                                      std::string_view name) const {
+            return reader_.GetMethodName(method_idx) == name &&
+                   reader_.GetMethodDeclaringClassDescriptor(method_idx) == class_descriptor;
+        }
+
+        bool MethodNameIndex::SignatureMatches(uint32_t method_idx, std::string_view signature) const {
+            const MethodId *method_id = reader_.GetMethodId(method_idx);
+            const ProtoId *proto = method_id == nullptr ? nullptr : reader_.GetProtoId(method_id->proto_idx_);
+            if (proto == nullptr || signature.empty() || signature[0] != '(') return false;
+
+            // 逐段比较 "(" + 参数描述符 + ")" + 返回类型，不拼接字符串
+            size_t pos = 1;
+            const TypeList *params = reader_.GetProtoParameters(*proto);
+            uint32_t num_params = params == nullptr ? 0 : params->size_;
+            for (uint32_t i = 0; i < num_params; ++i) {
+                std::string_view type = reader_.GetTypeDescriptor(params->list_[i].type_idx_);
+                if (type.empty() || signature.compare(pos, type.size(), type) != 0) return false;
+                pos += type.size();
+            }
+            if (pos >= signature.size() || signature[pos] != ')') return false;
+            return signature.substr(pos + 1) == reader_.GetTypeDescriptor(proto->return_type_idx_);
+        }
+
+        template<typename Visitor>
+        void MethodNameIndex::Probe(std::string_view class_descriptor, std::string_view name,
+                                    std::string_view signature, Visitor &&visitor) const {
+            EnsureBuilt();
+            if (slots_.empty()) return;
+
+            uint32_t slot = HashKey(class_descriptor, name) & mask_;
+            // 负载不超过 1/2，探测链一定以空槽结束
+            for (uint32_t method_idx; (method_idx = slots_[slot]) != kEmptySlot; slot = (slot + 1) & mask_) {
+                if (!Matches(method_idx, class_descriptor, name)) continue;
+                if (!signature.empty() && !SignatureMatches(method_idx, signature)) continue;
+                if (!visitor(method_idx)) return;
+            }
+        }
+
+        uint32_t MethodNameIndex::Find(std::string_view class_descriptor, std::string_view name,
+                                       std::string_view signature) const {
+            // 同一探测链上 method_idx 不一定有序，取最小的保证结果确定
+            uint32_t result = kDexNoIndex;
+            Probe(class_descriptor, name, signature, [&](uint32_t method_idx) {
+                if (method_idx < result) result = method_idx;
+                return true;
+            });
+            return result;
+        }
+
+        size_t MethodNameIndex::FindAll(std::string_view class_descriptor, std::string_view name,
+                                        std::string_view signature, std::vector<uint32_t> &out) const {
+            size_t old_size = out.size();
+            Probe(class_descriptor, name, signature, [&](uint32_t method_idx) {
+                out.push_back(method_idx);
+                return true;
+            });
+            return out.size() - old_size;
+        }
+
+        uint32_t MethodNameIndex::FindSymbol(std::string_view symbol) const {
+            std::string_view signature;
+            size_t paren = symbol.find('(');
+            if (paren != std::string_view::npos) {
+                signature = symbol.substr(paren);
+                symbol = symbol.substr(0, paren);
+            }
+
+            // smali 格式：Lcom/foo/Bar;->name
+            size_t arrow = symbol.find("->");
+            if (arrow != std::string_view::npos) {
+                return Find(symbol.substr(0, arrow), symbol.substr(arrow + 2), signature);
+            }
+
+            // Java 格式：com.foo.Bar.name，内部类用 $
+            size_t dot = symbol.rfind('.');
+            if (dot == std::string_view::npos || dot == 0 || dot + 1 == symbol.size()) return kDexNoIndex;
+            std::string descriptor;
+            descriptor.reserve(dot + 2);
+            descriptor.push_back('L');
+            for (char c: symbol.substr(0, dot)) descriptor.push_back(c == '.' ? '/' : c);
+            descriptor.push_back(';');
+            return Find(descriptor, symbol.substr(dot + 1), signature);
+        }
+
+        bool MethodNameIndex::Save(const std::string &path) const {
+            EnsureBuilt();
+            if (slots_.empty()) return false;
+
+            NameIndexFileHeader header{};
+            memcpy(header.magic_, kNameIndexMagic, sizeof(header.magic_));
+            header.version_ = kNameIndexVersion;
+            header.dex_checksum_ = reader_.GetHeader().checksum_;
+            header.dex_file_size_ = reader_.GetHeader().file_size_;
+            header.method_ids_size_ = reader_.NumMethodIds();
+            header.capacity_ = static_cast<uint32_t>(slots_.size());
+
+            // 先写临时文件再 rename，避免并发读到写了一半的索引
+            std::string tmp_path = path + ".tmp";
+            FILE *fp = fopen(tmp_path.c_str(), "wb");
+            if (fp == nullptr) return false;
+            bool ok = fwrite(&header, sizeof(header), 1, fp) == 1 &&
+                      fwrite(slots_.data(), sizeof(uint32_t), slots_.size(), fp) == slots_.size();
+            ok = fclose(fp) == 0 && ok;
+            if (!ok || rename(tmp_path.c_str(), path.c_str()) != 0) {
+                remove(tmp_path.c_str());
+                return false;
+            }
+            return true;
+        }
+
+        bool MethodNameIndex::Load(const std::string &path) {
+            if (!reader_.IsValid()) return false;
+
+            FILE *fp = fopen(path.c_str(), "rb");
+            if (fp == nullptr) return false;
+
+            NameIndexFileHeader header{};
+            uint32_t count = reader_.NumMethodIds();
+            bool ok = fread(&header, sizeof(header), 1, fp) == 1 &&
+                      memcmp(header.magic_, kNameIndexMagic, sizeof(header.magic_)) == 0 &&
+                      header.version_ == kNameIndexVersion &&
+                      header.dex_checksum_ == reader_.GetHeader().checksum_ &&
+                      header.dex_file_size_ == reader_.GetHeader().file_size_ &&
+                      header.method_ids_size_ == count &&
+                      header.capacity_ == CapacityFor(count);
+
+            std::vector<uint32_t> slots;
+            if (ok) {
+                slots.resize(header.capacity_);
+                ok = fread(slots.data(), sizeof(uint32_t), slots.size(), fp) == slots.size();
+            }
+            fclose(fp);
+            if (!ok) return false;
+
+            // 每个 method_idx 恰好出现一次
+            std::vector<bool> seen(count, false);
+            uint32_t used = 0;
+            for (uint32_t method_idx: slots) {
+                if (method_idx == kEmptySlot) continue;
+                if (method_idx >= count || seen[method_idx]) return false;
+                seen[method_idx] = true;
+                ++used;
+            }
+            if (used != count) return false;
+
+            std::lock_guard<std::mutex> lock(mutex_);
+            slots_ = std::move(slots);
+            mask_ = static_cast<uint32_t>(slots_.size() - 1);
+            built_.store(true, std::memory_order_release);
+            return true;
+        }
+
+    } // namespace dex
+};//namespace cyurs
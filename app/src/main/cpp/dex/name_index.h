@@ -0,0 +1,114 @@
+#ifndef CYURS_NAME_INDEX_H
+#define CYURS_NAME_INDEX_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <atomic>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "dex_reader.h"
+
+/**
+ * (类描述符, 方法名, 签名) -> method_idx 的哈希索引
+ *
+ * 以 (类描述符, 方法名) 的哈希做开放寻址（线性探测），槽中只存 u32 的 method_idx，
+ * 同名重载落在同一条探测链上，查找时再比较签名。容量为 2 的幂、负载不超过 1/2。
+ * 索引在第一次查找时构建，也可以持久化到 .nidx 文件，下次直接加载（按 dex 的 checksum + file_size 校验）。
+ *
+ *   MethodNameIndex index(reader);
+ *   uint32_t idx = index.FindSymbol("Lcom/cyrus/example/plugin/PluginClass;->getString()Ljava/lang/String;");
+ */
+namespace cyurs {
+    namespace dex {
+
+        // .nidx 文件头，之后是 capacity_ 个 u32 槽
+        struct NameIndexFileHeader {
+            uint8_t magic_[4];
+            uint32_t version_;
+            uint32_t dex_checksum_;
+            uint32_t dex_file_size_;
+            uint32_t method_ids_size_;
+            uint32_t capacity_;
+        };
+
+        constexpr char kNameIndexMagic[4] = {'N', 'I', 'D', 'X'};
+        constexpr uint32_t kNameIndexVersion = 1;
+
+        class MethodNameIndex {
+        public:
+            static constexpr uint32_t kEmptySlot = 0xFFFFFFFF;
+
+            explicit MethodNameIndex(const DexReader &reader) : reader_(reader) {}
+
+            MethodNameIndex(const MethodNameIndex &) = delete;
+
+            MethodNameIndex &operator=(const MethodNameIndex &) = delete;
+
+            /**
+             * 查找方法
+             *
+             * @param class_descriptor 如 Ljava/lang/String;
+             * @param signature 如 (ILjava/lang/String;)V，为空时返回第一个重载
+             * @return 找不到返回 kDexNoIndex
+             */
+            uint32_t Find(std::string_view class_descriptor, std::string_view name,
+                          std::string_view signature = {}) const;
+
+            // 全部匹配的 method_idx（signature 为空时是全部重载），返回个数
+            size_t FindAll(std::string_view class_descriptor, std::string_view name,
+                           std::string_view signature, std::vector<uint32_t> &out) const;
+
+            /**
+             * 按符号查找，支持：
+             *   Lcom/foo/Bar;->name(I)V    smali 格式
+             *   com.foo.Bar.name(I)V       Java 类名 + dex 签名
+             *   Lcom/foo/Bar;->name / com.foo.Bar.name    不带签名时返回第一个重载
+             */
+            uint32_t FindSymbol(std::string_view symbol) const;
+
+            // 立即构建（默认在第一次查找时构建）
+            void Build() const { EnsureBuilt(); }
+
+            // 写入 .nidx 文件
+            bool Save(const std::string &path) const;
+
+            // 加载 .nidx 文件，与当前 dex 不匹配或格式错误返回 false（之后查找时重新构建）
+            bool Load(const std::string &path);
+
+            const DexReader &reader() const { return reader_; }
+
+            // 槽的个数（构建后）
+            size_t capacity() const { return slots_.size(); }
+
+        private:
+            void EnsureBuilt() const;
+
+            void BuildLocked() const;
+
+            uint32_t HashOf(uint32_t method_idx) const;
+
+            // method_ids[method_idx] 的类和方法名是否为 (class_descriptor, name)
+            bool Matches(uint32_t method_idx, std::string_view class_descriptor, std::string_view name) const;
+
+            // 方法的原型是否为 signature
+            bool SignatureMatches(uint32_t method_idx, std::string_view signature) const;
+
+            // visitor: bool(uint32_t method_idx)，返回 false 停止
+            template<typename Visitor>
+            void Probe(std::string_view class_descriptor, std::string_view name,
+                       std::string_view signature, Visitor &&visitor) const;
+
+            const DexReader reader_;
+            mutable std::mutex mutex_;
+            mutable std::atomic<bool> built_{false};
+            mutable std::vector<uint32_t> slots_;
+            mutable uint32_t mask_ = 0;
+        };
+
+    } // namespace dex
+};//namespace cyurs
+
+#endif //CYURS_NAME_INDEX_H
@@ -0,0 +1,307 @@
+#include "dex_checksum.h"
+
+#include <cstddef>
+#include <cstring>
+
+#include "../dex/dex_file.h"
+
+#if defined(__aarch64__)
+#include <arm_neon.h>
+#include <sys/auxv.h>
+#include <asm/hwcap.h>
+#elif defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#endif
+
+namespace cyurs {
+    namespace dex_tools {
+
+        // 比 65536 小的最大素数
+        static constexpr uint32_t kAdlerBase = 65521;
+        // s2 在 32 位内不溢出时一次最多累加的字节数
+        static constexpr size_t kAdlerNmax = 5552;
+        // SIMD 每轮处理的字节数
+        static constexpr size_t kAdlerChunk = 32;
+
+        static uint32_t adler32_scalar(uint32_t adler, const uint8_t *data, size_t size) {
+            uint32_t s1 = adler & 0xffff;
+            uint32_t s2 = adler >> 16;
+            while (size > 0) {
+                size_t n = size < kAdlerNmax ? size : kAdlerNmax;
+                size -= n;
+                while (n >= 8) {
+                    s1 += data[0];
+                    s2 += s1;
+                    s1 += data[1];
+                    s2 += s1;
+                    s1 += data[2];
+                    s2 += s1;
+                    s1 += data[3];
+                    s2 += s1;
+                    s1 += data[4];
+                    s2 += s1;
+                    s1 += data[5];
+                    s2 += s1;
+                    s1 += data[6];
+                    s2 += s1;
+                    s1 += data[7];
+                    s2 += s1;
+                    data += 8;
+                    n -= 8;
+                }
+                while (n-- > 0) {
+                    s1 += *data++;
+                    s2 += s1;
+                }
+                s1 %= kAdlerBase;
+                s2 %= kAdlerBase;
+            }
+            return (s2 << 16) | s1;
+        }
+
+        /**
+         * 一个块 n = 32 * C 字节：
+         *   s1' = s1 + Σb
+         *   s2' = s2 + n * s1 + 32 * Σ_c(前 c 个 32 字节的和) + Σ_c Σ_j (32 - j) * b[c][j]
+         * 向量中分别累加：字节和 v_s1、每轮之前的 v_s1 之和 v_ps、带权和 v_s2。
+         * 块长度不超过 kAdlerNmax，各通道不会溢出。
+         */
+        static inline void adler32_block_finish(uint32_t &s1, uint32_t &s2, size_t n,
+                                                uint64_t sum, uint64_t prefix_sum, uint64_t weighted_sum) {
+            uint64_t new_s2 = s2 + static_cast<uint64_t>(n) * s1 + prefix_sum * kAdlerChunk + weighted_sum;
+            s1 = static_cast<uint32_t>((s1 + sum) % kAdlerBase);
+            s2 = static_cast<uint32_t>(new_s2 % kAdlerBase);
+        }
+
+#if defined(__aarch64__)
+
+        static uint32_t adler32_neon(uint32_t adler, const uint8_t *data, size_t size) {
+            static const uint8_t kWeights[32] = {32, 31, 30, 29, 28, 27, 26, 25, 24, 23, 22, 21, 20, 19, 18, 17,
+                                                 16, 15, 14, 13, 12, 11, 10, 9, 8, 7, 6, 5, 4, 3, 2, 1};
+            const uint8x8_t w0 = vld1_u8(kWeights);
+            const uint8x8_t w1 = vld1_u8(kWeights + 8);
+            const uint8x8_t w2 = vld1_u8(kWeights + 16);
+            const uint8x8_t w3 = vld1_u8(kWeights + 24);
+
+            uint32_t s1 = adler & 0xffff;
+            uint32_t s2 = adler >> 16;
+            while (size >= kAdlerChunk) {
+                size_t n = size < kAdlerNmax ? size : kAdlerNmax;
+                n -= n % kAdlerChunk;
+                size -= n;
+
+                uint32x4_t v_s1 = vdupq_n_u32(0);
+                uint32x4_t v_ps = vdupq_n_u32(0);
+                uint32x4_t v_s2 = vdupq_n_u32(0);
+                for (size_t i = 0; i < n; i += kAdlerChunk) {
+                    uint8x16_t b0 = vld1q_u8(data + i);
+                    uint8x16_t b1 = vld1q_u8(data + i + 16);
+                    v_ps = vaddq_u32(v_ps, v_s1);
+                    v_s1 = vpadalq_u16(v_s1, vaddq_u16(vpaddlq_u8(b0), vpaddlq_u8(b1)));
+
+                    // 每个 u16 通道最多 2 个乘积，不超过 2 * 255 * 32
+                    uint16x8_t m0 = vmull_u8(vget_low_u8(b0), w0);
+                    m0 = vmlal_u8(m0, vget_high_u8(b0), w1);
+                    uint16x8_t m1 = vmull_u8(vget_low_u8(b1), w2);
+                    m1 = vmlal_u8(m1, vget_high_u8(b1), w3);
+                    v_s2 = vpadalq_u16(v_s2, m0);
+                    v_s2 = vpadalq_u16(v_s2, m1);
+                }
+                data += n;
+                adler32_block_finish(s1, s2, n, vaddlvq_u32(v_s1), vaddlvq_u32(v_ps), vaddlvq_u32(v_s2));
+            }
+            return adler32_scalar((s2 << 16) | s1, data, size);
+        }
+
+#elif defined(__x86_64__) || defined(__i386__)
+
+        __attribute__((target("avx2")))
+        static inline uint64_t hsum_epi32(__m256i v) {
+            alignas(32) uint32_t lanes[8];
+            _mm256_store_si256(reinterpret_cast<__m256i *>(lanes), v);
+            uint64_t sum = 0;
+            for (uint32_t lane: lanes) sum += lane;
+            return sum;
+        }
+
+        __attribute__((target("avx2")))
+        static uint32_t adler32_avx2(uint32_t adler, const uint8_t *data, size_t size) {
+            const __m256i weights = _mm256_setr_epi8(32, 31, 30, 29, 28, 27, 26, 25, 24, 23, 22, 21, 20, 19, 18, 17,
+                                                     16, 15, 14, 13, 12, 11, 10, 9, 8, 7, 6, 5, 4, 3, 2, 1);
+            const __m256i ones = _mm256_set1_epi16(1);
+            const __m256i zero = _mm256_setzero_si256();
+
+            uint32_t s1 = adler & 0xffff;
+            uint32_t s2 = adler >> 16;
+            while (size >= kAdlerChunk) {
+                size_t n = size < kAdlerNmax ? size : kAdlerNmax;
+                n -= n % kAdlerChunk;
+                size -= n;
+
+                __m256i v_s1 = zero;
+                __m256i v_ps = zero;
+                __m256i v_s2 = zero;
+                for (size_t i = 0; i < n; i += kAdlerChunk) {
+                    __m256i bytes = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(data + i));
+                    v_ps = _mm256_add_epi32(v_ps, v_s1);
+                    // sad 结果在每个 64 位通道的低 32 位
+                    v_s1 = _mm256_add_epi32(v_s1, _mm256_sad_epu8(bytes, zero));
+                    v_s2 = _mm256_add_epi32(v_s2, _mm256_madd_epi16(_mm256_maddubs_epi16(bytes, weights), ones));
+                }
+                data += n;
+                adler32_block_finish(s1, s2, n, hsum_epi32(v_s1), hsum_epi32(v_ps), hsum_epi32(v_s2));
+            }
+            return adler32_scalar((s2 << 16) | s1, data, size);
+        }
+
+#endif
+
+        // ---- SHA-1 ----
+
+        using Sha1BlockFunc = void (*)(uint32_t state[5], const uint8_t *data, size_t blocks);
+
+        static inline uint32_t rol32(uint32_t value, int bits) {
+            return (value << bits) | (value >> (32 - bits));
+        }
+
+        static inline uint32_t load_be32(const uint8_t *p) {
+            return (static_cast<uint32_t>(p[0]) << 24) | (static_cast<uint32_t>(p[1]) << 16) |
+                   (static_cast<uint32_t>(p[2]) << 8) | p[3];
+        }
+
+        static void sha1_blocks_scalar(uint32_t state[5], const uint8_t *data, size_t blocks) {
+            uint32_t w[80];
+            while (blocks-- > 0) {
+                for (int i = 0; i < 16; ++i) w[i] = load_be32(data + i * 4);
+                for (int i = 16; i < 80; ++i) w[i] = rol32(w[i - 3] ^ w[i - 8] ^ w[i - 14] ^ w[i - 16], 1);
+
+                uint32_t a = state[0], b = state[1], c = state[2], d = state[3], e = state[4];
+#define SHA1_ROUND(f, k, i) do {                               \
+                    uint32_t temp = rol32(a, 5) + (f) + e + (k) + w[i]; \
+                    e = d;                                              \
+                    d = c;                                              \
+                    c = rol32(b, 30);                                   \
+                    b = a;                                              \
+                    a = temp;                                           \
+                } while (0)
+                // 四段分开循环，避免每轮判断使用哪个函数
+                for (int i = 0; i < 20; ++i) SHA1_ROUND(d ^ (b & (c ^ d)), 0x5A827999, i);
+                for (int i = 20; i < 40; ++i) SHA1_ROUND(b ^ c ^ d, 0x6ED9EBA1, i);
+                for (int i = 40; i < 60; ++i) SHA1_ROUND((b & c) | (d & (b | c)), 0x8F1BBCDC, i);
+                for (int i = 60; i < 80; ++i) SHA1_ROUND(b ^ c ^ d, 0xCA62C1D6, i);
+#undef SHA1_ROUND
+                state[0] += a;
+                state[1] += b;
+                state[2] += c;
+                state[3] += d;
+                state[4] += e;
+                data += 64;
+            }
+        }
+
+#if defined(__aarch64__)
+        // sha1_armv8.cpp，单独以 +crypto 编译
+        void sha1_blocks_armv8(uint32_t state[5], const uint8_t *data, size_t blocks);
+#endif
+
+        enum class AdlerImpl {
+            kScalar, kNeon, kAvx2
+        };
+
+        struct ChecksumImpl {
+            AdlerImpl adler = AdlerImpl::kScalar;
+            Sha1BlockFunc sha1_blocks = sha1_blocks_scalar;
+            bool sha1_hardware = false;
+        };
+
+        static const ChecksumImpl &checksum_impl() {
+            static const ChecksumImpl impl = [] {
+                ChecksumImpl result;
+#if defined(__aarch64__)
+                result.adler = AdlerImpl::kNeon;
+#if defined(CYURS_HAVE_SHA1_ARMV8)
+                if ((getauxval(AT_HWCAP) & HWCAP_SHA1) != 0) {
+                    result.sha1_blocks = sha1_blocks_armv8;
+                    result.sha1_hardware = true;
+                }
+#endif
+#elif defined(__x86_64__) || defined(__i386__)
+                if (__builtin_cpu_supports("avx2")) {
+                    result.adler = AdlerImpl::kAvx2;
+                }
+#endif
+                return result;
+            }();
+            return impl;
+        }
+
+        uint32_t adler32(uint32_t adler, const uint8_t *data, size_t size) {
+            switch (checksum_impl().adler) {
+#if defined(__aarch64__)
+                case AdlerImpl::kNeon:
+                    return adler32_neon(adler, data, size);
+#elif defined(__x86_64__) || defined(__i386__)
+                case AdlerImpl::kAvx2:
+                    return adler32_avx2(adler, data, size);
+#endif
+                default:
+                    return adler32_scalar(adler, data, size);
+            }
+        }
+
+        void sha1(const uint8_t *data, size_t size, uint8_t digest[kSha1DigestSize]) {
+            uint32_t state[5] = {0x67452301, 0xEFCDAB89, 0x98BADCFE, 0x10325476, 0xC3D2E1F0};
+            Sha1BlockFunc blocks = checksum_impl().sha1_blocks;
+
+            size_t full = size / 64;
+            blocks(state, data, full);
+
+            // 末尾补 0x80、0 和 64 位大端的比特长度
+            uint8_t tail[128] = {0};
+            size_t rest = size - full * 64;
+            memcpy(tail, data + full * 64, rest);
+            tail[rest] = 0x80;
+            size_t tail_size = rest < 56 ? 64 : 128;
+            uint64_t bits = static_cast<uint64_t>(size) * 8;
+            for (int i = 0; i < 8; ++i) {
+                tail[tail_size - 1 - i] = static_cast<uint8_t>(bits >> (i * 8));
+            }
+            blocks(state, tail, tail_size / 64);
+
+            for (int i = 0; i < 5; ++i) {
+                digest[i * 4] = static_cast<uint8_t>(state[i] >> 24);
+                digest[i * 4 + 1] = static_cast<uint8_t>(state[i] >> 16);
+                digest[i * 4 + 2] = static_cast<uint8_t>(state[i] >> 8);
+                digest[i * 4 + 3] = static_cast<uint8_t>(state[i]);
+            }
+        }
+
+        bool fixup_dex_header(uint8_t *data, size_t size) {
+            if (data == nullptr || size < sizeof(dex::Header)) return false;
+            auto *header = reinterpret_cast<dex::Header *>(data);
+            size_t file_size = header->file_size_;
+            if (file_size < sizeof(dex::Header) || file_size > size) file_size = size;
+
+            // signature_ 之后的数据
+            constexpr size_t kSignatureEnd = offsetof(dex::Header, signature_) + sizeof(header->signature_);
+            sha1(data + kSignatureEnd, file_size - kSignatureEnd, header->signature_);
+            // checksum_ 之后的数据
+            constexpr size_t kChecksumEnd = offsetof(dex::Header, checksum_) + sizeof(header->checksum_);
+            header->checksum_ = adler32(1, data + kChecksumEnd, file_size - kChecksumEnd);
+            return true;
+        }
+
+        const char *checksum_impl_name() {
+            const ChecksumImpl &impl = checksum_impl();
+            switch (impl.adler) {
+                case AdlerImpl::kNeon:
+                    return impl.sha1_hardware ? "adler32=neon sha1=armv8" : "adler32=neon sha1=scalar";
+                case AdlerImpl::kAvx2:
+                    return "adler32=avx2 sha1=scalar";
+                default:
+                    return "adler32=scalar sha1=scalar";
+            }
+        }
+
+    } // namespace dex_tools
+};//namespace cyurs
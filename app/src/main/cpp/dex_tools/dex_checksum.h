@@ -0,0 +1,37 @@
+#ifndef CYURS_DEX_CHECKSUM_H
+#define CYURS_DEX_CHECKSUM_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+/**
+ * dex 头的 checksum_（Adler-32）和 signature_（SHA-1）
+ *
+ * Adler-32 与 libtomcrypt misc/adler32.c 结果一致，按 CPU 选择 NEON / AVX2 / 标量实现；
+ * SHA-1 在支持 ARMv8 SHA1 指令时使用硬件指令，否则使用标量实现。
+ */
+namespace cyurs {
+    namespace dex_tools {
+
+        constexpr size_t kSha1DigestSize = 20;
+
+        // 标准 Adler-32，adler 初始值为 1
+        uint32_t adler32(uint32_t adler, const uint8_t *data, size_t size);
+
+        void sha1(const uint8_t *data, size_t size, uint8_t digest[kSha1DigestSize]);
+
+        /**
+         * 重新计算 dex 的 signature_ 和 checksum_
+         *
+         * 先算 signature_（覆盖 32 字节之后的数据），再算 checksum_（覆盖 12 字节之后，包含 signature_）。
+         * 范围取 header.file_size_，超出 size 时取 size。
+         */
+        bool fixup_dex_header(uint8_t *data, size_t size);
+
+        // 当前使用的实现，如 "adler32=neon sha1=armv8"
+        const char *checksum_impl_name();
+
+    } // namespace dex_tools
+};//namespace cyurs
+
+#endif //CYURS_DEX_CHECKSUM_H
@@ -0,0 +1,256 @@
+#include "dex_dumper.h"
+
+#include <sys/uio.h>
+#include <time.h>
+#include <unistd.h>
+#include <algorithm>
+#include <atomic>
+#include <cstdio>
+#include <cstring>
+#include <thread>
+#include <unordered_set>
+#include <android/log.h>
+
+#include "dex_loader.h"
+#include "dex_checksum.h"
+#include "../dex/dex_reader.h"
+#include "../dex/dex_writer.h"
+
+#define LOG_TAG "DexDumper"
+#define LOGI(...) __android_log_print(ANDROID_LOG_INFO, LOG_TAG, __VA_ARGS__)
+#define LOGE(...) __android_log_print(ANDROID_LOG_ERROR, LOG_TAG, __VA_ARGS__)
+
+namespace cyurs {
+    namespace dex_tools {
+
+        using namespace dex;
+
+        // v41 容器的头部
+        static constexpr size_t kMaxHeaderSize = sizeof(HeaderV41);
+        // cdex 共享数据区 / v41 容器的上限
+        static constexpr uint64_t kMaxSnapshotSize = 1ULL << 30;
+
+        struct DumpJob {
+            DexFileInfo info;
+            // 快照的起始地址和长度（cdex 包含共享数据区，v41 为整个容器）
+            uintptr_t snapshot_begin = 0;
+            size_t snapshot_size = 0;
+            // dex 头在快照中的偏移
+            size_t header_offset = 0;
+            std::string file_name;
+            uint8_t sha1[kSha1DigestSize] = {};
+            uint64_t output_size = 0;
+            bool converted = false;
+            bool ok = false;
+        };
+
+        static uint64_t now_us() {
+            struct timespec ts{};
+            clock_gettime(CLOCK_MONOTONIC, &ts);
+            return static_cast<uint64_t>(ts.tv_sec) * 1000000ULL + ts.tv_nsec / 1000;
+        }
+
+        /**
+         * 用 process_vm_readv 读取本进程的内存，不可读的页填 0
+         *
+         * @return 成功读取的字节数
+         */
+        static size_t snapshot_memory(uintptr_t addr, size_t size, uint8_t *out) {
+            static const size_t page_size = static_cast<size_t>(sysconf(_SC_PAGESIZE));
+            size_t done = 0;
+            size_t readable = 0;
+            while (done < size) {
+                struct iovec local{out + done, size - done};
+                struct iovec remote{reinterpret_cast<void *>(addr + done), size - done};
+                ssize_t n = process_vm_readv(getpid(), &local, 1, &remote, 1, 0);
+                if (n > 0) {
+                    done += static_cast<size_t>(n);
+                    readable += static_cast<size_t>(n);
+                    continue;
+                }
+                // 跳过不可读的页
+                size_t skip = std::min(size - done, page_size - ((addr + done) & (page_size - 1)));
+                memset(out + done, 0, skip);
+                done += skip;
+            }
+            return readable;
+        }
+
+        // 去重用的 dex 头哈希（FNV-1a 64）
+        static uint64_t hash_header(const uint8_t *data, size_t size) {
+            uint64_t hash = 14695981039346656037ULL;
+            for (size_t i = 0; i < size; ++i) {
+                hash ^= data[i];
+                hash *= 1099511628211ULL;
+            }
+            return hash;
+        }
+
+        struct DedupKey {
+            uint32_t location_checksum;
+            uint64_t header_hash;
+
+            bool operator==(const DedupKey &other) const {
+                return location_checksum == other.location_checksum && header_hash == other.header_hash;
+            }
+        };
+
+        struct DedupKeyHash {
+            size_t operator()(const DedupKey &key) const {
+                return static_cast<size_t>(key.header_hash ^ (static_cast<uint64_t>(key.location_checksum) << 17));
+            }
+        };
+
+        // 读取 dex 头，确定快照范围；dex 头不可读返回 false
+        static bool prepare_job(const void *dex_file, int sdk_level, DumpJob &job, DedupKey &key) {
+            if (!GetDexFileInfo(dex_file, sdk_level, &job.info) || job.info.size < sizeof(Header)) return false;
+
+            uint8_t header_bytes[kMaxHeaderSize] = {};
+            auto begin = reinterpret_cast<uintptr_t>(job.info.begin);
+            if (snapshot_memory(begin, sizeof(header_bytes), header_bytes) < sizeof(Header)) return false;
+            key = {job.info.location_checksum, hash_header(header_bytes, sizeof(Header))};
+
+            const auto *header = reinterpret_cast<const HeaderV41 *>(header_bytes);
+            job.snapshot_begin = begin;
+            job.snapshot_size = job.info.size;
+            if (memcmp(header->magic_, "cdex", 4) == 0) {
+                // cdex 的数据区在所有 dex 之后（vdex 的共享数据），data_off_ 相对于 begin_
+                uint64_t data_end = static_cast<uint64_t>(header->data_off_) + header->data_size_;
+                job.snapshot_size = std::max<uint64_t>(job.info.size, data_end);
+            } else if (memcmp(header->magic_, "dex\n", 4) == 0 && header->header_size_ >= sizeof(HeaderV41) &&
+                       header->header_offset_ <= begin) {
+                // v41 容器中的偏移相对于容器起始
+                job.header_offset = header->header_offset_;
+                job.snapshot_begin = begin - header->header_offset_;
+                job.snapshot_size = std::max<uint64_t>(header->container_size_,
+                                                       job.header_offset + job.info.size);
+            }
+
+            // 头部被改坏时不按其中的大小分配
+            if (job.snapshot_size > kMaxSnapshotSize) {
+                job.snapshot_begin = begin;
+                job.snapshot_size = job.info.size;
+                job.header_offset = 0;
+            }
+
+            char name[64];
+            snprintf(name, sizeof(name), "dex_%08x_%016llx.dex", key.location_checksum,
+                     static_cast<unsigned long long>(key.header_hash));
+            job.file_name = name;
+            return true;
+        }
+
+        static void dump_job(DumpJob &job, const std::string &out_dir, std::vector<uint8_t> &snapshot,
+                             std::vector<uint8_t> &rewritten) {
+            snapshot.resize(job.snapshot_size);
+            snapshot_memory(job.snapshot_begin, snapshot.size(), snapshot.data());
+
+            const uint8_t *data = snapshot.data() + job.header_offset;
+            size_t size = std::min(job.info.size, snapshot.size() - job.header_offset);
+
+            // cdex / v41 容器转为独立的标准 dex；转换失败（壳改过头部等）按原样写出
+            DexReader reader;
+            if (reader.OpenInContainer(snapshot.data(), snapshot.size(), job.header_offset) &&
+                !reader.IsStandaloneDex() && RewriteDex(reader, DexWriterOptions(), rewritten)) {
+                fixup_dex_header(rewritten.data(), rewritten.size());
+                data = rewritten.data();
+                size = rewritten.size();
+                job.converted = true;
+            }
+
+            sha1(data, size, job.sha1);
+            job.output_size = size;
+            job.ok = write_file(out_dir + "/" + job.file_name, data, size);
+            if (!job.ok) LOGE("write %s failed", job.file_name.c_str());
+        }
+
+        static bool write_index(const std::string &out_dir, const std::vector<DumpJob> &jobs) {
+            std::string index;
+            char buf[96];
+            for (const DumpJob &job: jobs) {
+                if (!job.ok) continue;
+                index.append(job.info.location);
+                snprintf(buf, sizeof(buf), "\t%p\t%llu\t", job.info.begin,
+                         static_cast<unsigned long long>(job.output_size));
+                index.append(buf);
+                for (uint8_t byte: job.sha1) {
+                    snprintf(buf, sizeof(buf), "%02x", byte);
+                    index.append(buf);
+                }
+                index.append("\t").append(job.file_name).append("\n");
+            }
+            return write_file(out_dir + "/" + kDexIndexFileName,
+                              reinterpret_cast<const uint8_t *>(index.data()), index.size());
+        }
+
+        bool dump_dex_files(const std::vector<const void *> &dex_files, int sdk_level, const std::string &out_dir,
+                            const DumpOptions &options, DumpStats &stats) {
+            uint64_t start = now_us();
+            stats.found = static_cast<uint32_t>(dex_files.size());
+
+            // 1. 串行读取 DexFile 并去重（同一个 dex 可能被多个 ClassLoader 打开）
+            std::vector<DumpJob> jobs;
+            std::unordered_set<DedupKey, DedupKeyHash> seen;
+            for (const void *dex_file: dex_files) {
+                DumpJob job;
+                DedupKey key{};
+                if (!prepare_job(dex_file, sdk_level, job, key)) {
+                    ++stats.failed;
+                    continue;
+                }
+                if (seen.insert(key).second) jobs.push_back(std::move(job));
+            }
+            stats.unique = static_cast<uint32_t>(jobs.size());
+
+            // 2. 并行写出，大的 dex 先领取
+            std::vector<DumpJob *> order;
+            for (DumpJob &job: jobs) order.push_back(&job);
+            std::sort(order.begin(), order.end(), [](const DumpJob *a, const DumpJob *b) {
+                return a->snapshot_size > b->snapshot_size;
+            });
+
+            int threads = options.threads > 0 ? options.threads : static_cast<int>(std::thread::hardware_concurrency());
+            threads = std::max(1, std::min<int>(threads, static_cast<int>(order.size())));
+            std::atomic<size_t> next{0};
+            auto worker = [&]() {
+                // 每个线程复用自己的缓冲区
+                std::vector<uint8_t> snapshot;
+                std::vector<uint8_t> rewritten;
+                size_t i;
+                while ((i = next.fetch_add(1)) < order.size()) {
+                    dump_job(*order[i], out_dir, snapshot, rewritten);
+                }
+            };
+            std::vector<std::thread> workers;
+            for (int t = 1; t < threads; ++t) workers.emplace_back(worker);
+            worker();
+            for (std::thread &thread: workers) thread.join();
+
+            for (const DumpJob &job: jobs) {
+                if (job.ok) {
+                    ++stats.written;
+                    stats.bytes += job.output_size;
+                    if (job.converted) ++stats.converted;
+                    LOGI("%s -> %s", job.info.location.c_str(), job.file_name.c_str());
+                } else {
+                    ++stats.failed;
+                }
+            }
+
+            // 3. 索引文件按 DexFile 的顺序写
+            bool ok = write_index(out_dir, jobs);
+            stats.elapsed_us = now_us() - start;
+            return ok;
+        }
+
+        std::string format_dump_stats(const DumpStats &stats) {
+            char buf[256];
+            snprintf(buf, sizeof(buf),
+                     "found=%u unique=%u written=%u converted=%u failed=%u bytes=%llu time=%.1fms",
+                     stats.found, stats.unique, stats.written, stats.converted, stats.failed,
+                     static_cast<unsigned long long>(stats.bytes), stats.elapsed_us / 1000.0);
+            return buf;
+        }
+
+    } // namespace dex_tools
+};//namespace cyurs
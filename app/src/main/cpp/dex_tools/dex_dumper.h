@@ -0,0 +1,56 @@
+#ifndef CYURS_DEX_DUMPER_H
+#define CYURS_DEX_DUMPER_H
+
+#include <stdint.h>
+#include <string>
+#include <vector>
+
+#include "../dex/dex_file_info.h"
+
+/**
+ * 整个进程的 DexFile dump（脱壳后）
+ *
+ * 输入是 art::DexFile 指针（DexFile.mCookie 中的元素），按 location_checksum_ + dex 头的哈希去重后，
+ * 多线程并行写到输出目录（大的 dex 先写），每个 dex 先用 process_vm_readv 拷贝一份快照，不可读的内存不会导致崩溃。
+ * cdex、v41 容器中的 dex 用 dex::RewriteDex 转成独立的标准 dex。
+ *
+ * 输出目录中另有索引文件 dex_index.txt，每行：location \t base \t size \t sha1 \t 文件名
+ */
+namespace cyurs {
+    namespace dex_tools {
+
+        constexpr const char *kDexIndexFileName = "dex_index.txt";
+
+        struct DumpOptions {
+            // 线程数，0 表示使用 CPU 核数
+            int threads = 0;
+        };
+
+        struct DumpStats {
+            // 输入的 DexFile 个数
+            uint32_t found = 0;
+            // 去重后的个数
+            uint32_t unique = 0;
+            uint32_t written = 0;
+            // cdex / v41 容器转换为标准 dex 的个数
+            uint32_t converted = 0;
+            uint32_t failed = 0;
+            uint64_t bytes = 0;
+            uint64_t elapsed_us = 0;
+        };
+
+        /**
+         * dump dex_files 中的全部 dex 到 out_dir（目录需已存在）
+         *
+         * @param dex_files art::DexFile 指针
+         * @param sdk_level 决定 art::DexFile 的内存布局
+         */
+        bool dump_dex_files(const std::vector<const void *> &dex_files, int sdk_level, const std::string &out_dir,
+                            const DumpOptions &options, DumpStats &stats);
+
+        std::string format_dump_stats(const DumpStats &stats);
+
+    } // namespace dex_tools
+};//namespace cyurs
+
+#endif //CYURS_DEX_DUMPER_H
@@ -0,0 +1,111 @@
+#include "dex_loader.h"
+
+#include <errno.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/stat.h>
+#include <android/log.h>
+
+#include "../maps/proc_maps.h"
+#include "../zip/zip_reader.h"
+
+#define LOG_TAG "DexTools"
+#define LOGE(...) __android_log_print(ANDROID_LOG_ERROR, LOG_TAG, __VA_ARGS__)
+
+namespace cyurs {
+    namespace dex_tools {
+
+        bool read_file(const std::string &path, std::vector<uint8_t> &out) {
+            int fd = open(path.c_str(), O_RDONLY | O_CLOEXEC);
+            if (fd < 0) return false;
+
+            struct stat st{};
+            if (fstat(fd, &st) != 0 || st.st_size <= 0) {
+                close(fd);
+                return false;
+            }
+
+            out.resize(static_cast<size_t>(st.st_size));
+            size_t done = 0;
+            while (done < out.size()) {
+                ssize_t n = read(fd, out.data() + done, out.size() - done);
+                if (n < 0 && errno == EINTR) continue;
+                if (n <= 0) break;
+                done += static_cast<size_t>(n);
+            }
+            close(fd);
+            out.resize(done);
+            return done > 0;
+        }
+
+        bool write_file(const std::string &path, const uint8_t *data, size_t size) {
+            int fd = open(path.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+            if (fd < 0) {
+                LOGE("open %s for write failed: %s", path.c_str(), strerror(errno));
+                return false;
+            }
+            size_t done = 0;
+            while (done < size) {
+                ssize_t n = write(fd, data + done, size - done);
+                if (n < 0 && errno == EINTR) continue;
+                if (n <= 0) break;
+                done += static_cast<size_t>(n);
+            }
+            close(fd);
+            return done == size;
+        }
+
+        std::string dex_location(const DexImage &image, size_t index, size_t count) {
+            if (count <= 1) return image.location;
+            if (index == 0) return image.location + "!classes.dex";
+            return image.location + "!classes" + std::to_string(index + 1) + ".dex";
+        }
+
+        static bool is_archive(const std::string &path) {
+            return maps::path_has_extension(path, ".apk") ||
+                   maps::path_has_extension(path, ".jar") ||
+                   maps::path_has_extension(path, ".zip");
+        }
+
+        std::vector<DexImage> load_dex_images(const std::string &path) {
+            std::vector<DexImage> images;
+
+            if (!is_archive(path)) {
+                DexImage image;
+                image.location = path;
+                if (read_file(path, image.data)) {
+                    images.emplace_back(std::move(image));
+                } else {
+                    LOGE("read %s failed", path.c_str());
+                }
+                return images;
+            }
+
+            zip::ZipArchive archive;
+            if (!archive.Open(path)) {
+                LOGE("open archive %s failed", path.c_str());
+                return images;
+            }
+
+            archive.ForEachEntry([&](const zip::ZipEntry &entry) {
+                if (!zip::IsClassesDex(entry.name)) return true;
+
+                DexImage image;
+                image.location = path + "!" + std::string(entry.name);
+                image.data.reserve(entry.uncompressed_size);
+                bool ok = archive.StreamEntry(entry, [&](const uint8_t *data, size_t size) {
+                    image.data.insert(image.data.end(), data, data + size);
+                    return true;
+                });
+                if (ok && !image.data.empty()) {
+                    images.emplace_back(std::move(image));
+                } else {
+                    LOGE("extract %s failed", image.location.c_str());
+                }
+                return true;
+            });
+            return images;
+        }
+
+    } // namespace dex_tools
+};//namespace cyurs
@@ -0,0 +1,37 @@
+#ifndef CYURS_DEX_LOADER_H
+#define CYURS_DEX_LOADER_H
+
+#include <stdint.h>
+#include <string>
+#include <vector>
+
+/**
+ * 把 .dex / .cdex / .vdex 或 apk / jar 中的 classes*.dex 读到内存
+ *
+ * 一个 DexImage 是一个完整的文件，其中可能有多个 dex（vdex、v41 容器），用 dex::OpenDexContainer 拆分。
+ */
+namespace cyurs {
+    namespace dex_tools {
+
+        struct DexImage {
+            // 来源，如 /system/framework/framework.jar!classes2.dex
+            std::string location;
+            std::vector<uint8_t> data;
+        };
+
+        // 读取整个文件
+        bool read_file(const std::string &path, std::vector<uint8_t> &out);
+
+        // 写入（覆盖）整个文件
+        bool write_file(const std::string &path, const uint8_t *data, size_t size);
+
+        // 容器中第 index 个 dex 的名字，只有一个 dex 时就是 image.location，否则追加 !classesN.dex
+        std::string dex_location(const DexImage &image, size_t index, size_t count);
+
+        // 按文件后缀识别，apk / jar / zip 读取其中全部 classes*.dex，失败返回空
+        std::vector<DexImage> load_dex_images(const std::string &path);
+
+    } // namespace dex_tools
+};//namespace cyurs
+
+#endif //CYURS_DEX_LOADER_H
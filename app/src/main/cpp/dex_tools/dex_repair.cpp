@@ -0,0 +1,277 @@
+#include "dex_repair.h"
+
+#include <time.h>
+#include <algorithm>
+#include <atomic>
+#include <cstdio>
+#include <thread>
+#include <android/log.h>
+
+#include "dex_loader.h"
+#include "dex_checksum.h"
+#include "../dex/class_accessor.h"
+
+#define LOG_TAG "DexRepair"
+#define LOGI(...) __android_log_print(ANDROID_LOG_INFO, LOG_TAG, __VA_ARGS__)
+#define LOGE(...) __android_log_print(ANDROID_LOG_ERROR, LOG_TAG, __VA_ARGS__)
+
+namespace cyurs {
+    namespace dex_tools {
+
+        using namespace dex;
+
+        // 每个线程一次领取的 class_def 个数
+        static constexpr uint32_t kClassBatch = 64;
+
+        // 放不下的方法，等待追加到文件末尾
+        struct Relocation {
+            uint32_t class_def_idx;
+            uint32_t method_idx;
+            const CodeDumpEntry *entry;
+            uint32_t code_size;
+            // 追加后的 code_off
+            uint32_t new_code_off;
+        };
+
+        struct WorkerResult {
+            std::vector<Relocation> relocations;
+            uint32_t patched_in_place = 0;
+            uint32_t matched = 0;
+        };
+
+        static uint64_t now_us() {
+            struct timespec ts{};
+            clock_gettime(CLOCK_MONOTONIC, &ts);
+            return static_cast<uint64_t>(ts.tv_sec) * 1000000ULL + ts.tv_nsec / 1000;
+        }
+
+        static void align4(std::vector<uint8_t> &out, size_t base) {
+            while (((base + out.size()) & 3) != 0) out.push_back(0);
+        }
+
+        /**
+         * 被多个方法引用的 code_off（从小到大）
+         *
+         * rewriteDex 去重后相同的 code_item 只保留一份，壳也常让抽空的方法共用一个桩，
+         * 这些 code_item 不能原位修改（其他方法会一起被改，多个线程还会同时写）。
+         */
+        static std::vector<uint32_t> collect_shared_code_offs(const DexReader &reader) {
+            std::vector<uint32_t> offs;
+            for (uint32_t i = 0; i < reader.NumClassDefs(); ++i) {
+                ClassAccessor accessor(reader, *reader.GetClassDef(i));
+                accessor.VisitMethods([&](const Method &method) {
+                    if (method.GetCodeItemOffset() != 0) offs.push_back(method.GetCodeItemOffset());
+                });
+            }
+            std::sort(offs.begin(), offs.end());
+
+            std::vector<uint32_t> shared;
+            for (size_t i = 1; i < offs.size(); ++i) {
+                if (offs[i] == offs[i - 1] && (shared.empty() || shared.back() != offs[i])) shared.push_back(offs[i]);
+            }
+            return shared;
+        }
+
+        static void repair_worker(const DexReader &reader, uint8_t *data,
+                                  const std::vector<const CodeDumpEntry *> &by_method,
+                                  const std::vector<uint32_t> &shared_code_offs,
+                                  std::atomic<uint32_t> &next_class, WorkerResult &result) {
+            uint32_t num_class_defs = reader.NumClassDefs();
+            uint32_t begin;
+            while ((begin = next_class.fetch_add(kClassBatch)) < num_class_defs) {
+                uint32_t end = std::min(num_class_defs, begin + kClassBatch);
+                for (uint32_t i = begin; i < end; ++i) {
+                    ClassAccessor accessor(reader, *reader.GetClassDef(i));
+                    accessor.VisitMethods([&](const Method &method) {
+                        uint32_t method_idx = method.GetIndex();
+                        if (method_idx >= by_method.size() || by_method[method_idx] == nullptr) return;
+                        const CodeDumpEntry *entry = by_method[method_idx];
+                        ++result.matched;
+
+                        auto code_size = static_cast<uint32_t>(ComputeCodeItemSize(entry->code, entry->code_len));
+                        uint32_t code_off = method.GetCodeItemOffset();
+                        size_t old_size = reader.GetCodeItemSize(code_off);
+                        bool shared = std::binary_search(shared_code_offs.begin(), shared_code_offs.end(), code_off);
+                        if (!shared && old_size != 0 && code_size <= old_size) {
+                            memcpy(data + code_off, entry->code, code_size);
+                            ++result.patched_in_place;
+                        } else {
+                            result.relocations.push_back({i, method_idx, entry, code_size, 0});
+                        }
+                    });
+                }
+            }
+        }
+
+        bool repair_dex(std::vector<uint8_t> &dex, const CodeDump &dump,
+                        const RepairOptions &options, RepairStats &stats) {
+            uint64_t start = now_us();
+            DexReader reader(dex.data(), dex.size());
+            // 原位修改和追加都要求偏移相对于文件起始，cdex / vdex / v41 容器先用 rewriteDex 转成标准 dex
+            if (!reader.IsStandaloneDex()) return false;
+            // 丢弃 file_size_ 之后的数据，追加从 file_size_ 开始
+            dex.resize(reader.GetHeader().file_size_);
+
+            // method_idx -> 记录，同一方法有多条时使用最后一条
+            uint32_t checksum = reader.GetHeader().checksum_;
+            std::vector<const CodeDumpEntry *> by_method(reader.NumMethodIds(), nullptr);
+            for (const CodeDumpEntry &entry: dump.entries) {
+                if (options.match_checksum && entry.dex_checksum != 0 && entry.dex_checksum != checksum) continue;
+                if (entry.method_idx >= by_method.size() || ComputeCodeItemSize(entry.code, entry.code_len) == 0) {
+                    ++stats.invalid;
+                    continue;
+                }
+                if (by_method[entry.method_idx] == nullptr) ++stats.records;
+                by_method[entry.method_idx] = &entry;
+            }
+
+            // 1. 并行原位修复，共用的 code_item 追加到末尾
+            std::vector<uint32_t> shared_code_offs = collect_shared_code_offs(reader);
+            uint32_t num_class_defs = reader.NumClassDefs();
+            int threads = options.threads > 0 ? options.threads : static_cast<int>(std::thread::hardware_concurrency());
+            threads = std::max(1, std::min<int>(threads, static_cast<int>((num_class_defs + kClassBatch - 1) / kClassBatch)));
+
+            std::atomic<uint32_t> next_class{0};
+            std::vector<WorkerResult> results(threads);
+            std::vector<std::thread> workers;
+            for (int t = 1; t < threads; ++t) {
+                workers.emplace_back(repair_worker, std::cref(reader), dex.data(), std::cref(by_method),
+                                     std::cref(shared_code_offs), std::ref(next_class), std::ref(results[t]));
+            }
+            repair_worker(reader, dex.data(), by_method, shared_code_offs, next_class, results[0]);
+            for (std::thread &worker: workers) worker.join();
+
+            std::vector<Relocation> relocations;
+            uint32_t matched = 0;
+            for (WorkerResult &result: results) {
+                stats.patched_in_place += result.patched_in_place;
+                matched += result.matched;
+                relocations.insert(relocations.end(), result.relocations.begin(), result.relocations.end());
+            }
+            stats.unmatched = stats.records > matched ? stats.records - matched : 0;
+
+            // 2. 串行追加放不下的 code_item 和对应类的 class_data
+            if (!relocations.empty()) {
+                std::sort(relocations.begin(), relocations.end(), [](const Relocation &a, const Relocation &b) {
+                    return a.class_def_idx != b.class_def_idx ? a.class_def_idx < b.class_def_idx
+                                                              : a.method_idx < b.method_idx;
+                });
+
+                size_t base = dex.size();
+                std::vector<uint8_t> tail;
+                for (Relocation &relocation: relocations) {
+                    align4(tail, base);
+                    relocation.new_code_off = static_cast<uint32_t>(base + tail.size());
+                    tail.insert(tail.end(), relocation.entry->code, relocation.entry->code + relocation.code_size);
+                }
+
+                // class_def 索引 -> 新的 class_data_off
+                std::vector<std::pair<uint32_t, uint32_t>> class_data_offs;
+                for (size_t i = 0; i < relocations.size();) {
+                    size_t j = i;
+                    while (j < relocations.size() && relocations[j].class_def_idx == relocations[i].class_def_idx) ++j;
+
+                    uint32_t class_def_idx = relocations[i].class_def_idx;
+                    ClassAccessor accessor(reader, *reader.GetClassDef(class_def_idx));
+                    size_t old_size = tail.size();
+                    auto class_data_off = static_cast<uint32_t>(base + old_size);
+                    const Relocation *first = relocations.data() + i;
+                    const Relocation *last = relocations.data() + j;
+                    bool encoded = EncodeClassData(accessor, tail, [&](const Method &method) {
+                        const Relocation *it = std::lower_bound(
+                                first, last, method.GetIndex(),
+                                [](const Relocation &r, uint32_t idx) { return r.method_idx < idx; });
+                        return it != last && it->method_idx == method.GetIndex() ? it->new_code_off
+                                                                                 : method.GetCodeItemOffset();
+                    });
+                    if (encoded) {
+                        class_data_offs.emplace_back(class_def_idx, class_data_off);
+                        stats.relocated += static_cast<uint32_t>(j - i);
+                    } else {
+                        tail.resize(old_size);
+                        stats.invalid += static_cast<uint32_t>(j - i);
+                    }
+                    i = j;
+                }
+
+                if (!class_data_offs.empty()) {
+                    uint32_t class_defs_off = reader.GetHeader().class_defs_off_;
+                    for (const auto &item: class_data_offs) {
+                        auto *class_def = reinterpret_cast<ClassDef *>(dex.data() + class_defs_off) + item.first;
+                        class_def->class_data_off_ = item.second;
+                    }
+                    stats.rewritten_classes = static_cast<uint32_t>(class_data_offs.size());
+
+                    dex.insert(dex.end(), tail.begin(), tail.end());
+                    auto *header = reinterpret_cast<Header *>(dex.data());
+                    header->file_size_ = static_cast<uint32_t>(dex.size());
+                    if (header->data_off_ != 0 && header->data_off_ <= dex.size()) {
+                        header->data_size_ = static_cast<uint32_t>(dex.size() - header->data_off_);
+                    }
+                }
+            }
+
+            if (options.fixup_header) {
+                fixup_dex_header(dex.data(), dex.size());
+            }
+
+            stats.elapsed_us = now_us() - start;
+            return true;
+        }
+
+        static bool repair_image(DexImage &image, const CodeDump &dump, const std::string &out_path,
+                                 const RepairOptions &options, RepairStats &stats) {
+            RepairStats image_stats;
+            if (!repair_dex(image.data, dump, options, image_stats)) {
+                LOGE("invalid dex %s", image.location.c_str());
+                return false;
+            }
+            LOGI("%s: %s", image.location.c_str(), format_repair_stats(image_stats).c_str());
+
+            stats.records += image_stats.records;
+            stats.patched_in_place += image_stats.patched_in_place;
+            stats.relocated += image_stats.relocated;
+            stats.rewritten_classes += image_stats.rewritten_classes;
+            stats.unmatched += image_stats.unmatched;
+            stats.invalid += image_stats.invalid;
+            stats.elapsed_us += image_stats.elapsed_us;
+            return write_file(out_path, image.data.data(), image.data.size());
+        }
+
+        bool repair_dex_file(const std::string &dex_path, const std::string &dump_path, const std::string &out_path,
+                             const RepairOptions &options, RepairStats &stats) {
+            std::vector<uint8_t> dump_data;
+            if (!read_file(dump_path, dump_data)) {
+                LOGE("read dump %s failed", dump_path.c_str());
+                return false;
+            }
+            CodeDump dump;
+            ParseCodeDump(dump_data.data(), dump_data.size(), dump);
+            LOGI("%zu records in %s", dump.entries.size(), dump_path.c_str());
+
+            std::vector<DexImage> images = load_dex_images(dex_path);
+            if (images.empty()) return false;
+
+            // 单个 dex 直接写到 out_path；apk / jar 中的多个 dex 写到 out_path 目录下，按 dex 头的 checksum 匹配记录
+            if (images.size() == 1) {
+                return repair_image(images[0], dump, out_path, options, stats);
+            }
+            bool ok = true;
+            for (DexImage &image: images) {
+                std::string name = image.location.substr(image.location.rfind('!') + 1);
+                ok = repair_image(image, dump, out_path + "/" + name, options, stats) && ok;
+            }
+            return ok;
+        }
+
+        std::string format_repair_stats(const RepairStats &stats) {
+            char buf[256];
+            snprintf(buf, sizeof(buf),
+                     "records=%u in_place=%u relocated=%u rewritten_classes=%u unmatched=%u invalid=%u time=%.1fms",
+                     stats.records, stats.patched_in_place, stats.relocated, stats.rewritten_classes,
+                     stats.unmatched, stats.invalid, stats.elapsed_us / 1000.0);
+            return buf;
+        }
+
+    } // namespace dex_tools
+};//namespace cyurs
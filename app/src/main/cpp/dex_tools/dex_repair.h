@@ -0,0 +1,70 @@
+#ifndef CYURS_DEX_REPAIR_H
+#define CYURS_DEX_REPAIR_H
+
+#include <stdint.h>
+#include <string>
+#include <vector>
+
+#include "../dex/code_dump.h"
+
+/**
+ * 用 dump 出来的方法体修复 dex（函数抽取壳把 code_item 清空或指向别处）
+ *
+ * 1. 多线程按 class_def 分段遍历 class_data，dump 中有记录的方法：
+ *    原 code_item 只被这一个方法引用且放得下就直接覆盖；
+ * 2. 放不下、code_off 为 0 或 code_item 被多个方法共用（去重后的 dex、壳的公共桩）的方法收集起来，
+ *    单线程统一追加到文件末尾：
+ *    先按 4 字节对齐追加 code_item，再为涉及的类重新编码 class_data_item 追加到末尾，
+ *    并修改 class_def.class_data_off_ 和 header 中的 file_size_ / data_size_。
+ *
+ * 最后重新计算 header 的 signature_ / checksum_。
+ *
+ * 追加的数据没有写入 map_list，适合 jadx / baksmali 等静态分析；
+ * 需要能被 ART 加载的规范 dex 时再用 dex 重写器重新布局。
+ */
+namespace cyurs {
+    namespace dex_tools {
+
+        struct RepairOptions {
+            // 0 表示使用 CPU 核数
+            int threads = 0;
+            // 只使用 dex_checksum 为 0 或等于 dex 头 checksum_ 的记录
+            bool match_checksum = true;
+            // 修复后重新计算 header 的 signature_ 和 checksum_
+            bool fixup_header = true;
+        };
+
+        struct RepairStats {
+            // dump 中可用于当前 dex 的记录数
+            uint32_t records = 0;
+            // 原位覆盖的方法数
+            uint32_t patched_in_place = 0;
+            // 追加到文件末尾的方法数
+            uint32_t relocated = 0;
+            // 重新编码 class_data 的类数
+            uint32_t rewritten_classes = 0;
+            // 记录的 method_idx 在 class_data 中找不到
+            uint32_t unmatched = 0;
+            // 记录中的 code_item 格式错误
+            uint32_t invalid = 0;
+            uint64_t elapsed_us = 0;
+        };
+
+        /**
+         * 修复内存中的 dex，dex 可能变长
+         *
+         * @return dex 无效时返回 false
+         */
+        bool repair_dex(std::vector<uint8_t> &dex, const dex::CodeDump &dump,
+                        const RepairOptions &options, RepairStats &stats);
+
+        // 读取 dex 和 dump 文件，修复后写到 out_path
+        bool repair_dex_file(const std::string &dex_path, const std::string &dump_path, const std::string &out_path,
+                             const RepairOptions &options, RepairStats &stats);
+
+        std::string format_repair_stats(const RepairStats &stats);
+
+    } // namespace dex_tools
+};//namespace cyurs
+
+#endif //CYURS_DEX_REPAIR_H
@@ -0,0 +1,77 @@
+#include "dex_rewrite.h"
+
+#include <cstdio>
+#include <vector>
+#include <android/log.h>
+
+#include "dex_loader.h"
+#include "dex_checksum.h"
+#include "../dex/dex_container.h"
+
+#define LOG_TAG "DexRewrite"
+#define LOGI(...) __android_log_print(ANDROID_LOG_INFO, LOG_TAG, __VA_ARGS__)
+#define LOGE(...) __android_log_print(ANDROID_LOG_ERROR, LOG_TAG, __VA_ARGS__)
+
+namespace cyurs {
+    namespace dex_tools {
+
+        static bool rewrite_one(const dex::DexReader &reader, const std::string &location, const std::string &out_path,
+                                const dex::DexWriterOptions &options, dex::DexWriterStats &stats) {
+            std::vector<uint8_t> out;
+            dex::DexWriterStats dex_stats;
+            if (!dex::RewriteDex(reader, options, out, &dex_stats)) {
+                LOGE("rewrite %s failed", location.c_str());
+                return false;
+            }
+            fixup_dex_header(out.data(), out.size());
+            LOGI("%s: %s", location.c_str(), format_rewrite_stats(dex_stats).c_str());
+
+            stats.input_size += dex_stats.input_size;
+            stats.output_size += dex_stats.output_size;
+            stats.items += dex_stats.items;
+            stats.dedup_strings += dex_stats.dedup_strings;
+            stats.dedup_type_lists += dex_stats.dedup_type_lists;
+            stats.dedup_code_items += dex_stats.dedup_code_items;
+            stats.dedup_others += dex_stats.dedup_others;
+            return write_file(out_path, out.data(), out.size());
+        }
+
+        bool rewrite_dex_file(const std::string &dex_path, const std::string &out_path,
+                              const dex::DexWriterOptions &options, dex::DexWriterStats &stats) {
+            std::vector<DexImage> images = load_dex_images(dex_path);
+
+            // vdex / v41 容器中的每个 dex 都写成独立的标准 dex
+            std::vector<std::pair<std::string, dex::DexReader>> dex_files;
+            for (const DexImage &image: images) {
+                std::vector<dex::DexReader> readers = dex::OpenDexContainer(image.data.data(), image.data.size());
+                if (readers.empty()) LOGE("invalid dex %s", image.location.c_str());
+                for (size_t i = 0; i < readers.size(); ++i) {
+                    dex_files.emplace_back(dex_location(image, i, readers.size()), readers[i]);
+                }
+            }
+            if (dex_files.empty()) return false;
+
+            // 只有一个 dex 时直接写到 out_path，否则 out_path 为目录
+            if (dex_files.size() == 1) {
+                return rewrite_one(dex_files[0].second, dex_files[0].first, out_path, options, stats);
+            }
+            bool ok = true;
+            for (const auto &dex_file: dex_files) {
+                const std::string &location = dex_file.first;
+                std::string name = location.substr(location.rfind('!') + 1);
+                ok = rewrite_one(dex_file.second, location, out_path + "/" + name, options, stats) && ok;
+            }
+            return ok;
+        }
+
+        std::string format_rewrite_stats(const dex::DexWriterStats &stats) {
+            char buf[256];
+            snprintf(buf, sizeof(buf),
+                     "size=%u->%u items=%u dedup_strings=%u dedup_type_lists=%u dedup_code_items=%u dedup_others=%u",
+                     stats.input_size, stats.output_size, stats.items, stats.dedup_strings,
+                     stats.dedup_type_lists, stats.dedup_code_items, stats.dedup_others);
+            return buf;
+        }
+
+    } // namespace dex_tools
+};//namespace cyurs
@@ -0,0 +1,26 @@
+#ifndef CYURS_DEX_REWRITE_H
+#define CYURS_DEX_REWRITE_H
+
+#include <string>
+
+#include "../dex/dex_writer.h"
+
+/**
+ * 用 dex::RewriteDex 重新布局 dex 文件，并重新计算 checksum / signature
+ *
+ * 修复（dex_repair）后的 dex 中追加的数据没有登记到 map_list，重写后得到可被 ART 加载的规范 dex；
+ * vdex / cdex / v41 容器中的 dex 重写后得到独立的标准 dex，不需要再经过 dex2oat / vdexExtractor 转换。
+ */
+namespace cyurs {
+    namespace dex_tools {
+
+        // 重写 dex_path 中的 dex；apk / jar / vdex 中有多个 dex 时 out_path 为输出目录
+        bool rewrite_dex_file(const std::string &dex_path, const std::string &out_path,
+                              const dex::DexWriterOptions &options, dex::DexWriterStats &stats);
+
+        std::string format_rewrite_stats(const dex::DexWriterStats &stats);
+
+    } // namespace dex_tools
+};//namespace cyurs
+
+#endif //CYURS_DEX_REWRITE_H
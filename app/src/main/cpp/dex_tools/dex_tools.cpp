@@ -0,0 +1,295 @@
+#include <jni.h>
+#include <android/api-level.h>
+#include <android/log.h>
+#include <algorithm>
+#include <string>
+
+#include "dex_loader.h"
+#include "leb128_benchmark.h"
+#include "dex_repair.h"
+#include "dex_checksum.h"
+#include "dex_rewrite.h"
+#include "dex_dumper.h"
+#include "../dex/class_accessor.h"
+#include "../dex/dex_container.h"
+#include "../dex/name_index.h"
+#include "../dex/mutf8.h"
+#include "../dex/dex_disassembler.h"
+#include "../dex/dex_cookie.h"
+
+using namespace cyurs;
+
+#define LOG_TAG "DexTools"
+#define LOGI(...) __android_log_print(ANDROID_LOG_INFO, LOG_TAG, __VA_ARGS__)
+#define LOGE(...) __android_log_print(ANDROID_LOG_ERROR, LOG_TAG, __VA_ARGS__)
+
+static std::string jstring_to_string(JNIEnv *env, jstring str) {
+    if (str == nullptr) return {};
+    const char *chars = env->GetStringUTFChars(str, nullptr);
+    std::string result(chars);
+    env->ReleaseStringUTFChars(str, chars);
+    return result;
+}
+
+// dex 中的字符串是 MUTF-8，直接解码为 UTF-16 交给 NewString，不经过 NewStringUTF 的逐字节转换
+static jstring new_java_string(JNIEnv *env, std::string_view mutf8) {
+    uint16_t stack_buf[256];
+    std::vector<uint16_t> heap_buf;
+    uint16_t *utf16 = stack_buf;
+    if (mutf8.size() > sizeof(stack_buf) / sizeof(stack_buf[0])) {
+        heap_buf.resize(mutf8.size());
+        utf16 = heap_buf.data();
+    }
+    size_t length = dex::DecodeMutf8(mutf8, utf16);
+    return env->NewString(reinterpret_cast<const jchar *>(utf16), static_cast<jsize>(length));
+}
+
+static jobjectArray to_java_string_array(JNIEnv *env, const std::vector<std::string> &lines) {
+    jclass string_class = env->FindClass("java/lang/String");
+    jobjectArray result = env->NewObjectArray(static_cast<jsize>(lines.size()), string_class, nullptr);
+    for (size_t i = 0; i < lines.size(); ++i) {
+        jstring str = new_java_string(env, lines[i]);
+        env->SetObjectArrayElement(result, static_cast<jsize>(i), str);
+        env->DeleteLocalRef(str);
+    }
+    return result;
+}
+
+extern "C"
+JNIEXPORT jstring JNICALL
+Java_com_cyrus_example_dex_1tools_DexTools_benchmarkLeb128(JNIEnv *env, jclass clazz,
+                                                         jstring path, jint iterations) {
+    std::string dex_path = jstring_to_string(env, path);
+    std::vector<dex_tools::DexImage> images = dex_tools::load_dex_images(dex_path);
+    if (images.empty()) {
+        LOGE("no dex found in %s", dex_path.c_str());
+        return nullptr;
+    }
+
+    std::string report;
+    for (const dex_tools::DexImage &image: images) {
+        std::vector<dex::DexReader> readers = dex::OpenDexContainer(image.data.data(), image.data.size());
+        if (readers.empty()) {
+            LOGE("invalid dex %s", image.location.c_str());
+            continue;
+        }
+        for (size_t i = 0; i < readers.size(); ++i) {
+            dex_tools::Leb128BenchResult result = dex_tools::run_leb128_benchmark(readers[i], iterations);
+            std::string text = dex_tools::format_leb128_benchmark(
+                    dex_tools::dex_location(image, i, readers.size()), result);
+            LOGI("%s", text.c_str());
+            if (!report.empty()) report += "\n\n";
+            report += text;
+        }
+    }
+    return env->NewStringUTF(report.c_str());
+}
+
+extern "C"
+JNIEXPORT jobjectArray JNICALL
+Java_com_cyrus_example_dex_1tools_DexTools_listMethods(JNIEnv *env, jclass clazz, jstring path) {
+    std::string dex_path = jstring_to_string(env, path);
+    std::vector<dex_tools::DexImage> images = dex_tools::load_dex_images(dex_path);
+
+    std::vector<std::string> lines;
+    char buf[64];
+    for (const dex_tools::DexImage &image: images) {
+        std::vector<dex::DexReader> readers = dex::OpenDexContainer(image.data.data(), image.data.size());
+        if (readers.empty()) {
+            LOGE("invalid dex %s", image.location.c_str());
+            continue;
+        }
+
+        // 一次线性遍历全部 class_data，不加载任何类
+        for (const dex::DexReader &reader: readers) {
+            VisitAllMethods(reader, [&](uint32_t class_def_idx, const Method &method) {
+                uint32_t method_idx = method.GetIndex();
+                const dex::MethodId *method_id = reader.GetMethodId(method_idx);
+                if (method_id == nullptr) return;
+                dex::CodeItemInfo code_item;
+                bool has_code = reader.GetCodeItemInfo(method.GetCodeItemOffset(), dex::kDexNoIndex, &code_item);
+
+                std::string line;
+                line.append(reader.GetMethodDeclaringClassDescriptor(method_idx));
+                line.append("->");
+                line.append(reader.GetMethodName(method_idx));
+                line.append(" ");
+                line.append(reader.GetShorty(method_id->proto_idx_));
+                snprintf(buf, sizeof(buf), " idx=%u flags=0x%x code_off=0x%x insns=%u",
+                         method_idx, method.GetAccessFlags(), method.GetCodeItemOffset(),
+                         has_code ? code_item.insns_size : 0u);
+                line.append(buf);
+                lines.emplace_back(std::move(line));
+            });
+        }
+    }
+
+    return to_java_string_array(env, lines);
+}
+
+extern "C"
+JNIEXPORT jstring JNICALL
+Java_com_cyrus_example_dex_1tools_DexTools_repairDex(JNIEnv *env, jclass clazz, jstring dex_path,
+                                                   jstring dump_path, jstring out_path, jint threads) {
+    dex_tools::RepairOptions options;
+    options.threads = threads;
+    dex_tools::RepairStats stats;
+    bool ok = dex_tools::repair_dex_file(jstring_to_string(env, dex_path), jstring_to_string(env, dump_path),
+                                         jstring_to_string(env, out_path), options, stats);
+    if (!ok) return nullptr;
+    return env->NewStringUTF(dex_tools::format_repair_stats(stats).c_str());
+}
+
+extern "C"
+JNIEXPORT jboolean JNICALL
+Java_com_cyrus_example_dex_1tools_DexTools_fixDexHeader(JNIEnv *env, jclass clazz, jstring path) {
+    std::string dex_path = jstring_to_string(env, path);
+    std::vector<uint8_t> data;
+    if (!dex_tools::read_file(dex_path, data)) {
+        LOGE("read %s failed", dex_path.c_str());
+        return JNI_FALSE;
+    }
+    if (!dex_tools::fixup_dex_header(data.data(), data.size())) return JNI_FALSE;
+    LOGI("fixup %s (%s)", dex_path.c_str(), dex_tools::checksum_impl_name());
+    return dex_tools::write_file(dex_path, data.data(), data.size()) ? JNI_TRUE : JNI_FALSE;
+}
+
+extern "C"
+JNIEXPORT jstring JNICALL
+Java_com_cyrus_example_dex_1tools_DexTools_rewriteDex(JNIEnv *env, jclass clazz, jstring dex_path,
+                                                    jstring out_path, jboolean dedup_code_items) {
+    dex::DexWriterOptions options;
+    options.dedup_code_items = dedup_code_items == JNI_TRUE;
+    dex::DexWriterStats stats;
+    if (!dex_tools::rewrite_dex_file(jstring_to_string(env, dex_path), jstring_to_string(env, out_path),
+                                     options, stats)) {
+        return nullptr;
+    }
+    return env->NewStringUTF(dex_tools::format_rewrite_stats(stats).c_str());
+}
+
+extern "C"
+JNIEXPORT jobjectArray JNICALL
+Java_com_cyrus_example_dex_1tools_DexTools_findMethods(JNIEnv *env, jclass clazz, jstring path,
+                                                     jobjectArray symbols, jstring cache_dir) {
+    std::string dex_path = jstring_to_string(env, path);
+    std::string index_dir = cache_dir == nullptr ? std::string() : jstring_to_string(env, cache_dir);
+    std::vector<std::string> queries;
+    jsize num_symbols = symbols == nullptr ? 0 : env->GetArrayLength(symbols);
+    for (jsize i = 0; i < num_symbols; ++i) {
+        auto symbol = static_cast<jstring>(env->GetObjectArrayElement(symbols, i));
+        queries.emplace_back(jstring_to_string(env, symbol));
+        env->DeleteLocalRef(symbol);
+    }
+
+    std::vector<std::string> lines;
+    char buf[32];
+    std::vector<dex_tools::DexImage> images = dex_tools::load_dex_images(dex_path);
+    for (const dex_tools::DexImage &image: images) {
+        std::vector<dex::DexReader> readers = dex::OpenDexContainer(image.data.data(), image.data.size());
+        for (size_t i = 0; i < readers.size(); ++i) {
+            std::string location = dex_tools::dex_location(image, i, readers.size());
+            dex::MethodNameIndex index(readers[i]);
+            if (!index_dir.empty()) {
+                // 索引保存在缓存目录，按 dex 的 checksum + file_size 命名（加载时也按这两项校验）
+                const dex::Header &header = readers[i].GetHeader();
+                snprintf(buf, sizeof(buf), "/%08x_%08x.nidx", header.checksum_, header.file_size_);
+                std::string index_path = index_dir + buf;
+                if (!index.Load(index_path) && !index.Save(index_path)) {
+                    LOGI("save %s failed, index kept in memory", index_path.c_str());
+                }
+            }
+            for (const std::string &symbol: queries) {
+                uint32_t method_idx = index.FindSymbol(symbol);
+                if (method_idx == dex::kDexNoIndex) continue;
+                snprintf(buf, sizeof(buf), " idx=%u", method_idx);
+                lines.emplace_back(symbol + " -> " + location + buf);
+            }
+        }
+    }
+
+    return to_java_string_array(env, lines);
+}
+
+extern "C"
+JNIEXPORT jobjectArray JNICALL
+Java_com_cyrus_example_dex_1tools_DexTools_getStrings(JNIEnv *env, jclass clazz, jstring path,
+                                                    jint dex_index, jint start, jint count) {
+    std::string dex_path = jstring_to_string(env, path);
+    std::vector<dex_tools::DexImage> images = dex_tools::load_dex_images(dex_path);
+
+    // dex_index 按 listMethods 中 dex 出现的顺序计数
+    dex::DecodedStrings strings;
+    jint index = 0;
+    for (const dex_tools::DexImage &image: images) {
+        for (const dex::DexReader &reader: dex::OpenDexContainer(image.data.data(), image.data.size())) {
+            if (index++ != dex_index) continue;
+            if (start >= 0 && count > 0) {
+                dex::DecodeStringIds(reader, static_cast<uint32_t>(start), static_cast<uint32_t>(count), strings);
+            }
+        }
+    }
+
+    jclass string_class = env->FindClass("java/lang/String");
+    jobjectArray result = env->NewObjectArray(static_cast<jsize>(strings.size()), string_class, nullptr);
+    for (size_t i = 0; i < strings.size(); ++i) {
+        jstring str = env->NewString(reinterpret_cast<const jchar *>(strings.data(i)),
+                                     static_cast<jsize>(strings.length(i)));
+        env->SetObjectArrayElement(result, static_cast<jsize>(i), str);
+        env->DeleteLocalRef(str);
+    }
+    return result;
+}
+
+extern "C"
+JNIEXPORT jstring JNICALL
+Java_com_cyrus_example_dex_1tools_DexTools_disassemble(JNIEnv *env, jclass clazz, jstring path, jstring symbol) {
+    std::string dex_path = jstring_to_string(env, path);
+    std::string method_symbol = jstring_to_string(env, symbol);
+
+    std::string text;
+    std::vector<dex_tools::DexImage> images = dex_tools::load_dex_images(dex_path);
+    for (const dex_tools::DexImage &image: images) {
+        std::vector<dex::DexReader> readers = dex::OpenDexContainer(image.data.data(), image.data.size());
+        for (size_t i = 0; i < readers.size(); ++i) {
+            const dex::DexReader &reader = readers[i];
+            uint32_t method_idx = dex::MethodNameIndex(reader).FindSymbol(method_symbol);
+            if (method_idx == dex::kDexNoIndex) continue;
+
+            // 同一个方法只在一个 class_def 中定义
+            VisitAllMethods(reader, [&](uint32_t class_def_idx, const Method &method) {
+                if (method.GetIndex() != method_idx) return;
+                text.append("# ").append(dex_tools::dex_location(image, i, readers.size())).append("\n");
+                if (!dex::DisassembleMethod(reader, method_idx, method.GetCodeItemOffset(), text)) {
+                    text.append("<no code>\n");
+                }
+            });
+        }
+    }
+    return text.empty() ? nullptr : new_java_string(env, text);
+}
+
+extern "C"
+JNIEXPORT jstring JNICALL
+Java_com_cyrus_example_dex_1tools_DexTools_dumpLoadedDex(JNIEnv *env, jclass clazz, jobjectArray class_loaders,
+                                                       jstring out_dir, jint threads) {
+    int sdk_level = android_get_device_api_level();
+    std::vector<const void *> dex_files;
+    jsize count = class_loaders == nullptr ? 0 : env->GetArrayLength(class_loaders);
+    for (jsize i = 0; i < count; ++i) {
+        jobject loader = env->GetObjectArrayElement(class_loaders, i);
+        CollectDexFiles(env, loader, sdk_level, dex_files);
+        env->DeleteLocalRef(loader);
+    }
+    // 多个 ClassLoader 共享 parent 时同一个 DexFile 会重复出现
+    std::sort(dex_files.begin(), dex_files.end());
+    dex_files.erase(std::unique(dex_files.begin(), dex_files.end()), dex_files.end());
+
+    dex_tools::DumpOptions options;
+    options.threads = threads;
+    dex_tools::DumpStats stats;
+    if (!dex_tools::dump_dex_files(dex_files, sdk_level, jstring_to_string(env, out_dir), options, stats)) {
+        return nullptr;
+    }
+    return env->NewStringUTF(dex_tools::format_dump_stats(stats).c_str());
+}
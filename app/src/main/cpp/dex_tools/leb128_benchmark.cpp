@@ -0,0 +1,161 @@
+#include "leb128_benchmark.h"
+
+#include <time.h>
+#include <cstdio>
+#include <vector>
+
+namespace cyurs {
+    namespace dex_tools {
+
+        using namespace dex;
+
+        // class_data_item 头部的 4 个 uleb128
+        static constexpr size_t kClassDataHeaderValues = 4;
+
+        static uint64_t now_ns() {
+            struct timespec ts{};
+            clock_gettime(CLOCK_MONOTONIC, &ts);
+            return static_cast<uint64_t>(ts.tv_sec) * 1000000000ULL + ts.tv_nsec;
+        }
+
+        // 一个类的 class data 中 field / method 部分的 uleb128 个数
+        static uint64_t member_value_count(const uint32_t *header) {
+            return (static_cast<uint64_t>(header[0]) + header[1]) * 2 +
+                   (static_cast<uint64_t>(header[2]) + header[3]) * 3;
+        }
+
+        // 用于防止结果被优化掉，同时校验各实现一致
+        struct DecodeStats {
+            uint64_t values = 0;
+            uint64_t bytes = 0;
+            uint64_t hash = 0;
+
+            void add(uint32_t value) {
+                hash = (hash ^ value) * 0x100000001b3ULL;
+                ++values;
+            }
+        };
+
+        static DecodeStats decode_slow(const DexReader &reader) {
+            DecodeStats stats;
+            for (uint32_t i = 0; i < reader.NumClassDefs(); ++i) {
+                const uint8_t *ptr = reader.GetClassData(*reader.GetClassDef(i));
+                if (ptr == nullptr) continue;
+                const uint8_t *begin = ptr;
+
+                uint32_t header[kClassDataHeaderValues];
+                for (uint32_t &value: header) {
+                    value = DecodeUnsignedLeb128Slow(&ptr);
+                    stats.add(value);
+                }
+                for (uint64_t n = member_value_count(header); n > 0; --n) {
+                    stats.add(DecodeUnsignedLeb128Slow(&ptr));
+                }
+                stats.bytes += ptr - begin;
+            }
+            return stats;
+        }
+
+        static DecodeStats decode_fast(const DexReader &reader) {
+            DecodeStats stats;
+            const uint8_t *end = reader.DataBegin() + reader.DataSize();
+            for (uint32_t i = 0; i < reader.NumClassDefs(); ++i) {
+                const uint8_t *ptr = reader.GetClassData(*reader.GetClassDef(i));
+                if (ptr == nullptr) continue;
+                const uint8_t *begin = ptr;
+
+                uint32_t header[kClassDataHeaderValues];
+                bool ok = true;
+                for (uint32_t &value: header) {
+                    ok = ok && DecodeUnsignedLeb128Checked(&ptr, end, &value);
+                    if (ok) stats.add(value);
+                }
+                for (uint64_t n = ok ? member_value_count(header) : 0; n > 0; --n) {
+                    uint32_t value;
+                    if (!DecodeUnsignedLeb128Checked(&ptr, end, &value)) break;
+                    stats.add(value);
+                }
+                stats.bytes += ptr - begin;
+            }
+            return stats;
+        }
+
+        static DecodeStats decode_bulk(const DexReader &reader, std::vector<uint32_t> &scratch) {
+            DecodeStats stats;
+            const uint8_t *end = reader.DataBegin() + reader.DataSize();
+            for (uint32_t i = 0; i < reader.NumClassDefs(); ++i) {
+                const uint8_t *ptr = reader.GetClassData(*reader.GetClassDef(i));
+                if (ptr == nullptr) continue;
+                const uint8_t *begin = ptr;
+
+                uint32_t header[kClassDataHeaderValues];
+                size_t n = DecodeUnsignedLeb128Bulk(&ptr, end, header, kClassDataHeaderValues);
+                for (size_t k = 0; k < n; ++k) stats.add(header[k]);
+                if (n == kClassDataHeaderValues) {
+                    uint64_t count = member_value_count(header);
+                    if (scratch.size() < count) scratch.resize(count);
+                    n = DecodeUnsignedLeb128Bulk(&ptr, end, scratch.data(), count);
+                    for (size_t k = 0; k < n; ++k) stats.add(scratch[k]);
+                }
+                stats.bytes += ptr - begin;
+            }
+            return stats;
+        }
+
+        Leb128BenchResult run_leb128_benchmark(const DexReader &reader, int iterations) {
+            Leb128BenchResult result;
+            if (!reader.IsValid()) return result;
+            if (iterations <= 0) iterations = 1;
+            result.iterations = iterations;
+
+            for (uint32_t i = 0; i < reader.NumClassDefs(); ++i) {
+                if (reader.GetClassData(*reader.GetClassDef(i)) != nullptr) ++result.classes;
+            }
+
+            std::vector<uint32_t> scratch;
+            DecodeStats slow, fast, bulk;
+
+            uint64_t start = now_ns();
+            for (int i = 0; i < iterations; ++i) slow = decode_slow(reader);
+            result.slow_ns = now_ns() - start;
+
+            start = now_ns();
+            for (int i = 0; i < iterations; ++i) fast = decode_fast(reader);
+            result.fast_ns = now_ns() - start;
+
+            start = now_ns();
+            for (int i = 0; i < iterations; ++i) bulk = decode_bulk(reader, scratch);
+            result.bulk_ns = now_ns() - start;
+
+            result.values = slow.values;
+            result.bytes = slow.bytes;
+            result.match = slow.values == fast.values && slow.hash == fast.hash && slow.bytes == fast.bytes &&
+                           slow.values == bulk.values && slow.hash == bulk.hash && slow.bytes == bulk.bytes;
+            return result;
+        }
+
+        std::string format_leb128_benchmark(const std::string &location, const Leb128BenchResult &result) {
+            auto per_value = [&](uint64_t ns) {
+                uint64_t total = result.values * static_cast<uint64_t>(result.iterations);
+                return total == 0 ? 0.0 : static_cast<double>(ns) / total;
+            };
+            auto speedup = [&](uint64_t ns) {
+                return ns == 0 ? 0.0 : static_cast<double>(result.slow_ns) / ns;
+            };
+
+            char buf[512];
+            snprintf(buf, sizeof(buf),
+                     "%s\nclasses=%u values=%llu bytes=%llu iterations=%d match=%s\n"
+                     "slow: %.2f ns/value\nfast: %.2f ns/value (x%.2f)\nbulk: %.2f ns/value (x%.2f)",
+                     location.c_str(), result.classes,
+                     static_cast<unsigned long long>(result.values),
+                     static_cast<unsigned long long>(result.bytes),
+                     result.iterations, result.match ? "true" : "false",
+                     per_value(result.slow_ns),
+                     per_value(result.fast_ns), speedup(result.fast_ns),
+                     per_value(result.bulk_ns), speedup(result.bulk_ns));
+            return buf;
+        }
+
+    } // namespace dex_tools
+};//namespace cyurs
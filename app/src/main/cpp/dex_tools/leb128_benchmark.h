@@ -0,0 +1,39 @@
+#ifndef CYURS_LEB128_BENCHMARK_H
+#define CYURS_LEB128_BENCHMARK_H
+
+#include <stdint.h>
+#include <string>
+
+#include "../dex/dex_reader.h"
+
+/**
+ * LEB128 解码微基准
+ *
+ * 解码 dex 中全部 class_data_item，分别用逐字节参考实现、带快速路径的单值解码和批量解码，
+ * 比较耗时并校验三者结果一致。
+ */
+namespace cyurs {
+    namespace dex_tools {
+
+        struct Leb128BenchResult {
+            uint32_t classes = 0;
+            // 单轮解码的值个数和字节数
+            uint64_t values = 0;
+            uint64_t bytes = 0;
+            int iterations = 0;
+            // 每种实现的总耗时
+            uint64_t slow_ns = 0;
+            uint64_t fast_ns = 0;
+            uint64_t bulk_ns = 0;
+            // 三种实现的解码结果一致
+            bool match = false;
+        };
+
+        Leb128BenchResult run_leb128_benchmark(const dex::DexReader &reader, int iterations);
+
+        std::string format_leb128_benchmark(const std::string &location, const Leb128BenchResult &result);
+
+    } // namespace dex_tools
+};//namespace cyurs
+
+#endif //CYURS_LEB128_BENCHMARK_H
@@ -0,0 +1,60 @@
+/**
+ * ARMv8 SHA1 指令实现的 SHA-1 压缩函数
+ *
+ * 只在 arm64 上以 -march=armv8-a+crypto 编译，运行时由 dex_checksum.cpp 根据 HWCAP_SHA1 决定是否调用。
+ */
+#if defined(__aarch64__) && (defined(__ARM_FEATURE_CRYPTO) || defined(__ARM_FEATURE_SHA2))
+
+#include <stddef.h>
+#include <stdint.h>
+#include <arm_neon.h>
+
+namespace cyurs {
+    namespace dex_tools {
+
+        void sha1_blocks_armv8(uint32_t state[5], const uint8_t *data, size_t blocks) {
+            static const uint32_t kK[4] = {0x5A827999, 0x6ED9EBA1, 0x8F1BBCDC, 0xCA62C1D6};
+
+            uint32x4_t abcd = vld1q_u32(state);
+            uint32_t e = state[4];
+
+            while (blocks-- > 0) {
+                const uint32x4_t abcd_saved = abcd;
+                const uint32_t e_saved = e;
+
+                // 80 个消息字，每 4 个一组
+                uint32x4_t w[20];
+                for (int i = 0; i < 4; ++i) {
+                    w[i] = vreinterpretq_u32_u8(vrev32q_u8(vld1q_u8(data + i * 16)));
+                }
+                for (int i = 4; i < 20; ++i) {
+                    w[i] = vsha1su1q_u32(vsha1su0q_u32(w[i - 4], w[i - 3], w[i - 2]), w[i - 1]);
+                }
+
+                // 每条指令完成 4 轮：0-19 选择函数，20-39 / 60-79 奇偶校验，40-59 多数函数
+                for (int i = 0; i < 20; ++i) {
+                    uint32_t e_next = vsha1h_u32(vgetq_lane_u32(abcd, 0));
+                    uint32x4_t wk = vaddq_u32(w[i], vdupq_n_u32(kK[i / 5]));
+                    if (i < 5) {
+                        abcd = vsha1cq_u32(abcd, e, wk);
+                    } else if (i < 10 || i >= 15) {
+                        abcd = vsha1pq_u32(abcd, e, wk);
+                    } else {
+                        abcd = vsha1mq_u32(abcd, e, wk);
+                    }
+                    e = e_next;
+                }
+
+                abcd = vaddq_u32(abcd, abcd_saved);
+                e += e_saved;
+                data += 64;
+            }
+
+            vst1q_u32(state, abcd);
+            state[4] = e;
+        }
+
+    } // namespace dex_tools
+};//namespace cyurs
+
+#endif
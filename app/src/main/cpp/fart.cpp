@@ -1,14 +1,26 @@
 #include <jni.h>
 #include <unistd.h>
+#include <string.h>
 #include <string>
 #include <android/log.h>
 #include <sstream>
 #include <signal.h>
 #include <set>
 #include <vector>
-#include <fstream>
+#include <unordered_map>
+#include <algorithm>
 #include <dlfcn.h>
-#include <regex>
+#include "maps/proc_maps.h"
+#include "fart/signature_scan.h"
+#include "fart/maps_watcher.h"
+#include "fart/anon_dex_scanner.h"
+#include "dex/art_method.h"
+#include "dex/dex_cookie.h"
+#include "dex/dex_file_info.h"
+#include "dex/dex_reader.h"
+#include <android/api-level.h>
+
+using namespace cyurs;
 
 #define LOG_TAG "AntiFART"
 #define LOGI(...) __android_log_print(ANDROID_LOG_INFO, LOG_TAG, __VA_ARGS__)
@@ -110,22 +122,357 @@ Java_com_cyrus_example_fart_AntiFART_dumpMethods(JNIEnv *env, jclass, jstring cl
 }
 
 
+// JNI_OnLoad 中缓存的 jclass / jmethodID，避免每次 dump 都重新查找
+static struct {
+    int sdk_level = 0;
+    jclass class_class = nullptr;
+    jmethodID get_declared_methods = nullptr;
+    jmethodID get_class_loader = nullptr;
+    jclass method_class = nullptr;
+    jmethodID method_to_string = nullptr;
+    jmethodID method_get_name = nullptr;
+    // Executable.artMethod，jmethodID 不是 ArtMethod* 时使用（可能被 hidden api 拦截）
+    jfieldID executable_art_method = nullptr;
+} g_reflect;
+
 extern "C"
-JNIEXPORT jobjectArray JNICALL
-Java_com_cyrus_example_fart_AntiFART_listLoadedFiles(JNIEnv *env, jclass) {
-    std::ifstream maps("/proc/self/maps");
-    std::string line;
-    std::vector<std::string> paths;
-
-    while (std::getline(maps, line)) {
-        std::size_t pathPos = line.find('/');
-        if (pathPos != std::string::npos) {
-            std::string path = line.substr(pathPos);
-            if (std::find(paths.begin(), paths.end(), path) == paths.end()) {
-                paths.push_back(path);
+JNIEXPORT jint JNICALL
+JNI_OnLoad(JavaVM *vm, void *) {
+    JNIEnv *env = nullptr;
+    if (vm->GetEnv(reinterpret_cast<void **>(&env), JNI_VERSION_1_6) != JNI_OK) {
+        return JNI_ERR;
+    }
+
+    g_reflect.sdk_level = android_get_device_api_level();
+
+    jclass classClass = env->FindClass("java/lang/Class");
+    g_reflect.class_class = static_cast<jclass>(env->NewGlobalRef(classClass));
+    g_reflect.get_declared_methods = env->GetMethodID(classClass, "getDeclaredMethods", "()[Ljava/lang/reflect/Method;");
+    g_reflect.get_class_loader = env->GetMethodID(classClass, "getClassLoader", "()Ljava/lang/ClassLoader;");
+    env->DeleteLocalRef(classClass);
+
+    jclass methodClass = env->FindClass("java/lang/reflect/Method");
+    g_reflect.method_class = static_cast<jclass>(env->NewGlobalRef(methodClass));
+    g_reflect.method_to_string = env->GetMethodID(methodClass, "toString", "()Ljava/lang/String;");
+    g_reflect.method_get_name = env->GetMethodID(methodClass, "getName", "()Ljava/lang/String;");
+    env->DeleteLocalRef(methodClass);
+
+    jclass executableClass = env->FindClass("java/lang/reflect/Executable");
+    if (executableClass != nullptr) {
+        g_reflect.executable_art_method = env->GetFieldID(executableClass, "artMethod", "J");
+        env->DeleteLocalRef(executableClass);
+    }
+    if (env->ExceptionCheck()) {
+        env->ExceptionClear(); // 拿不到就退回 FromReflectedMethod
+        g_reflect.executable_art_method = nullptr;
+    }
+
+    return JNI_VERSION_1_6;
+}
+
+namespace {
+
+    constexpr uint32_t kMethodDumpMagic = 0x504d444d;  // "MDMP"
+    constexpr uint16_t kMethodDumpVersion = 2;
+    constexpr uint32_t kNoDexMethodIndex = 0xFFFFFFFF;
+    constexpr uint32_t kClassNotFound = 0xFFFFFFFF;
+    // dex 规范中定义的 access flags（去掉 ART 运行时标志位）
+    constexpr uint32_t kAccDexFlagsMask = 0x3FFFF;
+
+    class MethodDumpWriter {
+    public:
+        void u16(uint16_t v) { append(&v, sizeof(v)); }
+
+        void u32(uint32_t v) { append(&v, sizeof(v)); }
+
+        // u16 长度 + MUTF-8 字节，直接 GetStringUTFRegion 到输出缓冲区，不创建中间 C 字符串
+        void jstr(JNIEnv *env, jstring str) {
+            if (str == nullptr) {
+                u16(0);
+                return;
+            }
+            jsize utf_len = env->GetStringUTFLength(str);
+            jsize len = env->GetStringLength(str);
+            if (utf_len > 0xFFFF) utf_len = 0;
+            u16(static_cast<uint16_t>(utf_len));
+            if (utf_len == 0) return;
+            size_t pos = buf_.size();
+            // GetStringUTFRegion 会在末尾写 '\0'
+            buf_.resize(pos + utf_len + 1);
+            env->GetStringUTFRegion(str, 0, len, reinterpret_cast<char *>(&buf_[pos]));
+            buf_.resize(pos + utf_len);
+        }
+
+        // 与 jstr 一致，超过 u16 的数据写为空，不破坏后面的记录
+        void bytes(const char *data, size_t size) {
+            if (size > 0xFFFF) size = 0;
+            u16(static_cast<uint16_t>(size));
+            append(data, size);
+        }
+
+        // 改写已经写入的 u32（如最后才知道的个数）
+        void patch_u32(size_t pos, uint32_t v) { memcpy(&buf_[pos], &v, sizeof(v)); }
+
+        size_t size() const { return buf_.size(); }
+
+        const std::vector<uint8_t> &data() const { return buf_; }
+
+        void reserve(size_t n) { buf_.reserve(n); }
+
+    private:
+        void append(const void *p, size_t n) {
+            const auto *b = static_cast<const uint8_t *>(p);
+            buf_.insert(buf_.end(), b, b + n);
+        }
+
+        std::vector<uint8_t> buf_;
+    };
+
+    // 通过 ArtMethod 读取 dex_method_index_ 和 access_flags_
+    bool read_art_method(JNIEnv *env, jobject methodObj, uint32_t &dex_method_index, uint32_t &access_flags) {
+        uintptr_t art_method = reinterpret_cast<uintptr_t>(env->FromReflectedMethod(methodObj));
+        // Android 11+ 的 jmethodID 可能是索引（最低位为 1），此时读 Executable.artMethod
+        if ((art_method & 1) != 0 || art_method == 0) {
+            if (g_reflect.executable_art_method == nullptr) return false;
+            art_method = static_cast<uintptr_t>(env->GetLongField(methodObj, g_reflect.executable_art_method));
+            if (art_method == 0) return false;
+        }
+
+        if (g_reflect.sdk_level >= 31) {
+            auto *method = reinterpret_cast<const V31::ArtMethod *>(art_method);
+            dex_method_index = method->dex_method_index_;
+            access_flags = method->access_flags_;
+        } else {
+            auto *method = reinterpret_cast<const V28::ArtMethod *>(art_method);
+            dex_method_index = method->dex_method_index_;
+            access_flags = method->access_flags_;
+        }
+        access_flags &= kAccDexFlagsMask;
+        return true;
+    }
+
+    /**
+     * 到声明类所在的 dex 中解析 dex_method_idx 的签名
+     *
+     * 按 ClassLoader 缓存其中的 dex（dexElements 顺序，含 parent），类描述符 -> 定义它的 dex，
+     * 同名类以第一个定义为准，和 ClassLoader 的查找顺序一致。只在一次 dump 内有效。
+     */
+    class DexSignatureResolver {
+    public:
+        void Release(JNIEnv *env) {
+            for (LoaderDexes &entry: loaders_) env->DeleteGlobalRef(entry.loader);
+            loaders_.clear();
+        }
+
+        /**
+         * @param descriptor 类描述符，如 Lcom/foo/Bar;
+         * @return 定义 clazz 的 dex，boot class 或找不到时返回 nullptr
+         */
+        const dex::DexReader *FindDex(JNIEnv *env, jclass clazz, const std::string &descriptor) {
+            if (g_reflect.get_class_loader == nullptr) return nullptr;
+            jobject loader = env->CallObjectMethod(clazz, g_reflect.get_class_loader);
+            if (env->ExceptionCheck()) {
+                env->ExceptionClear();
+                loader = nullptr;
+            }
+            if (loader == nullptr) return nullptr;
+
+            LoaderDexes *entry = nullptr;
+            for (LoaderDexes &candidate: loaders_) {
+                if (env->IsSameObject(candidate.loader, loader)) {
+                    entry = &candidate;
+                    break;
+                }
+            }
+            if (entry == nullptr) entry = &Load(env, loader);
+            env->DeleteLocalRef(loader);
+
+            auto it = entry->class_dex.find(descriptor);
+            return it == entry->class_dex.end() ? nullptr : &entry->readers[it->second];
+        }
+
+        // (参数描述符...)返回值描述符，与 method_ids 中声明类不符时返回 false
+        static bool GetSignature(const dex::DexReader &reader, uint32_t method_idx, const std::string &descriptor,
+                                 std::string &signature) {
+            if (method_idx >= reader.NumMethodIds() ||
+                reader.GetMethodDeclaringClassDescriptor(method_idx) != descriptor) {
+                return false;
+            }
+            const dex::ProtoId *proto = reader.GetProtoId(reader.GetMethodId(method_idx)->proto_idx_);
+            if (proto == nullptr) return false;
+            signature.assign("(");
+            if (const dex::TypeList *params = reader.GetProtoParameters(*proto)) {
+                for (uint32_t i = 0; i < params->size_; ++i) {
+                    signature.append(reader.GetTypeDescriptor(params->list_[i].type_idx_));
+                }
+            }
+            signature.push_back(')');
+            signature.append(reader.GetTypeDescriptor(proto->return_type_idx_));
+            return true;
+        }
+
+    private:
+        struct LoaderDexes {
+            jobject loader = nullptr;
+            std::vector<dex::DexReader> readers;
+            // 指向 dex 内存中的描述符
+            std::unordered_map<std::string_view, uint32_t> class_dex;
+        };
+
+        LoaderDexes &Load(JNIEnv *env, jobject loader) {
+            LoaderDexes &entry = loaders_.emplace_back();
+            entry.loader = env->NewGlobalRef(loader);
+
+            std::vector<const void *> dex_files;
+            CollectDexFiles(env, loader, g_reflect.sdk_level, dex_files);
+            DexFileInfo info;
+            for (const void *dex_file: dex_files) {
+                if (!GetDexFileInfo(dex_file, g_reflect.sdk_level, &info)) continue;
+                dex::DexReader reader(info.begin, info.size);
+                if (!reader.IsValid()) continue;
+                auto index = static_cast<uint32_t>(entry.readers.size());
+                for (uint32_t i = 0; i < reader.NumClassDefs(); ++i) {
+                    entry.class_dex.emplace(reader.GetClassDescriptor(*reader.GetClassDef(i)), index);
+                }
+                entry.readers.push_back(reader);
+            }
+            return entry;
+        }
+
+        std::vector<LoaderDexes> loaders_;
+    };
+
+} // namespace
+
+
+/**
+ * 批量 dump 多个类的方法
+ *
+ * 返回紧凑的二进制（小端）：
+ *   u32 magic "MDMP" | u16 version | u16 reserved | u32 class_count
+ *   每个类：u16 name_len | name | u32 method_count（0xFFFFFFFF 表示类不存在）
+ *     每个方法：u32 dex_method_idx | u32 access_flags | u32 dex_checksum | u16 len | name | u16 len | descriptor
+ *
+ * dex_method_idx 直接从 ArtMethod.dex_method_index_ 读取，到声明类所在 dex（ClassLoader 的 mCookie）的 method_ids
+ * 中解析签名，descriptor 为 (参数)返回值，dex_checksum 为该 dex 的 checksum，多 dex 时可以区分索引属于哪个 dex；
+ * 方法名取自 dex；读不到 ArtMethod 或找不到 dex（如 boot class）时 dex_checksum 为 0，
+ * name 退回 Method.getName()，descriptor 退回 Method.toString()。
+ */
+extern "C"
+JNIEXPORT jbyteArray JNICALL
+Java_com_cyrus_example_fart_AntiFART_dumpMethodsBulk(JNIEnv *env, jclass, jobjectArray classNames) {
+    if (g_reflect.get_declared_methods == nullptr || classNames == nullptr) {
+        return nullptr;
+    }
+
+    jsize classCount = env->GetArrayLength(classNames);
+    MethodDumpWriter writer;
+    writer.reserve(static_cast<size_t>(classCount) * 256);
+    writer.u32(kMethodDumpMagic);
+    writer.u16(kMethodDumpVersion);
+    writer.u16(0);
+    // 中途失败时改为实际写入的类数
+    size_t classCountPos = writer.size();
+    writer.u32(static_cast<uint32_t>(classCount));
+
+    DexSignatureResolver resolver;
+    std::string classPath;
+    std::string descriptor;
+    std::string signature;
+    jsize c = 0;
+    for (; c < classCount; ++c) {
+        // 每个类单独一个 local frame，避免 local ref 表溢出
+        if (env->PushLocalFrame(64) != JNI_OK) {
+            env->ExceptionClear();
+            break;
+        }
+
+        auto className = static_cast<jstring>(env->GetObjectArrayElement(classNames, c));
+        jsize utf_len = className ? env->GetStringUTFLength(className) : 0;
+        classPath.resize(utf_len + 1);
+        if (className) {
+            env->GetStringUTFRegion(className, 0, env->GetStringLength(className), &classPath[0]);
+        }
+        classPath.resize(utf_len);
+        writer.bytes(classPath.data(), classPath.size());
+
+        // 替换 . 为 /，Java 类名用点，JNI 中要用斜杠
+        std::replace(classPath.begin(), classPath.end(), '.', '/');
+        jclass clazz = classPath.empty() ? nullptr : env->FindClass(classPath.c_str());
+        if (env->ExceptionCheck()) {
+            env->ExceptionClear();
+            clazz = nullptr;
+        }
+
+        auto methodArray = clazz ? static_cast<jobjectArray>(env->CallObjectMethod(clazz, g_reflect.get_declared_methods)) : nullptr;
+        if (env->ExceptionCheck()) {
+            env->ExceptionClear();
+            methodArray = nullptr;
+        }
+        if (methodArray == nullptr) {
+            writer.u32(kClassNotFound);
+            env->PopLocalFrame(nullptr);
+            continue;
+        }
+
+        descriptor.assign("L").append(classPath).push_back(';');
+        const dex::DexReader *reader = resolver.FindDex(env, clazz, descriptor);
+
+        jsize len = env->GetArrayLength(methodArray);
+        writer.u32(static_cast<uint32_t>(len));
+        for (jsize i = 0; i < len; ++i) {
+            jobject methodObj = env->GetObjectArrayElement(methodArray, i);
+
+            uint32_t dex_method_index = kNoDexMethodIndex;
+            uint32_t access_flags = 0;
+            bool resolved = read_art_method(env, methodObj, dex_method_index, access_flags) && reader != nullptr &&
+                            DexSignatureResolver::GetSignature(*reader, dex_method_index, descriptor, signature);
+
+            writer.u32(dex_method_index);
+            writer.u32(access_flags);
+            writer.u32(resolved ? reader->GetHeader().checksum_ : 0);
+
+            // 方法名直接取 dex 中的 MUTF-8 字符串，解析不到时才调用 Method.getName()
+            std::string_view dex_name = resolved ? reader->GetMethodName(dex_method_index) : std::string_view();
+            if (!dex_name.empty()) {
+                writer.bytes(dex_name.data(), dex_name.size());
+            } else {
+                auto name = static_cast<jstring>(env->CallObjectMethod(methodObj, g_reflect.method_get_name));
+                writer.jstr(env, name);
+                if (name) env->DeleteLocalRef(name);
+            }
+
+            if (resolved) {
+                writer.bytes(signature.data(), signature.size());
+            } else {
+                auto desc = static_cast<jstring>(env->CallObjectMethod(methodObj, g_reflect.method_to_string));
+                writer.jstr(env, desc);
+                if (desc) env->DeleteLocalRef(desc);
             }
+            env->DeleteLocalRef(methodObj);
         }
+
+        env->PopLocalFrame(nullptr);
     }
+    resolver.Release(env);
+    if (c != classCount) writer.patch_u32(classCountPos, static_cast<uint32_t>(c));
+
+    jbyteArray result = env->NewByteArray(static_cast<jsize>(writer.size()));
+    if (result != nullptr) {
+        env->SetByteArrayRegion(result, 0, static_cast<jsize>(writer.size()),
+                                reinterpret_cast<const jbyte *>(writer.data().data()));
+    }
+    return result;
+}
+
+
+extern "C"
+JNIEXPORT jobjectArray JNICALL
+Java_com_cyrus_example_fart_AntiFART_listLoadedFiles(JNIEnv *env, jclass) {
+    // 只保留文件映射，按第一次出现的顺序去重
+    std::vector<std::string> paths = maps::collect_unique_paths([](const maps::MapEntry &entry) {
+        return entry.is_file();
+    });
 
     jclass stringClass = env->FindClass("java/lang/String");
     jobjectArray result = env->NewObjectArray(paths.size(), stringClass, nullptr);
@@ -165,82 +512,21 @@ Java_com_cyrus_example_fart_AntiFART_hasSymbolInSO(JNIEnv *env, jclass, jstring
     return result;
 }
 
-// so 黑名单函数特征
-std::vector<std::string> so_symbols_blacklist = {
-        "dumpDexFileByExecute",
-        "dumpArtMethod",
-        "myfartInvoke",
-        "DexFile_dumpMethodCode"
-};
-
 // 读取 /proc/self/maps 获取加载的 .so 路径
-std::set<std::string> get_loaded_so_paths() {
-    std::set<std::string> so_paths;
-    std::ifstream maps("/proc/self/maps");
-    std::string line;
-    std::regex so_regex(".+\\.so(\\s|$)");
-
-    while (std::getline(maps, line)) {
-        std::size_t path_pos = line.find('/');
-        if (path_pos != std::string::npos) {
-            std::string path = line.substr(path_pos);
-            if (std::regex_search(path, so_regex)) {
-                so_paths.insert(path);
-            }
-        }
-    }
-    return so_paths;
-}
-
-// 读取文件内容为字符串
-std::string read_file_content(const std::string &path) {
-    FILE *file = fopen(path.c_str(), "rb");
-    if (!file) {
-        LOGI("Failed to open: %s", path.c_str());
-        return "";
-    }
-
-    fseek(file, 0, SEEK_END);
-    long size = ftell(file);
-    rewind(file);
-
-    std::string buffer(size, 0);
-    fread(&buffer[0], 1, size, file);
-    fclose(file);
-
-    return buffer;
-}
-
-// 单词边界检查
-bool is_word_boundary(char ch) {
-    return !std::isalnum(static_cast<unsigned char>(ch)) && ch != '_';
-}
-
-// 返回匹配到的特征列表
-std::vector<std::string> get_matched_signatures(const std::string &content, const std::vector<std::string> &patterns) {
-    std::vector<std::string> matched;
-    for (const auto &pattern : patterns) {
-        size_t pos = content.find(pattern);
-        if (pos != std::string::npos) {
-            // 类似 DexFile_dumpMethodCode 这种，带 _ 的不需要做边界检查
-            if (pattern.find('_') != std::string::npos) {
-                matched.push_back(pattern);
-            }else{
-                // 单词边界检查
-                // 这样就不会匹配 farther、himmelfart，但可以匹配像 void fart()、"fart"、 call fart 等形式。
-                char prev = (pos == 0) ? '\0' : content[pos - 1];
-                char next = (pos + pattern.length() < content.size()) ? content[pos + pattern.length()] : '\0';
-
-                if (is_word_boundary(prev) && is_word_boundary(next)) {
-                    matched.push_back(pattern);
-                }
-            }
-        }
-    }
-    return matched;
+std::set<std::string, std::less<>> get_loaded_so_paths() {
+    maps::PathDeduper deduper;
+    maps::MapsReader reader;
+    reader.for_each(
+            [](const maps::MapEntry &entry) {
+                return entry.is_file() && maps::path_has_extension(entry.path, ".so");
+            },
+            [&](const maps::MapEntry &entry) {
+                deduper.insert(entry.path);
+                return true;
+            });
+    return deduper.paths();
 }
 
-
 // JNI 方法：检测已加载 .so 中是否包含黑名单符号
 extern "C"
 JNIEXPORT jobjectArray JNICALL
@@ -248,19 +534,15 @@ Java_com_cyrus_example_fart_AntiFART_detectFartInLoadedSO(JNIEnv *env, jclass cl
     std::vector<std::string> detected_logs;
     auto so_paths = get_loaded_so_paths();
 
+    SignatureMatcher matcher(so_symbols_blacklist);
     for (const auto &path: so_paths) {
-        std::string content = read_file_content(path);
-        if (!content.empty()) {
-            std::vector<std::string> matched = get_matched_signatures(content, so_symbols_blacklist);
-            if (!matched.empty()) {
-                std::ostringstream oss;
-                oss << "[FART DETECTED] " << path << " => ";
-                for (size_t i = 0; i < matched.size(); ++i) {
-                    oss << matched[i];
-                    if (i != matched.size() - 1) oss << ", ";
-                }
-                LOGI("%s", oss.str().c_str());
-                detected_logs.push_back(oss.str());
+        matcher.reset();
+        if (scan_file(path, matcher)) {
+            matcher.finish();
+            if (matcher.any()) {
+                std::string log = format_detection(path, matcher.matched());
+                LOGI("%s", log.c_str());
+                detected_logs.push_back(log);
             }
         }
     }
@@ -275,34 +557,19 @@ Java_com_cyrus_example_fart_AntiFART_detectFartInLoadedSO(JNIEnv *env, jclass cl
 }
 
 
-// dex 黑名单函数特征
-const std::vector<std::string> dex_method_blacklist = {
-        "loadClassAndInvoke",
-        "fart",
-        "fartwithClassloader",
-        "fartthread"
-};
-
-
 // 读取 /proc/self/maps 获取加载的 dex 或 dex 相关文件路径
-std::set<std::string> get_loaded_dex_paths() {
-    std::set<std::string> dex_paths;
-    std::ifstream maps("/proc/self/maps");
-    std::string line;
-
-    // 匹配 dex、odex、vdex、art、apk、jar 文件
-    std::regex dex_regex(R"((\.dex|\.odex|\.vdex|\.art|\.apk|\.jar)(\s|$))");
-
-    while (std::getline(maps, line)) {
-        std::size_t path_pos = line.find('/');
-        if (path_pos != std::string::npos) {
-            std::string path = line.substr(path_pos);
-            if (std::regex_search(path, dex_regex)) {
-                dex_paths.insert(path);
-            }
-        }
-    }
-    return dex_paths;
+std::set<std::string, std::less<>> get_loaded_dex_paths() {
+    maps::PathDeduper deduper;
+    maps::MapsReader reader;
+    reader.for_each(
+            [](const maps::MapEntry &entry) {
+                return entry.is_file() && is_dex_related_path(entry.path);
+            },
+            [&](const maps::MapEntry &entry) {
+                deduper.insert(entry.path);
+                return true;
+            });
+    return deduper.paths();
 }
 
 
@@ -313,19 +580,14 @@ Java_com_cyrus_example_fart_AntiFART_detectFartInLoadedDex(JNIEnv *env, jclass c
     std::vector<std::string> detected_logs;
     auto dex_paths = get_loaded_dex_paths();
 
+    SignatureMatcher matcher(dex_method_blacklist);
     for (const auto &path: dex_paths) {
-        std::string content = read_file_content(path);
-        if (!content.empty()) {
-            std::vector<std::string> matched = get_matched_signatures(content, dex_method_blacklist);
-            if (!matched.empty()) {
-                std::ostringstream oss;
-                oss << "[FART DETECTED] " << path << " => ";
-                for (size_t i = 0; i < matched.size(); ++i) {
-                    oss << matched[i];
-                    if (i != matched.size() - 1) oss << ", ";
-                }
-                LOGI("%s", oss.str().c_str());
-                detected_logs.push_back(oss.str());
+        matcher.reset();
+        if (scan_dex_path(path, matcher)) {
+            if (matcher.any()) {
+                std::string log = format_detection(path, matcher.matched());
+                LOGI("%s", log.c_str());
+                detected_logs.push_back(log);
             }
         }
     }
@@ -338,3 +600,70 @@ Java_com_cyrus_example_fart_AntiFART_detectFartInLoadedDex(JNIEnv *env, jclass c
 
     return result;
 }
+
+
+// JNI 方法：启动 maps 增量监控
+extern "C"
+JNIEXPORT jboolean JNICALL
+Java_com_cyrus_example_fart_AntiFART_startMapsWatcher(JNIEnv *env, jclass clazz, jint intervalMs) {
+    return MapsWatcher::instance().start(static_cast<uint32_t>(intervalMs)) ? JNI_TRUE : JNI_FALSE;
+}
+
+// JNI 方法：停止 maps 增量监控
+extern "C"
+JNIEXPORT void JNICALL
+Java_com_cyrus_example_fart_AntiFART_stopMapsWatcher(JNIEnv *env, jclass clazz) {
+    MapsWatcher::instance().stop();
+}
+
+// JNI 方法：取出 maps 监控到的检测结果
+extern "C"
+JNIEXPORT jobjectArray JNICALL
+Java_com_cyrus_example_fart_AntiFART_pollMapsWatcher(JNIEnv *env, jclass clazz) {
+    std::vector<std::string> detected_logs = MapsWatcher::instance().drain_detections();
+
+    jclass stringClass = env->FindClass("java/lang/String");
+    jobjectArray result = env->NewObjectArray(detected_logs.size(), stringClass, nullptr);
+    for (size_t i = 0; i < detected_logs.size(); ++i) {
+        env->SetObjectArrayElement(result, i, env->NewStringUTF(detected_logs[i].c_str()));
+    }
+
+    return result;
+}
+
+
+// JNI 方法：在匿名映射中查找内存加载的 dex（InMemoryDexClassLoader、壳解密出来的 dex）
+extern "C"
+JNIEXPORT jobjectArray JNICALL
+Java_com_cyrus_example_fart_AntiFART_scanAnonymousDex(JNIEnv *env, jclass clazz, jstring dumpDir) {
+    std::string dump_dir;
+    if (dumpDir != nullptr) {
+        const char *dir = env->GetStringUTFChars(dumpDir, nullptr);
+        dump_dir = dir;
+        env->ReleaseStringUTFChars(dumpDir, dir);
+    }
+
+    std::vector<std::string> logs;
+    for (const auto &image: scan_anonymous_dex(dump_dir)) {
+        char where[64];
+        snprintf(where, sizeof(where), "%p size=%u ", (void *) image.address, image.file_size);
+        std::string log = "[ANON DEX] " + std::string(where) + image.region;
+        if (!image.dump_path.empty()) {
+            log += " -> " + image.dump_path;
+        }
+        if (!image.matched.empty()) {
+            std::string detected = format_detection(log, image.matched);
+            LOGI("%s", detected.c_str());
+            log = detected;
+        }
+        logs.push_back(log);
+    }
+
+    jclass stringClass = env->FindClass("java/lang/String");
+    jobjectArray result = env->NewObjectArray(logs.size(), stringClass, nullptr);
+    for (size_t i = 0; i < logs.size(); ++i) {
+        env->SetObjectArrayElement(result, i, env->NewStringUTF(logs[i].c_str()));
+    }
+
+    return result;
+}
@@ -0,0 +1,220 @@
+#include "anon_dex_scanner.h"
+
+#include <android/log.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <cstring>
+#include "signature_scan.h"
+#include "../dex/dex_file.h"
+#include "../maps/proc_maps.h"
+
+#if defined(__aarch64__) || defined(__ARM_NEON)
+#include <arm_neon.h>
+#elif defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+#define LOG_TAG "AntiFART"
+#define LOGI(...) __android_log_print(ANDROID_LOG_INFO, LOG_TAG, __VA_ARGS__)
+
+using namespace cyurs;
+
+namespace {
+
+    constexpr uint32_t kDexEndianConstant = 0x12345678;
+    // 标准 dex 头 0x70，v41 dex container 头 0x78
+    constexpr uint32_t kMinHeaderSize = 0x70;
+    constexpr uint32_t kMaxHeaderSize = 0x78;
+    // 每次读取的块大小，块之间保留一个 header 大小的重叠
+    constexpr size_t kChunkSize = 1024 * 1024;
+
+    inline bool is_magic_at(const uint8_t *p) {
+        return p[0] == 'd' && p[1] == 'e' && p[2] == 'x' && p[3] == '\n';
+    }
+
+    bool write_file(const std::string &path, const uint8_t *data, size_t size) {
+        int fd = open(path.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+        if (fd < 0) return false;
+        size_t written = 0;
+        while (written < size) {
+            ssize_t n = write(fd, data + written, size - written);
+            if (n <= 0) break;
+            written += static_cast<size_t>(n);
+        }
+        close(fd);
+        return written == size;
+    }
+
+} // namespace
+
+
+size_t find_dex_magic(const uint8_t *buf, size_t limit, size_t size, size_t from) {
+    size_t i = from;
+
+#if defined(__aarch64__) || defined(__ARM_NEON)
+    // 同时比较 p[i] == 'd' 和 p[i + 3] == '\n'，命中后再逐个确认
+    const uint8x16_t d = vdupq_n_u8('d');
+    const uint8x16_t nl = vdupq_n_u8('\n');
+    for (; i + 16 <= limit && i + 16 + 3 <= size; i += 16) {
+        uint8x16_t m = vandq_u8(vceqq_u8(vld1q_u8(buf + i), d),
+                                vceqq_u8(vld1q_u8(buf + i + 3), nl));
+        // 每个字节压缩为 4 bit 的掩码
+        uint64_t mask = vget_lane_u64(vreinterpret_u64_u8(vshrn_n_u16(vreinterpretq_u16_u8(m), 4)), 0);
+        while (mask != 0) {
+            size_t pos = i + (__builtin_ctzll(mask) >> 2);
+            if (is_magic_at(buf + pos)) return pos;
+            mask &= ~(0xFULL << ((pos - i) << 2));
+        }
+    }
+#elif defined(__SSE2__)
+    const __m128i d = _mm_set1_epi8('d');
+    const __m128i nl = _mm_set1_epi8('\n');
+    for (; i + 16 <= limit && i + 16 + 3 <= size; i += 16) {
+        __m128i a = _mm_loadu_si128(reinterpret_cast<const __m128i *>(buf + i));
+        __m128i b = _mm_loadu_si128(reinterpret_cast<const __m128i *>(buf + i + 3));
+        uint32_t mask = static_cast<uint32_t>(_mm_movemask_epi8(_mm_and_si128(_mm_cmpeq_epi8(a, d), _mm_cmpeq_epi8(b, nl))));
+        while (mask != 0) {
+            size_t pos = i + __builtin_ctz(mask);
+            if (is_magic_at(buf + pos)) return pos;
+            mask &= mask - 1;
+        }
+    }
+#endif
+
+    // 剩余部分用 memchr
+    while (i < limit && i + 4 <= size) {
+        const void *p = memchr(buf + i, 'd', limit - i);
+        if (p == nullptr) break;
+        size_t pos = static_cast<const uint8_t *>(p) - buf;
+        if (pos + 4 > size) break;
+        if (is_magic_at(buf + pos)) return pos;
+        i = pos + 1;
+    }
+    return limit;
+}
+
+bool is_valid_dex_header(const uint8_t *data, size_t header_available, size_t available) {
+    if (header_available < kMinHeaderSize) return false;
+    const auto *header = reinterpret_cast<const dex::Header *>(data);
+
+    // 版本号：dex\n035\0 ~ dex\n041\0
+    const uint8_t *magic = header->magic_;
+    if (!is_magic_at(magic)) return false;
+    for (int i = 4; i < 7; ++i) {
+        if (magic[i] < '0' || magic[i] > '9') return false;
+    }
+    if (magic[7] != '\0') return false;
+
+    if (header->endian_tag_ != kDexEndianConstant) return false;
+    if (header->header_size_ < kMinHeaderSize || header->header_size_ > kMaxHeaderSize) return false;
+    if (header->file_size_ < header->header_size_ || header->file_size_ > available) return false;
+
+    // 各个 section 都要落在文件范围内
+    const uint32_t file_size = header->file_size_;
+    auto in_file = [file_size](uint32_t off, uint64_t count, uint32_t elem) {
+        return count == 0 || (off >= kMinHeaderSize && off + count * elem <= file_size);
+    };
+    return in_file(header->string_ids_off_, header->string_ids_size_, sizeof(dex::StringId)) &&
+           in_file(header->type_ids_off_, header->type_ids_size_, sizeof(dex::TypeId)) &&
+           in_file(header->proto_ids_off_, header->proto_ids_size_, sizeof(dex::ProtoId)) &&
+           in_file(header->field_ids_off_, header->field_ids_size_, sizeof(dex::FieldId)) &&
+           in_file(header->method_ids_off_, header->method_ids_size_, sizeof(dex::MethodId)) &&
+           in_file(header->class_defs_off_, header->class_defs_size_, sizeof(dex::ClassDef)) &&
+           header->map_off_ < file_size;
+}
+
+std::vector<AnonDexImage> scan_anonymous_dex(const std::string &dump_dir) {
+    struct Region {
+        uintptr_t start;
+        uintptr_t end;
+        std::string name;
+    };
+
+    // 先收集所有可读匿名映射，再逐个扫描（扫描过程中会分配内存，maps 可能发生变化）
+    std::vector<Region> regions;
+    maps::MapsReader reader;
+    reader.for_each(
+            [](const maps::MapEntry &entry) {
+                return entry.readable() && entry.is_anonymous();
+            },
+            [&](const maps::MapEntry &entry) {
+                // 相邻的同名映射合并，dex 可能跨越多个 VMA
+                if (!regions.empty() && regions.back().end == entry.start && regions.back().name == entry.path) {
+                    regions.back().end = entry.end;
+                } else {
+                    regions.push_back({entry.start, entry.end, std::string(entry.path)});
+                }
+                return true;
+            });
+
+    std::vector<AnonDexImage> images;
+    std::vector<uint8_t> chunk(kChunkSize + kMaxHeaderSize);
+    SignatureMatcher matcher(dex_method_blacklist);
+
+    for (const auto &region: regions) {
+        uintptr_t cur = region.start;
+        while (cur < region.end) {
+            size_t want = std::min(chunk.size(), static_cast<size_t>(region.end - cur));
+            size_t n = safe_read_memory(cur, chunk.data(), want);
+            if (n == 0) {
+                // 不可读的页直接跳过
+                static const size_t page_size = static_cast<size_t>(sysconf(_SC_PAGESIZE));
+                cur = (cur + page_size) & ~(page_size - 1);
+                continue;
+            }
+
+            // 最后一块之外，只在前 kChunkSize 字节内查找魔数，后面的重叠部分留给下一块
+            bool last = cur + n >= region.end || n < want;
+            size_t limit = last ? n : std::min(n, kChunkSize);
+            uintptr_t next = cur + limit;
+
+            size_t pos = find_dex_magic(chunk.data(), limit, n, 0);
+            while (pos < limit) {
+                uintptr_t addr = cur + pos;
+                size_t available = region.end - addr;
+                if (is_valid_dex_header(chunk.data() + pos, n - pos, available)) {
+                    uint32_t file_size = reinterpret_cast<const dex::Header *>(chunk.data() + pos)->file_size_;
+
+                    // 完整读出 dex
+                    std::vector<uint8_t> image(file_size);
+                    if (safe_read_memory(addr, image.data(), file_size) == file_size) {
+                        AnonDexImage found;
+                        found.address = addr;
+                        found.file_size = file_size;
+                        found.region = region.name;
+
+                        matcher.reset();
+                        matcher.feed(image.data(), image.size());
+                        matcher.finish();
+                        found.matched = matcher.matched();
+
+                        if (!dump_dir.empty()) {
+                            char name[96];
+                            snprintf(name, sizeof(name), "/anon_%lx_%u.dex", (unsigned long) addr, file_size);
+                            std::string path = dump_dir + name;
+                            if (write_file(path, image.data(), image.size())) {
+                                found.dump_path = path;
+                            }
+                        }
+
+                        LOGI("[ANON DEX] %p size=%u region=%s", (void *) addr, file_size, region.name.c_str());
+                        images.push_back(std::move(found));
+
+                        // 跳过整个 dex：在本块内结束时从 dex 之后继续查找（多个小 dex 紧挨着的情况），否则从 dex 之后读下一块
+                        uintptr_t end = addr + file_size;
+                        if (end < next) {
+                            pos = find_dex_magic(chunk.data(), limit, n, end - cur);
+                            continue;
+                        }
+                        next = end;
+                        break;
+                    }
+                }
+                pos = find_dex_magic(chunk.data(), limit, n, pos + 1);
+            }
+
+            cur = next;
+        }
+    }
+    return images;
+}
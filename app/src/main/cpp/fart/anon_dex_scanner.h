@@ -0,0 +1,39 @@
+#ifndef CYRUS_FART_ANON_DEX_SCANNER_H
+#define CYRUS_FART_ANON_DEX_SCANNER_H
+
+#include <stdint.h>
+#include <string>
+#include <vector>
+
+/**
+ * 内存 dex 扫描
+ *
+ * InMemoryDexClassLoader 以及各种壳解密出来的 dex 只存在于匿名映射中，maps 里没有路径。
+ * 这里在所有可读的匿名映射中向量化搜索 "dex\n0xx\0" 魔数，用 Header 的 file_size_ / header_size_ 等字段校验，
+ * 确认后的 dex 交给特征匹配，并可选地 dump 到指定目录。
+ * 内存统一通过 process_vm_readv 读取，不可读的页直接跳过。
+ */
+struct AnonDexImage {
+    uintptr_t address = 0;
+    uint32_t file_size = 0;
+    // 映射名，如 [anon:dalvik-DEX data]
+    std::string region;
+    std::vector<std::string> matched;
+    // dump 后的文件路径（未 dump 为空）
+    std::string dump_path;
+};
+
+// 返回 buf 中 [from, limit) 范围内第一个 "dex\n" 的位置，找不到返回 limit
+size_t find_dex_magic(const uint8_t *buf, size_t limit, size_t size, size_t from);
+
+// 校验 dex 头，available 为 header 起始处之后可用的字节数
+bool is_valid_dex_header(const uint8_t *header, size_t header_available, size_t available);
+
+/**
+ * 扫描当前进程所有可读的匿名映射
+ *
+ * @param dump_dir 不为空时把找到的 dex 写到该目录
+ */
+std::vector<AnonDexImage> scan_anonymous_dex(const std::string &dump_dir);
+
+#endif //CYRUS_FART_ANON_DEX_SCANNER_H
@@ -0,0 +1,147 @@
+#include "maps_watcher.h"
+
+#include <android/log.h>
+#include <algorithm>
+#include "signature_scan.h"
+
+#define LOG_TAG "AntiFART"
+#define LOGI(...) __android_log_print(ANDROID_LOG_INFO, LOG_TAG, __VA_ARGS__)
+
+using namespace cyurs;
+
+namespace {
+
+    // FNV-1a 64
+    inline uint64_t hash_line(std::string_view line) {
+        uint64_t h = 0xcbf29ce484222325ULL;
+        for (unsigned char c: line) {
+            h ^= c;
+            h *= 0x100000001b3ULL;
+        }
+        return h;
+    }
+
+} // namespace
+
+
+MapsWatcher &MapsWatcher::instance() {
+    static MapsWatcher watcher;
+    return watcher;
+}
+
+bool MapsWatcher::start(uint32_t interval_ms) {
+    bool expected = false;
+    if (!running_.compare_exchange_strong(expected, true)) {
+        return false;
+    }
+    interval_ms_ = interval_ms == 0 ? 1000 : interval_ms;
+    thread_ = std::thread(&MapsWatcher::loop, this);
+    LOGI("MapsWatcher started, interval=%ums", interval_ms_);
+    return true;
+}
+
+void MapsWatcher::stop() {
+    {
+        std::lock_guard<std::mutex> lock(wait_mutex_);
+        if (!running_.exchange(false)) return;
+    }
+    wait_cv_.notify_all();
+    if (thread_.joinable()) thread_.join();
+    LOGI("MapsWatcher stopped");
+}
+
+void MapsWatcher::loop() {
+    while (running()) {
+        size_t changed = tick();
+        if (changed > 0) {
+            LOGI("MapsWatcher: %zu new mappings", changed);
+        }
+
+        std::unique_lock<std::mutex> lock(wait_mutex_);
+        wait_cv_.wait_for(lock, std::chrono::milliseconds(interval_ms_), [this] { return !running(); });
+    }
+}
+
+size_t MapsWatcher::tick() {
+    std::lock_guard<std::mutex> lock(tick_mutex_);
+
+    // 新出现的行先记下来，读完 maps 后再扫描，避免扫描过程中持有 maps 的 fd
+    struct NewRegion {
+        uintptr_t start;
+        uintptr_t end;
+        std::string path;
+    };
+    std::vector<NewRegion> new_regions;
+
+    current_.clear();
+    reader_.for_each_line([&](std::string_view line) {
+        uint64_t h = hash_line(line);
+        current_.push_back(h);
+        if (std::binary_search(previous_.begin(), previous_.end(), h)) {
+            return true;
+        }
+
+        // 只关心文件映射和匿名可执行映射
+        maps::MapEntry entry;
+        if (!maps::parse_line(line, entry) || !entry.readable()) return true;
+        if (entry.is_file()) {
+            if (!maps::path_has_extension(entry.path, ".so") && !is_dex_related_path(entry.path)) return true;
+            new_regions.push_back({entry.start, entry.end, std::string(entry.path)});
+        } else if (entry.is_anonymous() && entry.executable()) {
+            new_regions.push_back({entry.start, entry.end, std::string()});
+        }
+        return true;
+    });
+
+    std::sort(current_.begin(), current_.end());
+    previous_.swap(current_);
+
+    for (const auto &region: new_regions) {
+        scan_region(region.start, region.end, region.path);
+    }
+    return new_regions.size();
+}
+
+void MapsWatcher::scan_region(uintptr_t start, uintptr_t end, const std::string &path) {
+    if (!path.empty()) {
+        const std::vector<std::string> *patterns = nullptr;
+        if (maps::path_has_extension(path, ".so")) {
+            patterns = &so_symbols_blacklist;
+        } else if (is_dex_related_path(path)) {
+            patterns = &dex_method_blacklist;
+        }
+        if (patterns == nullptr || !scanned_files_.insert(path)) return;
+
+        SignatureMatcher matcher(*patterns);
+        bool ok = patterns == &dex_method_blacklist ? scan_dex_path(path, matcher) : scan_file(path, matcher);
+        if (ok) {
+            matcher.finish();
+            if (matcher.any()) report(path, matcher.matched());
+        }
+        return;
+    }
+
+    // 匿名可执行内存（自定义 linker 加载的 so、壳解密出来的代码等）
+    SignatureMatcher matcher(so_symbols_blacklist);
+    scan_memory(start, end - start, matcher);
+    matcher.finish();
+    if (matcher.any()) {
+        char where[64];
+        snprintf(where, sizeof(where), "[anon:%lx-%lx]", (unsigned long) start, (unsigned long) end);
+        report(where, matcher.matched());
+    }
+}
+
+void MapsWatcher::report(const std::string &where, const std::vector<std::string> &matched) {
+    std::string log = format_detection(where, matched);
+    LOGI("%s", log.c_str());
+    std::lock_guard<std::mutex> lock(detections_mutex_);
+    detections_.push_back(std::move(log));
+}
+
+std::vector<std::string> MapsWatcher::drain_detections() {
+    std::lock_guard<std::mutex> lock(detections_mutex_);
+    std::vector<std::string> result;
+    result.swap(detections_);
+    return result;
+}
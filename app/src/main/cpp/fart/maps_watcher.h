@@ -0,0 +1,69 @@
+#ifndef CYRUS_FART_MAPS_WATCHER_H
+#define CYRUS_FART_MAPS_WATCHER_H
+
+#include <stdint.h>
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+#include "../maps/proc_maps.h"
+
+/**
+ * /proc/self/maps 变化监控
+ *
+ * 壳通常在运行后期才加载真正的 dex / so，定时全量重扫代价很高。
+ * 这里每个 tick 只对 maps 的每一行计算一个 64 位 hash 作为快照，与上一次的快照（有序数组）做差集，
+ * 只有新出现的文件映射和匿名可执行映射才会交给特征扫描，扫描开销只和变化量相关。
+ */
+class MapsWatcher {
+public:
+    static MapsWatcher &instance();
+
+    // 启动后台线程，interval_ms 为轮询间隔
+    bool start(uint32_t interval_ms);
+
+    void stop();
+
+    bool running() const { return running_.load(std::memory_order_acquire); }
+
+    // 取出并清空已检测到的结果
+    std::vector<std::string> drain_detections();
+
+    // 执行一次增量扫描，返回本次新出现的映射数量
+    size_t tick();
+
+private:
+    MapsWatcher() = default;
+
+    void loop();
+
+    // path 为空表示匿名可执行映射
+    void scan_region(uintptr_t start, uintptr_t end, const std::string &path);
+
+    void report(const std::string &where, const std::vector<std::string> &matched);
+
+    cyurs::maps::MapsReader reader_;
+
+    // 上一次快照：每行 hash，已排序
+    std::vector<uint64_t> previous_;
+    std::vector<uint64_t> current_;
+
+    // 已扫描过的文件（同一个文件 munmap 后重新 mmap 不会重复扫描）
+    cyurs::maps::PathDeduper scanned_files_;
+
+    std::atomic<bool> running_{false};
+    uint32_t interval_ms_ = 1000;
+    std::thread thread_;
+    std::mutex wait_mutex_;
+    std::condition_variable wait_cv_;
+
+    // tick() 只允许一个线程执行
+    std::mutex tick_mutex_;
+
+    std::mutex detections_mutex_;
+    std::vector<std::string> detections_;
+};
+
+#endif //CYRUS_FART_MAPS_WATCHER_H
@@ -0,0 +1,267 @@
+#include "signature_scan.h"
+
+#include <android/log.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/uio.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <cctype>
+#include <cstring>
+#include <sstream>
+#include "../maps/proc_maps.h"
+#include "../zip/zip_reader.h"
+
+#define LOG_TAG "AntiFART"
+#define LOGI(...) __android_log_print(ANDROID_LOG_INFO, LOG_TAG, __VA_ARGS__)
+
+// so 黑名单函数特征
+const std::vector<std::string> so_symbols_blacklist = {
+        "dumpDexFileByExecute",
+        "dumpArtMethod",
+        "myfartInvoke",
+        "DexFile_dumpMethodCode"
+};
+
+// dex 黑名单函数特征
+const std::vector<std::string> dex_method_blacklist = {
+        "loadClassAndInvoke",
+        "fart",
+        "fartwithClassloader",
+        "fartthread"
+};
+
+// 单词边界检查
+bool is_word_boundary(char ch) {
+    return !std::isalnum(static_cast<unsigned char>(ch)) && ch != '_';
+}
+
+bool is_dex_related_path(std::string_view path) {
+    // 匹配 dex、odex、vdex、art、apk、jar 文件
+    static constexpr std::string_view dex_exts[] = {".dex", ".odex", ".vdex", ".art", ".apk", ".jar"};
+    for (auto ext: dex_exts) {
+        if (cyurs::maps::path_has_extension(path, ext)) return true;
+    }
+    return false;
+}
+
+
+SignatureMatcher::SignatureMatcher(const std::vector<std::string> &patterns)
+        : patterns_(patterns), hit_(patterns.size(), false), need_boundary_(patterns.size(), false) {
+    for (size_t i = 0; i < patterns.size(); ++i) {
+        need_boundary_[i] = patterns[i].find('_') == std::string::npos;
+        max_len_ = std::max(max_len_, patterns[i].size());
+    }
+    tail_.reserve(max_len_ * 2 + 1);
+}
+
+void SignatureMatcher::scan(const uint8_t *buf, size_t size, size_t pos_limit, char prev_at_start, bool end_is_final) {
+    for (size_t i = 0; i < patterns_.size(); ++i) {
+        if (hit_[i]) continue;
+        const std::string &pattern = patterns_[i];
+        const size_t len = pattern.size();
+        if (len == 0 || len > size) continue;
+
+        size_t pos = 0;
+        while (pos < pos_limit && pos + len <= size) {
+            const void *found = memmem(buf + pos, size - pos, pattern.data(), len);
+            if (found == nullptr) break;
+            pos = static_cast<const uint8_t *>(found) - buf;
+            if (pos >= pos_limit) break;
+
+            if (!need_boundary_[i]) {
+                hit_[i] = true;
+                break;
+            }
+
+            // 单词边界检查
+            // 这样就不会匹配 farther、himmelfart，但可以匹配像 void fart()、"fart"、 call fart 等形式。
+            char prev = pos == 0 ? prev_at_start : static_cast<char>(buf[pos - 1]);
+            if (pos + len < size || end_is_final) {
+                char next = pos + len < size ? static_cast<char>(buf[pos + len]) : '\0';
+                if (is_word_boundary(prev) && is_word_boundary(next)) {
+                    hit_[i] = true;
+                    break;
+                }
+            }
+            // 末尾的命中要等下一块数据才能判断，会保留在 tail_ 中
+            ++pos;
+        }
+    }
+}
+
+void SignatureMatcher::feed(const uint8_t *data, size_t size) {
+    if (size == 0 || max_len_ == 0) return;
+
+    // 1. 跨块边界：tail_ + 新数据开头 max_len_ 字节，只看从 tail_ 中开始的命中
+    if (!tail_.empty()) {
+        size_t tail_size = tail_.size();
+        size_t head = std::min(size, max_len_);
+        tail_.insert(tail_.end(), data, data + head);
+        scan(tail_.data(), tail_.size(), tail_size, before_tail_, false);
+        tail_.resize(tail_size);
+    }
+
+    // 2. 当前块
+    char prev = tail_.empty() ? before_tail_ : static_cast<char>(tail_.back());
+    scan(data, size, size, prev, false);
+
+    // 3. 保留末尾 max_len_ + 1 字节
+    const size_t keep = max_len_ + 1;
+    if (size >= keep) {
+        before_tail_ = size > keep ? static_cast<char>(data[size - keep - 1])
+                                   : (tail_.empty() ? before_tail_ : static_cast<char>(tail_.back()));
+        tail_.assign(data + size - keep, data + size);
+    } else {
+        tail_.insert(tail_.end(), data, data + size);
+        if (tail_.size() > keep) {
+            size_t drop = tail_.size() - keep;
+            before_tail_ = static_cast<char>(tail_[drop - 1]);
+            tail_.erase(tail_.begin(), tail_.begin() + drop);
+        }
+    }
+}
+
+void SignatureMatcher::finish() {
+    if (!tail_.empty()) {
+        scan(tail_.data(), tail_.size(), tail_.size(), before_tail_, true);
+    }
+    tail_.clear();
+    before_tail_ = '\0';
+}
+
+void SignatureMatcher::reset() {
+    std::fill(hit_.begin(), hit_.end(), false);
+    tail_.clear();
+    before_tail_ = '\0';
+}
+
+bool SignatureMatcher::any() const {
+    for (bool hit: hit_) {
+        if (hit) return true;
+    }
+    return false;
+}
+
+bool SignatureMatcher::all() const {
+    for (bool hit: hit_) {
+        if (!hit) return false;
+    }
+    return true;
+}
+
+std::vector<std::string> SignatureMatcher::matched() const {
+    std::vector<std::string> result;
+    for (size_t i = 0; i < patterns_.size(); ++i) {
+        if (hit_[i]) result.push_back(patterns_[i]);
+    }
+    return result;
+}
+
+
+// 返回匹配到的特征列表
+std::vector<std::string> get_matched_signatures(const std::string &content, const std::vector<std::string> &patterns) {
+    SignatureMatcher matcher(patterns);
+    matcher.feed(reinterpret_cast<const uint8_t *>(content.data()), content.size());
+    matcher.finish();
+    return matcher.matched();
+}
+
+
+bool scan_file(const std::string &path, SignatureMatcher &matcher) {
+    int fd = open(path.c_str(), O_RDONLY | O_CLOEXEC);
+    if (fd < 0) {
+        LOGI("Failed to open: %s", path.c_str());
+        return false;
+    }
+
+    struct stat st{};
+    if (fstat(fd, &st) != 0 || st.st_size <= 0) {
+        close(fd);
+        return false;
+    }
+
+    // mmap 代替整个文件读入 std::string
+    size_t size = static_cast<size_t>(st.st_size);
+    void *base = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (base == MAP_FAILED) {
+        LOGI("Failed to mmap: %s", path.c_str());
+        return false;
+    }
+
+    madvise(base, size, MADV_SEQUENTIAL);
+    matcher.feed(static_cast<const uint8_t *>(base), size);
+    munmap(base, size);
+    return true;
+}
+
+
+bool scan_dex_path(const std::string &path, SignatureMatcher &matcher) {
+    if (!cyurs::maps::path_has_extension(path, ".apk") && !cyurs::maps::path_has_extension(path, ".jar")) {
+        bool ok = scan_file(path, matcher);
+        matcher.finish();
+        return ok;
+    }
+
+    cyurs::zip::ZipArchive archive;
+    if (!archive.Open(path)) {
+        LOGI("Failed to open zip: %s", path.c_str());
+        return false;
+    }
+
+    archive.ForEachEntry([&](const cyurs::zip::ZipEntry &entry) {
+        if (!cyurs::zip::IsClassesDex(entry.name)) return true;
+
+        archive.StreamEntry(entry, [&](const uint8_t *data, size_t size) {
+            matcher.feed(data, size);
+            return true;
+        });
+        // 每个 dex 单独收尾，避免把两个 dex 的首尾拼在一起
+        matcher.finish();
+
+        // 所有特征都已命中就不用再看后面的 dex
+        return !matcher.all();
+    });
+    return true;
+}
+
+
+size_t safe_read_memory(uintptr_t addr, void *buf, size_t size) {
+    struct iovec local{buf, size};
+    struct iovec remote{reinterpret_cast<void *>(addr), size};
+    ssize_t n = process_vm_readv(getpid(), &local, 1, &remote, 1, 0);
+    return n < 0 ? 0 : static_cast<size_t>(n);
+}
+
+void scan_memory(uintptr_t addr, size_t size, SignatureMatcher &matcher) {
+    static const size_t page_size = static_cast<size_t>(sysconf(_SC_PAGESIZE));
+    constexpr size_t kChunkSize = 256 * 1024;
+
+    std::vector<uint8_t> buffer(std::min(size, kChunkSize));
+    uintptr_t cur = addr;
+    const uintptr_t end = addr + size;
+
+    while (cur < end) {
+        size_t want = std::min(static_cast<size_t>(end - cur), kChunkSize);
+        size_t n = safe_read_memory(cur, buffer.data(), want);
+        if (n > 0) {
+            matcher.feed(buffer.data(), n);
+            cur += n;
+            continue;
+        }
+        // 当前页不可读，跳到下一页
+        cur = (cur + page_size) & ~(page_size - 1);
+    }
+}
+
+
+std::string format_detection(const std::string &where, const std::vector<std::string> &matched) {
+    std::ostringstream oss;
+    oss << "[FART DETECTED] " << where << " => ";
+    for (size_t i = 0; i < matched.size(); ++i) {
+        oss << matched[i];
+        if (i != matched.size() - 1) oss << ", ";
+    }
+    return oss.str();
+}
@@ -0,0 +1,96 @@
+#ifndef CYRUS_FART_SIGNATURE_SCAN_H
+#define CYRUS_FART_SIGNATURE_SCAN_H
+
+#include <stdint.h>
+#include <string>
+#include <string_view>
+#include <vector>
+
+// so 黑名单函数特征
+extern const std::vector<std::string> so_symbols_blacklist;
+
+// dex 黑名单函数特征
+extern const std::vector<std::string> dex_method_blacklist;
+
+// 单词边界检查
+bool is_word_boundary(char ch);
+
+// 是否为 dex、odex、vdex、art、apk、jar 文件
+bool is_dex_related_path(std::string_view path);
+
+/**
+ * 流式特征匹配器
+ *
+ * 数据可以分多块 feed 进来（文件分块、内存分段、解压输出等），
+ * 内部保留上一块末尾 max_pattern_len + 1 字节，跨块边界的特征和边界字符检查都不会漏。
+ * 全部数据 feed 完以后调用 finish()。
+ */
+class SignatureMatcher {
+public:
+    explicit SignatureMatcher(const std::vector<std::string> &patterns);
+
+    void feed(const uint8_t *data, size_t size);
+
+    void finish();
+
+    // 重置状态，可用于扫描下一个目标
+    void reset();
+
+    bool any() const;
+
+    // 所有特征都已命中
+    bool all() const;
+
+    // 按 patterns 顺序返回已命中的特征
+    std::vector<std::string> matched() const;
+
+private:
+    /**
+     * 在 buf 中查找起始位置 < pos_limit 的特征
+     *
+     * @param prev_at_start buf[0] 之前的字节
+     * @param end_is_final  buf 之后没有数据了（末尾按 '\0' 处理），否则末尾命中的特征留到下一块再判断
+     */
+    void scan(const uint8_t *buf, size_t size, size_t pos_limit, char prev_at_start, bool end_is_final);
+
+    const std::vector<std::string> &patterns_;
+    std::vector<bool> hit_;
+    // 是否需要单词边界检查（类似 DexFile_dumpMethodCode 这种，带 _ 的不需要做边界检查）
+    std::vector<bool> need_boundary_;
+    size_t max_len_ = 0;
+    // 上一块末尾的数据
+    std::vector<uint8_t> tail_;
+    // tail_ 之前的一个字节（'\0' 表示数据开头）
+    char before_tail_ = '\0';
+};
+
+// 返回匹配到的特征列表
+std::vector<std::string> get_matched_signatures(const std::string &content, const std::vector<std::string> &patterns);
+
+// mmap 文件后整体交给 matcher（不会 finish）
+bool scan_file(const std::string &path, SignatureMatcher &matcher);
+
+/**
+ * 扫描 dex 相关文件
+ *
+ * .apk / .jar 只解析中央目录并遍历 classes*.dex 条目：STORED 条目直接在 mmap 上扫描，
+ * DEFLATED 条目分块流式解压后交给 matcher，不再对压缩数据做字节匹配。
+ * 其他文件等同于 scan_file。每个条目扫描完会调用 matcher.finish()。
+ */
+bool scan_dex_path(const std::string &path, SignatureMatcher &matcher);
+
+/**
+ * 通过 process_vm_readv 读取当前进程内存，
+ * 遇到不可读的页（已 munmap 或 PROT_NONE）只会返回失败，不会触发 SIGSEGV。
+ *
+ * @return 实际读取的字节数
+ */
+size_t safe_read_memory(uintptr_t addr, void *buf, size_t size);
+
+// 分块安全读取一段内存交给 matcher，不可读的页会被跳过（不会 finish）
+void scan_memory(uintptr_t addr, size_t size, SignatureMatcher &matcher);
+
+// 格式化检测结果：[FART DETECTED] path => a, b
+std::string format_detection(const std::string &where, const std::vector<std::string> &matched);
+
+#endif //CYRUS_FART_SIGNATURE_SCAN_H
@@ -0,0 +1,482 @@
+#include "active_invoker.h"
+
+#include <errno.h>
+#include <fcntl.h>
+#include <time.h>
+#include <unistd.h>
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <android/log.h>
+
+#include "../dex/class_accessor.h"
+#include "../dex/dex_cookie.h"
+#include "../dex/dex_file_info.h"
+#include "../dex/dex_reader.h"
+
+#define LOG_TAG "ActiveInvoker"
+#define LOGI(...) __android_log_print(ANDROID_LOG_INFO, LOG_TAG, __VA_ARGS__)
+#define LOGW(...) __android_log_print(ANDROID_LOG_WARN, LOG_TAG, __VA_ARGS__)
+#define LOGE(...) __android_log_print(ANDROID_LOG_ERROR, LOG_TAG, __VA_ARGS__)
+
+namespace cyurs {
+    namespace hook {
+
+        using dex::DexReader;
+
+        static constexpr char kCheckpointMagic[4] = {'A', 'C', 'K', 'P'};
+        static constexpr uint16_t kCheckpointVersion = 1;
+        static constexpr int kMaxThreads = 16;
+        // 限速等待时检查 stop_ 的间隔
+        static constexpr int64_t kMaxSleepNs = 100 * 1000000LL;
+        static constexpr uint32_t kAccStatic = 0x0008;
+
+        struct CheckpointHeader {
+            char magic_[4];
+            uint16_t version_;
+            uint16_t reserved_;
+            uint32_t dex_count_;
+        };
+
+        struct CheckpointDex {
+            uint32_t checksum_;
+            uint32_t class_def_count_;
+        };
+
+        struct InvokeDex {
+            DexReader reader;
+            uint32_t checksum = 0;
+            uint32_t class_def_count = 0;
+            // 已完成的 class_def 位图
+            std::unique_ptr<std::atomic<uint64_t>[]> done;
+            size_t words = 0;
+
+            bool IsDone(uint32_t idx) const {
+                return (done[idx >> 6].load(std::memory_order_relaxed) >> (idx & 63)) & 1;
+            }
+
+            void MarkDone(uint32_t idx) {
+                done[idx >> 6].fetch_or(1ULL << (idx & 63), std::memory_order_relaxed);
+            }
+        };
+
+        static int64_t now_ns() {
+            struct timespec ts{};
+            clock_gettime(CLOCK_MONOTONIC, &ts);
+            return static_cast<int64_t>(ts.tv_sec) * 1000000000LL + ts.tv_nsec;
+        }
+
+        static bool write_fully(int fd, const uint8_t *data, size_t size) {
+            while (size > 0) {
+                ssize_t n = write(fd, data, size);
+                if (n < 0) {
+                    if (errno == EINTR) continue;
+                    return false;
+                }
+                data += n;
+                size -= static_cast<size_t>(n);
+            }
+            return true;
+        }
+
+        static bool read_file(const std::string &path, std::vector<uint8_t> &out) {
+            FILE *file = fopen(path.c_str(), "rb");
+            if (file == nullptr) return false;
+            uint8_t buf[16 * 1024];
+            size_t n;
+            while ((n = fread(buf, 1, sizeof(buf), file)) > 0) out.insert(out.end(), buf, buf + n);
+            bool ok = ferror(file) == 0;
+            fclose(file);
+            return ok;
+        }
+
+        // 与 dex_dumper 的快照范围一致：cdex 的数据区在 begin_ 之后、file_size_ 之外，v41 的偏移相对于容器起始
+        static bool open_dex_reader(const DexFileInfo &info, DexReader &reader) {
+            if (info.size < sizeof(dex::Header)) return false;
+            const auto *header = reinterpret_cast<const dex::HeaderV41 *>(info.begin);
+            auto begin = reinterpret_cast<uintptr_t>(info.begin);
+            if (memcmp(header->magic_, "cdex", 4) == 0) {
+                uint64_t data_end = static_cast<uint64_t>(header->data_off_) + header->data_size_;
+                return reader.Open(info.begin, std::max<uint64_t>(info.size, data_end));
+            }
+            if (memcmp(header->magic_, "dex\n", 4) == 0 && header->header_size_ >= sizeof(dex::HeaderV41) &&
+                header->header_offset_ <= begin) {
+                return reader.OpenInContainer(info.begin - header->header_offset_,
+                                              std::max<uint64_t>(header->container_size_,
+                                                                 header->header_offset_ + info.size),
+                                              header->header_offset_);
+            }
+            return reader.Open(info.begin, info.size);
+        }
+
+        // Lcom/foo/Bar; -> com.foo.Bar（loadClass / forName 使用的二进制名）
+        static void to_binary_name(std::string_view descriptor, std::string &name) {
+            name.clear();
+            if (descriptor.size() >= 2 && descriptor.front() == 'L' && descriptor.back() == ';') {
+                descriptor = descriptor.substr(1, descriptor.size() - 2);
+            }
+            for (char c: descriptor) name.push_back(c == '/' ? '.' : c);
+        }
+
+        ActiveInvoker &ActiveInvoker::instance() {
+            // 不析构，进程退出时工作线程可能还在 JNI 调用中
+            static auto *invoker = new ActiveInvoker();
+            return *invoker;
+        }
+
+        ActiveInvoker::~ActiveInvoker() = default;
+
+        bool ActiveInvoker::Start(JNIEnv *env, jobject class_loader, int sdk_level, const ClassScope &scope,
+                                  const InvokeOptions &options) {
+            std::lock_guard<std::mutex> lock(control_mutex_);
+            if (active_workers_.load() > 0) {
+                LOGW("active invoke already running");
+                return false;
+            }
+            if (class_loader == nullptr) return false;
+            // 上一次自然结束的工作线程
+            for (std::thread &worker: workers_) worker.join();
+            workers_.clear();
+            if (class_loader_ != nullptr) env->DeleteGlobalRef(class_loader_);
+            if (class_class_ != nullptr) env->DeleteGlobalRef(class_class_);
+            class_loader_ = nullptr;
+            class_class_ = nullptr;
+
+            jclass loader_class = env->FindClass("java/lang/ClassLoader");
+            jclass class_class = env->FindClass("java/lang/Class");
+            if (env->ExceptionCheck() || loader_class == nullptr || class_class == nullptr ||
+                env->GetJavaVM(&vm_) != JNI_OK) {
+                env->ExceptionClear();
+                return false;
+            }
+            load_class_ = env->GetMethodID(loader_class, "loadClass", "(Ljava/lang/String;)Ljava/lang/Class;");
+            for_name_ = env->GetStaticMethodID(class_class, "forName",
+                                               "(Ljava/lang/String;ZLjava/lang/ClassLoader;)Ljava/lang/Class;");
+            if (env->ExceptionCheck() || load_class_ == nullptr || for_name_ == nullptr) {
+                env->ExceptionClear();
+                return false;
+            }
+            // 持有 ClassLoader 的全局引用，运行期间它的 DexFile 不会被释放
+            class_loader_ = env->NewGlobalRef(class_loader);
+            class_class_ = static_cast<jclass>(env->NewGlobalRef(class_class));
+            env->DeleteLocalRef(loader_class);
+            env->DeleteLocalRef(class_class);
+
+            options_ = options;
+            stop_.store(false);
+            dexes_.clear();
+            items_.clear();
+            next_item_.store(0);
+            next_slot_ns_.store(0);
+            next_checkpoint_ns_.store(now_ns() + options_.checkpoint_interval_ms * 1000000LL);
+            done_.store(0);
+            loaded_.store(0);
+            failed_.store(0);
+            methods_resolved_.store(0);
+            methods_failed_.store(0);
+
+            std::vector<const void *> dex_files;
+            CollectDexFiles(env, class_loader, sdk_level, dex_files);
+            std::sort(dex_files.begin(), dex_files.end());
+            dex_files.erase(std::unique(dex_files.begin(), dex_files.end()), dex_files.end());
+
+            for (const void *dex_file: dex_files) {
+                DexFileInfo info;
+                if (!GetDexFileInfo(dex_file, sdk_level, &info)) continue;
+                std::unique_ptr<InvokeDex> dex(new InvokeDex());
+                if (!open_dex_reader(info, dex->reader)) {
+                    LOGW("skip unreadable dex %s", info.location.c_str());
+                    continue;
+                }
+                dex->checksum = dex->reader.GetHeader().checksum_;
+                dex->class_def_count = dex->reader.NumClassDefs();
+                // parent 与子 ClassLoader 可能加载了同一个 dex
+                bool duplicate = false;
+                for (const auto &other: dexes_) {
+                    duplicate |= other->checksum == dex->checksum && other->class_def_count == dex->class_def_count;
+                }
+                if (duplicate) continue;
+                dex->words = (dex->class_def_count + 63) / 64;
+                dex->done.reset(new std::atomic<uint64_t>[dex->words]);
+                for (size_t i = 0; i < dex->words; ++i) dex->done[i].store(0, std::memory_order_relaxed);
+                dexes_.push_back(std::move(dex));
+            }
+            LoadCheckpoint();
+
+            uint32_t total = 0;
+            uint32_t resumed = 0;
+            for (uint32_t dex_idx = 0; dex_idx < dexes_.size(); ++dex_idx) {
+                const InvokeDex &dex = *dexes_[dex_idx];
+                for (uint32_t idx = 0; idx < dex.class_def_count; ++idx) {
+                    if (!scope.Contains(dex.reader.GetClassDescriptor(*dex.reader.GetClassDef(idx)))) continue;
+                    ++total;
+                    if (dex.IsDone(idx)) {
+                        ++resumed;
+                    } else {
+                        items_.push_back({dex_idx, idx});
+                    }
+                }
+            }
+            dex_count_.store(static_cast<uint32_t>(dexes_.size()));
+            total_.store(total);
+            resumed_.store(resumed);
+
+            int threads = std::max(1, std::min(options_.threads, kMaxThreads));
+            threads = static_cast<int>(std::min<size_t>(threads, items_.size()));
+            LOGI("active invoke: dex=%zu classes=%u resumed=%u threads=%d rate=%u/s mode=%d", dexes_.size(), total,
+                 resumed, threads, options_.classes_per_second, options_.mode);
+
+            int64_t now_us = now_ns() / 1000;
+            start_us_.store(now_us);
+            end_us_.store(now_us);
+            active_workers_.store(threads);
+            for (int i = 0; i < threads; ++i) workers_.emplace_back(&ActiveInvoker::Worker, this, i);
+            return true;
+        }
+
+        void ActiveInvoker::Stop() {
+            std::lock_guard<std::mutex> lock(control_mutex_);
+            StopLocked();
+        }
+
+        void ActiveInvoker::StopLocked() {
+            stop_.store(true);
+            for (std::thread &worker: workers_) worker.join();
+            workers_.clear();
+        }
+
+        void ActiveInvoker::Worker(int index) {
+            char name[16];
+            snprintf(name, sizeof(name), "active-invoke-%d", index);
+            JavaVMAttachArgs args{JNI_VERSION_1_6, name, nullptr};
+            JNIEnv *env = nullptr;
+            if (vm_->AttachCurrentThread(&env, &args) == JNI_OK) {
+                std::string signature;
+                while (!stop_.load(std::memory_order_relaxed)) {
+                    size_t i = next_item_.fetch_add(1, std::memory_order_relaxed);
+                    if (i >= items_.size()) break;
+                    Throttle();
+                    if (stop_.load(std::memory_order_relaxed)) break;
+                    InvokeClass(env, items_[i], signature);
+                    dexes_[items_[i].dex]->MarkDone(items_[i].class_def_idx);
+                    done_.fetch_add(1, std::memory_order_relaxed);
+                    MaybeCheckpoint();
+                }
+                vm_->DetachCurrentThread();
+            } else {
+                LOGE("attach %s failed", name);
+            }
+
+            // 最后一个退出的线程保存进度
+            if (active_workers_.fetch_sub(1) == 1) {
+                end_us_.store(now_ns() / 1000);
+                SaveCheckpoint();
+                LOGI("active invoke %s: %s", stop_.load() ? "stopped" : "finished",
+                     format_invoke_progress(progress()).c_str());
+            }
+        }
+
+        void ActiveInvoker::Throttle() {
+            if (options_.classes_per_second == 0) return;
+            int64_t interval = 1000000000LL / options_.classes_per_second;
+            int64_t now = now_ns();
+            // 每个类预约一个时间槽，多个线程共享同一速率
+            int64_t slot = next_slot_ns_.load(std::memory_order_relaxed);
+            int64_t target;
+            do {
+                target = std::max(slot, now);
+            } while (!next_slot_ns_.compare_exchange_weak(slot, target + interval, std::memory_order_relaxed));
+
+            while (now < target && !stop_.load(std::memory_order_relaxed)) {
+                std::this_thread::sleep_for(std::chrono::nanoseconds(std::min(target - now, kMaxSleepNs)));
+                now = now_ns();
+            }
+        }
+
+        void ActiveInvoker::InvokeClass(JNIEnv *env, const Item &item, std::string &signature) {
+            const InvokeDex &dex = *dexes_[item.dex];
+            std::string binary_name;
+            to_binary_name(dex.reader.GetClassDescriptor(*dex.reader.GetClassDef(item.class_def_idx)), binary_name);
+            if (env->PushLocalFrame(8) != JNI_OK) {
+                env->ExceptionClear();
+                failed_.fetch_add(1, std::memory_order_relaxed);
+                return;
+            }
+
+            jstring name = env->NewStringUTF(binary_name.c_str());
+            jobject clazz = nullptr;
+            if (name != nullptr) {
+                if (options_.mode == kInvokeLoad) {
+                    clazz = env->CallObjectMethod(class_loader_, load_class_, name);
+                } else {
+                    clazz = env->CallStaticObjectMethod(class_class_, for_name_, name, JNI_TRUE, class_loader_);
+                }
+            }
+            // ClassNotFoundException / ExceptionInInitializerError / NoClassDefFoundError 等
+            if (env->ExceptionCheck() || clazz == nullptr) {
+                env->ExceptionClear();
+                failed_.fetch_add(1, std::memory_order_relaxed);
+            } else {
+                loaded_.fetch_add(1, std::memory_order_relaxed);
+                if (options_.mode == kInvokeResolveMethods) {
+                    ResolveMethods(env, static_cast<jclass>(clazz), dex, item.class_def_idx, signature);
+                }
+            }
+            env->PopLocalFrame(nullptr);
+        }
+
+        void ActiveInvoker::ResolveMethods(JNIEnv *env, jclass clazz, const InvokeDex &dex, uint32_t class_def_idx,
+                                           std::string &signature) {
+            const DexReader &reader = dex.reader;
+            ClassAccessor accessor(reader, *reader.GetClassDef(class_def_idx));
+            std::string name;
+            accessor.VisitMethods([&](const Method &method) {
+                const dex::MethodId *id = reader.GetMethodId(method.GetIndex());
+                const dex::ProtoId *proto = id == nullptr ? nullptr : reader.GetProtoId(id->proto_idx_);
+                if (proto == nullptr) {
+                    methods_failed_.fetch_add(1, std::memory_order_relaxed);
+                    return;
+                }
+                name.assign(reader.GetStringData(id->name_idx_));
+                if (name == "<clinit>") return;
+
+                // (参数描述符...)返回值描述符
+                signature.assign("(");
+                if (const dex::TypeList *params = reader.GetProtoParameters(*proto)) {
+                    for (uint32_t i = 0; i < params->size_; ++i) {
+                        signature.append(reader.GetTypeDescriptor(params->list_[i].type_idx_));
+                    }
+                }
+                signature.push_back(')');
+                signature.append(reader.GetTypeDescriptor(proto->return_type_idx_));
+
+                jmethodID method_id = (method.GetAccessFlags() & kAccStatic) != 0
+                                      ? env->GetStaticMethodID(clazz, name.c_str(), signature.c_str())
+                                      : env->GetMethodID(clazz, name.c_str(), signature.c_str());
+                if (env->ExceptionCheck() || method_id == nullptr) {
+                    env->ExceptionClear();
+                    methods_failed_.fetch_add(1, std::memory_order_relaxed);
+                } else {
+                    methods_resolved_.fetch_add(1, std::memory_order_relaxed);
+                }
+            });
+        }
+
+        void ActiveInvoker::MaybeCheckpoint() {
+            if (options_.checkpoint_path.empty()) return;
+            int64_t now = now_ns();
+            int64_t next = next_checkpoint_ns_.load(std::memory_order_relaxed);
+            // 只有抢到这个时间点的线程保存
+            if (now < next || !next_checkpoint_ns_.compare_exchange_strong(
+                    next, now + options_.checkpoint_interval_ms * 1000000LL, std::memory_order_relaxed)) {
+                return;
+            }
+            SaveCheckpoint();
+        }
+
+        void ActiveInvoker::LoadCheckpoint() {
+            std::vector<uint8_t> data;
+            if (options_.checkpoint_path.empty() || !read_file(options_.checkpoint_path, data)) return;
+
+            CheckpointHeader header{};
+            if (data.size() < sizeof(header)) return;
+            memcpy(&header, data.data(), sizeof(header));
+            if (memcmp(header.magic_, kCheckpointMagic, sizeof(kCheckpointMagic)) != 0 ||
+                header.version_ != kCheckpointVersion) {
+                LOGW("ignore invalid checkpoint %s", options_.checkpoint_path.c_str());
+                return;
+            }
+
+            size_t pos = sizeof(header);
+            uint32_t matched = 0;
+            for (uint32_t i = 0; i < header.dex_count_; ++i) {
+                CheckpointDex entry{};
+                if (data.size() - pos < sizeof(entry)) break;
+                memcpy(&entry, data.data() + pos, sizeof(entry));
+                pos += sizeof(entry);
+                size_t words = (static_cast<size_t>(entry.class_def_count_) + 63) / 64;
+                if ((data.size() - pos) / sizeof(uint64_t) < words) break;
+
+                for (auto &dex: dexes_) {
+                    if (dex->checksum != entry.checksum_ || dex->class_def_count != entry.class_def_count_) continue;
+                    for (size_t w = 0; w < words; ++w) {
+                        uint64_t bits;
+                        memcpy(&bits, data.data() + pos + w * sizeof(uint64_t), sizeof(bits));
+                        dex->done[w].fetch_or(bits, std::memory_order_relaxed);
+                    }
+                    ++matched;
+                    break;
+                }
+                pos += words * sizeof(uint64_t);
+            }
+            LOGI("checkpoint %s: %u/%u dex matched", options_.checkpoint_path.c_str(), matched, header.dex_count_);
+        }
+
+        bool ActiveInvoker::SaveCheckpoint() {
+            if (options_.checkpoint_path.empty()) return false;
+            std::lock_guard<std::mutex> lock(checkpoint_mutex_);
+
+            CheckpointHeader header{};
+            memcpy(header.magic_, kCheckpointMagic, sizeof(kCheckpointMagic));
+            header.version_ = kCheckpointVersion;
+            header.dex_count_ = static_cast<uint32_t>(dexes_.size());
+            std::vector<uint8_t> data(reinterpret_cast<const uint8_t *>(&header),
+                                      reinterpret_cast<const uint8_t *>(&header) + sizeof(header));
+            for (const auto &dex: dexes_) {
+                CheckpointDex entry{dex->checksum, dex->class_def_count};
+                data.insert(data.end(), reinterpret_cast<const uint8_t *>(&entry),
+                            reinterpret_cast<const uint8_t *>(&entry) + sizeof(entry));
+                for (size_t w = 0; w < dex->words; ++w) {
+                    uint64_t bits = dex->done[w].load(std::memory_order_relaxed);
+                    data.insert(data.end(), reinterpret_cast<const uint8_t *>(&bits),
+                                reinterpret_cast<const uint8_t *>(&bits) + sizeof(bits));
+                }
+            }
+
+            // 先写临时文件再 rename，被杀时不会留下半个 checkpoint
+            std::string tmp_path = options_.checkpoint_path + ".tmp";
+            int fd = open(tmp_path.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+            if (fd < 0) {
+                LOGE("open %s failed: %s", tmp_path.c_str(), strerror(errno));
+                return false;
+            }
+            bool ok = write_fully(fd, data.data(), data.size());
+            ok = close(fd) == 0 && ok;
+            if (!ok || rename(tmp_path.c_str(), options_.checkpoint_path.c_str()) != 0) {
+                LOGE("save checkpoint %s failed: %s", options_.checkpoint_path.c_str(), strerror(errno));
+                unlink(tmp_path.c_str());
+                return false;
+            }
+            return true;
+        }
+
+        InvokeProgress ActiveInvoker::progress() const {
+            InvokeProgress progress;
+            progress.dex_files = dex_count_.load(std::memory_order_relaxed);
+            progress.total = total_.load(std::memory_order_relaxed);
+            progress.resumed = resumed_.load(std::memory_order_relaxed);
+            progress.done = done_.load(std::memory_order_relaxed);
+            progress.loaded = loaded_.load(std::memory_order_relaxed);
+            progress.failed = failed_.load(std::memory_order_relaxed);
+            progress.methods_resolved = methods_resolved_.load(std::memory_order_relaxed);
+            progress.methods_failed = methods_failed_.load(std::memory_order_relaxed);
+            progress.running = active_workers_.load() > 0;
+            int64_t end_us = progress.running ? now_ns() / 1000 : end_us_.load();
+            progress.elapsed_us = static_cast<uint64_t>(std::max<int64_t>(0, end_us - start_us_.load()));
+            return progress;
+        }
+
+        std::string format_invoke_progress(const InvokeProgress &progress) {
+            char buf[224];
+            snprintf(buf, sizeof(buf),
+                     "dex=%u classes=%u resumed=%u done=%u loaded=%u failed=%u methods=%u methods_failed=%u "
+                     "elapsed=%.1fs running=%d",
+                     progress.dex_files, progress.total, progress.resumed, progress.done, progress.loaded,
+                     progress.failed, progress.methods_resolved, progress.methods_failed,
+                     progress.elapsed_us / 1e6, progress.running ? 1 : 0);
+            return buf;
+        }
+
+    } // namespace hook
+};//namespace cyurs
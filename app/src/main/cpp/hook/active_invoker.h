@@ -0,0 +1,150 @@
+#ifndef CYURS_ACTIVE_INVOKER_H
+#define CYURS_ACTIVE_INVOKER_H
+
+#include <jni.h>
+#include <stdint.h>
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "class_scope.h"
+
+/**
+ * 主动调用引擎（FART 思路）：在 native 中遍历目标 ClassLoader 的全部 DexFile 的 class_defs，
+ * 按 ClassScope 过滤后由一组附加到 JVM 的工作线程逐个加载类、解析方法，
+ * 让抽取壳在 LoadMethod 时回填的 CodeItem 被 hook 采集 / 补丁覆盖。
+ * LoadMethod 在类链接时调用，只加载类就会经过 hook，不需要真正执行方法。
+ *
+ * - 限速：按每秒类数均匀分配时间槽，避免主线程卡顿触发 watchdog；
+ * - 断点续跑：定期把已完成的 class_def 位图写到 checkpoint 文件（先写临时文件再 rename），
+ *   下次 Start 时按 (dex checksum, class_def 数) 匹配并跳过已完成的类。
+ *
+ * checkpoint 格式（小端）：
+ *   CheckpointHeader | { CheckpointDex | uint64_t bitmap[(class_def_count + 63) / 64] } * dex_count
+ */
+namespace cyurs {
+    namespace hook {
+
+        enum InvokeMode : int {
+            // ClassLoader.loadClass：只加载，不执行 <clinit>
+            kInvokeLoad = 0,
+            // Class.forName(name, true, loader)：加载并初始化
+            kInvokeInitialize = 1,
+            // 初始化后按 class_data 中的方法逐个 GetMethodID / GetStaticMethodID
+            kInvokeResolveMethods = 2,
+        };
+
+        struct InvokeOptions {
+            int threads = 2;
+            // 每秒最多处理的类数，0 不限速
+            uint32_t classes_per_second = 0;
+            InvokeMode mode = kInvokeLoad;
+            // 为空时不保存进度
+            std::string checkpoint_path;
+            uint32_t checkpoint_interval_ms = 1000;
+        };
+
+        struct InvokeProgress {
+            uint32_t dex_files = 0;
+            // 范围内的类（包括之前已完成的）
+            uint32_t total = 0;
+            // 从 checkpoint 恢复、本次跳过的类
+            uint32_t resumed = 0;
+            // 本次已处理的类
+            uint32_t done = 0;
+            uint32_t loaded = 0;
+            uint32_t failed = 0;
+            uint32_t methods_resolved = 0;
+            uint32_t methods_failed = 0;
+            uint64_t elapsed_us = 0;
+            bool running = false;
+        };
+
+        std::string format_invoke_progress(const InvokeProgress &progress);
+
+        struct InvokeDex;
+
+        class ActiveInvoker {
+        public:
+            static ActiveInvoker &instance();
+
+            ~ActiveInvoker();
+
+            /**
+             * 在调用线程上收集并过滤类，之后由工作线程异步处理
+             *
+             * @return 正在运行、class_loader 为空或 JNI 查找失败时返回 false
+             */
+            bool Start(JNIEnv *env, jobject class_loader, int sdk_level, const ClassScope &scope,
+                       const InvokeOptions &options);
+
+            // 停止并等待工作线程退出（当前的类处理完），保存进度
+            void Stop();
+
+            InvokeProgress progress() const;
+
+        private:
+            struct Item {
+                uint32_t dex;
+                uint32_t class_def_idx;
+            };
+
+            ActiveInvoker() = default;
+
+            void StopLocked();
+
+            void Worker(int index);
+
+            void Throttle();
+
+            void InvokeClass(JNIEnv *env, const Item &item, std::string &signature);
+
+            void ResolveMethods(JNIEnv *env, jclass clazz, const InvokeDex &dex, uint32_t class_def_idx,
+                                std::string &signature);
+
+            void MaybeCheckpoint();
+
+            void LoadCheckpoint();
+
+            bool SaveCheckpoint();
+
+            std::mutex control_mutex_;
+            std::vector<std::thread> workers_;
+            std::atomic<int> active_workers_{0};
+            std::atomic<bool> stop_{false};
+
+            InvokeOptions options_;
+            JavaVM *vm_ = nullptr;
+            jobject class_loader_ = nullptr;
+            jclass class_class_ = nullptr;
+            jmethodID load_class_ = nullptr;
+            jmethodID for_name_ = nullptr;
+
+            std::vector<std::unique_ptr<InvokeDex>> dexes_;
+            std::vector<Item> items_;
+            std::atomic<size_t> next_item_{0};
+
+            // 限速：下一个可用时间槽（steady_clock 纳秒）
+            std::atomic<int64_t> next_slot_ns_{0};
+            std::mutex checkpoint_mutex_;
+            std::atomic<int64_t> next_checkpoint_ns_{0};
+
+            std::atomic<uint32_t> dex_count_{0};
+            std::atomic<uint32_t> total_{0};
+            std::atomic<uint32_t> resumed_{0};
+            std::atomic<uint32_t> done_{0};
+            std::atomic<uint32_t> loaded_{0};
+            std::atomic<uint32_t> failed_{0};
+            std::atomic<uint32_t> methods_resolved_{0};
+            std::atomic<uint32_t> methods_failed_{0};
+            std::atomic<int64_t> start_us_{0};
+            std::atomic<int64_t> end_us_{0};
+        };
+
+    } // namespace hook
+};//namespace cyurs
+
+#endif //CYURS_ACTIVE_INVOKER_H
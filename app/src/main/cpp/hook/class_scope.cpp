@@ -0,0 +1,108 @@
+#include "class_scope.h"
+
+#include <errno.h>
+#include <cstdio>
+#include <cstring>
+
+namespace cyurs {
+    namespace hook {
+
+        static constexpr uint32_t kNoChild = 0xFFFFFFFF;
+
+        static bool is_space(char c) {
+            return c == ' ' || c == '\t' || c == '\r';
+        }
+
+        static std::string_view trim(std::string_view str) {
+            while (!str.empty() && is_space(str.front())) str.remove_prefix(1);
+            while (!str.empty() && is_space(str.back())) str.remove_suffix(1);
+            return str;
+        }
+
+        // Java 包名 / 类名前缀转为描述符前缀：com.foo. -> Lcom/foo/
+        static std::string to_descriptor_prefix(std::string_view prefix) {
+            if (prefix.front() == 'L' && prefix.find('/') != std::string_view::npos) return std::string(prefix);
+            if (prefix.front() == '[') return std::string(prefix);
+            std::string descriptor = "L";
+            for (char c: prefix) descriptor.push_back(c == '.' ? '/' : c);
+            return descriptor;
+        }
+
+        ClassScope::ClassScope() : nodes_(1) {}
+
+        uint32_t ClassScope::Child(uint32_t node, char c) const {
+            for (const auto &child: nodes_[node].children) {
+                if (child.first == c) return child.second;
+            }
+            return kNoChild;
+        }
+
+        bool ClassScope::AddRule(std::string_view rule) {
+            rule = trim(rule);
+            if (rule.size() < 2 || (rule.front() != '+' && rule.front() != '-')) return false;
+            Rule kind = rule.front() == '+' ? kInclude : kExclude;
+            std::string_view prefix = trim(rule.substr(1));
+            if (prefix.empty()) return false;
+
+            uint32_t node = 0;
+            for (char c: to_descriptor_prefix(prefix)) {
+                uint32_t next = Child(node, c);
+                if (next == kNoChild) {
+                    next = static_cast<uint32_t>(nodes_.size());
+                    nodes_[node].children.emplace_back(c, next);
+                    nodes_.emplace_back();
+                }
+                node = next;
+            }
+
+            if (nodes_[node].rule == kNone) ++rule_count_;
+            if (nodes_[node].rule == kInclude) --include_count_;
+            if (kind == kInclude) ++include_count_;
+            nodes_[node].rule = kind;
+            return true;
+        }
+
+        bool ClassScope::Parse(std::string_view text, ClassScope &scope, std::string *error) {
+            size_t line_no = 0;
+            while (!text.empty()) {
+                size_t end = text.find('\n');
+                std::string_view line = trim(text.substr(0, end));
+                text.remove_prefix(end == std::string_view::npos ? text.size() : end + 1);
+                ++line_no;
+                if (line.empty() || line.front() == '#') continue;
+                if (!scope.AddRule(line)) {
+                    if (error != nullptr) *error = "line " + std::to_string(line_no) + ": bad rule";
+                    return false;
+                }
+            }
+            return true;
+        }
+
+        bool ClassScope::Load(const std::string &path, ClassScope &scope, std::string *error) {
+            FILE *file = fopen(path.c_str(), "rb");
+            if (file == nullptr) {
+                if (error != nullptr) *error = strerror(errno);
+                return false;
+            }
+            std::string text;
+            char buf[4096];
+            size_t n;
+            while ((n = fread(buf, 1, sizeof(buf), file)) > 0) text.append(buf, n);
+            fclose(file);
+            return Parse(text, scope, error);
+        }
+
+        bool ClassScope::Contains(std::string_view descriptor) const {
+            Rule matched = kNone;
+            uint32_t node = 0;
+            for (char c: descriptor) {
+                node = Child(node, c);
+                if (node == kNoChild) break;
+                if (nodes_[node].rule != kNone) matched = nodes_[node].rule;
+            }
+            if (matched != kNone) return matched == kInclude;
+            return include_count_ == 0;
+        }
+
+    } // namespace hook
+};//namespace cyurs
@@ -0,0 +1,69 @@
+#ifndef CYURS_CLASS_SCOPE_H
+#define CYURS_CLASS_SCOPE_H
+
+#include <stdint.h>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+/**
+ * 主动调用的类范围：包含 / 排除前缀组成的前缀树
+ *
+ * 按类描述符（Lcom/foo/Bar;）匹配，最长的匹配前缀决定结果；没有匹配任何前缀时，
+ * 只有在没有包含规则的情况下才算在范围内（只写排除规则表示“除此之外全部”）。
+ *
+ * 配置文件每行一条规则，# 开头为注释：
+ *   +com.target.app.          包含，Java 包名写法（末尾的 . 表示只匹配这个包及子包）
+ *   -com.target.app.sdk.      排除
+ *   +Lcom/other/Main;         也可以直接写类描述符
+ */
+namespace cyurs {
+    namespace hook {
+
+        class ClassScope {
+        public:
+            ClassScope();
+
+            /**
+             * 添加一条规则（+ 包含，- 排除），同一前缀后添加的覆盖前面的
+             *
+             * @return 格式错误返回 false
+             */
+            bool AddRule(std::string_view rule);
+
+            // @param error 失败时为带行号的错误信息
+            static bool Parse(std::string_view text, ClassScope &scope, std::string *error);
+
+            // 读取并解析配置文件，error 为文件错误或带行号的格式错误
+            static bool Load(const std::string &path, ClassScope &scope, std::string *error);
+
+            // @param descriptor 类描述符，如 Lcom/foo/Bar;
+            bool Contains(std::string_view descriptor) const;
+
+            size_t rule_count() const { return rule_count_; }
+
+        private:
+            enum Rule : int8_t {
+                kNone = 0,
+                kInclude = 1,
+                kExclude = -1,
+            };
+
+            struct Node {
+                Rule rule = kNone;
+                // (字符, 子节点下标)，规则通常只有几十条，线性查找
+                std::vector<std::pair<char, uint32_t>> children;
+            };
+
+            uint32_t Child(uint32_t node, char c) const;
+
+            std::vector<Node> nodes_;
+            size_t rule_count_ = 0;
+            size_t include_count_ = 0;
+        };
+
+    } // namespace hook
+};//namespace cyurs
+
+#endif //CYURS_CLASS_SCOPE_H
@@ -0,0 +1,261 @@
+#include "code_capture.h"
+
+#include <errno.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <memory>
+#include <android/log.h>
+
+#include "../dex/code_dump.h"
+
+#define LOG_TAG "CodeCapture"
+#define LOGI(...) __android_log_print(ANDROID_LOG_INFO, LOG_TAG, __VA_ARGS__)
+#define LOGE(...) __android_log_print(ANDROID_LOG_ERROR, LOG_TAG, __VA_ARGS__)
+
+namespace cyurs {
+    namespace hook {
+
+        using dex::CodeDumpRecordHeader;
+
+        // 写线程批量缓冲区的初始大小，所有缓冲区的数据合并后一次 write
+        static constexpr size_t kBatchSize = 4u << 20;
+        static constexpr uint32_t kMinRingSize = 4096;
+
+        /**
+         * 单生产者（拥有它的线程）单消费者（写线程）的字节环
+         *
+         * head / tail 只增不减，位置为 & mask；记录整条写入后才发布 head，消费者看到的总是完整记录。
+         */
+        struct CaptureRing {
+            // 生产者写，消费者读
+            alignas(64) std::atomic<uint64_t> head{0};
+            std::atomic<uint64_t> captured{0};
+            std::atomic<uint64_t> dropped{0};
+            // 消费者写，生产者读
+            alignas(64) std::atomic<uint64_t> tail{0};
+            alignas(64) std::atomic<bool> in_use{false};
+            CaptureRing *next = nullptr;
+            uint64_t mask = 0;
+            std::unique_ptr<uint8_t[]> data;
+
+            explicit CaptureRing(uint32_t size) : mask(size - 1), data(new uint8_t[size]) {}
+
+            void CopyIn(uint64_t pos, const void *src, size_t len) {
+                if (len == 0) return;
+                size_t offset = static_cast<size_t>(pos & mask);
+                size_t first = std::min<size_t>(len, mask + 1 - offset);
+                memcpy(data.get() + offset, src, first);
+                memcpy(data.get(), static_cast<const uint8_t *>(src) + first, len - first);
+            }
+
+            void CopyOut(uint64_t pos, size_t len, std::string &out) const {
+                size_t offset = static_cast<size_t>(pos & mask);
+                size_t first = std::min<size_t>(len, mask + 1 - offset);
+                out.append(reinterpret_cast<const char *>(data.get() + offset), first);
+                out.append(reinterpret_cast<const char *>(data.get()), len - first);
+            }
+        };
+
+        // 线程退出时归还缓冲区
+        struct RingHolder {
+            CaptureRing *ring = nullptr;
+
+            ~RingHolder() {
+                if (ring != nullptr) ring->in_use.store(false, std::memory_order_release);
+            }
+        };
+
+        static thread_local RingHolder t_ring;
+
+        static uint32_t round_up_pow2(uint32_t size) {
+            uint32_t result = kMinRingSize;
+            while (result < size && result < (1u << 30)) result <<= 1;
+            return result;
+        }
+
+        static bool write_fully(int fd, const char *data, size_t size) {
+            while (size > 0) {
+                ssize_t n = write(fd, data, size);
+                if (n < 0) {
+                    if (errno == EINTR) continue;
+                    return false;
+                }
+                data += n;
+                size -= static_cast<size_t>(n);
+            }
+            return true;
+        }
+
+        CodeCapture &CodeCapture::instance() {
+            // 不析构，进程退出时可能还有线程在 hook 中
+            static auto *capture = new CodeCapture();
+            return *capture;
+        }
+
+        CaptureRing *CodeCapture::AcquireRing() {
+            // 先复用已退出线程的缓冲区
+            for (CaptureRing *ring = rings_.load(std::memory_order_acquire); ring != nullptr; ring = ring->next) {
+                bool expected = false;
+                if (!ring->in_use.load(std::memory_order_relaxed) &&
+                    ring->in_use.compare_exchange_strong(expected, true, std::memory_order_acquire)) {
+                    return ring;
+                }
+            }
+
+            auto *ring = new(std::nothrow) CaptureRing(ring_size_.load(std::memory_order_relaxed));
+            if (ring == nullptr) return nullptr;
+            ring->in_use.store(true, std::memory_order_relaxed);
+            ring->next = rings_.load(std::memory_order_relaxed);
+            while (!rings_.compare_exchange_weak(ring->next, ring, std::memory_order_release,
+                                                 std::memory_order_relaxed)) {
+            }
+            ring_count_.fetch_add(1, std::memory_order_relaxed);
+            return ring;
+        }
+
+        bool CodeCapture::Capture(uint32_t dex_checksum, uint32_t method_idx, const uint8_t *code, uint32_t code_len) {
+            if (!running()) return false;
+            CaptureRing *ring = t_ring.ring;
+            if (ring == nullptr) {
+                // 每个线程只在第一次采集时分配
+                ring = AcquireRing();
+                if (ring == nullptr) return false;
+                t_ring.ring = ring;
+            }
+
+            uint64_t need = sizeof(CodeDumpRecordHeader) + static_cast<uint64_t>(code_len);
+            uint64_t head = ring->head.load(std::memory_order_relaxed);
+            uint64_t tail = ring->tail.load(std::memory_order_acquire);
+            if (need > ring->mask + 1 - (head - tail)) {
+                ring->dropped.fetch_add(1, std::memory_order_relaxed);
+                return false;
+            }
+
+            CodeDumpRecordHeader record{dex_checksum, method_idx, code_len};
+            ring->CopyIn(head, &record, sizeof(record));
+            ring->CopyIn(head + sizeof(record), code, code_len);
+            ring->head.store(head + need, std::memory_order_release);
+            ring->captured.fetch_add(1, std::memory_order_relaxed);
+            return true;
+        }
+
+        size_t CodeCapture::Drain(std::string &batch) {
+            size_t total = 0;
+            for (CaptureRing *ring = rings_.load(std::memory_order_acquire); ring != nullptr; ring = ring->next) {
+                uint64_t tail = ring->tail.load(std::memory_order_relaxed);
+                uint64_t head = ring->head.load(std::memory_order_acquire);
+                if (head == tail) continue;
+                ring->CopyOut(tail, static_cast<size_t>(head - tail), batch);
+                ring->tail.store(head, std::memory_order_release);
+                total += static_cast<size_t>(head - tail);
+            }
+            if (batch.empty()) return total;
+
+            if (write_fully(fd_, batch.data(), batch.size())) {
+                bytes_written_.fetch_add(batch.size(), std::memory_order_relaxed);
+            } else {
+                LOGE("write failed: errno=%d, %zu bytes lost", errno, batch.size());
+            }
+            batch.clear();
+            return total;
+        }
+
+        void CodeCapture::Discard() {
+            for (CaptureRing *ring = rings_.load(std::memory_order_acquire); ring != nullptr; ring = ring->next) {
+                ring->tail.store(ring->head.load(std::memory_order_acquire), std::memory_order_release);
+                ring->captured.store(0, std::memory_order_relaxed);
+                ring->dropped.store(0, std::memory_order_relaxed);
+            }
+            bytes_written_.store(0, std::memory_order_relaxed);
+        }
+
+        void CodeCapture::WriterLoop() {
+            std::string batch;
+            batch.reserve(kBatchSize);
+            bool stop = false;
+            while (!stop) {
+                {
+                    std::unique_lock<std::mutex> lock(mutex_);
+                    cond_.wait_for(lock, std::chrono::milliseconds(flush_interval_ms_),
+                                   [this] { return stop_requested_; });
+                    stop = stop_requested_;
+                }
+                Drain(batch);
+                if (batch.capacity() > kBatchSize * 4) batch.shrink_to_fit();
+            }
+        }
+
+        bool CodeCapture::Start(const std::string &path, uint32_t ring_size, uint32_t flush_interval_ms) {
+            std::lock_guard<std::mutex> control(control_mutex_);
+            StopLocked();
+
+            int fd = open(path.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+            if (fd < 0) {
+                LOGE("open %s failed: errno=%d", path.c_str(), errno);
+                return false;
+            }
+            std::string header;
+            dex::WriteCodeDumpHeader(header);
+            if (!write_fully(fd, header.data(), header.size())) {
+                LOGE("write %s failed: errno=%d", path.c_str(), errno);
+                close(fd);
+                return false;
+            }
+
+            // 写线程还没启动，这里是唯一的消费者
+            Discard();
+            fd_ = fd;
+            ring_size_.store(round_up_pow2(ring_size), std::memory_order_relaxed);
+            flush_interval_ms_ = flush_interval_ms == 0 ? kDefaultFlushIntervalMs : flush_interval_ms;
+            stop_requested_ = false;
+            writer_ = std::thread(&CodeCapture::WriterLoop, this);
+            running_.store(true, std::memory_order_release);
+            LOGI("capture started: %s", path.c_str());
+            return true;
+        }
+
+        void CodeCapture::Stop() {
+            std::lock_guard<std::mutex> control(control_mutex_);
+            StopLocked();
+        }
+
+        void CodeCapture::StopLocked() {
+            if (!writer_.joinable()) return;
+            // 先停止采集；此时正在 hook 中的线程写进来的记录留在缓冲区，下次 Start 时丢弃
+            running_.store(false, std::memory_order_release);
+            {
+                std::lock_guard<std::mutex> lock(mutex_);
+                stop_requested_ = true;
+            }
+            cond_.notify_one();
+            writer_.join();
+            close(fd_);
+            fd_ = -1;
+            LOGI("capture stopped: %s", format_capture_stats(stats()).c_str());
+        }
+
+        CaptureStats CodeCapture::stats() const {
+            CaptureStats stats;
+            for (CaptureRing *ring = rings_.load(std::memory_order_acquire); ring != nullptr; ring = ring->next) {
+                stats.captured += ring->captured.load(std::memory_order_relaxed);
+                stats.dropped += ring->dropped.load(std::memory_order_relaxed);
+            }
+            stats.bytes_written = bytes_written_.load(std::memory_order_relaxed);
+            stats.rings = ring_count_.load(std::memory_order_relaxed);
+            return stats;
+        }
+
+        std::string format_capture_stats(const CaptureStats &stats) {
+            char buf[160];
+            snprintf(buf, sizeof(buf), "captured=%llu dropped=%llu bytes=%llu rings=%u",
+                     static_cast<unsigned long long>(stats.captured), static_cast<unsigned long long>(stats.dropped),
+                     static_cast<unsigned long long>(stats.bytes_written), stats.rings);
+            return buf;
+        }
+
+    } // namespace hook
+};//namespace cyurs
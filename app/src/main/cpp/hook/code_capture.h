@@ -0,0 +1,108 @@
+#ifndef CYURS_CODE_CAPTURE_H
+#define CYURS_CODE_CAPTURE_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
+#include <string>
+#include <thread>
+
+/**
+ * LoadMethod hook 中的 code_item 采集
+ *
+ * 每个加载类的线程有一个自己的环形缓冲区（单生产者单消费者，无锁），hook 中只做一次 memcpy，
+ * 后台线程定期把所有缓冲区的数据批量写到文件。文件为 dex/code_dump.h 的二进制格式（CDMP），
+ * 可以直接交给 dex_repair 回填。
+ *
+ * 缓冲区满时丢弃该条记录并计数，从不阻塞加载类的线程。
+ * 线程退出后缓冲区归还，由之后新建的线程复用，剩余数据照常写出。
+ */
+namespace cyurs {
+    namespace hook {
+
+        struct CaptureStats {
+            // 写入缓冲区的记录数
+            uint64_t captured = 0;
+            // 缓冲区满或记录太大被丢弃的记录数
+            uint64_t dropped = 0;
+            // 写到文件的字节数（不含文件头）
+            uint64_t bytes_written = 0;
+            // 创建的缓冲区个数
+            uint32_t rings = 0;
+        };
+
+        struct CaptureRing;
+
+        class CodeCapture {
+        public:
+            // 每个线程的缓冲区大小（2 的幂）
+            static constexpr uint32_t kDefaultRingSize = 1u << 20;
+            static constexpr uint32_t kDefaultFlushIntervalMs = 100;
+
+            static CodeCapture &instance();
+
+            /**
+             * 创建（截断）输出文件并启动后台写线程，已启动时先 Stop
+             *
+             * @param ring_size 之后新建的缓冲区大小，向上取 2 的幂
+             */
+            bool Start(const std::string &path, uint32_t ring_size = kDefaultRingSize,
+                       uint32_t flush_interval_ms = kDefaultFlushIntervalMs);
+
+            // 写出剩余数据并关闭文件
+            void Stop();
+
+            bool running() const { return running_.load(std::memory_order_relaxed); }
+
+            /**
+             * 追加一条记录到当前线程的缓冲区（hook 中调用）
+             *
+             * @return 未启动或缓冲区满返回 false
+             */
+            bool Capture(uint32_t dex_checksum, uint32_t method_idx, const uint8_t *code, uint32_t code_len);
+
+            CaptureStats stats() const;
+
+        private:
+            CodeCapture() = default;
+
+            CaptureRing *AcquireRing();
+
+            // 需持有 control_mutex_
+            void StopLocked();
+
+            void WriterLoop();
+
+            // 把所有缓冲区的数据取出并写到文件，返回写出的字节数
+            size_t Drain(std::string &batch);
+
+            // 丢弃所有缓冲区中的旧数据（上一次采集停止后才写进去的）
+            void Discard();
+
+            std::atomic<bool> running_{false};
+            // 全局缓冲区链表，只增不减
+            std::atomic<CaptureRing *> rings_{nullptr};
+            std::atomic<uint32_t> ring_size_{kDefaultRingSize};
+            std::atomic<uint32_t> ring_count_{0};
+            std::atomic<uint64_t> bytes_written_{0};
+
+            // 以下只在 Start / Stop 和写线程中使用
+            // 串行化 Start / Stop，保证同一时刻只有一个消费者
+            std::mutex control_mutex_;
+            // 唤醒写线程
+            std::mutex mutex_;
+            std::condition_variable cond_;
+            bool stop_requested_ = false;
+            uint32_t flush_interval_ms_ = kDefaultFlushIntervalMs;
+            int fd_ = -1;
+            std::thread writer_;
+        };
+
+        std::string format_capture_stats(const CaptureStats &stats);
+
+    } // namespace hook
+};//namespace cyurs
+
+#endif //CYURS_CODE_CAPTURE_H
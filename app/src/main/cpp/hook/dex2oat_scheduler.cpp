@@ -0,0 +1,271 @@
+#include "dex2oat_scheduler.h"
+
+#include <dlfcn.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <sys/wait.h>
+#include <time.h>
+#include <unistd.h>
+#include <algorithm>
+#include <atomic>
+#include <cstdio>
+#include <cstring>
+#include <thread>
+#include <android/log.h>
+
+#include "exec_rules.h"
+
+#define LOG_TAG "Dex2oatScheduler"
+#define LOGI(...) __android_log_print(ANDROID_LOG_INFO, LOG_TAG, __VA_ARGS__)
+#define LOGW(...) __android_log_print(ANDROID_LOG_WARN, LOG_TAG, __VA_ARGS__)
+#define LOGE(...) __android_log_print(ANDROID_LOG_ERROR, LOG_TAG, __VA_ARGS__)
+
+extern char **environ;
+
+namespace cyurs {
+    namespace hook {
+
+        static constexpr int kMaxJobs = 16;
+
+        static uint64_t now_us() {
+            struct timespec ts{};
+            clock_gettime(CLOCK_MONOTONIC, &ts);
+            return static_cast<uint64_t>(ts.tv_sec) * 1000000ULL + ts.tv_nsec / 1000;
+        }
+
+        static uint64_t fnv1a64(uint64_t hash, const void *data, size_t size) {
+            const auto *bytes = static_cast<const uint8_t *>(data);
+            for (size_t i = 0; i < size; ++i) {
+                hash ^= bytes[i];
+                hash *= 0x100000001B3ULL;
+            }
+            return hash;
+        }
+
+        // dex 取头中的 checksum_（只读 12 字节），其他文件对全部内容求哈希
+        static bool input_checksum(const std::string &path, uint32_t *checksum) {
+            int fd = open(path.c_str(), O_RDONLY | O_CLOEXEC);
+            if (fd < 0) return false;
+            uint8_t buf[64 * 1024];
+            ssize_t n = pread(fd, buf, 12, 0);
+            if (n == 12 && memcmp(buf, "dex\n", 4) == 0) {
+                memcpy(checksum, buf + 8, sizeof(*checksum));
+                close(fd);
+                return true;
+            }
+            uint64_t hash = 0xCBF29CE484222325ULL;
+            while ((n = read(fd, buf, sizeof(buf))) != 0) {
+                if (n < 0) {
+                    if (errno == EINTR) continue;
+                    close(fd);
+                    return false;
+                }
+                hash = fnv1a64(hash, buf, static_cast<size_t>(n));
+            }
+            close(fd);
+            *checksum = static_cast<uint32_t>(hash ^ (hash >> 32));
+            return true;
+        }
+
+        static bool file_exists(const std::string &path) {
+            struct stat st{};
+            return stat(path.c_str(), &st) == 0 && S_ISREG(st.st_mode);
+        }
+
+        // 先写临时文件再 rename，其他任务不会读到写了一半的缓存
+        static bool copy_file(const std::string &src, const std::string &dst) {
+            int in = open(src.c_str(), O_RDONLY | O_CLOEXEC);
+            if (in < 0) return false;
+            char suffix[32];
+            snprintf(suffix, sizeof(suffix), ".tmp%d", gettid());
+            std::string tmp = dst + suffix;
+            int out = open(tmp.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+            if (out < 0) {
+                close(in);
+                return false;
+            }
+
+            bool ok = true;
+            char buf[64 * 1024];
+            while (ok) {
+                ssize_t n = read(in, buf, sizeof(buf));
+                if (n < 0 && errno == EINTR) continue;
+                if (n <= 0) {
+                    ok = n == 0;
+                    break;
+                }
+                for (ssize_t written = 0; ok && written < n;) {
+                    ssize_t w = write(out, buf + written, static_cast<size_t>(n - written));
+                    if (w < 0 && errno == EINTR) continue;
+                    ok = w > 0;
+                    written += w;
+                }
+            }
+            close(in);
+            ok = close(out) == 0 && ok;
+            if (!ok || rename(tmp.c_str(), dst.c_str()) != 0) {
+                unlink(tmp.c_str());
+                return false;
+            }
+            return true;
+        }
+
+        // dex2oat 在 --oat-file 旁边生成同名的 .vdex
+        static std::string vdex_path(const std::string &oat_path) {
+            size_t slash = oat_path.rfind('/');
+            size_t dot = oat_path.rfind('.');
+            if (dot == std::string::npos || (slash != std::string::npos && dot < slash)) return oat_path + ".vdex";
+            return oat_path.substr(0, dot) + ".vdex";
+        }
+
+        static void replace_all(std::string &str, const char *from, const std::string &to) {
+            size_t from_len = strlen(from);
+            for (size_t pos = str.find(from); pos != std::string::npos; pos = str.find(from, pos + to.size())) {
+                str.replace(pos, from_len, to);
+            }
+        }
+
+        /**
+         * 启动子进程，返回 pid，失败返回 -1
+         *
+         * posix_spawn 在 API 28 才加入 bionic（minSdk 为 26），运行时查找；没有时 vfork + execve，子进程只调用 execve / _exit。
+         * 查找到的是被 hook 的 posix_spawn / execve，这里启动的子进程不经过 execve 规则（默认规则拒绝 dex2oat）。
+         */
+        static pid_t spawn_process(const std::string &path, const std::vector<std::string> &args) {
+            std::vector<char *> argv;
+            argv.push_back(const_cast<char *>(path.c_str()));
+            for (const std::string &arg: args) argv.push_back(const_cast<char *>(arg.c_str()));
+            argv.push_back(nullptr);
+
+            ScopedExecRulesBypass bypass;
+            using PosixSpawn = int (*)(pid_t *, const char *, const void *, const void *, char *const[], char *const[]);
+            static auto posix_spawn_fn = reinterpret_cast<PosixSpawn>(dlsym(RTLD_DEFAULT, "posix_spawn"));
+            if (posix_spawn_fn != nullptr) {
+                pid_t pid;
+                int error = posix_spawn_fn(&pid, path.c_str(), nullptr, nullptr, argv.data(), environ);
+                if (error != 0) {
+                    LOGE("posix_spawn %s failed: %s", path.c_str(), strerror(error));
+                    return -1;
+                }
+                return pid;
+            }
+
+            pid_t pid = vfork();
+            if (pid == 0) {
+                execve(path.c_str(), argv.data(), environ);
+                _exit(kDex2oatSpawnFailed);
+            }
+            if (pid < 0) LOGE("vfork failed: %s", strerror(errno));
+            return pid;
+        }
+
+        static int wait_process(pid_t pid) {
+            int status = 0;
+            while (waitpid(pid, &status, 0) < 0) {
+                if (errno != EINTR) return kDex2oatSpawnFailed;
+            }
+            if (WIFEXITED(status)) return WEXITSTATUS(status);
+            if (WIFSIGNALED(status)) return kDex2oatSignalBase + WTERMSIG(status);
+            return kDex2oatSpawnFailed;
+        }
+
+        std::vector<std::string> DefaultDex2oatArgs() {
+#if defined(__aarch64__)
+            const char *isa = "--instruction-set=arm64";
+#elif defined(__arm__)
+            const char *isa = "--instruction-set=arm";
+#elif defined(__x86_64__)
+            const char *isa = "--instruction-set=x86_64";
+#else
+            const char *isa = "--instruction-set=x86";
+#endif
+            return {
+                    "--dex-file={dex}",
+                    "--oat-file={oat}",
+                    isa,
+                    "--runtime-arg",
+                    "-Xbootclasspath:/apex/com.android.art/javalib/core-oj.jar:/apex/com.android.art/javalib/core-libart.jar",
+                    "--boot-image=/apex/com.android.art/javalib/boot.art",
+            };
+        }
+
+        static void run_job(const Dex2oatJob &job, const Dex2oatOptions &options,
+                            const std::vector<std::string> &args, uint64_t args_hash, Dex2oatResult &result) {
+            uint64_t start = now_us();
+            std::string cache_oat;
+            std::string cache_vdex;
+            uint32_t checksum;
+            if (!options.cache_dir.empty() && input_checksum(job.dex_path, &checksum)) {
+                // dex2oat 把 dex location（默认为 --dex-file 的路径）写入 oat，同一个 dex 换了路径不能复用
+                uint64_t key = fnv1a64(args_hash, job.dex_path.c_str(), job.dex_path.size() + 1);
+                char name[48];
+                snprintf(name, sizeof(name), "/%08x_%016llx", checksum, static_cast<unsigned long long>(key));
+                cache_oat = options.cache_dir + name + ".oat";
+                cache_vdex = options.cache_dir + name + ".vdex";
+                if (file_exists(cache_oat) && copy_file(cache_oat, job.oat_path) &&
+                    (!file_exists(cache_vdex) || copy_file(cache_vdex, vdex_path(job.oat_path)))) {
+                    result.status = 0;
+                    result.cached = true;
+                    result.elapsed_us = now_us() - start;
+                    return;
+                }
+            }
+
+            std::vector<std::string> job_args = args;
+            for (std::string &arg: job_args) {
+                replace_all(arg, "{dex}", job.dex_path);
+                replace_all(arg, "{oat}", job.oat_path);
+            }
+            pid_t pid = spawn_process(options.compiler, job_args);
+            result.status = pid < 0 ? kDex2oatSpawnFailed : wait_process(pid);
+            result.elapsed_us = now_us() - start;
+
+            if (result.status == 0 && !cache_oat.empty() && file_exists(job.oat_path)) {
+                // 先放 .vdex，.oat 存在即表示缓存完整
+                std::string vdex = vdex_path(job.oat_path);
+                bool ok = !file_exists(vdex) || copy_file(vdex, cache_vdex);
+                if (!ok || !copy_file(job.oat_path, cache_oat)) LOGW("cache %s failed", job.oat_path.c_str());
+            }
+        }
+
+        std::vector<Dex2oatResult> RunDex2oatJobs(const std::vector<Dex2oatJob> &jobs, const Dex2oatOptions &options) {
+            std::vector<Dex2oatResult> results(jobs.size());
+            if (jobs.empty()) return results;
+            if (!options.cache_dir.empty()) mkdir(options.cache_dir.c_str(), 0755);
+
+            const std::vector<std::string> args = options.args.empty() ? DefaultDex2oatArgs() : options.args;
+            // 命令和参数模板（替换前）的哈希，每个任务再加上输入路径
+            uint64_t args_hash = fnv1a64(0xCBF29CE484222325ULL, options.compiler.c_str(), options.compiler.size() + 1);
+            for (const std::string &arg: args) args_hash = fnv1a64(args_hash, arg.c_str(), arg.size() + 1);
+
+            uint64_t start = now_us();
+            std::atomic<size_t> next{0};
+            auto worker = [&]() {
+                for (size_t i = next.fetch_add(1); i < jobs.size(); i = next.fetch_add(1)) {
+                    run_job(jobs[i], options, args, args_hash, results[i]);
+                    LOGI("%s -> %s: status=%d%s %.1fms", jobs[i].dex_path.c_str(), jobs[i].oat_path.c_str(),
+                         results[i].status, results[i].cached ? " (cached)" : "", results[i].elapsed_us / 1000.0);
+                }
+            };
+
+            // 每个线程同一时间只有一个子进程
+            size_t threads = std::min<size_t>(std::max(1, std::min(options.max_jobs, kMaxJobs)), jobs.size());
+            std::vector<std::thread> workers;
+            for (size_t i = 1; i < threads; ++i) workers.emplace_back(worker);
+            worker();
+            for (std::thread &thread: workers) thread.join();
+
+            size_t failed = 0;
+            size_t cached = 0;
+            for (const Dex2oatResult &result: results) {
+                failed += result.status != 0;
+                cached += result.cached;
+            }
+            LOGI("dex2oat: %zu jobs, %zu cached, %zu failed, jobs=%zu, %.1fms", jobs.size(), cached, failed, threads,
+                 (now_us() - start) / 1000.0);
+            return results;
+        }
+
+    } // namespace hook
+};//namespace cyurs
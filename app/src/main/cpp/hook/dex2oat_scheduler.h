@@ -0,0 +1,61 @@
+#ifndef CYURS_DEX2OAT_SCHEDULER_H
+#define CYURS_DEX2OAT_SCHEDULER_H
+
+#include <stdint.h>
+#include <string>
+#include <vector>
+
+/**
+ * 并行调用 dex2oat（或任意替代命令）编译多个 dex，带编译结果缓存
+ *
+ * 每个任务在独立的子进程中执行（posix_spawn，系统不支持时 vfork + execve），不会替换当前进程；
+ * 最多同时运行 max_jobs 个子进程，每个工作线程只 waitpid 自己启动的子进程，不影响进程中其他子进程。
+ *
+ * 缓存键为 (dex 头中的 checksum_, 编译命令、参数模板及输入路径的哈希)，非 dex 输入（apk / jar）用整个文件的哈希代替 checksum。
+ * 输入路径也是键的一部分：oat 中记录了 dex location，默认即 --dex-file 的路径。
+ * 命中时直接复制缓存的输出，不再启动编译；编译成功后把输出（以及同名的 .vdex，如果生成了）放入缓存。
+ *
+ * 参数模板中的 {dex} / {oat} 替换为每个任务的输入 / 输出路径。
+ */
+namespace cyurs {
+    namespace hook {
+
+        // 与 shell 一致：127 无法启动，128 + N 被信号 N 终止
+        constexpr int kDex2oatSpawnFailed = 127;
+        constexpr int kDex2oatSignalBase = 128;
+
+        struct Dex2oatOptions {
+            std::string compiler = "/system/bin/dex2oat";
+            // 为空时使用 DefaultDex2oatArgs()
+            std::vector<std::string> args;
+            int max_jobs = 2;
+            // 为空时不缓存
+            std::string cache_dir;
+        };
+
+        struct Dex2oatJob {
+            std::string dex_path;
+            std::string oat_path;
+        };
+
+        struct Dex2oatResult {
+            // 0 成功（包括缓存命中），其余见 kDex2oatSpawnFailed / kDex2oatSignalBase
+            int status = kDex2oatSpawnFailed;
+            bool cached = false;
+            uint64_t elapsed_us = 0;
+        };
+
+        // --dex-file={dex} --oat-file={oat} --instruction-set=<当前 ABI> 以及 boot image 参数
+        std::vector<std::string> DefaultDex2oatArgs();
+
+        /**
+         * 执行全部任务并等待完成（阻塞，不要在主线程调用）
+         *
+         * @return 与 jobs 一一对应
+         */
+        std::vector<Dex2oatResult> RunDex2oatJobs(const std::vector<Dex2oatJob> &jobs, const Dex2oatOptions &options);
+
+    } // namespace hook
+};//namespace cyurs
+
+#endif //CYURS_DEX2OAT_SCHEDULER_H
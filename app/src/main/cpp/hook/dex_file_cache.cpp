@@ -0,0 +1,165 @@
+#include "dex_file_cache.h"
+
+#include <cstring>
+#include <android/log.h>
+
+#include "../dex/method_table.h"
+
+#define LOG_TAG "DexFileCache"
+#define LOGI(...) __android_log_print(ANDROID_LOG_INFO, LOG_TAG, __VA_ARGS__)
+
+namespace cyurs {
+    namespace hook {
+
+        const PatchSlice *DexFileMeta::GetPatchSlice(const PatchTable *table) const {
+            const PatchSlice *slice = slice_.load(std::memory_order_acquire);
+            if (slice != nullptr && slice->table == table) return slice;
+
+            std::lock_guard<std::mutex> lock(slice_mutex_);
+            slice = slice_.load(std::memory_order_relaxed);
+            if (slice != nullptr && slice->table == table) return slice;
+            // 补丁表替换后旧的 slice 不释放，可能还有线程在使用
+            slice = BuildPatchSlice(table);
+            slice_.store(slice, std::memory_order_release);
+            return slice;
+        }
+
+        const PatchSlice *DexFileMeta::BuildPatchSlice(const PatchTable *table) const {
+            auto *slice = new PatchSlice();
+            slice->table = table;
+            if (table == nullptr || !standard_dex || method_ids_size == 0) return slice;
+
+            bool has_location = table->has_kind(kPatchKeyLocation);
+            uint64_t location_hash = has_location ? HashPatchLocation(info.location) : 0;
+
+            // 与 PatchTable::Find 的顺序一致：checksum > location > 任意 dex（kind 越小越优先）
+            std::vector<const PatchEntry *> &entries = slice->entries;
+            for (const PatchEntry &patch: *table) {
+                bool match = patch.kind_ == kPatchKeyAnyDex ||
+                             (patch.kind_ == kPatchKeyDexChecksum && patch.dex_key_ == dex_checksum) ||
+                             (has_location && patch.kind_ == kPatchKeyLocation &&
+                              patch.dex_key_ == static_cast<uint32_t>(location_hash) &&
+                              patch.dex_key_high_ == static_cast<uint32_t>(location_hash >> 32) &&
+                              table->location(patch) == info.location);
+                if (!match || patch.method_idx_ >= method_ids_size) continue;
+                if (entries.empty()) entries.assign(method_ids_size, nullptr);
+                const PatchEntry *&current = entries[patch.method_idx_];
+                if (current == nullptr || patch.kind_ < current->kind_) current = &patch;
+            }
+
+            size_t count = 0;
+            for (const PatchEntry *patch: entries) count += patch != nullptr;
+            if (count == 0) {
+                entries.clear();
+                entries.shrink_to_fit();
+                return slice;
+            }
+
+            // MethodTable 中放得下的补丁，所在的页预先设为可写；其余的留到 hook 中按 ART 加载的 code_item 检查
+            // （壳可能在运行时改写 code_off，表中为 0 或长度不够的方法之后不一定仍是这样）
+            std::vector<PageRange> ranges;
+            const dex::MethodTable *method_table = dex::MethodTableCache::instance().Get(info.begin, info.size);
+            for (uint32_t method_idx = 0; method_table != nullptr && method_idx < entries.size(); ++method_idx) {
+                const PatchEntry *patch = entries[method_idx];
+                if (patch == nullptr) continue;
+                const dex::MethodTableEntry *entry = method_table->Find(method_idx);
+                if (entry == nullptr || entry->code_off == 0 || patch->insns_size_ > entry->insns_size) continue;
+                ranges.push_back({info.begin + entry->code_off + 16, patch->insns_size_ * sizeof(uint16_t)});
+            }
+
+            // 全部补丁所在的页一次设为可写
+            slice->pages = DexPageTrackerCache::instance().Get(info.begin, info.size);
+            slice->pages->MakeWritable(ranges.data(), ranges.size());
+            LOGI("%zu patches for %s, mprotect calls=%u", count, info.location.c_str(),
+                 slice->pages->mprotect_calls());
+            return slice;
+        }
+
+        static size_t hash_pointer(const void *ptr) {
+            auto value = static_cast<uint64_t>(reinterpret_cast<uintptr_t>(ptr));
+            return static_cast<size_t>((value >> 4) * 0x9E3779B97F4A7C15ULL >> 40);
+        }
+
+        DexFileCache &DexFileCache::instance() {
+            // 不析构，进程退出时可能还有线程在 hook 中
+            static auto *cache = new DexFileCache();
+            return *cache;
+        }
+
+        DexFileCache::DexFileCache() : slots_(new std::atomic<const DexFileMeta *>[kCapacity]) {
+            for (size_t i = 0; i < kCapacity; ++i) slots_[i].store(nullptr, std::memory_order_relaxed);
+        }
+
+        const DexFileMeta *DexFileCache::Probe(const void *dex_file, const uint8_t *begin) const {
+            size_t slot = hash_pointer(dex_file);
+            for (size_t i = 0; i < kCapacity; ++i, ++slot) {
+                const DexFileMeta *meta = slots_[slot & (kCapacity - 1)].load(std::memory_order_acquire);
+                if (meta == nullptr) return nullptr;
+                if (meta->dex_file == dex_file && meta->info.begin == begin) return meta;
+            }
+            return nullptr;
+        }
+
+        const DexFileMeta *DexFileCache::Get(const void *dex_file, int sdk_level) {
+            const uint8_t *begin = GetDexFileBegin(dex_file, sdk_level);
+            if (begin == nullptr) return nullptr;
+
+            // 同一线程连续加载同一个 dex 的方法
+            thread_local const DexFileMeta *last_meta = nullptr;
+            if (last_meta != nullptr && last_meta->dex_file == dex_file && last_meta->info.begin == begin) {
+                return last_meta;
+            }
+
+            const DexFileMeta *meta = Probe(dex_file, begin);
+            if (meta == nullptr) {
+                std::lock_guard<std::mutex> lock(mutex_);
+                auto it = overflow_.find(dex_file);
+                if (it != overflow_.end() && it->second->info.begin == begin) meta = it->second;
+            }
+            if (meta != nullptr) {
+                last_meta = meta;
+                return meta;
+            }
+
+            // 在锁外解析（GetDexFileInfo 需要读 location 字符串）
+            std::unique_ptr<DexFileMeta> created(new DexFileMeta());
+            created->dex_file = dex_file;
+            if (!GetDexFileInfo(dex_file, sdk_level, &created->info)) return nullptr;
+            if (created->info.size >= sizeof(dex::Header)) {
+                const auto *header = reinterpret_cast<const dex::Header *>(created->info.begin);
+                created->dex_checksum = header->checksum_;
+                created->standard_dex = memcmp(header->magic_, "dex\n", 4) == 0;
+                // 超出 dex 的 method_ids（壳改写的头）按没有补丁处理
+                size_t ids_limit = header->method_ids_off_ <= created->info.size
+                                   ? (created->info.size - header->method_ids_off_) / sizeof(dex::MethodId) : 0;
+                if (header->method_ids_size_ <= ids_limit) created->method_ids_size = header->method_ids_size_;
+            }
+
+            std::lock_guard<std::mutex> lock(mutex_);
+            // 其他线程已经插入
+            meta = Probe(dex_file, begin);
+            auto it = overflow_.find(dex_file);
+            if (meta == nullptr && it != overflow_.end() && it->second->info.begin == begin) meta = it->second;
+            if (meta == nullptr) {
+                meta = created.release();
+                if (count_ < kCapacity / 4 * 3) {
+                    size_t slot = hash_pointer(dex_file);
+                    while (slots_[slot & (kCapacity - 1)].load(std::memory_order_relaxed) != nullptr) ++slot;
+                    slots_[slot & (kCapacity - 1)].store(meta, std::memory_order_release);
+                    ++count_;
+                } else {
+                    // DexFile 释放后地址被复用时覆盖，旧的元数据不释放
+                    overflow_[dex_file] = meta;
+                }
+            }
+            last_meta = meta;
+            return meta;
+        }
+
+        size_t DexFileCache::size() {
+            std::lock_guard<std::mutex> lock(mutex_);
+            return count_ + overflow_.size();
+        }
+
+    } // namespace hook
+};//namespace cyurs
@@ -0,0 +1,93 @@
+#ifndef CYURS_DEX_FILE_CACHE_H
+#define CYURS_DEX_FILE_CACHE_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+
+#include "../dex/dex_file_info.h"
+#include "page_tracker.h"
+#include "patch_table.h"
+
+/**
+ * LoadMethod hook 中按 art::DexFile 指针缓存的元数据
+ *
+ * 每个 DexFile 只解析一次：begin / size / location / checksum、是否为标准 dex，
+ * 以及补丁表中属于这个 dex 的部分（method_idx 直接下标）。之后每次 LoadMethod 只需要一次指针查找。
+ * 这里只读 dex 头，不遍历 class_data（在加载类的线程上同步执行）。
+ *
+ * 查找不加锁（插入后不删除的开放寻址表），命中时校验 DexFile.begin_，DexFile 释放后地址被复用时重新解析。
+ * 元数据不会释放，返回的指针在进程生命周期内有效。
+ */
+namespace cyurs {
+    namespace hook {
+
+        // 补丁表中属于一个 dex 的补丁
+        struct PatchSlice {
+            const PatchTable *table = nullptr;
+            // method_idx -> 补丁；这个 dex 没有补丁时为空
+            std::vector<const PatchEntry *> entries;
+            // 有补丁时才创建
+            DexPageTracker *pages = nullptr;
+
+            const PatchEntry *Find(uint32_t method_idx) const {
+                return method_idx < entries.size() ? entries[method_idx] : nullptr;
+            }
+        };
+
+        struct DexFileMeta {
+            const void *dex_file = nullptr;
+            DexFileInfo info;
+            // dex 头中的 checksum_
+            uint32_t dex_checksum = 0;
+            // cdex 的 code_item 格式不同，不采集也不回填
+            bool standard_dex = false;
+            // dex 头中的 method_ids_size_
+            uint32_t method_ids_size = 0;
+
+            /**
+             * 补丁表中属于这个 dex 的部分，每个补丁表只构建一次
+             *
+             * 有补丁时才构建 MethodTable，用来把补丁所在的页一次设为可写（相邻页合并为一次 mprotect）；
+             * 构建失败不影响回填，补丁是否放得下、页是否可写都由 hook 按 ART 实际加载的 code_item 处理。
+             */
+            const PatchSlice *GetPatchSlice(const PatchTable *table) const;
+
+        private:
+            const PatchSlice *BuildPatchSlice(const PatchTable *table) const;
+
+            mutable std::atomic<const PatchSlice *> slice_{nullptr};
+            mutable std::mutex slice_mutex_;
+        };
+
+        class DexFileCache {
+        public:
+            static DexFileCache &instance();
+
+            // dex_file 为空或 begin_ / header_ 为空时返回 nullptr
+            const DexFileMeta *Get(const void *dex_file, int sdk_level);
+
+            size_t size();
+
+        private:
+            // 开放寻址表的槽位数，超过 3/4 后新的 DexFile 放到 overflow_
+            static constexpr size_t kCapacity = 1u << 12;
+
+            DexFileCache();
+
+            const DexFileMeta *Probe(const void *dex_file, const uint8_t *begin) const;
+
+            std::unique_ptr<std::atomic<const DexFileMeta *>[]> slots_;
+            std::mutex mutex_;
+            size_t count_ = 0;
+            std::unordered_map<const void *, const DexFileMeta *> overflow_;
+        };
+
+    } // namespace hook
+};//namespace cyurs
+
+#endif //CYURS_DEX_FILE_CACHE_H
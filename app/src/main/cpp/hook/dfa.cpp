@@ -0,0 +1,458 @@
+#include "dfa.h"
+
+#include <algorithm>
+#include <bitset>
+#include <cstring>
+#include <map>
+
+namespace cyurs {
+    namespace hook {
+
+        using ByteSet = std::bitset<256>;
+
+        static constexpr uint32_t kStartMarker = 0xFFFFFFFF;
+
+        /**
+         * Thompson NFA 的构建与子集构造
+         *
+         * 片段为 (起始节点, 未连接的出边)，出边编码为 节点下标 * 2 + (0: out / 1: out1)。
+         */
+        class DfaBuilder {
+        public:
+            explicit DfaBuilder(std::string_view pattern) : pattern_(pattern) {}
+
+            bool Build(Dfa &dfa, std::string *error) {
+                Fragment body;
+                if (!ParseAlternation(body)) return Fail(error);
+                if (pos_ != pattern_.size()) {
+                    error_ = "unbalanced )";
+                    return Fail(error);
+                }
+
+                // 子串匹配：前面加 .*；到达 kMatch 后接受状态吸收之后的全部输入，相当于后面的 .*
+                body = Concat(AnyStar(), body);
+                uint32_t match = AddNode(kMatch);
+                Patch(body.outs, match);
+                start_ = body.start;
+
+                if (!Determinize(dfa)) return Fail(error);
+                return true;
+            }
+
+        private:
+            enum NodeType : uint8_t {
+                kBytes,
+                kEpsilon,
+                kSplit,
+                // ^：只在输入开始处可以通过
+                kBegin,
+                // $：只在输入结束处可以通过
+                kEnd,
+                kMatch,
+            };
+
+            struct Node {
+                NodeType type;
+                uint32_t out = 0;
+                uint32_t out1 = 0;
+                ByteSet bytes;
+            };
+
+            struct Fragment {
+                uint32_t start = 0;
+                std::vector<uint32_t> outs;
+            };
+
+            bool Fail(std::string *error) const {
+                if (error != nullptr) *error = error_ + " at " + std::to_string(pos_);
+                return false;
+            }
+
+            uint32_t AddNode(NodeType type) {
+                nodes_.push_back({type});
+                return static_cast<uint32_t>(nodes_.size() - 1);
+            }
+
+            void Patch(const std::vector<uint32_t> &outs, uint32_t target) {
+                for (uint32_t out: outs) {
+                    if (out & 1) {
+                        nodes_[out >> 1].out1 = target;
+                    } else {
+                        nodes_[out >> 1].out = target;
+                    }
+                }
+            }
+
+            Fragment Bytes(const ByteSet &bytes) {
+                uint32_t node = AddNode(kBytes);
+                nodes_[node].bytes = bytes;
+                return {node, {node << 1}};
+            }
+
+            Fragment Empty() {
+                uint32_t node = AddNode(kEpsilon);
+                return {node, {node << 1}};
+            }
+
+            Fragment Concat(const Fragment &a, const Fragment &b) {
+                Patch(a.outs, b.start);
+                return {a.start, b.outs};
+            }
+
+            Fragment Alternate(const Fragment &a, const Fragment &b) {
+                uint32_t split = AddNode(kSplit);
+                nodes_[split].out = a.start;
+                nodes_[split].out1 = b.start;
+                Fragment result{split, a.outs};
+                result.outs.insert(result.outs.end(), b.outs.begin(), b.outs.end());
+                return result;
+            }
+
+            Fragment Star(const Fragment &a) {
+                uint32_t split = AddNode(kSplit);
+                nodes_[split].out = a.start;
+                Patch(a.outs, split);
+                return {split, {(split << 1) | 1}};
+            }
+
+            Fragment Plus(const Fragment &a) {
+                uint32_t split = AddNode(kSplit);
+                nodes_[split].out = a.start;
+                Patch(a.outs, split);
+                return {a.start, {(split << 1) | 1}};
+            }
+
+            Fragment Optional(const Fragment &a) {
+                uint32_t split = AddNode(kSplit);
+                nodes_[split].out = a.start;
+                Fragment result{split, a.outs};
+                result.outs.push_back((split << 1) | 1);
+                return result;
+            }
+
+            Fragment AnyStar() {
+                ByteSet all;
+                all.set();
+                return Star(Bytes(all));
+            }
+
+            bool AtEnd() const { return pos_ >= pattern_.size(); }
+
+            bool ParseAlternation(Fragment &result) {
+                if (!ParseConcat(result)) return false;
+                while (!AtEnd() && pattern_[pos_] == '|') {
+                    ++pos_;
+                    Fragment right;
+                    if (!ParseConcat(right)) return false;
+                    result = Alternate(result, right);
+                }
+                return true;
+            }
+
+            bool ParseConcat(Fragment &result) {
+                bool empty = true;
+                while (!AtEnd() && pattern_[pos_] != '|' && pattern_[pos_] != ')') {
+                    Fragment item;
+                    if (!ParseRepeat(item)) return false;
+                    result = empty ? item : Concat(result, item);
+                    empty = false;
+                }
+                if (empty) result = Empty();
+                return true;
+            }
+
+            bool ParseRepeat(Fragment &result) {
+                if (!ParseAtom(result)) return false;
+                while (!AtEnd()) {
+                    char c = pattern_[pos_];
+                    if (c == '*') {
+                        result = Star(result);
+                    } else if (c == '+') {
+                        result = Plus(result);
+                    } else if (c == '?') {
+                        result = Optional(result);
+                    } else {
+                        break;
+                    }
+                    ++pos_;
+                }
+                return true;
+            }
+
+            bool ParseAtom(Fragment &result) {
+                char c = pattern_[pos_++];
+                ByteSet bytes;
+                switch (c) {
+                    case '(':
+                        if (!ParseAlternation(result)) return false;
+                        if (AtEnd() || pattern_[pos_] != ')') {
+                            error_ = "missing )";
+                            return false;
+                        }
+                        ++pos_;
+                        return true;
+                    case '[':
+                        if (!ParseClass(bytes)) return false;
+                        break;
+                    case '.':
+                        bytes.set();
+                        break;
+                    case '\\':
+                        if (!ParseEscape(bytes)) return false;
+                        break;
+                    case '*':
+                    case '+':
+                    case '?':
+                        error_ = "nothing to repeat";
+                        --pos_;
+                        return false;
+                    case '^':
+                    case '$': {
+                        uint32_t node = AddNode(c == '^' ? kBegin : kEnd);
+                        result = {node, {node << 1}};
+                        return true;
+                    }
+                    default:
+                        bytes.set(static_cast<uint8_t>(c));
+                        break;
+                }
+                result = Bytes(bytes);
+                return true;
+            }
+
+            static void AddRange(ByteSet &bytes, uint8_t from, uint8_t to) {
+                for (uint32_t c = from; c <= to; ++c) bytes.set(c);
+            }
+
+            bool ParseEscape(ByteSet &bytes) {
+                if (AtEnd()) {
+                    error_ = "trailing \\";
+                    return false;
+                }
+                char c = pattern_[pos_++];
+                switch (c) {
+                    case 'd':
+                    case 'D':
+                        AddRange(bytes, '0', '9');
+                        break;
+                    case 'w':
+                    case 'W':
+                        AddRange(bytes, '0', '9');
+                        AddRange(bytes, 'a', 'z');
+                        AddRange(bytes, 'A', 'Z');
+                        bytes.set('_');
+                        break;
+                    case 's':
+                    case 'S':
+                        for (char space: {' ', '\t', '\n', '\r', '\f', '\v'}) bytes.set(static_cast<uint8_t>(space));
+                        break;
+                    case 'n':
+                        bytes.set('\n');
+                        return true;
+                    case 't':
+                        bytes.set('\t');
+                        return true;
+                    default:
+                        bytes.set(static_cast<uint8_t>(c));
+                        return true;
+                }
+                if (c == 'D' || c == 'W' || c == 'S') bytes.flip();
+                return true;
+            }
+
+            bool ParseClass(ByteSet &bytes) {
+                bool negate = !AtEnd() && pattern_[pos_] == '^';
+                if (negate) ++pos_;
+                bool first = true;
+                while (!AtEnd() && (pattern_[pos_] != ']' || first)) {
+                    first = false;
+                    uint8_t from = static_cast<uint8_t>(pattern_[pos_++]);
+                    if (from == '\\') {
+                        ByteSet escaped;
+                        if (!ParseEscape(escaped)) return false;
+                        bytes |= escaped;
+                        continue;
+                    }
+                    if (pos_ + 1 < pattern_.size() && pattern_[pos_] == '-' && pattern_[pos_ + 1] != ']') {
+                        auto to = static_cast<uint8_t>(pattern_[pos_ + 1]);
+                        pos_ += 2;
+                        if (to < from) {
+                            error_ = "bad range";
+                            return false;
+                        }
+                        AddRange(bytes, from, to);
+                    } else {
+                        bytes.set(from);
+                    }
+                }
+                if (AtEnd()) {
+                    error_ = "missing ]";
+                    return false;
+                }
+                ++pos_;
+                if (negate) bytes.flip();
+                return true;
+            }
+
+            /**
+             * 把 epsilon / split 展开为只含 kBytes / kEnd / kMatch 的有序集合
+             *
+             * @param at_start 是否在输入开始处（此时可以通过 kBegin）
+             */
+            void Closure(std::vector<uint32_t> &seeds, std::vector<uint32_t> &result,
+                         std::vector<uint32_t> &visited, uint32_t generation, bool at_start) const {
+                result.clear();
+                while (!seeds.empty()) {
+                    uint32_t node = seeds.back();
+                    seeds.pop_back();
+                    if (visited[node] == generation) continue;
+                    visited[node] = generation;
+                    const Node &n = nodes_[node];
+                    if (n.type == kEpsilon || (n.type == kBegin && at_start)) {
+                        seeds.push_back(n.out);
+                    } else if (n.type == kSplit) {
+                        seeds.push_back(n.out1);
+                        seeds.push_back(n.out);
+                    } else if (n.type != kBegin) {
+                        result.push_back(node);
+                    }
+                }
+                std::sort(result.begin(), result.end());
+            }
+
+            // 输入在这里结束时，从集合中的 kEnd 出发能否到达 kMatch
+            bool AcceptsAtEnd(const std::vector<uint32_t> &set, bool at_start, std::vector<uint32_t> &seeds,
+                              std::vector<uint32_t> &visited, uint32_t generation) const {
+                for (uint32_t node: set) {
+                    if (nodes_[node].type == kEnd) seeds.push_back(nodes_[node].out);
+                }
+                bool accept = false;
+                while (!seeds.empty()) {
+                    uint32_t node = seeds.back();
+                    seeds.pop_back();
+                    if (visited[node] == generation) continue;
+                    visited[node] = generation;
+                    const Node &n = nodes_[node];
+                    if (n.type == kMatch) {
+                        accept = true;
+                    } else if (n.type == kEpsilon || n.type == kEnd || (n.type == kBegin && at_start)) {
+                        seeds.push_back(n.out);
+                    } else if (n.type == kSplit) {
+                        seeds.push_back(n.out1);
+                        seeds.push_back(n.out);
+                    }
+                }
+                return accept;
+            }
+
+            bool Determinize(Dfa &dfa) {
+                std::map<std::vector<uint32_t>, uint32_t> ids;
+                std::vector<std::vector<uint32_t>> states;
+                std::vector<uint32_t> visited(nodes_.size(), 0);
+                uint32_t generation = 0;
+
+                // 0 为死状态（空集合）
+                states.emplace_back();
+                ids[states[0]] = 0;
+                std::vector<uint32_t> seeds{start_};
+                std::vector<uint32_t> set;
+                Closure(seeds, set, visited, ++generation, true);
+                // 开始状态单独编号：同样的集合在输入开始处还可以通过 kBegin（如 $^）
+                set.push_back(kStartMarker);
+                ids[set] = 1;
+                states.push_back(set);
+
+                dfa.next_.clear();
+                dfa.flags_.clear();
+                for (uint32_t id = 0; id < states.size(); ++id) {
+                    dfa.next_.resize((id + 1) << 8, 0);
+                    if (id == Dfa::kStart) states[id].pop_back();
+                    bool matched = false;
+                    for (uint32_t node: states[id]) matched |= nodes_[node].type == kMatch;
+                    if (matched) {
+                        // 已经找到匹配的子串，之后的输入不影响结果
+                        for (uint32_t c = 0; c < 256; ++c) dfa.next_[(id << 8) | c] = id;
+                        dfa.flags_.push_back(Dfa::kAccept);
+                        continue;
+                    }
+                    bool accept = AcceptsAtEnd(states[id], id == Dfa::kStart, seeds, visited, ++generation);
+                    dfa.flags_.push_back(accept ? Dfa::kAccept : 0);
+                    for (uint32_t c = 0; c < 256; ++c) {
+                        for (uint32_t node: states[id]) {
+                            if (nodes_[node].type == kBytes && nodes_[node].bytes.test(c)) {
+                                seeds.push_back(nodes_[node].out);
+                            }
+                        }
+                        Closure(seeds, set, visited, ++generation, false);
+                        auto it = ids.find(set);
+                        if (it == ids.end()) {
+                            if (states.size() >= Dfa::kMaxStates) {
+                                error_ = "pattern too complex";
+                                return false;
+                            }
+                            it = ids.emplace(set, static_cast<uint32_t>(states.size())).first;
+                            states.push_back(set);
+                        }
+                        dfa.next_[(id << 8) | c] = it->second;
+                    }
+                }
+
+                for (uint32_t id = 0; id < states.size(); ++id) {
+                    bool loops = true;
+                    for (uint32_t c = 0; c < 256 && loops; ++c) loops = dfa.next_[(id << 8) | c] == id;
+                    if (loops) dfa.flags_[id] |= Dfa::kSettled;
+                }
+                return true;
+            }
+
+            std::string_view pattern_;
+            size_t pos_ = 0;
+            std::string error_;
+            std::vector<Node> nodes_;
+            uint32_t start_ = 0;
+        };
+
+        bool Dfa::CompileRegex(std::string_view pattern, Dfa &dfa, std::string *error) {
+            return DfaBuilder(pattern).Build(dfa, error);
+        }
+
+        bool Dfa::CompileGlob(std::string_view pattern, Dfa &dfa, std::string *error) {
+            std::string regex = "^";
+            for (size_t i = 0; i < pattern.size(); ++i) {
+                char c = pattern[i];
+                if (c == '*' && i + 1 < pattern.size() && pattern[i + 1] == '*') {
+                    regex += ".*";
+                    ++i;
+                } else if (c == '*') {
+                    regex += "[^/]*";
+                } else if (c == '?') {
+                    regex += "[^/]";
+                } else if (c == '[') {
+                    size_t end = pattern.find(']', i + 2);
+                    if (end == std::string_view::npos) {
+                        if (error != nullptr) *error = "missing ]";
+                        return false;
+                    }
+                    std::string_view body = pattern.substr(i + 1, end - i - 1);
+                    regex += '[';
+                    if (body.front() == '!') {
+                        regex += '^';
+                        body.remove_prefix(1);
+                    }
+                    for (char b: body) {
+                        if (b == '\\') regex += '\\';
+                        regex += b;
+                    }
+                    regex += ']';
+                    i = end;
+                } else {
+                    if (strchr(".+()|^$\\[]", c) != nullptr) regex += '\\';
+                    regex += c;
+                }
+            }
+            regex += '$';
+            return CompileRegex(regex, dfa, error);
+        }
+
+    } // namespace hook
+};//namespace cyurs
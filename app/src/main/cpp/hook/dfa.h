@@ -0,0 +1,68 @@
+#ifndef CYURS_DFA_H
+#define CYURS_DFA_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <string>
+#include <string_view>
+#include <vector>
+
+/**
+ * 按字节匹配的 DFA：正则 / glob 在加载时编译（Thompson NFA -> 子集构造），匹配时每个字节查一次表，不分配内存
+ *
+ * 正则支持：字面量、.、[a-z] / [^...]、\d \w \s（及大写取反）、* + ?、|、( )、^ / $（输入开始 / 结束）。
+ * 没有 ^ / $ 时为子串匹配（等价于前后加 .*）。
+ *
+ * glob：* 匹配不含 / 的任意串，** 匹配任意串，? 匹配一个非 / 字符，[...] / [!...] 为字符类，整串匹配。
+ */
+namespace cyurs {
+    namespace hook {
+
+        class Dfa {
+        public:
+            // 不可能再匹配的状态
+            static constexpr uint32_t kDead = 0;
+            static constexpr uint32_t kStart = 1;
+            // 状态数上限，超过时编译失败
+            static constexpr size_t kMaxStates = 4096;
+
+            // @param error 失败时为原因
+            static bool CompileRegex(std::string_view pattern, Dfa &dfa, std::string *error);
+
+            static bool CompileGlob(std::string_view pattern, Dfa &dfa, std::string *error);
+
+            uint32_t Step(uint32_t state, uint8_t c) const { return next_[(state << 8) | c]; }
+
+            bool accepting(uint32_t state) const { return (flags_[state] & kAccept) != 0; }
+
+            // 之后无论输入什么结果都不会再变（死状态或吸收的接受状态），可以提前结束
+            bool settled(uint32_t state) const { return (flags_[state] & kSettled) != 0; }
+
+            uint32_t Feed(uint32_t state, std::string_view input) const {
+                for (size_t i = 0; i < input.size() && !settled(state); ++i) {
+                    state = Step(state, static_cast<uint8_t>(input[i]));
+                }
+                return state;
+            }
+
+            bool Match(std::string_view input) const { return accepting(Feed(kStart, input)); }
+
+            size_t state_count() const { return flags_.size(); }
+
+        private:
+            enum : uint8_t {
+                kAccept = 1,
+                kSettled = 2,
+            };
+
+            friend class DfaBuilder;
+
+            // state * 256 + 字节
+            std::vector<uint32_t> next_;
+            std::vector<uint8_t> flags_;
+        };
+
+    } // namespace hook
+};//namespace cyurs
+
+#endif //CYURS_DFA_H
@@ -0,0 +1,202 @@
+#include "exec_rules.h"
+
+#include <errno.h>
+#include <cstdio>
+#include <cstring>
+
+namespace cyurs {
+    namespace hook {
+
+        thread_local int ScopedExecRulesBypass::depth_ = 0;
+
+        static bool is_space(char c) {
+            return c == ' ' || c == '\t' || c == '\r';
+        }
+
+        static std::string_view trim(std::string_view str) {
+            while (!str.empty() && is_space(str.front())) str.remove_prefix(1);
+            while (!str.empty() && is_space(str.back())) str.remove_suffix(1);
+            return str;
+        }
+
+        // 取出下一个以空白分隔的词
+        static std::string_view next_token(std::string_view &str) {
+            str = trim(str);
+            size_t end = 0;
+            while (end < str.size() && !is_space(str[end])) ++end;
+            std::string_view token = str.substr(0, end);
+            str.remove_prefix(end);
+            return token;
+        }
+
+        // 前面是空白的 =>，参数正则中的 => 不受影响（如 a=>b）
+        static size_t find_arrow(std::string_view line) {
+            for (size_t pos = line.find("=>"); pos != std::string_view::npos; pos = line.find("=>", pos + 2)) {
+                if (pos > 0 && is_space(line[pos - 1])) return pos;
+            }
+            return std::string_view::npos;
+        }
+
+        static bool parse_action(std::string_view name, ExecAction *action) {
+            for (ExecAction candidate: {kExecAllow, kExecDeny, kExecRewrite, kExecRedirect}) {
+                if (name == exec_action_name(candidate)) {
+                    *action = candidate;
+                    return true;
+                }
+            }
+            return false;
+        }
+
+        const char *exec_action_name(ExecAction action) {
+            switch (action) {
+                case kExecAllow:
+                    return "allow";
+                case kExecDeny:
+                    return "deny";
+                case kExecRewrite:
+                    return "rewrite";
+                case kExecRedirect:
+                    return "redirect";
+            }
+            return "unknown";
+        }
+
+        static bool parse_rule(std::string_view line, ExecRule &rule, std::string *error) {
+            std::string_view operands;
+            size_t arrow = find_arrow(line);
+            if (arrow != std::string_view::npos) {
+                operands = line.substr(arrow + 2);
+                line = line.substr(0, arrow);
+            }
+
+            std::string_view action = next_token(line);
+            if (!parse_action(action, &rule.action)) {
+                *error = "unknown action " + std::string(action);
+                return false;
+            }
+            std::string_view glob = next_token(line);
+            if (glob.empty()) {
+                *error = "missing path glob";
+                return false;
+            }
+            if (!Dfa::CompileGlob(glob, rule.path, error)) return false;
+            std::string_view regex = trim(line);
+            if (!regex.empty()) {
+                if (!Dfa::CompileRegex(regex, rule.args, error)) return false;
+                rule.match_args = true;
+            }
+
+            for (std::string_view token = next_token(operands); !token.empty(); token = next_token(operands)) {
+                rule.operands.emplace_back(token);
+            }
+            bool needs_operands = rule.action == kExecRewrite || rule.action == kExecRedirect;
+            if (needs_operands != (arrow != std::string_view::npos) ||
+                (rule.action == kExecRedirect && rule.operands.size() != 1)) {
+                *error = rule.action == kExecRedirect ? "redirect needs exactly one path after =>"
+                                                      : needs_operands ? "rewrite needs arguments after =>"
+                                                                       : "=> only allowed for rewrite / redirect";
+                return false;
+            }
+            return true;
+        }
+
+        std::unique_ptr<ExecRuleSet> ExecRuleSet::Parse(std::string_view text, std::string *error) {
+            std::unique_ptr<ExecRuleSet> rules(new ExecRuleSet());
+            uint32_t line_no = 0;
+            while (!text.empty()) {
+                size_t end = text.find('\n');
+                std::string_view line = trim(text.substr(0, end));
+                text.remove_prefix(end == std::string_view::npos ? text.size() : end + 1);
+                ++line_no;
+                if (line.empty() || line.front() == '#') continue;
+
+                ExecRule rule;
+                rule.line = line_no;
+                std::string reason;
+                if (!parse_rule(line, rule, &reason)) {
+                    if (error != nullptr) *error = "line " + std::to_string(line_no) + ": " + reason;
+                    return nullptr;
+                }
+                rules->rules_.push_back(std::move(rule));
+            }
+            return rules;
+        }
+
+        std::unique_ptr<ExecRuleSet> ExecRuleSet::Load(const std::string &path, std::string *error) {
+            FILE *file = fopen(path.c_str(), "rb");
+            if (file == nullptr) {
+                if (error != nullptr) *error = strerror(errno);
+                return nullptr;
+            }
+            std::string text;
+            char buf[4096];
+            size_t n;
+            while ((n = fread(buf, 1, sizeof(buf), file)) > 0) text.append(buf, n);
+            fclose(file);
+            return Parse(text, error);
+        }
+
+        const ExecRule *ExecRuleSet::Find(const char *path, char *const argv[]) const {
+            for (const ExecRule &rule: rules_) {
+                if (!rule.path.Match(path == nullptr ? "" : path)) continue;
+                if (rule.match_args) {
+                    // 逐个参数送入 DFA，不拼接字符串
+                    uint32_t state = Dfa::kStart;
+                    if (argv != nullptr && argv[0] != nullptr) {
+                        for (int i = 1; argv[i] != nullptr && !rule.args.settled(state); ++i) {
+                            if (i > 1) state = rule.args.Step(state, ' ');
+                            state = rule.args.Feed(state, argv[i]);
+                        }
+                    }
+                    if (!rule.args.accepting(state)) continue;
+                }
+                return &rule;
+            }
+            return nullptr;
+        }
+
+        ExecAction ExecRuleSet::Apply(const char *&path, char *const *&argv, ExecArgv &buffer,
+                                      const ExecRule **matched) const {
+            const ExecRule *rule = Find(path, argv);
+            if (matched != nullptr) *matched = rule;
+            if (rule == nullptr) return kExecAllow;
+
+            switch (rule->action) {
+                case kExecAllow:
+                case kExecDeny:
+                    return rule->action;
+                case kExecRedirect:
+                    path = rule->operands[0].c_str();
+                    return kExecRedirect;
+                case kExecRewrite:
+                    break;
+            }
+
+            int argc = 0;
+            while (argv != nullptr && argv[argc] != nullptr) ++argc;
+            int count = 0;
+            // 留一个位置给结尾的 nullptr
+            auto append = [&](const char *arg) {
+                if (count >= ExecArgv::kCapacity - 1) return false;
+                buffer.args[count++] = arg;
+                return true;
+            };
+            bool ok = append(argc > 0 ? argv[0] : path);
+            for (const std::string &operand: rule->operands) {
+                if (operand == "$@") {
+                    for (int i = 1; i < argc && ok; ++i) ok = append(argv[i]);
+                } else if (operand.size() == 2 && operand[0] == '$' && operand[1] >= '1' && operand[1] <= '9') {
+                    int index = operand[1] - '0';
+                    if (index < argc) ok = ok && append(argv[index]);
+                } else {
+                    ok = ok && append(operand.c_str());
+                }
+            }
+            if (!ok) return kExecAllow;
+            buffer.args[count] = nullptr;
+            argv = const_cast<char *const *>(buffer.args);
+            return kExecRewrite;
+        }
+
+    } // namespace hook
+};//namespace cyurs
@@ -0,0 +1,109 @@
+#ifndef CYURS_EXEC_RULES_H
+#define CYURS_EXEC_RULES_H
+
+#include <stdint.h>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "dfa.h"
+
+/**
+ * execve / posix_spawn 拦截规则
+ *
+ * 规则集加载时编译（路径 glob 和参数正则都编译为 DFA），之后只读；hook 中通过原子指针取得当前规则集，
+ * 匹配不加锁、不分配内存（vfork 的子进程中也会调用 execve）。
+ *
+ * 规则文件每行一条，按顺序匹配，第一条匹配的规则生效，没有匹配时放行；# 开头为注释：
+ *   <动作> <路径 glob> [参数正则] [=> 动作参数]
+ *
+ *   deny      **dex2oat**                                  拒绝（errno / 返回值为 EACCES）
+ *   allow     /system/bin/sh
+ *   rewrite   **dex2oat*  --compiler-filter=speed   => $@ --compiler-filter=verify
+ *   redirect  /system/bin/dex2oat*                      => /data/local/tmp/dex2oat_wrapper
+ *
+ * 参数正则匹配 argv[1..] 以单个空格连接的字符串，省略时不限制参数。
+ * rewrite 的参数中 $@ 展开为原来的 argv[1..]，$1 ~ $9 为单个参数，其余原样使用；argv[0] 保持不变。
+ * redirect 执行另一个程序，argv 不变。
+ */
+namespace cyurs {
+    namespace hook {
+
+        enum ExecAction : uint8_t {
+            kExecAllow = 0,
+            kExecDeny = 1,
+            kExecRewrite = 2,
+            kExecRedirect = 3,
+        };
+
+        const char *exec_action_name(ExecAction action);
+
+        // rewrite 后的 argv，放在调用方的栈上
+        struct ExecArgv {
+            static constexpr int kCapacity = 512;
+            const char *args[kCapacity];
+        };
+
+        struct ExecRule {
+            ExecAction action = kExecAllow;
+            uint32_t line = 0;
+            Dfa path;
+            bool match_args = false;
+            Dfa args;
+            // rewrite 的参数模板 / redirect 的路径
+            std::vector<std::string> operands;
+        };
+
+        class ExecRuleSet {
+        public:
+            // @param error 失败时为带行号的错误信息
+            static std::unique_ptr<ExecRuleSet> Parse(std::string_view text, std::string *error);
+
+            static std::unique_ptr<ExecRuleSet> Load(const std::string &path, std::string *error);
+
+            // 第一条匹配的规则，没有匹配返回 nullptr
+            const ExecRule *Find(const char *path, char *const argv[]) const;
+
+            /**
+             * 应用匹配的规则：rewrite / redirect 时修改 path / argv（新 argv 写到 buffer）
+             *
+             * @return 生效的动作；rewrite 后参数超过 ExecArgv::kCapacity 时不改写，按 allow 处理
+             */
+            ExecAction Apply(const char *&path, char *const *&argv, ExecArgv &buffer,
+                             const ExecRule **matched = nullptr) const;
+
+            size_t size() const { return rules_.size(); }
+
+        private:
+            ExecRuleSet() = default;
+
+            std::vector<ExecRule> rules_;
+        };
+
+        /**
+         * 作用域内当前线程的 execve / posix_spawn 跳过规则
+         *
+         * 用于 posix_spawn hook 调用原函数时（bionic 在 vfork 的子进程中再调用 execve，规则只应用一次），
+         * 以及模块自己启动的子进程（dex2oat 调度）。vfork 的子进程与父线程共享 TLS，子进程中同样可见。
+         */
+        class ScopedExecRulesBypass {
+        public:
+            ScopedExecRulesBypass() { ++depth_; }
+
+            ~ScopedExecRulesBypass() { --depth_; }
+
+            ScopedExecRulesBypass(const ScopedExecRulesBypass &) = delete;
+
+            ScopedExecRulesBypass &operator=(const ScopedExecRulesBypass &) = delete;
+
+            static bool active() { return depth_ != 0; }
+
+        private:
+            static thread_local int depth_;
+        };
+
+    } // namespace hook
+};//namespace cyurs
+
+#endif //CYURS_EXEC_RULES_H
@@ -0,0 +1,175 @@
+#include "hook_stats.h"
+
+#include <pthread.h>
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+
+namespace cyurs {
+    namespace hook {
+
+        struct HookCounters {
+            std::atomic<uint64_t> calls{0};
+            std::atomic<uint64_t> total_ns{0};
+            std::atomic<uint64_t> max_ns{0};
+            std::atomic<uint32_t> buckets[kHookHistogramBuckets] = {};
+        };
+
+        // 一个线程的计数，每个 hook 一组固定的计数器
+        struct HookShard {
+            HookCounters sites[kMaxHookSites];
+            std::atomic<bool> in_use{false};
+        };
+
+        static constexpr uint32_t kMaxHookShards = 32;
+
+        /**
+         * 静态分片池，Record 不分配内存、不注册 thread_local 析构
+         * （hook 可能在 vfork 的子进程中返回，那里的分配和 TLS 注册会写到父进程的堆上）。
+         * 没有用过的分片只占 .bss 的虚拟地址。分片用完后共用最后一个（计数是原子的，只是会竞争缓存行）。
+         */
+        static HookShard g_shards[kMaxHookShards];
+
+        // 线程 -> 分片；线程退出时归还分片
+        static pthread_key_t g_shard_key;
+        static bool g_shard_key_valid = false;
+
+        static void release_shard(void *shard) {
+            static_cast<HookShard *>(shard)->in_use.store(false, std::memory_order_release);
+        }
+
+        static HookShard *acquire_shard() {
+            for (HookShard &shard: g_shards) {
+                bool expected = false;
+                if (!shard.in_use.load(std::memory_order_relaxed) &&
+                    shard.in_use.compare_exchange_strong(expected, true, std::memory_order_acquire)) {
+                    return &shard;
+                }
+            }
+            return &g_shards[kMaxHookShards - 1];
+        }
+
+        uint64_t HookHistogramBucketLower(uint32_t bucket) {
+            if (bucket < 4) return bucket;
+            uint32_t msb = bucket / 4 + 1;
+            return static_cast<uint64_t>(4 + bucket % 4) << (msb - 2);
+        }
+
+        HookStats::HookStats() {
+            g_shard_key_valid = pthread_key_create(&g_shard_key, release_shard) == 0;
+        }
+
+        HookStats &HookStats::instance() {
+            // 不析构，进程退出时可能还有线程在 hook 中
+            static auto *stats = new HookStats();
+            return *stats;
+        }
+
+        uint32_t HookStats::Register(const char *name) {
+            std::lock_guard<std::mutex> lock(register_mutex_);
+            uint32_t count = site_count_.load(std::memory_order_relaxed);
+            for (uint32_t i = 0; i < count; ++i) {
+                if (strcmp(names_[i].load(std::memory_order_relaxed), name) == 0) return i;
+            }
+            if (count >= kMaxHookSites) return kInvalidHookSite;
+            names_[count].store(name, std::memory_order_relaxed);
+            site_count_.store(count + 1, std::memory_order_release);
+            return count;
+        }
+
+        void HookStats::Record(uint32_t site, uint64_t ns) {
+            if (site >= kMaxHookSites || !g_shard_key_valid) return;
+            auto *shard = static_cast<HookShard *>(pthread_getspecific(g_shard_key));
+            if (shard == nullptr) {
+                shard = acquire_shard();
+                pthread_setspecific(g_shard_key, shard);
+            }
+
+            HookCounters *counters = &shard->sites[site];
+            // 分片同一时间只属于一个线程，原子操作只是为了导出时的并发读
+            counters->calls.fetch_add(1, std::memory_order_relaxed);
+            counters->total_ns.fetch_add(ns, std::memory_order_relaxed);
+            if (ns > counters->max_ns.load(std::memory_order_relaxed)) {
+                counters->max_ns.store(ns, std::memory_order_relaxed);
+            }
+            counters->buckets[HookHistogramBucket(ns)].fetch_add(1, std::memory_order_relaxed);
+        }
+
+        // 第一个累计数达到 calls * percent / 100 的桶的上界
+        static uint64_t percentile(const HookSiteStats &stats, uint32_t percent) {
+            uint64_t target = (stats.calls * percent + 99) / 100;
+            uint64_t seen = 0;
+            for (uint32_t i = 0; i < kHookHistogramBuckets; ++i) {
+                seen += stats.buckets[i];
+                if (seen >= target && seen > 0) {
+                    if (i + 1 == kHookHistogramBuckets) return stats.max_ns;
+                    return std::min(HookHistogramBucketLower(i + 1) - 1, stats.max_ns);
+                }
+            }
+            return stats.max_ns;
+        }
+
+        std::vector<HookSiteStats> HookStats::Snapshot() const {
+            uint32_t count = site_count_.load(std::memory_order_acquire);
+            std::vector<HookSiteStats> result(count);
+            for (uint32_t i = 0; i < count; ++i) {
+                result[i].name = names_[i].load(std::memory_order_relaxed);
+                result[i].buckets.assign(kHookHistogramBuckets, 0);
+            }
+
+            for (const HookShard &shard: g_shards) {
+                for (uint32_t i = 0; i < count; ++i) {
+                    const HookCounters *counters = &shard.sites[i];
+                    if (counters->calls.load(std::memory_order_relaxed) == 0) continue;
+                    HookSiteStats &stats = result[i];
+                    stats.calls += counters->calls.load(std::memory_order_relaxed);
+                    stats.total_ns += counters->total_ns.load(std::memory_order_relaxed);
+                    stats.max_ns = std::max(stats.max_ns, counters->max_ns.load(std::memory_order_relaxed));
+                    for (uint32_t b = 0; b < kHookHistogramBuckets; ++b) {
+                        stats.buckets[b] += counters->buckets[b].load(std::memory_order_relaxed);
+                    }
+                }
+            }
+
+            for (HookSiteStats &stats: result) {
+                stats.p50_ns = percentile(stats, 50);
+                stats.p90_ns = percentile(stats, 90);
+                stats.p99_ns = percentile(stats, 99);
+            }
+            std::sort(result.begin(), result.end(), [](const HookSiteStats &a, const HookSiteStats &b) {
+                return a.total_ns > b.total_ns;
+            });
+            return result;
+        }
+
+        void HookStats::Reset() {
+            uint32_t count = site_count_.load(std::memory_order_acquire);
+            for (HookShard &shard: g_shards) {
+                for (uint32_t i = 0; i < count; ++i) {
+                    HookCounters *counters = &shard.sites[i];
+                    // 没有调用过的计数器不写，不使用的分片不占物理内存
+                    if (counters->calls.load(std::memory_order_relaxed) == 0) continue;
+                    counters->calls.store(0, std::memory_order_relaxed);
+                    counters->total_ns.store(0, std::memory_order_relaxed);
+                    counters->max_ns.store(0, std::memory_order_relaxed);
+                    for (auto &bucket: counters->buckets) bucket.store(0, std::memory_order_relaxed);
+                }
+            }
+        }
+
+        std::string format_hook_stats(const std::vector<HookSiteStats> &stats) {
+            std::string text;
+            char buf[256];
+            for (const HookSiteStats &site: stats) {
+                snprintf(buf, sizeof(buf),
+                         "%s calls=%llu total=%.3fms mean=%.1fus p50=%.1fus p90=%.1fus p99=%.1fus max=%.1fus\n",
+                         site.name.c_str(), static_cast<unsigned long long>(site.calls), site.total_ns / 1e6,
+                         site.calls == 0 ? 0.0 : site.total_ns / 1e3 / site.calls, site.p50_ns / 1e3,
+                         site.p90_ns / 1e3, site.p99_ns / 1e3, site.max_ns / 1e3);
+                text += buf;
+            }
+            return text;
+        }
+
+    } // namespace hook
+};//namespace cyurs
@@ -0,0 +1,107 @@
+#ifndef CYURS_HOOK_STATS_H
+#define CYURS_HOOK_STATS_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <time.h>
+#include <atomic>
+#include <mutex>
+#include <string>
+#include <vector>
+
+/**
+ * hook 的调用次数和耗时直方图
+ *
+ * 每个线程一个分片，只有所属线程写（relaxed 原子读改写，不加锁、不竞争缓存行），导出时汇总全部分片。
+ * 线程退出后分片归还，由之后新建的线程复用，计数保留。分片和计数器都是静态分配的，Record 不分配内存。
+ *
+ * 直方图为对数线性：每个 2 的幂区间分 4 个桶，纳秒值 < 4 时每个值一个桶，相对误差 < 25%。
+ */
+namespace cyurs {
+    namespace hook {
+
+        constexpr uint32_t kMaxHookSites = 64;
+        constexpr uint32_t kHookHistogramBuckets = 128;
+        constexpr uint32_t kInvalidHookSite = 0xFFFFFFFF;
+
+        struct HookSiteStats {
+            std::string name;
+            uint64_t calls = 0;
+            uint64_t total_ns = 0;
+            uint64_t max_ns = 0;
+            // 桶的上界，不超过 max_ns
+            uint64_t p50_ns = 0;
+            uint64_t p90_ns = 0;
+            uint64_t p99_ns = 0;
+            std::vector<uint64_t> buckets;
+        };
+
+        // 纳秒值所在的桶
+        inline uint32_t HookHistogramBucket(uint64_t ns) {
+            if (ns < 4) return static_cast<uint32_t>(ns);
+            uint32_t msb = 63 - static_cast<uint32_t>(__builtin_clzll(ns));
+            uint32_t sub = static_cast<uint32_t>(ns >> (msb - 2)) & 3;
+            uint32_t bucket = (msb - 1) * 4 + sub;
+            return bucket < kHookHistogramBuckets ? bucket : kHookHistogramBuckets - 1;
+        }
+
+        // 桶的下界（包含）
+        uint64_t HookHistogramBucketLower(uint32_t bucket);
+
+        class HookStats {
+        public:
+            static HookStats &instance();
+
+            /**
+             * 注册一个 hook（安装时调用），同名的返回同一个编号
+             *
+             * @param name 只保存指针，需要一直有效（如字符串常量）
+             * @return 超过 kMaxHookSites 时返回 kInvalidHookSite，之后的调用不计数
+             */
+            uint32_t Register(const char *name);
+
+            // hook 中调用
+            void Record(uint32_t site, uint64_t ns);
+
+            // 按总耗时从大到小排序
+            std::vector<HookSiteStats> Snapshot() const;
+
+            // 清零（与正在进行的 Record 并发时可能漏掉几次调用）
+            void Reset();
+
+        private:
+            HookStats();
+
+            std::mutex register_mutex_;
+            std::atomic<uint32_t> site_count_{0};
+            std::atomic<const char *> names_[kMaxHookSites] = {};
+        };
+
+        std::string format_hook_stats(const std::vector<HookSiteStats> &stats);
+
+        inline uint64_t hook_now_ns() {
+            struct timespec ts{};
+            clock_gettime(CLOCK_MONOTONIC, &ts);
+            return static_cast<uint64_t>(ts.tv_sec) * 1000000000ULL + ts.tv_nsec;
+        }
+
+        // 作用域内的耗时记到 site
+        class HookTimer {
+        public:
+            explicit HookTimer(uint32_t site) : site_(site), start_(hook_now_ns()) {}
+
+            ~HookTimer() { HookStats::instance().Record(site_, hook_now_ns() - start_); }
+
+            HookTimer(const HookTimer &) = delete;
+
+            HookTimer &operator=(const HookTimer &) = delete;
+
+        private:
+            uint32_t site_;
+            uint64_t start_;
+        };
+
+    } // namespace hook
+};//namespace cyurs
+
+#endif //CYURS_HOOK_STATS_H
@@ -0,0 +1,57 @@
+#ifndef CYURS_INSTRUMENTED_HOOK_H
+#define CYURS_INSTRUMENTED_HOOK_H
+
+#include "shadowhook.h"
+#include "hook_stats.h"
+
+/**
+ * 带计数的 shadowhook 安装
+ *
+ * 每个替换函数生成一个同签名的跳板 Instrumented<my_func>::Call，跳板计时后调用替换函数，
+ * 安装的是跳板，替换函数和 orig 指针的用法不变：
+ *
+ *   InstrumentedHookSym<my_posix_spawn>("libc.so", "posix_spawn", reinterpret_cast<void **>(&orig_posix_spawn));
+ *
+ * 调用返回时才记录。会在 vfork 的子进程中执行的 hook（如 execve）不要使用跳板，子进程与父进程共享内存。
+ */
+namespace cyurs {
+    namespace hook {
+
+        template<auto Replacement>
+        struct Instrumented;
+
+        template<typename R, typename... Args, R (*Replacement)(Args...)>
+        struct Instrumented<Replacement> {
+            static inline std::atomic<uint32_t> site{kInvalidHookSite};
+
+            static R Call(Args... args) {
+                HookTimer timer(site.load(std::memory_order_relaxed));
+                return Replacement(args...);
+            }
+
+            static void Register(const char *name) {
+                if (site.load() == kInvalidHookSite) site.store(HookStats::instance().Register(name));
+            }
+        };
+
+        // shadowhook_hook_sym_name，name 为空时统计名称为符号名
+        template<auto Replacement>
+        void *InstrumentedHookSym(const char *lib_name, const char *sym_name, void **orig_addr,
+                                  const char *name = nullptr) {
+            Instrumented<Replacement>::Register(name != nullptr ? name : sym_name);
+            return shadowhook_hook_sym_name(lib_name, sym_name, reinterpret_cast<void *>(&Instrumented<Replacement>::Call),
+                                            orig_addr);
+        }
+
+        // shadowhook_hook_func_addr，地址没有符号名，需要指定统计名称
+        template<auto Replacement>
+        void *InstrumentedHookFuncAddr(void *func_addr, const char *name, void **orig_addr) {
+            Instrumented<Replacement>::Register(name);
+            return shadowhook_hook_func_addr(func_addr, reinterpret_cast<void *>(&Instrumented<Replacement>::Call),
+                                             orig_addr);
+        }
+
+    } // namespace hook
+};//namespace cyurs
+
+#endif //CYURS_INSTRUMENTED_HOOK_H
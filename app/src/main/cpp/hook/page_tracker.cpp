@@ -0,0 +1,178 @@
+#include "page_tracker.h"
+
+#include <errno.h>
+#include <sys/mman.h>
+#include <unistd.h>
+#include <algorithm>
+#include <android/log.h>
+
+#include "../maps/proc_maps.h"
+
+#define LOG_TAG "PageTracker"
+#define LOGE(...) __android_log_print(ANDROID_LOG_ERROR, LOG_TAG, __VA_ARGS__)
+
+namespace cyurs {
+    namespace hook {
+
+        static size_t page_size() {
+            static const size_t size = static_cast<size_t>(sysconf(_SC_PAGESIZE));
+            return size;
+        }
+
+        DexPageTracker::DexPageTracker(const uint8_t *begin, size_t size) : begin_(begin), size_(size) {
+            auto addr = reinterpret_cast<uintptr_t>(begin);
+            first_page_ = addr & ~(page_size() - 1);
+            page_count_ = (addr + size - first_page_ + page_size() - 1) / page_size();
+            size_t words = (page_count_ + 63) / 64;
+            bits_.reset(new std::atomic<uint64_t>[words]);
+            for (size_t i = 0; i < words; ++i) bits_[i].store(0, std::memory_order_relaxed);
+            orig_prot_.reset(new uint8_t[page_count_]());
+        }
+
+        bool DexPageTracker::ProtectRun(size_t first, size_t count, int prot, bool writable) {
+            // 原本就可写的页不需要 mprotect，只更新位图
+            if ((orig_prot_[first] & PROT_WRITE) == 0) {
+                void *addr = reinterpret_cast<void *>(first_page_ + first * page_size());
+                mprotect_calls_.fetch_add(1, std::memory_order_relaxed);
+                if (mprotect(addr, count * page_size(), prot) != 0) {
+                    LOGE("mprotect failed: addr=%p, pages=%zu, prot=%d, errno=%d", addr, count, prot, errno);
+                    return false;
+                }
+            }
+            for (size_t page = first; page < first + count; ++page) {
+                uint64_t bit = 1ULL << (page & 63);
+                if (writable) {
+                    bits_[page >> 6].fetch_or(bit, std::memory_order_release);
+                } else {
+                    bits_[page >> 6].fetch_and(~bit, std::memory_order_release);
+                }
+            }
+            return true;
+        }
+
+        void DexPageTracker::LoadProtection(size_t first, size_t last) {
+            uintptr_t start = first_page_ + first * page_size();
+            uintptr_t end = first_page_ + (last + 1) * page_size();
+            // maps 中找不到的页按 ART 的默认权限处理
+            for (size_t page = first; page <= last; ++page) orig_prot_[page] = PROT_READ;
+
+            maps::MapsReader reader;
+            reader.for_each([&](const maps::MapEntry &entry) {
+                if (entry.end <= start) return true;
+                if (entry.start >= end) return false;
+                uint8_t prot = (entry.readable() ? PROT_READ : 0) | (entry.writable() ? PROT_WRITE : 0) |
+                               (entry.executable() ? PROT_EXEC : 0);
+                size_t from = (std::max(entry.start, start) - first_page_) / page_size();
+                size_t to = (std::min(entry.end, end) - first_page_) / page_size();
+                for (size_t page = from; page < to; ++page) orig_prot_[page] = prot;
+                return true;
+            });
+        }
+
+        bool DexPageTracker::MakeWritable(const PageRange *ranges, size_t count) {
+            auto end = reinterpret_cast<uintptr_t>(begin_) + size_;
+            std::vector<size_t> pages;
+            bool in_range = true;
+            for (size_t i = 0; i < count; ++i) {
+                auto addr = reinterpret_cast<uintptr_t>(ranges[i].addr);
+                if (ranges[i].size == 0) continue;
+                if (addr < reinterpret_cast<uintptr_t>(begin_) || addr + ranges[i].size > end) {
+                    in_range = false;
+                    continue;
+                }
+                size_t first = (addr - first_page_) / page_size();
+                size_t last = (addr + ranges[i].size - 1 - first_page_) / page_size();
+                for (size_t page = first; page <= last; ++page) {
+                    if (!IsWritable(page)) pages.push_back(page);
+                }
+            }
+            // 全部已可写，不加锁
+            if (pages.empty()) return in_range;
+
+            std::sort(pages.begin(), pages.end());
+            pages.erase(std::unique(pages.begin(), pages.end()), pages.end());
+
+            std::lock_guard<std::mutex> lock(mutex_);
+            // 其他线程已经设置过
+            pages.erase(std::remove_if(pages.begin(), pages.end(), [this](size_t page) { return IsWritable(page); }),
+                        pages.end());
+            if (pages.empty()) return in_range;
+            LoadProtection(pages.front(), pages.back());
+
+            bool ok = in_range;
+            size_t run_start = 0;
+            size_t run_count = 0;
+            for (size_t page: pages) {
+                if (run_count != 0 && page == run_start + run_count && orig_prot_[page] == orig_prot_[run_start]) {
+                    ++run_count;
+                    continue;
+                }
+                if (run_count != 0) ok &= ProtectRun(run_start, run_count, orig_prot_[run_start] | PROT_WRITE, true);
+                run_start = page;
+                run_count = 1;
+            }
+            if (run_count != 0) ok &= ProtectRun(run_start, run_count, orig_prot_[run_start] | PROT_WRITE, true);
+            return ok;
+        }
+
+        size_t DexPageTracker::Restore() {
+            std::lock_guard<std::mutex> lock(mutex_);
+            size_t restored = 0;
+            size_t page = 0;
+            while (page < page_count_) {
+                if (!IsWritable(page)) {
+                    ++page;
+                    continue;
+                }
+                size_t first = page;
+                while (page < page_count_ && IsWritable(page) && orig_prot_[page] == orig_prot_[first]) ++page;
+                if (ProtectRun(first, page - first, orig_prot_[first], false)) restored += page - first;
+            }
+            return restored;
+        }
+
+        size_t DexPageTracker::writable_pages() const {
+            size_t count = 0;
+            for (size_t i = 0; i < (page_count_ + 63) / 64; ++i) {
+                count += static_cast<size_t>(__builtin_popcountll(bits_[i].load(std::memory_order_relaxed)));
+            }
+            return count;
+        }
+
+        DexPageTrackerCache &DexPageTrackerCache::instance() {
+            static DexPageTrackerCache cache;
+            return cache;
+        }
+
+        DexPageTracker *DexPageTrackerCache::Get(const uint8_t *begin, size_t size) {
+            if (begin == nullptr || size == 0) return nullptr;
+
+            // 同一线程连续回填同一个 dex
+            thread_local DexPageTracker *last_tracker = nullptr;
+            if (last_tracker != nullptr && last_tracker->begin() == begin && last_tracker->size() == size) {
+                return last_tracker;
+            }
+
+            std::lock_guard<std::mutex> lock(mutex_);
+            std::unique_ptr<DexPageTracker> &tracker = trackers_[{begin, size}];
+            if (tracker == nullptr) tracker.reset(new DexPageTracker(begin, size));
+            last_tracker = tracker.get();
+            return last_tracker;
+        }
+
+        size_t DexPageTrackerCache::RestoreAll() {
+            std::lock_guard<std::mutex> lock(mutex_);
+            size_t restored = 0;
+            for (auto &item: trackers_) restored += item.second->Restore();
+            return restored;
+        }
+
+        uint64_t DexPageTrackerCache::mprotect_calls() {
+            std::lock_guard<std::mutex> lock(mutex_);
+            uint64_t calls = 0;
+            for (auto &item: trackers_) calls += item.second->mprotect_calls();
+            return calls;
+        }
+
+    } // namespace hook
+};//namespace cyurs
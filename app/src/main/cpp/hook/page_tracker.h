@@ -0,0 +1,108 @@
+#ifndef CYURS_PAGE_TRACKER_H
+#define CYURS_PAGE_TRACKER_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <atomic>
+#include <memory>
+#include <map>
+#include <mutex>
+#include <utility>
+#include <vector>
+
+/**
+ * 回填 CodeItem 时 dex 内存的写权限管理
+ *
+ * 每个 dex 一个页位图，记录已可写的页：
+ *   - 只修改被写到的页，在原权限上加 PROT_WRITE（ART 和其他线程还在读）
+ *   - 每页最多 mprotect 一次，之后的检查只读位图，不加锁
+ *   - 一次传入多段时按页排序合并，原权限相同的连续页一次 mprotect
+ * 第一次设为可写前从 /proc/self/maps 读取页的原权限，Restore 恢复为原权限：
+ * 文件映射的 dex 通常为只读，壳在内存中加载的 dex 常为可读写，原本可写的页不做 mprotect。
+ */
+namespace cyurs {
+    namespace hook {
+
+        struct PageRange {
+            const void *addr;
+            size_t size;
+        };
+
+        class DexPageTracker {
+        public:
+            DexPageTracker(const uint8_t *begin, size_t size);
+
+            /**
+             * 使 ranges 覆盖的页可写，已可写的页跳过
+             *
+             * @return 有范围超出 dex 或 mprotect 失败返回 false
+             */
+            bool MakeWritable(const PageRange *ranges, size_t count);
+
+            bool MakeWritable(const void *addr, size_t size) {
+                PageRange range{addr, size};
+                return MakeWritable(&range, 1);
+            }
+
+            // 恢复为设为可写之前的权限，返回恢复的页数
+            size_t Restore();
+
+            const uint8_t *begin() const { return begin_; }
+
+            size_t size() const { return size_; }
+
+            uint32_t mprotect_calls() const { return mprotect_calls_.load(std::memory_order_relaxed); }
+
+            size_t writable_pages() const;
+
+        private:
+            bool IsWritable(size_t page) const {
+                return (bits_[page >> 6].load(std::memory_order_acquire) >> (page & 63)) & 1;
+            }
+
+            // 需持有 mutex_；writable 为页在位图中的新状态
+            bool ProtectRun(size_t first, size_t count, int prot, bool writable);
+
+            // 需持有 mutex_；从 maps 读取 [first, last] 页的当前权限写入 orig_prot_
+            void LoadProtection(size_t first, size_t last);
+
+            const uint8_t *begin_;
+            size_t size_;
+            // begin_ 所在页的起始地址
+            uintptr_t first_page_;
+            size_t page_count_;
+            std::unique_ptr<std::atomic<uint64_t>[]> bits_;
+            // 每页设为可写之前的权限（PROT_*），只在页可写时有效
+            std::unique_ptr<uint8_t[]> orig_prot_;
+            std::atomic<uint32_t> mprotect_calls_{0};
+            std::mutex mutex_;
+        };
+
+        /**
+         * 进程内的 DexPageTracker，按 dex 的内存地址和大小区分
+         *
+         * tracker 不会释放；每个线程记住上一次命中的 tracker，连续回填同一个 dex 时不加锁。
+         */
+        class DexPageTrackerCache {
+        public:
+            static DexPageTrackerCache &instance();
+
+            DexPageTracker *Get(const uint8_t *begin, size_t size);
+
+            // 恢复全部 dex 的页权限，返回恢复的页数
+            size_t RestoreAll();
+
+            // 全部 tracker 的 mprotect 调用次数
+            uint64_t mprotect_calls();
+
+        private:
+            DexPageTrackerCache() = default;
+
+            std::mutex mutex_;
+            std::map<std::pair<const uint8_t *, size_t>, std::unique_ptr<DexPageTracker>> trackers_;
+        };
+
+    } // namespace hook
+};//namespace cyurs
+
+#endif //CYURS_PAGE_TRACKER_H
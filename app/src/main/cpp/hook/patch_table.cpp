@@ -0,0 +1,457 @@
+#include "patch_table.h"
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <algorithm>
+#include <cstdio>
+#include <cerrno>
+#include <cstdlib>
+#include <cstring>
+#include <map>
+#include <unordered_map>
+
+namespace cyurs {
+    namespace hook {
+
+        // 每个种子最多尝试的位移，找不到时换种子重建
+        static constexpr uint32_t kMaxDisplacement = 1u << 20;
+        static constexpr uint32_t kMaxSeedAttempts = 16;
+
+        static uint64_t Mix64(uint64_t x) {
+            x ^= x >> 30;
+            x *= 0xBF58476D1CE4E5B9ULL;
+            x ^= x >> 27;
+            x *= 0x94D049BB133111EBULL;
+            x ^= x >> 31;
+            return x;
+        }
+
+        static uint64_t HashKey(uint32_t kind, uint64_t dex_key, uint32_t method_idx, uint32_t seed) {
+            return Mix64(Mix64(dex_key ^ seed) ^ ((static_cast<uint64_t>(method_idx) << 2) | kind));
+        }
+
+        // 桶内第 d 次尝试的槽位，[0, n)
+        static uint32_t SlotOf(uint64_t hash, uint32_t displacement, uint32_t n) {
+            auto mixed = static_cast<uint32_t>(Mix64(hash ^ (displacement * 0x9E3779B97F4A7C15ULL)) >> 32);
+            return static_cast<uint32_t>((static_cast<uint64_t>(mixed) * n) >> 32);
+        }
+
+        uint64_t HashPatchLocation(std::string_view location) {
+            uint64_t hash = 14695981039346656037ULL;
+            for (char c: location) {
+                hash ^= static_cast<uint8_t>(c);
+                hash *= 1099511628211ULL;
+            }
+            return hash;
+        }
+
+        // 参与完美哈希的 64 位键
+        static uint64_t SpecKey(const PatchSpec &spec) {
+            switch (spec.kind) {
+                case kPatchKeyDexChecksum:
+                    return spec.dex_key;
+                case kPatchKeyLocation:
+                    return HashPatchLocation(spec.location);
+                default:
+                    return 0;
+            }
+        }
+
+        static int HexValue(char c) {
+            if (c >= '0' && c <= '9') return c - '0';
+            if (c >= 'a' && c <= 'f') return c - 'a' + 10;
+            if (c >= 'A' && c <= 'F') return c - 'A' + 10;
+            return -1;
+        }
+
+        static bool ParseNumber(std::string_view token, uint32_t &out) {
+            std::string str(token);
+            char *end = nullptr;
+            errno = 0;
+            unsigned long long value = strtoull(str.c_str(), &end, 0);
+            if (str.empty() || errno != 0 || *end != '\0' || value > 0xFFFFFFFFULL) return false;
+            out = static_cast<uint32_t>(value);
+            return true;
+        }
+
+        static bool IsSpace(char c) {
+            return c == ' ' || c == '\t' || c == '\r';
+        }
+
+        static std::string_view NextToken(std::string_view &line) {
+            size_t begin = 0;
+            while (begin < line.size() && IsSpace(line[begin])) ++begin;
+            size_t end = begin;
+            while (end < line.size() && !IsSpace(line[end])) ++end;
+            std::string_view token = line.substr(begin, end - begin);
+            line.remove_prefix(end);
+            return token;
+        }
+
+        static bool ParseLine(std::string_view line, PatchSpec &spec, std::string &reason) {
+            std::string_view key = NextToken(line);
+            std::string_view method = NextToken(line);
+            if (key == "*") {
+                spec.kind = kPatchKeyAnyDex;
+                spec.dex_key = 0;
+            } else if (key.substr(0, 4) == "loc:") {
+                spec.kind = kPatchKeyLocation;
+                spec.location.assign(key.substr(4));
+            } else if (ParseNumber(key, spec.dex_key)) {
+                spec.kind = kPatchKeyDexChecksum;
+            } else {
+                reason = "bad dex key";
+                return false;
+            }
+            if (!ParseNumber(method, spec.method_idx)) {
+                reason = "bad method_idx";
+                return false;
+            }
+
+            // 剩下的是 insns 字节，允许空白分隔
+            std::vector<uint8_t> bytes;
+            int high = -1;
+            for (char c: line) {
+                if (IsSpace(c)) continue;
+                int value = HexValue(c);
+                if (value < 0) {
+                    reason = "bad hex digit";
+                    return false;
+                }
+                if (high < 0) {
+                    high = value;
+                } else {
+                    bytes.push_back(static_cast<uint8_t>((high << 4) | value));
+                    high = -1;
+                }
+            }
+            if (bytes.empty() || high >= 0 || (bytes.size() & 1) != 0) {
+                reason = "insns must be whole code units";
+                return false;
+            }
+            spec.insns.resize(bytes.size() / 2);
+            memcpy(spec.insns.data(), bytes.data(), bytes.size());
+            return true;
+        }
+
+        bool ParsePatchText(std::string_view text, std::vector<PatchSpec> &specs, std::string *error) {
+            size_t line_no = 0;
+            while (!text.empty()) {
+                size_t end = text.find('\n');
+                std::string_view line = text.substr(0, end);
+                text.remove_prefix(end == std::string_view::npos ? text.size() : end + 1);
+                ++line_no;
+
+                while (!line.empty() && IsSpace(line.front())) line.remove_prefix(1);
+                if (line.empty() || line.front() == '#') continue;
+
+                PatchSpec spec;
+                std::string reason;
+                if (!ParseLine(line, spec, reason)) {
+                    if (error != nullptr) *error = "line " + std::to_string(line_no) + ": " + reason;
+                    return false;
+                }
+                specs.push_back(std::move(spec));
+            }
+            return true;
+        }
+
+        // 为全部键找到无冲突的位移，失败返回 false
+        static bool Displace(const std::vector<const PatchSpec *> &keys, const std::vector<uint64_t> &dex_keys,
+                             uint32_t seed, uint32_t bucket_count,
+                             std::vector<uint32_t> &displacements, std::vector<uint32_t> &slots) {
+            auto n = static_cast<uint32_t>(keys.size());
+            std::vector<uint64_t> hashes(n);
+            std::vector<std::vector<uint32_t>> buckets(bucket_count);
+            for (uint32_t i = 0; i < n; ++i) {
+                hashes[i] = HashKey(keys[i]->kind, dex_keys[i], keys[i]->method_idx, seed);
+                buckets[hashes[i] & (bucket_count - 1)].push_back(i);
+            }
+
+            // 大的桶先放
+            std::vector<uint32_t> order(bucket_count);
+            for (uint32_t b = 0; b < bucket_count; ++b) order[b] = b;
+            std::stable_sort(order.begin(), order.end(), [&](uint32_t a, uint32_t b) {
+                return buckets[a].size() > buckets[b].size();
+            });
+
+            displacements.assign(bucket_count, 0);
+            slots.assign(n, 0);
+            std::vector<bool> used(n, false);
+            std::vector<uint32_t> candidate;
+            for (uint32_t b: order) {
+                const std::vector<uint32_t> &bucket = buckets[b];
+                if (bucket.empty()) break;
+                bool placed = false;
+                for (uint32_t d = 0; d < kMaxDisplacement && !placed; ++d) {
+                    candidate.clear();
+                    placed = true;
+                    for (uint32_t key: bucket) {
+                        uint32_t slot = SlotOf(hashes[key], d, n);
+                        if (used[slot] || std::find(candidate.begin(), candidate.end(), slot) != candidate.end()) {
+                            placed = false;
+                            break;
+                        }
+                        candidate.push_back(slot);
+                    }
+                    if (!placed) continue;
+                    displacements[b] = d;
+                    for (size_t i = 0; i < bucket.size(); ++i) {
+                        used[candidate[i]] = true;
+                        slots[bucket[i]] = candidate[i];
+                    }
+                }
+                if (!placed) return false;
+            }
+            return true;
+        }
+
+        bool BuildPatchTableImage(const std::vector<PatchSpec> &specs, std::vector<uint8_t> &out) {
+            // 去重，后出现的覆盖前面的；location 键按字符串去重
+            std::unordered_map<std::string, size_t> index;
+            std::vector<const PatchSpec *> keys;
+            uint16_t key_kinds = 0;
+            std::string unique_key;
+            for (const PatchSpec &spec: specs) {
+                if (spec.kind > kPatchKeyAnyDex || spec.insns.empty()) return false;
+                unique_key.assign(reinterpret_cast<const char *>(&spec.kind), sizeof(spec.kind));
+                unique_key.append(reinterpret_cast<const char *>(&spec.method_idx), sizeof(spec.method_idx));
+                if (spec.kind == kPatchKeyDexChecksum) {
+                    unique_key.append(reinterpret_cast<const char *>(&spec.dex_key), sizeof(spec.dex_key));
+                } else if (spec.kind == kPatchKeyLocation) {
+                    unique_key.append(spec.location);
+                }
+                auto result = index.emplace(unique_key, keys.size());
+                if (result.second) {
+                    keys.push_back(&spec);
+                } else {
+                    keys[result.first->second] = &spec;
+                }
+                key_kinds |= static_cast<uint16_t>(1u << spec.kind);
+            }
+
+            // 只有注释的文本文件等
+            if (keys.empty()) return false;
+
+            auto n = static_cast<uint32_t>(keys.size());
+            std::vector<uint64_t> dex_keys(n);
+            // 不同 location 的 64 位哈希相同且 method_idx 相同时无法放进完美哈希
+            std::map<std::pair<uint64_t, uint32_t>, const std::string *> location_keys;
+            uint64_t insns_size = 0;
+            for (uint32_t i = 0; i < n; ++i) {
+                dex_keys[i] = SpecKey(*keys[i]);
+                insns_size += keys[i]->insns.size() * sizeof(uint16_t);
+                if (keys[i]->kind != kPatchKeyLocation) continue;
+                auto result = location_keys.emplace(std::make_pair(dex_keys[i], keys[i]->method_idx),
+                                                    &keys[i]->location);
+                if (!result.second && *result.first->second != keys[i]->location) return false;
+            }
+
+            // location 字符串放在 insns 之后，相同的只存一份
+            std::unordered_map<std::string_view, uint32_t> location_offs;
+            std::string locations;
+            for (const PatchSpec *spec: keys) {
+                if (spec->kind != kPatchKeyLocation || location_offs.count(spec->location) != 0) continue;
+                location_offs.emplace(spec->location, static_cast<uint32_t>(insns_size + locations.size()));
+                locations.append(spec->location);
+            }
+            uint64_t data_size = insns_size + locations.size();
+
+            // 平均每个桶 2 ~ 4 个键
+            uint32_t bucket_count = 1;
+            while (bucket_count < n / 4 + 1) bucket_count <<= 1;
+
+            std::vector<uint32_t> displacements;
+            std::vector<uint32_t> slots;
+            uint32_t seed = 0;
+            bool ok = false;
+            for (uint32_t attempt = 0; attempt < kMaxSeedAttempts && !ok; ++attempt) {
+                seed = static_cast<uint32_t>(Mix64(attempt + 1));
+                ok = Displace(keys, dex_keys, seed, bucket_count, displacements, slots);
+            }
+            if (!ok) return false;
+
+            uint64_t buckets_off = sizeof(PatchTableHeader);
+            uint64_t entries_off = buckets_off + static_cast<uint64_t>(bucket_count) * sizeof(uint32_t);
+            uint64_t data_off = entries_off + static_cast<uint64_t>(n) * sizeof(PatchEntry);
+            uint64_t file_size = (data_off + data_size + 3) & ~3ULL;
+            if (file_size > 0xFFFFFFFFULL) return false;
+
+            out.assign(file_size, 0);
+            PatchTableHeader header{};
+            memcpy(header.magic_, kPatchTableMagic, sizeof(kPatchTableMagic));
+            header.version_ = kPatchTableVersion;
+            header.key_kinds_ = key_kinds;
+            header.entry_count_ = n;
+            header.bucket_count_ = bucket_count;
+            header.seed_ = seed;
+            header.buckets_off_ = static_cast<uint32_t>(buckets_off);
+            header.entries_off_ = static_cast<uint32_t>(entries_off);
+            header.data_off_ = static_cast<uint32_t>(data_off);
+            header.data_size_ = static_cast<uint32_t>(data_size);
+            header.file_size_ = static_cast<uint32_t>(file_size);
+            memcpy(out.data(), &header, sizeof(header));
+            if (bucket_count != 0) {
+                memcpy(out.data() + buckets_off, displacements.data(), bucket_count * sizeof(uint32_t));
+            }
+
+            uint32_t insns_off = 0;
+            for (uint32_t i = 0; i < n; ++i) {
+                const PatchSpec &spec = *keys[i];
+                PatchEntry entry{spec.kind, static_cast<uint32_t>(dex_keys[i]), spec.method_idx, insns_off,
+                                 static_cast<uint32_t>(spec.insns.size()), static_cast<uint32_t>(dex_keys[i] >> 32),
+                                 0, 0};
+                if (spec.kind == kPatchKeyLocation) {
+                    entry.location_off_ = location_offs[spec.location];
+                    entry.location_size_ = static_cast<uint32_t>(spec.location.size());
+                }
+                memcpy(out.data() + entries_off + static_cast<uint64_t>(slots[i]) * sizeof(PatchEntry),
+                       &entry, sizeof(entry));
+                size_t bytes = spec.insns.size() * sizeof(uint16_t);
+                memcpy(out.data() + data_off + insns_off, spec.insns.data(), bytes);
+                insns_off += static_cast<uint32_t>(bytes);
+            }
+            if (!locations.empty()) memcpy(out.data() + data_off + insns_size, locations.data(), locations.size());
+            return true;
+        }
+
+        PatchTable::~PatchTable() {
+            if (base_ != nullptr) munmap(base_, map_size_);
+        }
+
+        std::unique_ptr<PatchTable> PatchTable::Map(void *base, size_t size, std::string *error) {
+            // 先接管映射，校验失败时由析构释放
+            std::unique_ptr<PatchTable> table(new PatchTable());
+            table->base_ = base;
+            table->map_size_ = size;
+
+            auto fail = [error](const char *reason) {
+                if (error != nullptr) *error = reason;
+                return std::unique_ptr<PatchTable>();
+            };
+            const auto *bytes = static_cast<const uint8_t *>(base);
+            if (size < sizeof(PatchTableHeader)) return fail("file too small");
+            const auto *header = reinterpret_cast<const PatchTableHeader *>(bytes);
+            if (memcmp(header->magic_, kPatchTableMagic, sizeof(kPatchTableMagic)) != 0) return fail("bad magic");
+            if (header->version_ != kPatchTableVersion) return fail("unsupported version");
+            if (header->file_size_ > size) return fail("truncated");
+
+            uint32_t n = header->entry_count_;
+            uint32_t bucket_count = header->bucket_count_;
+            if (bucket_count == 0 || (bucket_count & (bucket_count - 1)) != 0) return fail("bad bucket count");
+            if (((header->buckets_off_ | header->entries_off_ | header->data_off_) & 3) != 0) {
+                return fail("misaligned sections");
+            }
+            uint64_t file_size = header->file_size_;
+            if (header->buckets_off_ + static_cast<uint64_t>(bucket_count) * sizeof(uint32_t) > file_size ||
+                header->entries_off_ + static_cast<uint64_t>(n) * sizeof(PatchEntry) > file_size ||
+                static_cast<uint64_t>(header->data_off_) + header->data_size_ > file_size) {
+                return fail("section out of range");
+            }
+
+            const auto *entries = reinterpret_cast<const PatchEntry *>(bytes + header->entries_off_);
+            for (uint32_t i = 0; i < n; ++i) {
+                const PatchEntry &entry = entries[i];
+                if (entry.kind_ > kPatchKeyAnyDex || (entry.insns_off_ & 1) != 0 ||
+                    entry.insns_off_ + static_cast<uint64_t>(entry.insns_size_) * sizeof(uint16_t) > header->data_size_ ||
+                    static_cast<uint64_t>(entry.location_off_) + entry.location_size_ > header->data_size_) {
+                    return fail("bad entry");
+                }
+            }
+
+            table->header_ = header;
+            table->buckets_ = reinterpret_cast<const uint32_t *>(bytes + header->buckets_off_);
+            table->entries_ = entries;
+            table->data_ = bytes + header->data_off_;
+            return table;
+        }
+
+        std::unique_ptr<PatchTable> PatchTable::FromImage(const uint8_t *data, size_t size, std::string *error) {
+            size_t map_size = std::max<size_t>(size, 1);
+            void *base = mmap(nullptr, map_size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+            if (base == MAP_FAILED) {
+                if (error != nullptr) *error = "mmap failed";
+                return nullptr;
+            }
+            memcpy(base, data, size);
+            mprotect(base, map_size, PROT_READ);
+            return Map(base, map_size, error);
+        }
+
+        std::unique_ptr<PatchTable> PatchTable::Open(const std::string &path, std::string *error) {
+            int fd = open(path.c_str(), O_RDONLY | O_CLOEXEC);
+            if (fd < 0) {
+                if (error != nullptr) *error = "open failed: " + std::string(strerror(errno));
+                return nullptr;
+            }
+            struct stat st{};
+            if (fstat(fd, &st) != 0 || st.st_size <= 0) {
+                close(fd);
+                if (error != nullptr) *error = "empty file";
+                return nullptr;
+            }
+            auto size = static_cast<size_t>(st.st_size);
+            void *base = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+            close(fd);
+            if (base == MAP_FAILED) {
+                if (error != nullptr) *error = "mmap failed: " + std::string(strerror(errno));
+                return nullptr;
+            }
+
+            // 已编译的镜像直接使用文件映射
+            if (size >= sizeof(kPatchTableMagic) && memcmp(base, kPatchTableMagic, sizeof(kPatchTableMagic)) == 0) {
+                return Map(base, size, error);
+            }
+
+            std::vector<PatchSpec> specs;
+            bool parsed = ParsePatchText(std::string_view(static_cast<const char *>(base), size), specs, error);
+            munmap(base, size);
+            if (!parsed) return nullptr;
+            if (specs.empty()) {
+                if (error != nullptr) *error = "no patches";
+                return nullptr;
+            }
+            std::vector<uint8_t> image;
+            if (!BuildPatchTableImage(specs, image)) {
+                if (error != nullptr) *error = "build failed";
+                return nullptr;
+            }
+            return FromImage(image.data(), image.size(), error);
+        }
+
+        const PatchEntry *PatchTable::FindSlot(PatchKeyKind kind, uint64_t dex_key, uint32_t method_idx) const {
+            uint32_t n = header_->entry_count_;
+            if (n == 0 || !has_kind(kind)) return nullptr;
+            uint64_t hash = HashKey(kind, dex_key, method_idx, header_->seed_);
+            uint32_t displacement = buckets_[hash & (header_->bucket_count_ - 1)];
+            const PatchEntry *entry = &entries_[SlotOf(hash, displacement, n)];
+            if (entry->kind_ != kind || entry->method_idx_ != method_idx ||
+                entry->dex_key_ != static_cast<uint32_t>(dex_key) ||
+                entry->dex_key_high_ != static_cast<uint32_t>(dex_key >> 32)) {
+                return nullptr;
+            }
+            return entry;
+        }
+
+        const PatchEntry *PatchTable::Find(PatchKeyKind kind, uint32_t dex_key, uint32_t method_idx) const {
+            if (kind == kPatchKeyLocation) return nullptr;
+            return FindSlot(kind, dex_key, method_idx);
+        }
+
+        const PatchEntry *PatchTable::FindLocation(std::string_view location, uint32_t method_idx) const {
+            if (!has_kind(kPatchKeyLocation)) return nullptr;
+            const PatchEntry *entry = FindSlot(kPatchKeyLocation, HashPatchLocation(location), method_idx);
+            return entry != nullptr && this->location(*entry) == location ? entry : nullptr;
+        }
+
+        const PatchEntry *PatchTable::Find(uint32_t dex_checksum, std::string_view location, uint32_t method_idx) const {
+            const PatchEntry *entry = Find(kPatchKeyDexChecksum, dex_checksum, method_idx);
+            if (entry == nullptr) entry = FindLocation(location, method_idx);
+            if (entry == nullptr) entry = Find(kPatchKeyAnyDex, 0, method_idx);
+            return entry;
+        }
+
+    } // namespace hook
+};//namespace cyurs
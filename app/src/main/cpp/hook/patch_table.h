@@ -0,0 +1,173 @@
+#ifndef CYURS_PATCH_TABLE_H
+#define CYURS_PATCH_TABLE_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <vector>
+
+/**
+ * LoadMethod hook 的 CodeItem 补丁表
+ *
+ * 键为 (dex 标识, method_idx)，值为替换的 insns，insns 从 code_item 的 insns 起始处覆盖。
+ * dex 标识有三种：
+ *   dex 头中的 checksum_、DexFile location、任意 dex（如只知道 method_idx 的单 dex 壳）。
+ * 查找顺序为 checksum -> location -> 任意 dex，表中没有的键类型直接跳过（没有 location 键时不计算 location 哈希）。
+ * location 键按 64 位哈希定位，location 字符串保存在数据区，命中后再比较字符串，哈希冲突不会误匹配。
+ *
+ * 表为完美哈希（CHD：先按哈希分桶，每个桶找一个位移使桶内的键落到互不冲突的槽位），查找固定两次哈希 + 一次比较。
+ * 编译后的二进制镜像可以直接 mmap 使用；文本补丁文件在加载时编译到匿名映射中。
+ *
+ * 文本格式，每行一个补丁，# 开头为注释：
+ *   0x26fff606 73 1a00 8700 1100     dex checksum、method_idx、insns 的十六进制字节（按文件中的字节序）
+ *   loc:/data/app/.../base.apk 73 ...  location（与 DexFile.location_ 完全一致）
+ *   * 73 ...                          任意 dex
+ * 同一个键出现多次时以最后一次为准。
+ *
+ * 二进制格式（小端）：
+ *   PatchTableHeader | uint32_t displacements[bucket_count] | PatchEntry[entry_count] | insns 数据 | location 字符串
+ */
+namespace cyurs {
+    namespace hook {
+
+        constexpr char kPatchTableMagic[4] = {'P', 'T', 'C', 'H'};
+        constexpr uint16_t kPatchTableVersion = 2;
+
+        enum PatchKeyKind : uint32_t {
+            kPatchKeyDexChecksum = 0,
+            kPatchKeyLocation = 1,
+            kPatchKeyAnyDex = 2,
+        };
+
+        struct PatchTableHeader {
+            char magic_[4];
+            uint16_t version_;
+            // 表中出现的键类型，1 << PatchKeyKind
+            uint16_t key_kinds_;
+            uint32_t entry_count_;
+            // 2 的幂
+            uint32_t bucket_count_;
+            uint32_t seed_;
+            // 以下偏移相对于文件起始，4 字节对齐
+            uint32_t buckets_off_;
+            uint32_t entries_off_;
+            uint32_t data_off_;
+            uint32_t data_size_;
+            uint32_t file_size_;
+        };
+
+        struct PatchEntry {
+            uint32_t kind_;
+            // dex checksum / location 哈希的低 32 位，任意 dex 时为 0
+            uint32_t dex_key_;
+            uint32_t method_idx_;
+            // 相对于数据区，字节
+            uint32_t insns_off_;
+            // code unit 个数
+            uint32_t insns_size_;
+            // location 哈希的高 32 位，其他键为 0
+            uint32_t dex_key_high_;
+            // location 字符串，相对于数据区；其他键为 0
+            uint32_t location_off_;
+            uint32_t location_size_;
+        };
+
+        // 编译前的补丁
+        struct PatchSpec {
+            PatchKeyKind kind = kPatchKeyDexChecksum;
+            // kPatchKeyDexChecksum 时为 checksum
+            uint32_t dex_key = 0;
+            // kPatchKeyLocation 时为 location
+            std::string location;
+            uint32_t method_idx = 0;
+            std::vector<uint16_t> insns;
+        };
+
+        // location 键的哈希（FNV-1a 64）
+        uint64_t HashPatchLocation(std::string_view location);
+
+        /**
+         * 解析文本补丁文件
+         *
+         * @param error 失败时为带行号的错误信息
+         */
+        bool ParsePatchText(std::string_view text, std::vector<PatchSpec> &specs, std::string *error);
+
+        /**
+         * 编译为二进制镜像（可写到文件，之后由 PatchTable::Open 直接 mmap）
+         *
+         * @return 补丁为空、键类型无效，或两个不同的 location 64 位哈希相同且 method_idx 相同时返回 false
+         */
+        bool BuildPatchTableImage(const std::vector<PatchSpec> &specs, std::vector<uint8_t> &out);
+
+        class PatchTable {
+        public:
+            ~PatchTable();
+
+            PatchTable(const PatchTable &) = delete;
+
+            PatchTable &operator=(const PatchTable &) = delete;
+
+            /**
+             * 打开补丁文件：二进制镜像直接 mmap，文本文件编译到匿名映射
+             *
+             * @return 文件不存在或格式错误返回 nullptr，error 为原因
+             */
+            static std::unique_ptr<PatchTable> Open(const std::string &path, std::string *error);
+
+            // 校验并使用内存中的二进制镜像（拷贝到只读匿名映射）
+            static std::unique_ptr<PatchTable> FromImage(const uint8_t *data, size_t size, std::string *error);
+
+            // checksum / 任意 dex 键
+            const PatchEntry *Find(PatchKeyKind kind, uint32_t dex_key, uint32_t method_idx) const;
+
+            // location 键，比较 location 字符串
+            const PatchEntry *FindLocation(std::string_view location, uint32_t method_idx) const;
+
+            /**
+             * 按 checksum -> location -> 任意 dex 的顺序查找
+             *
+             * @param location 只有表中有 location 键时才会被哈希
+             */
+            const PatchEntry *Find(uint32_t dex_checksum, std::string_view location, uint32_t method_idx) const;
+
+            const uint16_t *insns(const PatchEntry &entry) const {
+                return reinterpret_cast<const uint16_t *>(data_ + entry.insns_off_);
+            }
+
+            // location 键的 location，其他键为空
+            std::string_view location(const PatchEntry &entry) const {
+                return {reinterpret_cast<const char *>(data_ + entry.location_off_), entry.location_size_};
+            }
+
+            uint32_t size() const { return header_->entry_count_; }
+
+            // 全部补丁（按槽位顺序）
+            const PatchEntry *begin() const { return entries_; }
+
+            const PatchEntry *end() const { return entries_ + size(); }
+
+            bool has_kind(PatchKeyKind kind) const { return (header_->key_kinds_ & (1u << kind)) != 0; }
+
+        private:
+            PatchTable() = default;
+
+            static std::unique_ptr<PatchTable> Map(void *base, size_t size, std::string *error);
+
+            // 按 (kind, 64 位键, method_idx) 定位槽位，不比较 location 字符串
+            const PatchEntry *FindSlot(PatchKeyKind kind, uint64_t dex_key, uint32_t method_idx) const;
+
+            void *base_ = nullptr;
+            size_t map_size_ = 0;
+            const PatchTableHeader *header_ = nullptr;
+            const uint32_t *buckets_ = nullptr;
+            const PatchEntry *entries_ = nullptr;
+            const uint8_t *data_ = nullptr;
+        };
+
+    } // namespace hook
+};//namespace cyurs
+
+#endif //CYURS_PATCH_TABLE_H
@@ -0,0 +1,303 @@
+#ifndef CYURS_PROC_MAPS_H
+#define CYURS_PROC_MAPS_H
+
+#include <stdint.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <errno.h>
+#include <cstring>
+#include <memory>
+#include <set>
+#include <string>
+#include <string_view>
+#include <vector>
+
+/**
+ * /proc/self/maps 解析器
+ *
+ * 1. 以大块（默认 64KB）read() 读取 maps，避免 std::getline / fgets 逐行读取的开销；
+ * 2. 每一行在读缓冲区里原地切分为 string_view 字段，解析过程不分配内存；
+ * 3. 通过 filter / visitor 回调处理每一行，去重交给 PathDeduper。
+ *
+ * 注意：MapEntry 中的 string_view 只在 visitor 回调期间有效，需要保存时自行拷贝。
+ */
+namespace cyurs {
+    namespace maps {
+
+        // maps 中的一行
+        // 格式: start-end perms offset dev inode pathname
+        struct MapEntry {
+            uintptr_t start = 0;
+            uintptr_t end = 0;
+            std::string_view perms;
+            uint64_t offset = 0;
+            std::string_view dev;
+            uint64_t inode = 0;
+            // 可能为空（匿名映射）、[anon:xxx] / [stack] 等伪路径，或者 / 开头的文件路径
+            std::string_view path;
+            // 原始行（不含换行符）
+            std::string_view line;
+
+            size_t size() const { return end - start; }
+
+            bool readable() const { return perms.size() > 0 && perms[0] == 'r'; }
+
+            bool writable() const { return perms.size() > 1 && perms[1] == 'w'; }
+
+            bool executable() const { return perms.size() > 2 && perms[2] == 'x'; }
+
+            // 文件映射
+            bool is_file() const { return !path.empty() && path[0] == '/'; }
+
+            // 匿名映射（没有路径，或 [anon:xxx]）
+            bool is_anonymous() const {
+                return path.empty() || path.compare(0, 6, "[anon:") == 0;
+            }
+        };
+
+        inline bool parse_hex(std::string_view &s, uint64_t &out) {
+            uint64_t v = 0;
+            size_t i = 0;
+            for (; i < s.size(); ++i) {
+                char c = s[i];
+                uint32_t d;
+                if (c >= '0' && c <= '9') d = c - '0';
+                else if (c >= 'a' && c <= 'f') d = c - 'a' + 10;
+                else if (c >= 'A' && c <= 'F') d = c - 'A' + 10;
+                else break;
+                v = (v << 4) | d;
+            }
+            if (i == 0) return false;
+            out = v;
+            s.remove_prefix(i);
+            return true;
+        }
+
+        inline bool parse_dec(std::string_view &s, uint64_t &out) {
+            uint64_t v = 0;
+            size_t i = 0;
+            for (; i < s.size() && s[i] >= '0' && s[i] <= '9'; ++i) {
+                v = v * 10 + (s[i] - '0');
+            }
+            if (i == 0) return false;
+            out = v;
+            s.remove_prefix(i);
+            return true;
+        }
+
+        inline void skip_spaces(std::string_view &s) {
+            size_t i = 0;
+            while (i < s.size() && (s[i] == ' ' || s[i] == '\t')) ++i;
+            s.remove_prefix(i);
+        }
+
+        inline std::string_view next_token(std::string_view &s) {
+            skip_spaces(s);
+            size_t i = 0;
+            while (i < s.size() && s[i] != ' ' && s[i] != '\t') ++i;
+            std::string_view token = s.substr(0, i);
+            s.remove_prefix(i);
+            return token;
+        }
+
+        // 解析一行 maps，成功返回 true
+        inline bool parse_line(std::string_view line, MapEntry &entry) {
+            std::string_view s = line;
+            uint64_t start, end, offset, inode;
+
+            if (!parse_hex(s, start) || s.empty() || s[0] != '-') return false;
+            s.remove_prefix(1);
+            if (!parse_hex(s, end)) return false;
+
+            std::string_view perms = next_token(s);
+            skip_spaces(s);
+            if (!parse_hex(s, offset)) return false;
+            std::string_view dev = next_token(s);
+            skip_spaces(s);
+            if (!parse_dec(s, inode)) return false;
+            skip_spaces(s);
+
+            entry.start = static_cast<uintptr_t>(start);
+            entry.end = static_cast<uintptr_t>(end);
+            entry.perms = perms;
+            entry.offset = offset;
+            entry.dev = dev;
+            entry.inode = inode;
+            entry.path = s;
+            entry.line = line;
+            return true;
+        }
+
+        /**
+         * 判断路径是否带有指定后缀（后面紧跟空白或结束），
+         * 等价于原来的正则 "\.so(\s|$)"，同时兼容 "xxx.so (deleted)" 这种情况。
+         */
+        inline bool path_has_extension(std::string_view path, std::string_view ext) {
+            size_t pos = path.find(ext);
+            while (pos != std::string_view::npos) {
+                size_t next = pos + ext.size();
+                if (pos > 0 && (next == path.size() || path[next] == ' ' || path[next] == '\t')) {
+                    return true;
+                }
+                pos = path.find(ext, pos + 1);
+            }
+            return false;
+        }
+
+        class MapsReader {
+        public:
+            static constexpr size_t kDefaultBufferSize = 64 * 1024;
+
+            explicit MapsReader(size_t buffer_size = kDefaultBufferSize)
+                    : buffer_(new char[buffer_size]), capacity_(buffer_size) {
+            }
+
+            /**
+             * 遍历 maps 的每一行原始文本（不含换行符）
+             *
+             * @param line_visitor bool(std::string_view line)，返回 false 停止遍历
+             * @return 打开 maps 失败返回 false
+             */
+            template<typename LineVisitor>
+            bool for_each_line(LineVisitor &&line_visitor, const char *maps_path = "/proc/self/maps") {
+                int fd = open(maps_path, O_RDONLY | O_CLOEXEC);
+                if (fd < 0) return false;
+
+                char *buf = buffer_.get();
+                size_t used = 0;
+                bool eof = false;
+                bool stop = false;
+                // 正在丢弃超长行的剩余部分
+                bool skipping = false;
+
+                while (!eof && !stop) {
+                    ssize_t n = read(fd, buf + used, capacity_ - used);
+                    if (n < 0) {
+                        if (errno == EINTR) continue;
+                        break;
+                    }
+                    if (n == 0) {
+                        eof = true;
+                    }
+                    used += static_cast<size_t>(n);
+
+                    // 逐行切分当前缓冲区中完整的行
+                    size_t begin = 0;
+                    if (skipping) {
+                        const char *nl = static_cast<const char *>(memchr(buf, '\n', used));
+                        if (nl == nullptr) {
+                            used = 0;
+                            continue;
+                        }
+                        skipping = false;
+                        begin = nl - buf + 1;
+                    }
+                    while (begin < used) {
+                        const char *nl = static_cast<const char *>(memchr(buf + begin, '\n', used - begin));
+                        if (nl == nullptr) {
+                            // 最后一行没有换行符
+                            if (eof) {
+                                stop = !line_visitor(std::string_view(buf + begin, used - begin));
+                                begin = used;
+                            }
+                            break;
+                        }
+                        size_t len = nl - (buf + begin);
+                        if (!line_visitor(std::string_view(buf + begin, len))) {
+                            stop = true;
+                            break;
+                        }
+                        begin += len + 1;
+                    }
+
+                    // 把不完整的行挪到缓冲区头部，与下一块拼接
+                    if (begin > 0) {
+                        memmove(buf, buf + begin, used - begin);
+                        used -= begin;
+                    } else if (used == capacity_) {
+                        // 单行超过缓冲区大小，丢弃到下一个换行符为止
+                        used = 0;
+                        skipping = true;
+                    }
+                }
+
+                close(fd);
+                return true;
+            }
+
+            /**
+             * 遍历 maps 中解析成功的每一项
+             *
+             * @param filter  bool(const MapEntry&)，返回 false 的项不会交给 visitor
+             * @param visitor bool(const MapEntry&)，返回 false 停止遍历
+             */
+            template<typename Filter, typename Visitor>
+            bool for_each(Filter &&filter, Visitor &&visitor, const char *maps_path = "/proc/self/maps") {
+                return for_each_line([&](std::string_view line) {
+                    MapEntry entry;
+                    if (!parse_line(line, entry)) return true;
+                    if (!filter(entry)) return true;
+                    return static_cast<bool>(visitor(entry));
+                }, maps_path);
+            }
+
+            template<typename Visitor>
+            bool for_each(Visitor &&visitor, const char *maps_path = "/proc/self/maps") {
+                return for_each([](const MapEntry &) { return true; }, visitor, maps_path);
+            }
+
+        private:
+            std::unique_ptr<char[]> buffer_;
+            size_t capacity_;
+        };
+
+        /**
+         * 路径去重
+         *
+         * maps 中同一个文件的多个段通常是相邻的，先和上一条路径比较，命中则不查集合；
+         * 只有第一次出现的路径才会拷贝成 std::string 保存。
+         */
+        class PathDeduper {
+        public:
+            // 第一次出现返回 true
+            bool insert(std::string_view path) {
+                if (last_ != nullptr && *last_ == path) return false;
+                auto it = seen_.find(path);
+                if (it != seen_.end()) {
+                    last_ = &*it;
+                    return false;
+                }
+                last_ = &*seen_.emplace(path).first;
+                return true;
+            }
+
+            const std::set<std::string, std::less<>> &paths() const { return seen_; }
+
+        private:
+            std::set<std::string, std::less<>> seen_;
+            const std::string *last_ = nullptr;
+        };
+
+        /**
+         * 收集满足条件的去重路径，按第一次出现的顺序返回
+         *
+         * @param filter bool(const MapEntry&)
+         */
+        template<typename Filter>
+        std::vector<std::string> collect_unique_paths(Filter &&filter) {
+            std::vector<std::string> result;
+            PathDeduper deduper;
+            MapsReader reader;
+            reader.for_each(filter, [&](const MapEntry &entry) {
+                if (deduper.insert(entry.path)) {
+                    result.emplace_back(entry.path);
+                }
+                return true;
+            });
+            return result;
+        }
+
+    } // namespace maps
+};//namespace cyurs
+
+#endif //CYURS_PROC_MAPS_H
@@ -15,6 +15,9 @@
 #include <cstdint>
 #include <sys/stat.h>
 #include "soinfo.h"
+#include "../maps/proc_maps.h"
+
+using namespace cyurs;
 
 #define LOG_TAG "SoUnpack"
 #define LOGI(...) __android_log_print(ANDROID_LOG_INFO, LOG_TAG, __VA_ARGS__)
@@ -50,47 +53,35 @@ struct ModuleInfo {
 
 // 获取模块信息
 ModuleInfo get_module_info(const char* module_name) {
-    FILE* fp = fopen("/proc/self/maps", "r");
-    if (!fp) return {};
-
-    char line[512];
-    uintptr_t start = 0, end = 0;
-    char perms[5] = {0};
-    char path[256] = {0};
     ModuleInfo info;
-
-    while (fgets(line, sizeof(line), fp)) {
-        if (strstr(line, module_name)) {
-            // 格式: start-end perms offset dev inode pathname
-            if (sscanf(line, "%lx-%lx %4s %*s %*s %*s %255[^\n]", &start, &end, perms, path) >= 3) {
-                info.base = start;
-                info.size = end - start;
-                info.permissions = perms;
-                info.path = path;
-                break;  // 只获取第一个匹配到的模块
-            }
-        }
-    }
-
-    fclose(fp);
+    maps::MapsReader reader(16 * 1024);
+    reader.for_each(
+            [&](const maps::MapEntry &entry) {
+                return entry.path.find(module_name) != std::string_view::npos;
+            },
+            [&](const maps::MapEntry &entry) {
+                info.base = entry.start;
+                info.size = entry.size();
+                info.permissions.assign(entry.perms);
+                info.path.assign(entry.path);
+                return false;  // 只获取第一个匹配到的模块
+            });
     return info;
 }
 
 
 // 获取模块基址（通过 /proc/self/maps 或 dlopen + dladdr 等）
 uintptr_t get_module_base(const char* module_name) {
-    FILE* fp = fopen("/proc/self/maps", "r");
-    if (!fp) return 0;
-
-    char line[512];
     uintptr_t base = 0;
-    while (fgets(line, sizeof(line), fp)) {
-        if (strstr(line, module_name)) {
-            sscanf(line, "%lx-%*lx %*s %*s %*s %*d", &base);
-            break;
-        }
-    }
-    fclose(fp);
+    maps::MapsReader reader(16 * 1024);
+    reader.for_each(
+            [&](const maps::MapEntry &entry) {
+                return entry.path.find(module_name) != std::string_view::npos;
+            },
+            [&](const maps::MapEntry &entry) {
+                base = entry.start;
+                return false;
+            });
     return base;
 }
 
@@ -3,6 +3,7 @@
 #include "shadowhook.h"
 #include <link.h>
 #include <string.h>
+#include "hook/instrumented_hook.h"
 
 #define TAG "sohooker"
 #define LOGI(...) __android_log_print(ANDROID_LOG_INFO, TAG, __VA_ARGS__)
@@ -107,9 +108,16 @@ __attribute__((constructor)) static void init_hook() {
     LOGI("🎯 hooking address: %p", (void *) target_addr);
 
     // Hook
-    shadowhook_hook_func_addr(
+    cyurs::hook::InstrumentedHookFuncAddr<fake_ca>(
             (void *) target_addr,             // target
-            (void *) fake_ca,                 // replacement
+            "ca",                             // 统计名称
             (void **) &orig_ca_func           // backup
     );
 }
+
+extern "C"
+JNIEXPORT jstring JNICALL
+Java_com_cyrus_example_sohooker_SoHooker_getHookStats(JNIEnv *env, jclass) {
+    return env->NewStringUTF(
+            cyurs::hook::format_hook_stats(cyurs::hook::HookStats::instance().Snapshot()).c_str());
+}
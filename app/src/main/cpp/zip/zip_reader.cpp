@@ -0,0 +1,221 @@
+#include "zip_reader.h"
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <cstring>
+#include <memory>
+#include <zlib.h>
+
+namespace cyurs {
+    namespace zip {
+
+        namespace {
+
+            constexpr uint32_t kEocdSignature = 0x06054b50;
+            constexpr uint32_t kCentralDirSignature = 0x02014b50;
+            constexpr uint32_t kLocalHeaderSignature = 0x04034b50;
+
+            constexpr size_t kEocdSize = 22;
+            constexpr size_t kCentralDirHeaderSize = 46;
+            constexpr size_t kLocalHeaderSize = 30;
+            // EOCD 后面最多跟 65535 字节的注释
+            constexpr size_t kMaxCommentSize = 0xFFFF;
+
+            inline uint16_t read_u16(const uint8_t *p) {
+                return static_cast<uint16_t>(p[0] | (p[1] << 8));
+            }
+
+            inline uint32_t read_u32(const uint8_t *p) {
+                return static_cast<uint32_t>(p[0]) | (static_cast<uint32_t>(p[1]) << 8) |
+                       (static_cast<uint32_t>(p[2]) << 16) | (static_cast<uint32_t>(p[3]) << 24);
+            }
+
+        } // namespace
+
+        ZipArchive::~ZipArchive() {
+            Close();
+        }
+
+        bool ZipArchive::Open(const std::string &path) {
+            Close();
+            int fd = open(path.c_str(), O_RDONLY | O_CLOEXEC);
+            if (fd < 0) return false;
+
+            struct stat st{};
+            if (fstat(fd, &st) != 0 || st.st_size < static_cast<off_t>(kEocdSize)) {
+                close(fd);
+                return false;
+            }
+
+            void *base = mmap(nullptr, static_cast<size_t>(st.st_size), PROT_READ, MAP_PRIVATE, fd, 0);
+            close(fd);
+            if (base == MAP_FAILED) return false;
+
+            data_ = static_cast<const uint8_t *>(base);
+            size_ = static_cast<size_t>(st.st_size);
+            mapped_ = true;
+            if (!ParseEndOfCentralDirectory()) {
+                Close();
+                return false;
+            }
+            return true;
+        }
+
+        bool ZipArchive::OpenMemory(const uint8_t *data, size_t size) {
+            Close();
+            data_ = data;
+            size_ = size;
+            mapped_ = false;
+            if (!ParseEndOfCentralDirectory()) {
+                Close();
+                return false;
+            }
+            return true;
+        }
+
+        void ZipArchive::Close() {
+            if (mapped_ && data_ != nullptr) {
+                munmap(const_cast<uint8_t *>(data_), size_);
+            }
+            data_ = nullptr;
+            size_ = 0;
+            mapped_ = false;
+            central_dir_ = nullptr;
+            central_dir_size_ = 0;
+            entry_count_ = 0;
+        }
+
+        bool ZipArchive::ParseEndOfCentralDirectory() {
+            if (size_ < kEocdSize) return false;
+
+            // 从文件末尾往前找 EOCD 签名
+            size_t min_pos = size_ > kEocdSize + kMaxCommentSize ? size_ - kEocdSize - kMaxCommentSize : 0;
+            for (size_t pos = size_ - kEocdSize + 1; pos-- > min_pos;) {
+                const uint8_t *eocd = data_ + pos;
+                if (read_u32(eocd) != kEocdSignature) continue;
+
+                uint16_t comment_size = read_u16(eocd + 20);
+                if (pos + kEocdSize + comment_size > size_) continue;
+
+                uint32_t cd_size = read_u32(eocd + 12);
+                uint32_t cd_offset = read_u32(eocd + 16);
+                // 可能是注释中的假签名，继续往前找
+                if (static_cast<uint64_t>(cd_offset) + cd_size > pos) continue;
+
+                central_dir_ = data_ + cd_offset;
+                central_dir_size_ = cd_size;
+                entry_count_ = read_u16(eocd + 10);
+                return true;
+            }
+            return false;
+        }
+
+        void ZipArchive::ForEachEntry(const EntryVisitor &visitor) const {
+            const uint8_t *p = central_dir_;
+            const uint8_t *end = central_dir_ + central_dir_size_;
+
+            for (uint32_t i = 0; i < entry_count_; ++i) {
+                if (p + kCentralDirHeaderSize > end || read_u32(p) != kCentralDirSignature) return;
+
+                uint16_t name_len = read_u16(p + 28);
+                uint16_t extra_len = read_u16(p + 30);
+                uint16_t comment_len = read_u16(p + 32);
+                if (p + kCentralDirHeaderSize + name_len > end) return;
+
+                ZipEntry entry;
+                entry.method = read_u16(p + 10);
+                entry.crc32 = read_u32(p + 16);
+                entry.compressed_size = read_u32(p + 20);
+                entry.uncompressed_size = read_u32(p + 24);
+                entry.local_header_offset = read_u32(p + 42);
+                entry.name = std::string_view(reinterpret_cast<const char *>(p + kCentralDirHeaderSize), name_len);
+
+                if (!visitor(entry)) return;
+                p += kCentralDirHeaderSize + name_len + extra_len + comment_len;
+            }
+        }
+
+        bool ZipArchive::FindEntry(std::string_view name, ZipEntry &out) const {
+            bool found = false;
+            ForEachEntry([&](const ZipEntry &entry) {
+                if (entry.name == name) {
+                    out = entry;
+                    found = true;
+                    return false;
+                }
+                return true;
+            });
+            return found;
+        }
+
+        const uint8_t *ZipArchive::GetEntryData(const ZipEntry &entry) const {
+            uint64_t off = entry.local_header_offset;
+            if (off + kLocalHeaderSize > size_) return nullptr;
+
+            const uint8_t *local = data_ + off;
+            if (read_u32(local) != kLocalHeaderSignature) return nullptr;
+
+            // local header 里的 name / extra 长度可能和中央目录不同（如对齐用的 extra）
+            uint64_t data_off = off + kLocalHeaderSize + read_u16(local + 26) + read_u16(local + 28);
+            if (data_off + entry.compressed_size > size_) return nullptr;
+            return data_ + data_off;
+        }
+
+        bool ZipArchive::StreamEntry(const ZipEntry &entry, const ChunkSink &sink, size_t chunk_size) const {
+            const uint8_t *src = GetEntryData(entry);
+            if (src == nullptr) return false;
+
+            if (entry.method == kMethodStored) {
+                // 不压缩的条目直接在映射上扫描
+                if (entry.compressed_size > 0) sink(src, entry.compressed_size);
+                return true;
+            }
+            if (entry.method != kMethodDeflated) return false;
+
+            z_stream stream{};
+            // 负数 windowBits 表示 raw deflate（zip 中没有 zlib 头）
+            if (inflateInit2(&stream, -MAX_WBITS) != Z_OK) return false;
+
+            std::unique_ptr<uint8_t[]> out(new uint8_t[chunk_size]);
+            stream.next_in = const_cast<Bytef *>(src);
+            stream.avail_in = entry.compressed_size;
+
+            bool ok = true;
+            int ret = Z_OK;
+            while (ret != Z_STREAM_END) {
+                stream.next_out = out.get();
+                stream.avail_out = static_cast<uInt>(chunk_size);
+                ret = inflate(&stream, Z_NO_FLUSH);
+                if (ret != Z_OK && ret != Z_STREAM_END) {
+                    ok = false;
+                    break;
+                }
+                size_t produced = chunk_size - stream.avail_out;
+                if (produced > 0 && !sink(out.get(), produced)) break;
+                if (ret == Z_OK && produced == 0 && stream.avail_in == 0) {
+                    // 数据被截断
+                    ok = false;
+                    break;
+                }
+            }
+
+            inflateEnd(&stream);
+            return ok;
+        }
+
+        bool IsClassesDex(std::string_view name) {
+            constexpr std::string_view prefix = "classes";
+            constexpr std::string_view suffix = ".dex";
+            if (name.size() < prefix.size() + suffix.size()) return false;
+            if (name.compare(0, prefix.size(), prefix) != 0) return false;
+            if (name.compare(name.size() - suffix.size(), suffix.size(), suffix) != 0) return false;
+            for (size_t i = prefix.size(); i < name.size() - suffix.size(); ++i) {
+                if (name[i] < '0' || name[i] > '9') return false;
+            }
+            return true;
+        }
+
+    } // namespace zip
+};//namespace cyurs
@@ -0,0 +1,92 @@
+#ifndef CYURS_ZIP_READER_H
+#define CYURS_ZIP_READER_H
+
+#include <stdint.h>
+#include <functional>
+#include <string>
+#include <string_view>
+
+/**
+ * 只读 zip（apk / jar）解析
+ *
+ * 从文件末尾的 End of Central Directory 找到中央目录，直接在 mmap 上遍历条目，不读取整个文件。
+ * STORED 条目直接返回映射中的数据，DEFLATED 条目按固定大小分块流式解压。
+ */
+namespace cyurs {
+    namespace zip {
+
+        constexpr uint16_t kMethodStored = 0;
+        constexpr uint16_t kMethodDeflated = 8;
+
+        struct ZipEntry {
+            // 指向中央目录中的文件名，ZipArchive 存活期间有效
+            std::string_view name;
+            uint16_t method = 0;
+            uint32_t crc32 = 0;
+            uint32_t compressed_size = 0;
+            uint32_t uncompressed_size = 0;
+            uint32_t local_header_offset = 0;
+        };
+
+        // 返回 false 停止
+        using EntryVisitor = std::function<bool(const ZipEntry &)>;
+        // 解压输出回调，返回 false 停止
+        using ChunkSink = std::function<bool(const uint8_t *, size_t)>;
+
+        class ZipArchive {
+        public:
+            ZipArchive() = default;
+
+            ~ZipArchive();
+
+            ZipArchive(const ZipArchive &) = delete;
+
+            ZipArchive &operator=(const ZipArchive &) = delete;
+
+            // mmap 打开文件
+            bool Open(const std::string &path);
+
+            // 使用已有的内存（不拷贝、不负责释放）
+            bool OpenMemory(const uint8_t *data, size_t size);
+
+            void Close();
+
+            // 遍历中央目录
+            void ForEachEntry(const EntryVisitor &visitor) const;
+
+            bool FindEntry(std::string_view name, ZipEntry &out) const;
+
+            // 条目压缩数据在映射中的起始地址（解析 local file header），失败返回 nullptr
+            const uint8_t *GetEntryData(const ZipEntry &entry) const;
+
+            /**
+             * 流式读取条目内容
+             *
+             * STORED：直接把映射中的数据交给 sink（只回调一次）
+             * DEFLATED：每次解压 chunk_size 字节交给 sink
+             */
+            bool StreamEntry(const ZipEntry &entry, const ChunkSink &sink, size_t chunk_size = 64 * 1024) const;
+
+            const uint8_t *begin() const { return data_; }
+
+            size_t size() const { return size_; }
+
+        private:
+            bool ParseEndOfCentralDirectory();
+
+            const uint8_t *data_ = nullptr;
+            size_t size_ = 0;
+            bool mapped_ = false;
+
+            const uint8_t *central_dir_ = nullptr;
+            size_t central_dir_size_ = 0;
+            uint32_t entry_count_ = 0;
+        };
+
+        // classes.dex、classes2.dex ... classesN.dex
+        bool IsClassesDex(std::string_view name);
+
+    } // namespace zip
+};//namespace cyurs
+
+#endif //CYURS_ZIP_READER_H
@@ -0,0 +1,108 @@
+package com.cyrus.example.dex_tools
+
+object DexTools {
+
+    init {
+        System.loadLibrary("dex_tools")
+    }
+
+    /**
+     * LEB128 解码微基准：解码 dex 中全部 class_data_item，对比逐字节、快速路径和批量解码的耗时
+     *
+     * @param path .dex / .cdex / .vdex 文件，或 apk / jar（如 /system/framework/framework.jar）
+     * @param iterations 每种实现重复解码的轮数
+     * @return 每个 dex 的统计结果，读取失败返回 null
+     */
+    @JvmStatic
+    external fun benchmarkLeb128(path: String, iterations: Int): String?
+
+    /**
+     * 直接解析 class_data 列出 dex 中全部方法（不加载类、不依赖 hook）
+     *
+     * 每行格式：Lclass;->name shorty idx=method_idx flags=0x.. code_off=0x.. insns=指令长度
+     *
+     * @param path .dex / .cdex / .vdex 文件，或 apk / jar
+     */
+    @JvmStatic
+    external fun listMethods(path: String): Array<String>
+
+    /**
+     * 用 dump 出来的方法体修复 dex（函数抽取壳）
+     *
+     * dump 支持 FART 文本格式（{name:..,method_idx:..,offset:..,code_item_len:..,ins:Base64};）和 CDMP 二进制格式。
+     * 原 code_item 放得下的直接覆盖，放不下的追加到文件末尾并重写对应类的 class_data，最后重新计算 checksum / signature。
+     *
+     * @param dexPath 待修复的 .dex；apk / jar 时修复其中全部 classes*.dex，此时 outPath 为输出目录
+     * @param threads 线程数，0 表示使用 CPU 核数
+     * @return 统计信息，失败返回 null
+     */
+    @JvmStatic
+    external fun repairDex(dexPath: String, dumpPath: String, outPath: String, threads: Int): String?
+
+    /**
+     * 重新计算 dex 头的 checksum（Adler-32）和 signature（SHA-1），原地写回文件
+     */
+    @JvmStatic
+    external fun fixDexHeader(path: String): Boolean
+
+    /**
+     * 重新布局 dex：去重 string_data / type_list / code_item 等，丢弃没有被引用的数据，重建 map_list 并修正全部偏移
+     *
+     * 输出是确定的（同一个输入多次重写结果相同），适合修复后的 dex 重新被 ART 加载或做 diff。
+     *
+     * @param dexPath .dex / .cdex / .vdex，或 apk / jar；vdex、v41 容器中的 cdex / dex 输出为独立的标准 dex（有多个 dex 时 outPath 为输出目录）
+     * @param dedupCodeItems 内容相同的 code_item 是否合并为一份
+     * @return 统计信息，失败返回 null
+     */
+    @JvmStatic
+    external fun rewriteDex(dexPath: String, outPath: String, dedupCodeItems: Boolean): String?
+
+    /**
+     * 按符号查找 method_idx（哈希索引，不遍历 method_ids）
+     *
+     * 索引第一次使用时构建并保存为 cacheDir 下的 .nidx 文件（按 dex 的 checksum + file_size 命名），之后直接加载。
+     *
+     * @param path .dex / .cdex / .vdex，或 apk / jar
+     * @param symbols 如 Lcom/foo/Bar;->name(I)V 或 com.foo.Bar.name(I)V，不带签名时匹配第一个重载
+     * @param cacheDir 索引目录（如 context.cacheDir），null 时只在内存中使用
+     * @return 每个找到的符号一行：symbol -> dex 位置 idx=method_idx
+     */
+    @JvmStatic
+    external fun findMethods(path: String, symbols: Array<String>, cacheDir: String?): Array<String>
+
+    /**
+     * 批量读取 dex 的 string_ids[start, start + count)
+     *
+     * 全部字符串一次解码（SIMD 的 MUTF-8 -> UTF-16）到同一块缓冲区，再用 NewString 创建，不经过 NewStringUTF。
+     *
+     * @param path .dex / .cdex / .vdex，或 apk / jar
+     * @param dexIndex 第几个 dex（apk / vdex 中有多个 dex 时，按 classes.dex、classes2.dex... 的顺序）
+     * @return 超出 string_ids 的部分被忽略；dex 不存在返回空数组
+     */
+    @JvmStatic
+    external fun getStrings(path: String, dexIndex: Int, start: Int, count: Int): Array<String>
+
+    /**
+     * 反汇编方法体（格式接近 dexdump -d），索引解析为字符串、类型、字段和方法签名
+     *
+     * @param path .dex / .cdex / .vdex，或 apk / jar
+     * @param symbol 同 findMethods，如 Lcom/foo/Bar;->name(I)V
+     * @return 找不到方法返回 null
+     */
+    @JvmStatic
+    external fun disassemble(path: String, symbol: String): String?
+
+    /**
+     * dump ClassLoader（及其全部 parent）中已加载的全部 dex，用于脱壳后落盘
+     *
+     * 直接读取 DexFile.mCookie 中的 art::DexFile，按 location_checksum + dex 头去重后多线程写到 outDir，
+     * cdex / v41 容器中的 dex 转成标准 dex；outDir 下的 dex_index.txt 记录 location、基址、大小和 sha1。
+     *
+     * @param classLoaders 如 arrayOf(context.classLoader, pluginClassLoader)
+     * @param outDir 输出目录（需已存在）
+     * @param threads 线程数，0 表示使用 CPU 核数
+     * @return 统计信息，写索引失败返回 null
+     */
+    @JvmStatic
+    external fun dumpLoadedDex(classLoaders: Array<ClassLoader>, outDir: String, threads: Int): String?
+}
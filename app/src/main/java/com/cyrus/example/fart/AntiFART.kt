@@ -1,5 +1,8 @@
 package com.cyrus.example.fart
 
+import java.nio.ByteBuffer
+import java.nio.ByteOrder
+
 object AntiFART {
 
     private val TAG = AntiFART.javaClass.simpleName
@@ -27,6 +30,58 @@ object AntiFART {
     @JvmStatic
     external fun dumpMethods(className: String): String
 
+    /**
+     * 批量获取多个类的方法，返回紧凑的二进制，用 [parseMethodDump] 解析
+     *
+     * jclass / jmethodID 在 JNI_OnLoad 中缓存，方法索引直接从 ArtMethod.dex_method_index_ 读取，
+     * 签名从声明类所在 dex 的 method_ids 中解析，适合一次 dump 成千上万个类。
+     */
+    @JvmStatic
+    external fun dumpMethodsBulk(classNames: Array<String>): ByteArray?
+
+    data class MethodRecord(
+        // dex 中的 method_idx，-1 表示读取 ArtMethod 失败
+        val dexMethodIndex: Int,
+        val accessFlags: Int,
+        // 声明类所在 dex 的 checksum，0 表示没有解析到 dex
+        val dexChecksum: Int,
+        val name: String,
+        // dexChecksum 不为 0 时为 dex 中的签名，如 (ILjava/lang/String;)V；否则为 Method.toString()
+        val descriptor: String
+    )
+
+    /**
+     * 解析 [dumpMethodsBulk] 的结果，类不存在时对应的值为 null
+     */
+    @JvmStatic
+    fun parseMethodDump(bytes: ByteArray): Map<String, List<MethodRecord>?> {
+        val buffer = ByteBuffer.wrap(bytes).order(ByteOrder.LITTLE_ENDIAN)
+        fun readString(): String {
+            val len = buffer.short.toInt() and 0xFFFF
+            val str = String(bytes, buffer.position(), len, Charsets.UTF_8)
+            buffer.position(buffer.position() + len)
+            return str
+        }
+
+        val result = LinkedHashMap<String, List<MethodRecord>?>()
+        if (buffer.int != 0x504d444d) return result
+        if (buffer.short.toInt() != 2) return result // version
+        buffer.short // reserved
+        val classCount = buffer.int
+        repeat(classCount) {
+            val className = readString()
+            val methodCount = buffer.int
+            if (methodCount == -1) {
+                result[className] = null
+                return@repeat
+            }
+            result[className] = List(methodCount) {
+                MethodRecord(buffer.int, buffer.int, buffer.int, readString(), readString())
+            }
+        }
+        return result
+    }
+
     /**
      * 读取 /proc/self/maps 文件，获取当前 app 已加载的所有文件
      */
@@ -95,4 +150,34 @@ object AntiFART {
     @JvmStatic
     external fun detectFartInLoadedDex(): Array<String>
 
+    /**
+     * 启动 /proc/self/maps 增量监控线程
+     *
+     * 每次轮询只对新出现的文件映射和匿名可执行映射做特征扫描，适合检测壳在运行后期才加载的 dex / so。
+     *
+     * @param intervalMs 轮询间隔（毫秒）
+     * @return 已经在运行时返回 false
+     */
+    @JvmStatic
+    external fun startMapsWatcher(intervalMs: Int): Boolean
+
+    @JvmStatic
+    external fun stopMapsWatcher()
+
+    /**
+     * 取出 maps 监控线程检测到的结果（取出后清空）
+     */
+    @JvmStatic
+    external fun pollMapsWatcher(): Array<String>
+
+    /**
+     * 在所有可读的匿名映射中查找内存加载的 dex（InMemoryDexClassLoader、壳解密出来的 dex）
+     *
+     * 找到的 dex 会做 FART 特征检测
+     *
+     * @param dumpDir 不为空时把找到的 dex 写到该目录
+     */
+    @JvmStatic
+    external fun scanAnonymousDex(dumpDir: String?): Array<String>
+
 }
@@ -33,19 +33,148 @@ object CyrusStudioHook {
     @JvmStatic
     external fun hookLoadMethod()
 
+    /**
+     * 加载 LoadMethod hook 的 CodeItem 补丁表，替换之前加载的表
+     *
+     * 补丁文件为文本格式（每行：dex checksum / loc:location / *、method_idx、insns 十六进制字节）
+     * 或编译后的二进制镜像（直接 mmap）。
+     *
+     * @param path 补丁文件路径
+     * @return 补丁条数，文件不存在或格式错误返回 -1
+     */
+    @JvmStatic
+    external fun loadPatchTable(path: String): Int
+
+    /**
+     * 把回填时设为可写的 dex 内存页恢复为只读
+     *
+     * 之后再有回填会重新设置可写。
+     *
+     * @return 恢复的页数
+     */
+    @JvmStatic
+    external fun restoreDexPages(): Int
+
+    /**
+     * hook execve / posix_spawn / posix_spawnp，按规则拦截；没有加载规则时拒绝 dex2oat（dex2oat / dex2oatBatch 启动的子进程不受影响）
+     */
     @JvmStatic
     external fun hookExecve()
 
     /**
-     * 使用 execve 调用 dex2oat 对指定 dex 进行优化
+     * 加载 execve / posix_spawn 拦截规则，原子替换当前规则（可以在 hookExecve 之前或之后调用）
+     *
+     * 每行一条：<allow|deny|rewrite|redirect> <路径 glob> [参数正则] [=> 动作参数]，第一条匹配的规则生效，例如：
+     *   deny      **dex2oat**
+     *   rewrite   **dex2oat*  --compiler-filter=speed  => $@ --compiler-filter=verify
+     *   redirect  /system/bin/dex2oat64  => /data/local/tmp/dex2oat_wrapper
+     *
+     * @param path 规则文件路径
+     * @return 规则条数，文件不存在或格式错误返回 -1
+     */
+    @JvmStatic
+    external fun loadExecRules(path: String): Int
+
+    /**
+     * 开始采集 LoadMethod 中的 code_item（需先 hookLoadMethod）
+     *
+     * 记录先写入每个线程的缓冲区，后台线程定期批量写到文件，格式为 CDMP 二进制 dump，可用于 dex 修复。
+     *
+     * @param path 输出文件路径，已存在时覆盖
+     * @return 文件创建失败返回 false
+     */
+    @JvmStatic
+    external fun startCodeCapture(path: String): Boolean
+
+    /**
+     * 停止采集并写出剩余数据
+     *
+     * @return 统计信息（采集条数、缓冲区满丢弃条数、写出字节数）
+     */
+    @JvmStatic
+    external fun stopCodeCapture(): String
+
+    /**
+     * 在 native 中主动加载 ClassLoader 中的类，让抽取壳回填的 code_item 经过 LoadMethod hook
+     *
+     * 遍历全部 dex 的 class_defs，按范围文件过滤后由工作线程异步处理，可配合 startCodeCapture 使用。
+     *
+     * @param classLoader 目标 ClassLoader（包括 parent 中的 dex）
+     * @param scopePath 范围文件，每行 +包名前缀 / -包名前缀，# 为注释；null 表示全部类
+     * @param checkpointPath 进度文件，存在时跳过其中已完成的类；null 表示不保存进度
+     * @param threads 工作线程数（1 ~ 16）
+     * @param classesPerSecond 每秒最多处理的类数，0 不限速
+     * @param mode 0 loadClass（不初始化），1 Class.forName 初始化，2 初始化并解析全部方法
+     * @return 正在运行或范围文件错误返回 false
+     */
+    @JvmStatic
+    external fun startActiveInvoke(
+        classLoader: ClassLoader,
+        scopePath: String?,
+        checkpointPath: String?,
+        threads: Int,
+        classesPerSecond: Int,
+        mode: Int
+    ): Boolean
+
+    /**
+     * 停止主动调用（等待正在处理的类完成）并保存进度
+     *
+     * @return 进度信息
+     */
+    @JvmStatic
+    external fun stopActiveInvoke(): String
+
+    @JvmStatic
+    external fun getActiveInvokeProgress(): String
+
+    /**
+     * 在子进程中调用 dex2oat 对指定 dex 进行优化，等待其退出（阻塞，不要在主线程调用）
      *
      * 注意！！！ 需要 root 环境 + 修改 SELinux 策略 ！！！
      *
      * @param dexPath 要优化的 .dex 文件路径（如 /data/local/tmp/classes.dex）
      * @param oatPath 优化输出的 .odex 文件路径（如 /data/local/tmp/classes.odex）
-     * @return true 表示调用成功（不代表 dex2oat 成功执行）
+     * @return dex2oat 退出码为 0 时返回 true
      */
     @JvmStatic
     external fun dex2oat(dexPath: String, oatPath: String): Boolean
 
+    /**
+     * 并行编译多个 dex，编译结果按 (dex checksum, dex 路径, 命令及参数) 缓存，未改变的 dex 不会重新编译（阻塞）
+     *
+     * @param dexPaths 输入文件
+     * @param oatPaths 输出文件，与 dexPaths 一一对应
+     * @param compiler 编译命令，null 为 /system/bin/dex2oat（测试时可以用任意命令代替）
+     * @param args 参数模板，{dex} / {oat} 替换为输入 / 输出路径；null 为 dex2oat 的默认参数
+     * @param cacheDir 缓存目录，null 不缓存
+     * @param maxJobs 同时运行的子进程数（1 ~ 16）
+     * @return 每个任务的状态：0 成功（包括缓存命中），127 无法启动，128 + N 被信号 N 终止，其余为退出码；
+     *         dexPaths 与 oatPaths 长度不同时返回 null
+     */
+    @JvmStatic
+    external fun dex2oatBatch(
+        dexPaths: Array<String>,
+        oatPaths: Array<String>,
+        compiler: String?,
+        args: Array<String>?,
+        cacheDir: String?,
+        maxJobs: Int
+    ): IntArray?
+
+    /**
+     * 已安装 hook 的调用次数和耗时，每个 hook 一行，按总耗时从大到小：
+     *   posix_spawn calls=12 total=0.840ms mean=70.0us p50=64.0us p90=128.0us p99=128.0us max=101.2us
+     *
+     * 分位数为直方图桶的上界（相对误差 < 25%）；只统计返回的调用；execve 不统计（会在 vfork 的子进程中执行）
+     */
+    @JvmStatic
+    external fun getHookStats(): String
+
+    /**
+     * 清零 hook 统计
+     */
+    @JvmStatic
+    external fun resetHookStats()
+
 }
@@ -1,8 +1,10 @@
 package com.cyrus.example.shell
 
 import android.content.Context
+import com.cyrus.example.hook.CyrusStudioHook
 import com.cyrus.example.hotfix.Hotfix
 import dalvik.system.InMemoryDexClassLoader
+import java.io.File
 import java.nio.ByteBuffer
 
 /**
@@ -35,6 +37,19 @@ object DexExtract {
         return classLoader!!
     }
 
+    /**
+     * 把 assets 中的补丁文件拷贝到私有目录，并加载为 LoadMethod hook 的补丁表
+     *
+     * @return 补丁条数，失败返回 -1
+     */
+    fun loadPatchTable(context: Context): Int {
+        val patchFile = File(context.filesDir, "classes3_extracted.patch")
+        context.assets.open("classes3_extracted.patch").use { input ->
+            patchFile.outputStream().use { output -> input.copyTo(output) }
+        }
+        return CyrusStudioHook.loadPatchTable(patchFile.absolutePath)
+    }
+
     fun getString(): String? {
         // 通过反射加载目标类
         try {
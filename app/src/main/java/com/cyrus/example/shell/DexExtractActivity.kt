@@ -39,6 +39,7 @@ class DexExtractActivity : ComponentActivity() {
             Button(
                 onClick = {
                     output += "Clicked: hook LoadMethod，自动回填 CodeItem\n"
+                    output += "补丁表：${DexExtract.loadPatchTable(this@DexExtractActivity)} 条\n"
                     CyrusStudioHook.hookLoadMethod()
                 },
                 modifier = Modifier
@@ -0,0 +1,13 @@
+package com.cyrus.example.sohooker
+
+object SoHooker {
+
+    /**
+     * libsohooker.so 中 hook 的调用次数和耗时，格式同 CyrusStudioHook.getHookStats
+     *
+     * 需要先 System.loadLibrary("sohooker")
+     */
+    @JvmStatic
+    external fun getHookStats(): String
+
+}